@@ -32,11 +32,12 @@
 
 #include "DXTCompressorDLL.h"
 #include <cassert>
+#include <cfloat>
 #include <cstdlib>
 #include <cstring>
 #include <emmintrin.h>
 
-#define ALIGN16(x) __declspec(align(16)) x
+#define ALIGN16(x) alignas(16) x
 #define INSET_SHIFT 4 // Inset the bounding box with (range >> shift).
 #define C565_5_MASK 0xF8 // 0xFF minus last three bits
 #define C565_6_MASK 0xFC // 0xFF minus last two bits
@@ -71,6 +72,8 @@ namespace DXTC
 	ALIGN16(static uint32_t SIMD_SSE2_dword_alpha_bit_mask6[4]) = { 7 << 18, 0, 7 << 18, 0 };
 	ALIGN16(static uint32_t SIMD_SSE2_dword_alpha_bit_mask7[4]) = { 7 << 21, 0, 7 << 21, 0 };
 
+	static const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
 	// Compress an image using DXT1 compression. Use the inBuf parameter to point to an image in
 	// 4-byte RGBA format. The width and height parameters specify the size of the image in pixels.
 	// The buffer pointed to by outBuf should be large enough to store the compressed image. This
@@ -795,4 +798,338 @@ namespace DXTC
 
 		outBuf += 6;
 	}
+
+	// Compress an image using SSE2-optimized BC4 compression. The selected channel of the 4-byte RGBA
+	// image in inBuf is coded like the DXT5 alpha block. The address pointed to by inBuf must be
+	// 16-byte aligned. This implementation has an 8:1 compression ratio.
+	void CompressImageBC4SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int channel)
+	{
+		ALIGN16(uint8_t block[64]);
+
+		for(int j = 0; j < height; j += 4, inBuf += width * 4 * 4)
+		{
+			for(int i = 0; i < width; i += 4)
+			{
+				ExtractBlock_SSE2(inBuf + i * 4, width, block);
+				EmitChannelBlock_SSE2(block, channel, outBuf);
+			}
+		}
+	}
+
+	// Compress an image using SSE2-optimized BC5 compression. The red and green channels of the
+	// 4-byte RGBA image in inBuf are coded as two BC4 blocks, e.g. the xy of a tangent space normal.
+	// The address pointed to by inBuf must be 16-byte aligned. This implementation has an 4:1
+	// compression ratio.
+	void CompressImageBC5SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height)
+	{
+		ALIGN16(uint8_t block[64]);
+
+		for(int j = 0; j < height; j += 4, inBuf += width * 4 * 4)
+		{
+			for(int i = 0; i < width; i += 4)
+			{
+				ExtractBlock_SSE2(inBuf + i * 4, width, block);
+				EmitChannelBlock_SSE2(block, 0, outBuf);
+				EmitChannelBlock_SSE2(block, 1, outBuf);
+			}
+		}
+	}
+
+	// Move the selected channel of each pixel in colorBlock to the alpha position, so the DXT5
+	// alpha functions can be used to code it.
+	void ExtractChannel_SSE2(const uint8_t* colorBlock, int channel, uint8_t* channelBlock)
+	{
+		const __m128i shift = _mm_cvtsi32_si128((3 - channel) * 8);
+		for(int i = 0; i < 64; i += 16)
+		{
+			__m128i pixels = _mm_load_si128((__m128i*)(colorBlock + i));
+			_mm_store_si128((__m128i*)(channelBlock + i), _mm_sll_epi32(pixels, shift));
+		}
+	}
+
+	// Write an 8 byte BC4 block for the selected channel of colorBlock. EmitAlphaIndices_SSE2 stores
+	// one byte past the block, which is harmless inside a DXT5 block but not between BC4 blocks, so
+	// the block is assembled in a local buffer first.
+	void EmitChannelBlock_SSE2(const uint8_t* colorBlock, int channel, uint8_t*& outBuf)
+	{
+		ALIGN16(uint8_t block[64]);
+		ALIGN16(uint8_t minColor[4]);
+		ALIGN16(uint8_t maxColor[4]);
+		ALIGN16(uint8_t code[16]);
+
+		ExtractChannel_SSE2(colorBlock, channel, block);
+		GetMinMaxColors_SSE2(block, minColor, maxColor);
+
+		uint8_t* codePtr = code;
+		EmitByte(codePtr, maxColor[3]);
+		EmitByte(codePtr, minColor[3]);
+		EmitAlphaIndices_SSE2(block, codePtr, minColor[3], maxColor[3]);
+
+		memcpy(outBuf, code, 8);
+		outBuf += 8;
+	}
+
+	// Compress an image using BC7 mode 6. Blocks are extracted with SSE2, the address pointed to by
+	// inBuf must be 16-byte aligned. This implementation has an 4:1 compression ratio.
+	void CompressImageBC7Mode6SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height)
+	{
+		ALIGN16(uint8_t block[64]);
+
+		for(int j = 0; j < height; j += 4, inBuf += width * 4 * 4)
+		{
+			for(int i = 0; i < width; i += 4)
+			{
+				ExtractBlock_SSE2(inBuf + i * 4, width, block);
+				EmitBC7Mode6Block(block, outBuf);
+			}
+		}
+	}
+
+	// Quantize an RGBA endpoint to 7 bits per channel and a p-bit shared by the channels. The
+	// decoded 8-bit endpoint is (value << 1) | pbit.
+	static void QuantizeEndpointBC7(const float* endpoint, int* quantized, int& pbit)
+	{
+		int bestError = INT32_MAX;
+		for(int p = 0; p < 2; p++)
+		{
+			int error = 0;
+			int q[4];
+			for(int c = 0; c < 4; c++)
+			{
+				int v = (int)((endpoint[c] - p) * 0.5f + 0.5f);
+				v = v < 0 ? 0 : (v > 127 ? 127 : v);
+				int d = ((v << 1) | p) - (int)(endpoint[c] + 0.5f);
+				q[c] = v;
+				error += d * d;
+			}
+			if(error < bestError)
+			{
+				bestError = error;
+				pbit = p;
+				memcpy(quantized, q, sizeof(q));
+			}
+		}
+	}
+
+	// Pick the closest of the 16 interpolated colors for each pixel. The pixel is projected on the
+	// endpoint line and only the neighboring palette entries are tested. Returns the squared error.
+	static int FindIndicesBC7(const uint8_t* colorBlock, const int* color0, const int* color1, uint8_t* indices)
+	{
+		int palette[16][4];
+		for(int i = 0; i < 16; i++)
+		{
+			for(int c = 0; c < 4; c++)
+			{
+				palette[i][c] = ((64 - BC7_WEIGHTS4[i]) * color0[c] + BC7_WEIGHTS4[i] * color1[c] + 32) >> 6;
+			}
+		}
+
+		int dir[4];
+		int dirLength = 0;
+		for(int c = 0; c < 4; c++)
+		{
+			dir[c] = color1[c] - color0[c];
+			dirLength += dir[c] * dir[c];
+		}
+
+		int totalError = 0;
+		for(int i = 0; i < 16; i++)
+		{
+			const uint8_t* pixel = colorBlock + i * 4;
+			int guess = 0;
+			if(dirLength > 0)
+			{
+				int dot = 0;
+				for(int c = 0; c < 4; c++)
+				{
+					dot += (pixel[c] - color0[c]) * dir[c];
+				}
+				guess = (dot * 15 + dirLength / 2) / dirLength;
+				guess = guess < 0 ? 0 : (guess > 15 ? 15 : guess);
+			}
+
+			int bestIndex = guess;
+			int bestError = INT32_MAX;
+			for(int k = guess - 1; k <= guess + 1; k++)
+			{
+				if(k < 0 || k > 15)
+				{
+					continue;
+				}
+				int error = 0;
+				for(int c = 0; c < 4; c++)
+				{
+					int d = palette[k][c] - pixel[c];
+					error += d * d;
+				}
+				if(error < bestError)
+				{
+					bestError = error;
+					bestIndex = k;
+				}
+			}
+			indices[i] = (uint8_t)bestIndex;
+			totalError += bestError;
+		}
+		return totalError;
+	}
+
+	// Quantize both endpoints and find the indices. Returns the squared error.
+	static int EncodeBC7Mode6(const uint8_t* colorBlock, const float* endpoint0, const float* endpoint1,
+		int* quantized0, int* quantized1, int* pbits, uint8_t* indices)
+	{
+		int color0[4];
+		int color1[4];
+		QuantizeEndpointBC7(endpoint0, quantized0, pbits[0]);
+		QuantizeEndpointBC7(endpoint1, quantized1, pbits[1]);
+		for(int c = 0; c < 4; c++)
+		{
+			color0[c] = (quantized0[c] << 1) | pbits[0];
+			color1[c] = (quantized1[c] << 1) | pbits[1];
+		}
+		return FindIndicesBC7(colorBlock, color0, color1, indices);
+	}
+
+	// Write bits to a 128 bit BC7 block, least significant bit first.
+	static void WriteBitsBC7(uint64_t* block, int& position, uint32_t value, int count)
+	{
+		for(int i = 0; i < count; i++, position++)
+		{
+			block[position >> 6] |= (uint64_t)((value >> i) & 1) << (position & 63);
+		}
+	}
+
+	// Compress a 4 by 4 block with BC7 mode 6. The endpoints start on the diagonal of the inset
+	// bounding box oriented by the covariance with the widest channel, then are refined once by a
+	// least squares fit to the chosen indices.
+	void EmitBC7Mode6Block(const uint8_t* colorBlock, uint8_t*& outBuf)
+	{
+		ALIGN16(uint8_t minColor[4]);
+		ALIGN16(uint8_t maxColor[4]);
+		GetMinMaxColors_SSE2(colorBlock, minColor, maxColor);
+
+		// Orient the diagonal of the bounding box.
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for(int i = 0; i < 16; i++)
+		{
+			for(int c = 0; c < 4; c++)
+			{
+				mean[c] += colorBlock[i * 4 + c] * (1.0f / 16.0f);
+			}
+		}
+		int axis = 0;
+		for(int c = 1; c < 4; c++)
+		{
+			if(maxColor[c] - minColor[c] > maxColor[axis] - minColor[axis])
+			{
+				axis = c;
+			}
+		}
+		float endpoint0[4];
+		float endpoint1[4];
+		for(int c = 0; c < 4; c++)
+		{
+			float covariance = 0.0f;
+			for(int i = 0; i < 16; i++)
+			{
+				covariance += (colorBlock[i * 4 + c] - mean[c]) * (colorBlock[i * 4 + axis] - mean[axis]);
+			}
+			endpoint0[c] = covariance < 0.0f ? maxColor[c] : minColor[c];
+			endpoint1[c] = covariance < 0.0f ? minColor[c] : maxColor[c];
+		}
+
+		int quantized0[4];
+		int quantized1[4];
+		int pbits[2];
+		uint8_t indices[16];
+		int error = EncodeBC7Mode6(colorBlock, endpoint0, endpoint1, quantized0, quantized1, pbits, indices);
+
+		// Least squares refit of the endpoints to the chosen indices.
+		if(error > 0)
+		{
+			float a = 0.0f, b = 0.0f, d = 0.0f;
+			float x0[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float x1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for(int i = 0; i < 16; i++)
+			{
+				float t = BC7_WEIGHTS4[indices[i]] * (1.0f / 64.0f);
+				a += (1.0f - t) * (1.0f - t);
+				b += (1.0f - t) * t;
+				d += t * t;
+				for(int c = 0; c < 4; c++)
+				{
+					x0[c] += (1.0f - t) * colorBlock[i * 4 + c];
+					x1[c] += t * colorBlock[i * 4 + c];
+				}
+			}
+			float det = a * d - b * b;
+			if(det > FLT_EPSILON)
+			{
+				float refined0[4];
+				float refined1[4];
+				for(int c = 0; c < 4; c++)
+				{
+					refined0[c] = (d * x0[c] - b * x1[c]) / det;
+					refined1[c] = (a * x1[c] - b * x0[c]) / det;
+					refined0[c] = refined0[c] < 0.0f ? 0.0f : (refined0[c] > 255.0f ? 255.0f : refined0[c]);
+					refined1[c] = refined1[c] < 0.0f ? 0.0f : (refined1[c] > 255.0f ? 255.0f : refined1[c]);
+				}
+
+				int refinedQuantized0[4];
+				int refinedQuantized1[4];
+				int refinedPbits[2];
+				uint8_t refinedIndices[16];
+				int refinedError = EncodeBC7Mode6(colorBlock, refined0, refined1,
+					refinedQuantized0, refinedQuantized1, refinedPbits, refinedIndices);
+				if(refinedError < error)
+				{
+					memcpy(quantized0, refinedQuantized0, sizeof(quantized0));
+					memcpy(quantized1, refinedQuantized1, sizeof(quantized1));
+					memcpy(pbits, refinedPbits, sizeof(pbits));
+					memcpy(indices, refinedIndices, sizeof(indices));
+				}
+			}
+		}
+
+		// The most significant index bit of the first pixel is implicit zero.
+		if(indices[0] & 8)
+		{
+			for(int c = 0; c < 4; c++)
+			{
+				int t = quantized0[c];
+				quantized0[c] = quantized1[c];
+				quantized1[c] = t;
+			}
+			int t = pbits[0];
+			pbits[0] = pbits[1];
+			pbits[1] = t;
+			for(int i = 0; i < 16; i++)
+			{
+				indices[i] = (uint8_t)(15 - indices[i]);
+			}
+		}
+
+		uint64_t block[2] = { 0, 0 };
+		int position = 0;
+		WriteBitsBC7(block, position, 1 << 6, 7);
+		for(int c = 0; c < 4; c++)
+		{
+			WriteBitsBC7(block, position, quantized0[c], 7);
+			WriteBitsBC7(block, position, quantized1[c], 7);
+		}
+		WriteBitsBC7(block, position, pbits[0], 1);
+		WriteBitsBC7(block, position, pbits[1], 1);
+		WriteBitsBC7(block, position, indices[0], 3);
+		for(int i = 1; i < 16; i++)
+		{
+			WriteBitsBC7(block, position, indices[i], 4);
+		}
+		assert(position == 128);
+
+		for(int i = 0; i < 16; i++)
+		{
+			outBuf[i] = (uint8_t)(block[i >> 3] >> ((i & 7) * 8));
+		}
+		outBuf += 16;
+	}
 }
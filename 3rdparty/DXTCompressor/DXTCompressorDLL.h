@@ -52,4 +52,14 @@ namespace DXTC
     void GetMinMaxColors_SSE2(const uint8_t* colorBlock, uint8_t* minColor, uint8_t* maxColor);
     void EmitColorIndices_SSE2(const uint8_t* colorBlock, uint8_t*& outBuf, const uint8_t* minColor, const uint8_t* maxColor);
     void EmitAlphaIndices_SSE2(const uint8_t* colorBlock, uint8_t*& outBuf, const uint8_t minAlpha, const uint8_t maxAlpha);
+
+	// BC4/BC5 compressor (SSE2 version), each channel is coded like the DXT5 alpha block.
+	void CompressImageBC4SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height, int channel = 0);
+	void CompressImageBC5SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height);
+	void ExtractChannel_SSE2(const uint8_t* colorBlock, int channel, uint8_t* channelBlock);
+	void EmitChannelBlock_SSE2(const uint8_t* colorBlock, int channel, uint8_t*& outBuf);
+
+	// BC7 compressor (SSE2 block extraction), mode 6 only: one subset, RGBA endpoints, 4 bit indices.
+	void CompressImageBC7Mode6SSE2(const uint8_t* inBuf, uint8_t* outBuf, int width, int height);
+	void EmitBC7Mode6Block(const uint8_t* colorBlock, uint8_t*& outBuf);
 }
@@ -17,6 +17,7 @@
 
 #include "SDesktopApp.h"
 #include <Star/Core/SManagerFwd.h>
+#include <Star/Core/SCoreTypes.h>
 
 namespace Star {
 
@@ -50,7 +51,7 @@ DesktopApp::DesktopApp(HINSTANCE hInstance, const Desc& desc)
     // logging
     {
         updateLogFolder("log");
-        initLogging(boost::log::trivial::debug, ("log/luminous_desktop_" + getDateTimeStr() + ".txt").c_str());
+        initAsyncLogging(boost::log::trivial::debug, ("log/luminous_desktop_" + getDateTimeStr() + ".txt").c_str());
 
         // start logging
         S_INFO << getDateTimeAscStr();
@@ -61,11 +62,14 @@ DesktopApp::DesktopApp(HINSTANCE hInstance, const Desc& desc)
     initLocale("C", true);
 
     // Core workflow
-    Core::Workflow::init(desc.mMaxResourceCount, desc.mMaxTaskCount);
+    Core::Workflow::init(desc.mMaxResourceCount, desc.mMaxTaskCount, desc.mNumLoaderThreads);
+    Core::Workflow::setBudget(Core::Texture, desc.mTextureBudget);
 }
 
 DesktopApp::~DesktopApp() {
     Core::Workflow::terminate();
+    // drains the async log queue
+    exitLogging();
 }
 
 bool DesktopApp::try_spawnWindow(uint32_t width, uint32_t height, int nCmdShow,
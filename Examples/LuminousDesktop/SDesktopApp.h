@@ -32,7 +32,9 @@ public:
     struct Desc {
         uint32_t mNumTaskThreads = 12;
         uint32_t mMaxTaskCount = 8;
+        uint32_t mNumLoaderThreads = 2;
         uint32_t mMaxResourceCount = 2048;
+        uint64_t mTextureBudget = 512ull << 20;
     };
     DesktopApp(HINSTANCE hInstance, const Desc& desc);
     DesktopApp(const DesktopApp&) = delete;
@@ -0,0 +1,65 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <gsl/gsl_assert>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <memory_resource>
+#include <numeric>
+#include <vector>
+
+namespace Star::Asset {
+
+// 4x4 blocks are encoded independently, so strips of block rows can be compressed
+// in parallel and still produce the same bytes as one call over the whole mip
+constexpr uint32_t sCompressGrainBlocks = 4096;
+
+// compress(src, dst, width, height) encodes whole block rows of width texels,
+// src rows are width / blockX blocks of srcBPE bytes, dst rows of dstBPE bytes
+template<class Compress>
+void compressBlockRows(std::pmr::memory_resource* mr, const std::byte* src, std::byte* dst,
+    uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY,
+    uint32_t srcBPE, uint32_t dstBPE, Compress compress,
+    uint32_t grainBlocks = sCompressGrainBlocks
+) {
+    Expects(width % blockX == 0);
+    Expects(height % blockY == 0);
+    const uint32_t blocksPerRow = width / blockX;
+    const uint32_t blockRows = height / blockY;
+    const uint32_t rowsPerStrip = std::max(1u, grainBlocks / blocksPerRow);
+    if (blockRows <= rowsPerStrip) {
+        compress(src, dst, width, height);
+        return;
+    }
+
+    const uint32_t stripCount = (blockRows + rowsPerStrip - 1) / rowsPerStrip;
+    std::pmr::vector<uint32_t> strips(stripCount, mr);
+    std::iota(strips.begin(), strips.end(), 0u);
+    std::for_each(std::execution::par, strips.begin(), strips.end(),
+        [&](uint32_t stripID) {
+            const auto begin = stripID * rowsPerStrip;
+            const auto end = std::min(begin + rowsPerStrip, blockRows);
+            compress(src + size_t(begin) * blocksPerRow * srcBPE,
+                dst + size_t(begin) * blocksPerRow * dstBPE,
+                width, (end - begin) * blockY);
+        });
+}
+
+}
@@ -22,6 +22,8 @@
 #include "SAssetUtils.h"
 #include "SAssetFbxImporter.h"
 #include "SAssetTexture.h"
+#include "SAssetMeshContainer.h"
+#include "SAssetMeshOptimizer.h"
 #include <Star/Graphics/SContentSerialization.h>
 #include <Star/AssetFactory/SAssetSerialization.h>
 #include <StarCompiler/ShaderGraph/SShaderModules.h>
@@ -30,6 +32,7 @@
 #include <StarCompiler/ShaderWorks/SShaderAssetBuilder.h>
 #include <Star/Graphics/SContentUtils.h>
 #include <Star/Graphics/SRenderFormatUtils.h>
+#include <mutex>
 
 namespace Star::Asset {
 
@@ -612,6 +615,10 @@ public:
         if (!mDatabase.mMeshInfo.empty()) {
             create_directories(meshFolder);
         }
+        // vertex cache statistics of the meshes imported by this build, tracked by ci
+        std::ostringstream meshReport;
+        writeMeshReportHeader(meshReport);
+        bool meshImported = false;
         for (const auto& meshAsset : mDatabase.mMeshInfo) {
             auto iter = mResources.mMeshes.find(meshAsset.mMetaID);
             if (iter == mResources.mMeshes.end()) {
@@ -621,7 +628,8 @@ public:
                 auto filePath = (mFolder / fbxPath).generic_string();
                 auto pScene = importer.read(filePath);
                 AssetFbxScene fbx(std::move(pScene), meshAsset.mFbx->mMetaID, mFolder, filePath);
-                fbx.readMeshes("StaticMesh", mResources);
+                fbx.readMeshes("StaticMesh", mResources, &meshReport);
+                meshImported = true;
             }
 
             std::filesystem::path filename;
@@ -631,10 +639,12 @@ public:
                 filename = meshFolder / oss.str();
             }
             const auto& meshData = mResources.mMeshes.at(meshAsset.mMetaID);
-            std::ostringstream oss;
-            boost::archive::binary_oarchive oa(oss);
-            oa << meshData;
-            updateBinary(filename, oss.str());
+            std::string content;
+            writeMeshContainer(meshData, content);
+            updateBinary(filename, content);
+        }
+        if (meshImported) {
+            updateFile(meshFolder / "mesh_report.csv", meshReport.str());
         }
 
         std::map<std::string, std::map<std::string, uint32_t>, std::less<>> shaderVertexLayouts;
@@ -710,11 +720,51 @@ public:
             }
             updateResource(materialAsset.mName, materialData);
         }
-        TextureImportSettings settings;
+        // block compression of each texture follows how materials use it
+        for (auto iter = mDatabase.mTextureInfo.begin(); iter != mDatabase.mTextureInfo.end(); ++iter) {
+            auto res = mDatabase.mTextureInfo.modify(iter, [](TextureInfo& info) {
+                info.mImportSettings.mFormat = Format::UNKNOWN;
+            });
+            Ensures(res);
+        }
+        for (const auto& materialAsset : mDatabase.mMaterialInfo) {
+            for (const auto& [attr, texMetaID] : materialAsset.mTextures) {
+                auto iter = mDatabase.mTextureInfo.find(texMetaID);
+                if (iter == mDatabase.mTextureInfo.end())
+                    continue;
+                // known slots decide, unknown slots fall back to the path
+                auto format = getTextureFormatBySlot(attr);
+                if (format == Format::UNKNOWN) {
+                    format = getTextureFormatByUsage(iter->mName);
+                }
+                auto res = mDatabase.mTextureInfo.modify(iter, [format](TextureInfo& info) {
+                    auto& current = info.mImportSettings.mFormat;
+                    if (current == Format::UNKNOWN) {
+                        current = format;
+                    } else if (current != format) {
+                        // conflicting usages, keep every channel without gamma
+                        current = Format::S_BC7_UNORM_BLOCK;
+                    }
+                });
+                Ensures(res);
+            }
+        }
+        for (auto iter = mDatabase.mTextureInfo.begin(); iter != mDatabase.mTextureInfo.end(); ++iter) {
+            if (iter->mImportSettings.mFormat != Format::UNKNOWN)
+                continue;
+            // not referenced by any material
+            auto format = getTextureFormatByUsage(iter->mName);
+            auto res = mDatabase.mTextureInfo.modify(iter, [format](TextureInfo& info) {
+                info.mImportSettings.mFormat = format;
+            });
+            Ensures(res);
+        }
+
         std::for_each(std::execution::par_unseq,
             mDatabase.mTextureInfo.begin(),
             mDatabase.mTextureInfo.end(),
-            [this, &settings](const TextureInfo& textureAsset){
+            [this](const TextureInfo& textureAsset){
+                const auto& settings = textureAsset.mImportSettings;
                 TextureData textureData(std::pmr::get_default_resource());
 
                 std::filesystem::path name(textureAsset.mName);
@@ -834,8 +884,9 @@ public:
 
     void registerProducers() {
         Expects(std::this_thread::get_id() == mThreadID);
-        registerProducer(Core::Mesh);
-        registerProducer(Core::Texture);
+        // loaded on the workflow loader pool, see mRuntimeMutex
+        registerProducer(Core::Mesh, true);
+        registerProducer(Core::Texture, true);
         registerProducer(Core::Shader);
         registerProducer(Core::Material);
         registerProducer(Core::Content);
@@ -862,10 +913,52 @@ public:
         return &iter->second;
     }
 
-    bool load(const Core::Resource& resource, bool async) override {
-        if (mTaskCount >= mMaxTaskCount)
-            return false;
+    // runs on a loader thread, a resource is never loaded twice at the same time
+    // returns nullptr when the token was cancelled before the mesh was read
+    const MeshData* loadMesh(const MetaID& metaID, Core::CancellationToken token) {
+        auto iterInfo = mDatabase.mMeshInfo.find(metaID);
+        Expects(iterInfo != mDatabase.mMeshInfo.end());
+        auto filePath = mLibrary / iterInfo->mName;
 
+        MeshData* ptr = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mRuntimeMutex);
+            auto res = mResources.mMeshes.try_emplace(metaID);
+            if (!res.second) {
+                return &res.first->second;
+            }
+            ptr = &res.first->second;
+        }
+        try {
+            auto file = std::make_unique<MappedMeshFile>(filePath);
+            if (token.cancelled()) {
+                // the mapping is dropped, destroy leaves meshes to lazy deletion
+                std::lock_guard<std::mutex> lock(mRuntimeMutex);
+                mResources.mMeshes.erase(metaID);
+                return nullptr;
+            }
+            if (!isMeshContainer(file->data())) {
+                // legacy boost archive
+                std::ifstream ifs(filePath, std::ios::binary);
+                PmrBinaryInArchive ia(ifs, mResources.get_allocator().resource());
+                ia >> *ptr;
+                return ptr;
+            }
+            MeshContainerView view(file->data());
+            // blobs reference the mapping, meshes are never erased (lazy deletion)
+            view.view(*ptr);
+            std::lock_guard<std::mutex> lock(mRuntimeMutex);
+            mMappedMeshes.emplace(metaID, std::move(file));
+        } catch (...) {
+            // a partly read mesh must not be found by the next load
+            std::lock_guard<std::mutex> lock(mRuntimeMutex);
+            mResources.mMeshes.erase(metaID);
+            throw;
+        }
+        return ptr;
+    }
+
+    bool load(const Core::Resource& resource, bool async, Core::CancellationToken token) override {
         const auto& metaID = getMetaID(resource);
         const auto& tag = getTag(resource);
 
@@ -874,34 +967,48 @@ public:
 
         visit(overload(
             [&](Core::Mesh_) {
-                Expects(!async);
-                auto ptr = load(metaID, mDatabase.mMeshInfo, mResources.mMeshes);
-                deliver(resource, ptr, async);
+                auto ptr = loadMesh(metaID, token);
+                if (!ptr) {
+                    deliverCancelled(resource, async);
+                    return;
+                }
+                deliver(resource, ptr, async, getMeshSize(*ptr));
             },
             [&](Core::Texture_) {
                 const auto& info = mDatabase.mTextureInfo;
-                auto& resources = mResources.mTextures;
-
-                Expects(std::this_thread::get_id() == mThreadID);
-                auto iter = resources.find(metaID);
-
-                Expects(iter == resources.end());
                 auto iterInfo = info.find(metaID);
                 Expects(iterInfo != info.end());
                 auto filePath = mLibrary / iterInfo->mName;
                 filePath.replace_extension(".dds");
-                std::ifstream ifs(filePath, std::ios::binary);
-                auto res = resources.try_emplace(metaID);
-                Ensures(res.second);
-                iter = res.first;
-                bool bSrgb = true;
-                if (boost::algorithm::contains(iterInfo->mName, "normal")) {
-                    bSrgb = false;
+                // colorspace follows the import format, legacy assets go by the path
+                const auto format = iterInfo->mImportSettings.mFormat;
+                bool bSrgb = format != Format::UNKNOWN ? isSRGB(format)
+                    : !boost::algorithm::contains(iterInfo->mName, "normal");
+                // unordered_map nodes are stable, only the node itself is filled outside the lock
+                TextureData* ptr = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(mRuntimeMutex);
+                    auto res = mResources.mTextures.try_emplace(metaID);
+                    Ensures(res.second);
+                    ptr = &res.first->second;
+                }
+                if (token.cancelled()) {
+                    // destroy erases the empty texture
+                    deliverCancelled(resource, async);
+                    return;
+                }
+                try {
+                    std::ifstream ifs(filePath, std::ios::binary);
+                    loadDDS(ifs, *ptr, bSrgb);
+                } catch (const std::exception& e) {
+                    if (!async)
+                        throw;
+                    S_ERROR << filePath << " load failed: " << e.what();
+                    deliverFailed(resource, async);
+                    return;
                 }
-                loadDDS(ifs, std::pmr::get_default_resource(), iter->second, bSrgb);
-                auto ptr = &iter->second;
-                deliver(resource, ptr, async);
                 S_WARNING << filePath << " loaded";
+                deliver(resource, ptr, async, ptr->mBuffer.size());
             },
             [&](Core::Shader_) {
                 Expects(!async);
@@ -927,6 +1034,30 @@ public:
         return true;
     }
 
+    // library file size, the dds upload buffer and the mapped mesh container are read whole
+    uint64_t estimateSize(const Core::Resource& resource) const override {
+        Expects(std::this_thread::get_id() == mThreadID);
+        const auto& metaID = getMetaID(resource);
+        std::filesystem::path filePath;
+        visit(overload(
+            [&](Core::Mesh_) {
+                filePath = mLibrary / at(mDatabase.mMeshInfo, metaID).mName;
+            },
+            [&](Core::Texture_) {
+                filePath = mLibrary / at(mDatabase.mTextureInfo, metaID).mName;
+                filePath.replace_extension(".dds");
+            },
+            [&](auto) {
+                // small, not budgeted
+            }
+        ), getTag(resource));
+        if (filePath.empty())
+            return 0;
+        std::error_code ec;
+        auto size = std::filesystem::file_size(filePath, ec);
+        return ec ? 0 : size;
+    }
+
     void created(const Core::Resource& resource) override {
         Expects(std::this_thread::get_id() == mThreadID);
         --mTaskCount;
@@ -935,8 +1066,54 @@ public:
     void destroy(const Core::Resource& resource) noexcept override {
         Expects(std::this_thread::get_id() == mThreadID);
         --mResourceCount;
-        // lazy deletion
-        // TODO: add destroy
+        visit(overload(
+            [&](Core::Texture_) {
+                // only runtime owned, evicted by manager budget
+                std::lock_guard<std::mutex> lock(mRuntimeMutex);
+                auto count = mResources.mTextures.erase(getMetaID(resource));
+                Ensures(count == 1);
+            },
+            [&](auto) {
+                // lazy deletion, still referenced by asset processing
+            }
+        ), getTag(resource));
+    }
+
+    void dependencies(const Core::Resource& resource,
+        std::vector<MetaID>& metaIDs, std::vector<Core::ResourceType>& tags) const override {
+        Expects(std::this_thread::get_id() == mThreadID);
+        const auto& metaID = getMetaID(resource);
+        auto add = [&](const MetaID& id, const Core::ResourceType& tag) {
+            if (!id.is_nil()) {
+                metaIDs.emplace_back(id);
+                tags.emplace_back(tag);
+            }
+        };
+        visit(overload(
+            [&](Core::Material_) {
+                // shaders are resolved by name through the render graph
+                const auto& material = mResources.mMaterials.at(metaID);
+                for (const auto& [slot, textureID] : material.mTextures) {
+                    add(textureID, Core::Texture);
+                }
+            },
+            [&](Core::Content_) {
+                const auto& content = mResources.mContents.at(metaID);
+                for (const auto& drawCall : content.mDrawCalls) {
+                    add(drawCall.mMesh, Core::Mesh);
+                    add(drawCall.mMaterial, Core::Material);
+                }
+                for (const auto& objects : content.mFlattenedObjects) {
+                    for (const auto& renderer : objects.mMeshRenderers) {
+                        add(renderer.mMeshID, Core::Mesh);
+                        for (const auto& materialID : renderer.mMaterialIDs) {
+                            add(materialID, Core::Material);
+                        }
+                    }
+                }
+            },
+            [&](auto) {}
+        ), getTag(resource));
     }
 
     bool try_createMaterial(std::string_view assetPath, std::string_view shaderName) {
@@ -1103,12 +1280,15 @@ public:
     Resources mResources;
 
     std::pmr::unordered_map<MetaID, FlattenedObjects> mFlattenedFbx;
+    std::unordered_map<MetaID, std::unique_ptr<MappedMeshFile>> mMappedMeshes;
     Shader::ShaderModules mShaderModules;
     Map<std::string, RenderGraphFactory> mRenderGraphs;
 
-    int32_t mMaxTaskCount = 4;
-    int32_t mTaskCount = 0;
-    int64_t mResourceCount = 0;
+    std::atomic_int32_t mTaskCount = 0;
+    std::atomic_int64_t mResourceCount = 0;
+
+    // guards the runtime loaded maps, mesh and texture loads run on the workflow loader pool
+    std::mutex mRuntimeMutex;
 };
 
 AssetFactory::AssetFactory(std::string_view assetPath, std::string_view libPath, const allocator_type& alloc)
@@ -17,9 +17,12 @@
 
 #include "SAssetFbx.h"
 #include <Star/Graphics/SContentUtils.h>
+#include <Star/Graphics/SVisibility.h>
 #include "SAssetTypes.h"
 #include "SAssetFbxUtils.h"
 #include "SAssetUtils.h"
+#include "SAssetMeshUtils.h"
+#include "SAssetMeshOptimizer.h"
 #include <Star/Graphics/SContentSerialization.h>
 #include <3rdparty/mikktspace/mikktspace.h>
 
@@ -514,6 +517,9 @@ void fillBufferByVertex(const MeshBufferLayout& layout,
             }
         }
     }
+
+    // vertices were expanded per polygon vertex, merge duplicates
+    weldVertices(mesh);
 }
 
 void fillBufferByPoint(const MeshBufferLayout& layout,
@@ -953,17 +959,18 @@ void AssetFbxScene::readMeshInfo(const fbxsdk::FbxMesh* pMesh,
     Ensures(res.second);
 }
 
-void AssetFbxScene::readMeshes(std::string_view layout, Resources& resources) const {
+void AssetFbxScene::readMeshes(std::string_view layout, Resources& resources, std::ostream* pReport) const {
     size_t meshID = 0;
     std::set<const fbxsdk::FbxMesh*> meshes;
     std::set<std::string> names;
-    readMeshes(layout, mScene->GetRootNode(), resources, meshes, names, meshID);
+    readMeshes(layout, mScene->GetRootNode(), resources, meshes, names, meshID, pReport);
     Ensures(meshes.size() == names.size());
 }
 
 void AssetFbxScene::readMeshes(std::string_view layout,
     fbxsdk::FbxNode* pFbxNode, Resources& resources,
-    std::set<const fbxsdk::FbxMesh*>& meshes, std::set<std::string>& names, size_t& meshID
+    std::set<const fbxsdk::FbxMesh*>& meshes, std::set<std::string>& names, size_t& meshID,
+    std::ostream* pReport
 ) const {
     // first pass
     auto pAttribute = pFbxNode->GetNodeAttribute();
@@ -972,7 +979,7 @@ void AssetFbxScene::readMeshes(std::string_view layout,
         case fbxsdk::FbxNodeAttribute::eMesh:
             auto res = meshes.emplace(static_cast<const FbxMesh*>(pAttribute));
             if (res.second) {
-                readMesh(layout, *res.first, resources, names, meshID);
+                readMesh(layout, *res.first, resources, names, meshID, pReport);
             }
             break;
         }
@@ -980,13 +987,13 @@ void AssetFbxScene::readMeshes(std::string_view layout,
 
     int childCount = pFbxNode->GetChildCount();
     for (int i = 0; i != childCount; ++i) {
-        readMeshes(layout, pFbxNode->GetChild(i), resources, meshes, names, meshID);
+        readMeshes(layout, pFbxNode->GetChild(i), resources, meshes, names, meshID, pReport);
     }
 }
 
 void AssetFbxScene::readMesh(std::string_view layoutName,
     const fbxsdk::FbxMesh* pMesh, Resources& resources,
-    std::set<std::string>& names, size_t& meshID
+    std::set<std::string>& names, size_t& meshID, std::ostream* pReport
 ) const {
     auto meshName = getMeshName(pMesh, names, meshID);
     boost::uuids::name_generator_latest gen(mMetaID);
@@ -1103,6 +1110,15 @@ void AssetFbxScene::readMesh(std::string_view layoutName,
 
         mesh.mSubMeshes.emplace_back(SubMeshData{ prevOffset * PolygonSize, (meshFaceCount - prevOffset) * PolygonSize });
     }
+
+    auto report = optimizeMesh(mesh);
+    S_INFO << str(boost::format("mesh %s, vertices: %d, ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f")
+        % meshName % report.mAfter.mVertexCount
+        % report.mBefore.acmr() % report.mAfter.acmr()
+        % report.mBefore.atvr() % report.mAfter.atvr());
+    if (pReport) {
+        writeMeshReport(*pReport, meshName, report);
+    }
 }
 
 void AssetFbxScene::readFlattenedNodes(const MetaIDNameIndex<MeshInfo>& meshInfo,
@@ -1169,6 +1185,22 @@ void AssetFbxScene::readMeshRenderer(const MetaIDNameIndex<MeshInfo>& meshInfo,
 
     batch.mMeshRenderers[nodeID].mMeshID = meshMetaID;
 
+    // bounds, positions are read from control points without conversion
+    {
+        Vector3f minCorner = Vector3f::Constant(std::numeric_limits<float>::max());
+        Vector3f maxCorner = Vector3f::Constant(std::numeric_limits<float>::lowest());
+        const auto* pPoints = pMesh->GetControlPoints();
+        for (int i = 0; i != pMesh->GetControlPointsCount(); ++i) {
+            Vector3f p(float(pPoints[i][0]), float(pPoints[i][1]), float(pPoints[i][2]));
+            minCorner = minCorner.cwiseMin(p);
+            maxCorner = maxCorner.cwiseMax(p);
+        }
+        auto& bounds = batch.mBoundingBoxes[nodeID];
+        bounds.mLocalBounds = Box3f(minCorner, maxCorner);
+        bounds.mWorldBounds = transformBounds(bounds.mLocalBounds,
+            batch.mWorldTransforms[nodeID].mTransform);
+    }
+
     // fill submeshes
     int matElemCount = pMesh->GetElementMaterialCount();
     if (matElemCount == 0) {
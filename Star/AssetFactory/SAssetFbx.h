@@ -50,7 +50,9 @@ public:
     void readInfo(const FbxInfo& info, MetaIDNameIndex<MeshInfo>& meshInfo,
         std::unordered_set<MetaID>& assets) const;
 
-    void readMeshes(std::string_view layout, Graphics::Render::Resources& resources) const;
+    // pReport: receives a row per imported mesh, see writeMeshReport
+    void readMeshes(std::string_view layout, Graphics::Render::Resources& resources,
+        std::ostream* pReport = nullptr) const;
 
     void readFlattenedNodes(const MetaIDNameIndex<MeshInfo>& meshInfo,
         Graphics::Render::FlattenedObjects& batch) const;
@@ -75,11 +77,12 @@ private:
 
     void readMeshes(std::string_view layout, 
         fbxsdk::FbxNode* pFbxNode, Graphics::Render::Resources& resources,
-        std::set<const fbxsdk::FbxMesh*>& meshes, std::set<std::string>& names, size_t& meshID) const;
+        std::set<const fbxsdk::FbxMesh*>& meshes, std::set<std::string>& names, size_t& meshID,
+        std::ostream* pReport) const;
 
     void readMesh(std::string_view layout,
         const fbxsdk::FbxMesh* pMesh, Graphics::Render::Resources& resources,
-        std::set<std::string>& names, size_t& meshID) const;
+        std::set<std::string>& names, size_t& meshID, std::ostream* pReport) const;
 
     void readFlattenedNodes(fbxsdk::FbxNode* pFbxNode, const MetaIDNameIndex<MeshInfo>& resources,
         Graphics::Render::FlattenedObjects& batch, size_t& nodeID,
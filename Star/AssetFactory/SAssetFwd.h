@@ -42,6 +42,11 @@ struct ByPolygon_;
 
 using MappingMode = std::variant<ByControlPoint_, ByPolygonVertex_, ByPolygon_>;
 
+struct BoxFilter_;
+struct KaiserFilter_;
+
+using MipFilter = std::variant<BoxFilter_, KaiserFilter_>;
+
 struct TextureImportSettings;
 
 } // namespace Asset
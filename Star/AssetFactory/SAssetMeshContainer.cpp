@@ -0,0 +1,332 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SAssetMeshContainer.h"
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+static_assert(sizeof(SubMeshData) == 2 * sizeof(uint32_t));
+
+namespace {
+
+template<size_t I = 0, class Variant>
+void emplaceVariant(Variant& var, size_t index) {
+    if constexpr (I != std::variant_size_v<Variant>) {
+        if (index == I) {
+            var.template emplace<I>();
+            return;
+        }
+        emplaceVariant<I + 1>(var, index);
+    }
+}
+
+bool inRange(uint64_t offset, uint64_t size, uint64_t total) noexcept {
+    return offset <= total && size <= total - offset;
+}
+
+}
+
+void writeMeshContainer(const MeshData& mesh, std::string& content) {
+    struct Blob {
+        MeshContainerChunk mChunk;
+        const void* mData;
+    };
+    std::vector<Blob> blobs;
+    auto addChunk = [&blobs](MeshChunkType type, uint32_t index,
+        const void* data, size_t size, uint32_t count, uint32_t stride
+    ) {
+        Expects(uint64_t(count) * stride == size);
+        blobs.emplace_back(Blob{ MeshContainerChunk{ type, index, 0, size, count, stride }, data });
+    };
+
+    if (!mesh.mLayoutName.empty()) {
+        addChunk(MeshChunkType::LayoutName, 0, mesh.mLayoutName.data(), mesh.mLayoutName.size(),
+            gsl::narrow<uint32_t>(mesh.mLayoutName.size()), 1);
+    }
+
+    std::vector<std::vector<MeshContainerVertexElement>> elements(mesh.mVertexBuffers.size());
+    for (uint32_t slot = 0; slot != mesh.mVertexBuffers.size(); ++slot) {
+        const auto& vb = mesh.mVertexBuffers[slot];
+        auto& dst = elements[slot];
+        dst.reserve(vb.mDesc.mElements.size());
+        for (const auto& e : vb.mDesc.mElements) {
+            dst.emplace_back(MeshContainerVertexElement{
+                gsl::narrow<uint32_t>(e.mType.index()),
+                e.mAlignedByteOffset,
+                static_cast<uint32_t>(e.mFormat),
+                0
+            });
+        }
+        addChunk(MeshChunkType::VertexElements, slot, dst.data(),
+            dst.size() * sizeof(MeshContainerVertexElement),
+            gsl::narrow<uint32_t>(dst.size()), sizeof(MeshContainerVertexElement));
+        const auto buffer = vb.data();
+        addChunk(MeshChunkType::VertexBuffer, slot, buffer.data(), buffer.size(),
+            vb.mVertexCount, vb.mDesc.mVertexSize);
+    }
+
+    const auto& ib = mesh.mIndexBuffer;
+    const auto indices = ib.data();
+    if (!indices.empty()) {
+        Expects(ib.mElementSize == 2 || ib.mElementSize == 4);
+        addChunk(MeshChunkType::IndexBuffer, 0, indices.data(), indices.size(),
+            gsl::narrow<uint32_t>(indices.size() / ib.mElementSize), ib.mElementSize);
+    }
+
+    addChunk(MeshChunkType::SubMeshes, 0, mesh.mSubMeshes.data(),
+        mesh.mSubMeshes.size() * sizeof(SubMeshData),
+        gsl::narrow<uint32_t>(mesh.mSubMeshes.size()), sizeof(SubMeshData));
+
+    MeshContainerHeader header;
+    header.mChunkTableOffset = sizeof(MeshContainerHeader);
+    header.mChunkCount = gsl::narrow<uint32_t>(blobs.size());
+    header.mLayoutID = mesh.mLayoutID;
+    header.mVertexBufferCount = gsl::narrow<uint32_t>(mesh.mVertexBuffers.size());
+    header.mPrimitiveTopology = ib.mPrimitiveTopology;
+    header.mPrimitiveCount = ib.mPrimitiveCount;
+
+    uint64_t offset = header.mChunkTableOffset + blobs.size() * sizeof(MeshContainerChunk);
+    for (auto& blob : blobs) {
+        offset = boost::alignment::align_up(offset, sMeshContainerAlignment);
+        blob.mChunk.mOffset = offset;
+        offset += blob.mChunk.mSize;
+    }
+    header.mFileSize = boost::alignment::align_up(offset, sMeshContainerAlignment);
+
+    content.assign(gsl::narrow<size_t>(header.mFileSize), '\0');
+    std::memcpy(content.data(), &header, sizeof(header));
+    auto* table = content.data() + header.mChunkTableOffset;
+    for (const auto& blob : blobs) {
+        std::memcpy(table, &blob.mChunk, sizeof(MeshContainerChunk));
+        table += sizeof(MeshContainerChunk);
+        if (blob.mChunk.mSize) {
+            std::memcpy(content.data() + blob.mChunk.mOffset, blob.mData, blob.mChunk.mSize);
+        }
+    }
+}
+
+bool isMeshContainer(gsl::span<const std::byte> data) noexcept {
+    return data.size() >= sizeof(MeshContainerHeader) &&
+        std::memcmp(data.data(), sMeshContainerMagic.data(), sMeshContainerMagic.size()) == 0;
+}
+
+MeshContainerView::MeshContainerView(gsl::span<const std::byte> data)
+    : mData(data)
+{
+    if (!isMeshContainer(data)) {
+        throw std::runtime_error("mesh container: invalid magic");
+    }
+    if (reinterpret_cast<uintptr_t>(data.data()) % alignof(MeshContainerHeader)) {
+        throw std::runtime_error("mesh container: misaligned data");
+    }
+    mHeader = reinterpret_cast<const MeshContainerHeader*>(data.data());
+    const auto& header = *mHeader;
+    const uint64_t fileSize = data.size();
+
+    if (header.mVersion != sMeshContainerVersion) {
+        throw std::runtime_error("mesh container: unsupported version " + std::to_string(header.mVersion));
+    }
+    if (header.mFileSize != fileSize) {
+        throw std::runtime_error("mesh container: file size mismatch");
+    }
+    if (header.mChunkTableOffset % alignof(MeshContainerChunk) ||
+        !inRange(header.mChunkTableOffset, uint64_t(header.mChunkCount) * sizeof(MeshContainerChunk), fileSize))
+    {
+        throw std::runtime_error("mesh container: chunk table out of range");
+    }
+    mChunks = gsl::span<const MeshContainerChunk>(
+        reinterpret_cast<const MeshContainerChunk*>(data.data() + header.mChunkTableOffset),
+        header.mChunkCount);
+
+    const uint64_t tableEnd = header.mChunkTableOffset + uint64_t(header.mChunkCount) * sizeof(MeshContainerChunk);
+    for (const auto& c : mChunks) {
+        if (c.mOffset % sMeshContainerAlignment || c.mOffset < tableEnd ||
+            !inRange(c.mOffset, c.mSize, fileSize))
+        {
+            throw std::runtime_error("mesh container: chunk out of range");
+        }
+        if (uint64_t(c.mCount) * c.mStride != c.mSize) {
+            throw std::runtime_error("mesh container: chunk size mismatch");
+        }
+        if (&c != find(c.mType, c.mIndex)) {
+            throw std::runtime_error("mesh container: duplicated chunk");
+        }
+        switch (c.mType) {
+        case MeshChunkType::LayoutName:
+            break;
+        case MeshChunkType::VertexElements:
+            if (c.mStride != sizeof(MeshContainerVertexElement))
+                throw std::runtime_error("mesh container: vertex element stride mismatch");
+            break;
+        case MeshChunkType::VertexBuffer:
+            if (c.mIndex >= header.mVertexBufferCount || c.mStride == 0)
+                throw std::runtime_error("mesh container: invalid vertex buffer");
+            break;
+        case MeshChunkType::IndexBuffer:
+            if (c.mStride != 2 && c.mStride != 4)
+                throw std::runtime_error("mesh container: invalid index size");
+            break;
+        case MeshChunkType::SubMeshes:
+            if (c.mStride != sizeof(SubMeshData))
+                throw std::runtime_error("mesh container: submesh stride mismatch");
+            break;
+        default:
+            throw std::runtime_error("mesh container: unknown chunk");
+        }
+    }
+
+    for (uint32_t slot = 0; slot != header.mVertexBufferCount; ++slot) {
+        const auto vertexSize = chunk(MeshChunkType::VertexBuffer, slot).mStride;
+        for (const auto& e : vertexElements(slot)) {
+            if (e.mType >= std::variant_size_v<VertexElementType> ||
+                e.mAlignedByteOffset >= vertexSize)
+            {
+                throw std::runtime_error("mesh container: invalid vertex element");
+            }
+        }
+    }
+
+    const uint64_t indexCount = find(MeshChunkType::IndexBuffer, 0)
+        ? chunk(MeshChunkType::IndexBuffer, 0).mCount : 0;
+    for (const auto& submesh : subMeshes()) {
+        if (uint64_t(submesh.mIndexOffset) + submesh.mIndexCount > indexCount) {
+            throw std::runtime_error("mesh container: submesh out of range");
+        }
+    }
+}
+
+const MeshContainerChunk* MeshContainerView::find(MeshChunkType type, uint32_t index) const noexcept {
+    for (const auto& c : mChunks) {
+        if (c.mType == type && c.mIndex == index)
+            return &c;
+    }
+    return nullptr;
+}
+
+const MeshContainerChunk& MeshContainerView::chunk(MeshChunkType type, uint32_t index) const {
+    auto* c = find(type, index);
+    if (!c) {
+        throw std::runtime_error("mesh container: chunk not found");
+    }
+    return *c;
+}
+
+gsl::span<const MeshContainerVertexElement> MeshContainerView::vertexElements(uint32_t slot) const {
+    const auto& c = chunk(MeshChunkType::VertexElements, slot);
+    return { reinterpret_cast<const MeshContainerVertexElement*>(mData.data() + c.mOffset), c.mCount };
+}
+
+gsl::span<const std::byte> MeshContainerView::vertexBuffer(uint32_t slot) const {
+    const auto& c = chunk(MeshChunkType::VertexBuffer, slot);
+    return mData.subspan(c.mOffset, c.mSize);
+}
+
+uint32_t MeshContainerView::vertexCount(uint32_t slot) const {
+    return chunk(MeshChunkType::VertexBuffer, slot).mCount;
+}
+
+uint32_t MeshContainerView::vertexSize(uint32_t slot) const {
+    return chunk(MeshChunkType::VertexBuffer, slot).mStride;
+}
+
+gsl::span<const std::byte> MeshContainerView::indexBuffer() const noexcept {
+    auto* c = find(MeshChunkType::IndexBuffer, 0);
+    return c ? mData.subspan(c->mOffset, c->mSize) : gsl::span<const std::byte>{};
+}
+
+uint32_t MeshContainerView::indexElementSize() const noexcept {
+    auto* c = find(MeshChunkType::IndexBuffer, 0);
+    return c ? c->mStride : 0;
+}
+
+uint32_t MeshContainerView::primitiveCount() const noexcept {
+    return mHeader->mPrimitiveCount;
+}
+
+gsl::span<const SubMeshData> MeshContainerView::subMeshes() const noexcept {
+    auto* c = find(MeshChunkType::SubMeshes, 0);
+    if (!c)
+        return {};
+    return { reinterpret_cast<const SubMeshData*>(mData.data() + c->mOffset), c->mCount };
+}
+
+std::string_view MeshContainerView::layoutName() const noexcept {
+    auto* c = find(MeshChunkType::LayoutName, 0);
+    if (!c)
+        return {};
+    return { reinterpret_cast<const char*>(mData.data() + c->mOffset), gsl::narrow_cast<size_t>(c->mSize) };
+}
+
+void MeshContainerView::read(MeshData& mesh) const {
+    read(mesh, true);
+}
+
+void MeshContainerView::view(MeshData& mesh) const {
+    read(mesh, false);
+}
+
+void MeshContainerView::read(MeshData& mesh, bool copyBlobs) const {
+    mesh.mLayoutID = mHeader->mLayoutID;
+    mesh.mLayoutName = layoutName();
+
+    mesh.mVertexBuffers.clear();
+    mesh.mVertexBuffers.reserve(vertexBufferCount());
+    for (uint32_t slot = 0; slot != vertexBufferCount(); ++slot) {
+        auto& vb = mesh.mVertexBuffers.emplace_back();
+        const auto elements = vertexElements(slot);
+        vb.mDesc.mElements.reserve(elements.size());
+        for (const auto& src : elements) {
+            auto& e = vb.mDesc.mElements.emplace_back();
+            emplaceVariant(e.mType, src.mType);
+            e.mAlignedByteOffset = gsl::narrow<uint16_t>(src.mAlignedByteOffset);
+            e.mFormat = static_cast<Format>(src.mFormat);
+        }
+        vb.mDesc.mVertexSize = vertexSize(slot);
+        vb.mVertexCount = vertexCount(slot);
+
+        const auto buffer = vertexBuffer(slot);
+        const auto* first = reinterpret_cast<const char*>(buffer.data());
+        if (copyBlobs)
+            vb.mBuffer.assign(first, first + buffer.size());
+        else
+            vb.mMapped = gsl::span<const char>(first, buffer.size());
+    }
+
+    auto& ib = mesh.mIndexBuffer;
+    const auto indices = indexBuffer();
+    const auto* first = reinterpret_cast<const char*>(indices.data());
+    if (copyBlobs)
+        ib.mBuffer.assign(first, first + indices.size());
+    else
+        ib.mMapped = gsl::span<const char>(first, indices.size());
+    ib.mElementSize = indexElementSize();
+    ib.mPrimitiveCount = mHeader->mPrimitiveCount;
+    ib.mPrimitiveTopology = static_cast<GFX_PRIMITIVE_TOPOLOGY>(mHeader->mPrimitiveTopology);
+
+    const auto submeshes = subMeshes();
+    mesh.mSubMeshes.assign(submeshes.begin(), submeshes.end());
+}
+
+MappedMeshFile::MappedMeshFile(const std::filesystem::path& filename)
+    : mFile(filename.string().c_str(), boost::interprocess::read_only)
+    , mRegion(mFile, boost::interprocess::read_only)
+{}
+
+}
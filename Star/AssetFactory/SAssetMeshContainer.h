@@ -0,0 +1,129 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace Star::Asset {
+
+// Mesh container, little endian
+//   MeshContainerHeader
+//   MeshContainerChunk[mChunkCount] at mChunkTableOffset
+//   chunk blobs, each aligned to sMeshContainerAlignment
+constexpr std::array<char, 4> sMeshContainerMagic = { 'S', 'M', 'S', 'H' };
+constexpr uint32_t sMeshContainerVersion = 1;
+constexpr uint32_t sMeshContainerAlignment = 256;
+
+enum class MeshChunkType : uint32_t {
+    LayoutName = 1,
+    VertexElements,
+    VertexBuffer,
+    IndexBuffer,
+    SubMeshes,
+};
+
+struct MeshContainerHeader {
+    std::array<char, 4> mMagic = sMeshContainerMagic;
+    uint32_t mVersion = sMeshContainerVersion;
+    uint64_t mFileSize = 0;
+    uint64_t mChunkTableOffset = 0;
+    uint32_t mChunkCount = 0;
+    uint32_t mLayoutID = 0;
+    uint32_t mVertexBufferCount = 0;
+    uint32_t mPrimitiveTopology = 0;
+    uint32_t mPrimitiveCount = 0;
+    uint32_t mReserved[5] = {};
+};
+static_assert(sizeof(MeshContainerHeader) == 64);
+
+// mCount elements of mStride bytes, mIndex is the vertex buffer slot
+struct MeshContainerChunk {
+    MeshChunkType mType;
+    uint32_t mIndex;
+    uint64_t mOffset;
+    uint64_t mSize;
+    uint32_t mCount;
+    uint32_t mStride;
+};
+static_assert(sizeof(MeshContainerChunk) == 32);
+
+struct MeshContainerVertexElement {
+    uint32_t mType;
+    uint32_t mAlignedByteOffset;
+    uint32_t mFormat;
+    uint32_t mReserved;
+};
+static_assert(sizeof(MeshContainerVertexElement) == 16);
+
+void writeMeshContainer(const Graphics::Render::MeshData& mesh, std::string& content);
+
+bool isMeshContainer(gsl::span<const std::byte> data) noexcept;
+
+// Validated view over a mesh container, blobs reference the container memory.
+// throws std::runtime_error if the container is malformed
+class MeshContainerView {
+public:
+    explicit MeshContainerView(gsl::span<const std::byte> data);
+
+    const MeshContainerHeader& header() const noexcept {
+        return *mHeader;
+    }
+    uint32_t vertexBufferCount() const noexcept {
+        return mHeader->mVertexBufferCount;
+    }
+    gsl::span<const MeshContainerVertexElement> vertexElements(uint32_t slot) const;
+    gsl::span<const std::byte> vertexBuffer(uint32_t slot) const;
+    uint32_t vertexCount(uint32_t slot) const;
+    uint32_t vertexSize(uint32_t slot) const;
+    gsl::span<const std::byte> indexBuffer() const noexcept;
+    uint32_t indexElementSize() const noexcept;
+    uint32_t primitiveCount() const noexcept;
+    gsl::span<const Graphics::Render::SubMeshData> subMeshes() const noexcept;
+    std::string_view layoutName() const noexcept;
+
+    // copy descriptors and blobs into mesh, one allocation per buffer
+    void read(Graphics::Render::MeshData& mesh) const;
+    // copy descriptors only, blobs reference the container memory,
+    // which must outlive mesh
+    void view(Graphics::Render::MeshData& mesh) const;
+private:
+    void read(Graphics::Render::MeshData& mesh, bool copyBlobs) const;
+    const MeshContainerChunk& chunk(MeshChunkType type, uint32_t index) const;
+    const MeshContainerChunk* find(MeshChunkType type, uint32_t index) const noexcept;
+
+    gsl::span<const std::byte> mData;
+    const MeshContainerHeader* mHeader = nullptr;
+    gsl::span<const MeshContainerChunk> mChunks;
+};
+
+// read only file mapping, blobs of a container can be viewed without copy
+class MappedMeshFile {
+public:
+    explicit MappedMeshFile(const std::filesystem::path& filename);
+
+    gsl::span<const std::byte> data() const noexcept {
+        return { static_cast<const std::byte*>(mRegion.get_address()), mRegion.get_size() };
+    }
+private:
+    boost::interprocess::file_mapping mFile;
+    boost::interprocess::mapped_region mRegion;
+};
+
+}
@@ -0,0 +1,353 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetMeshOptimizer.h"
+#include "SAssetMeshUtils.h"
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+VertexCacheStatistics analyzeVertexCache(gsl::span<const uint32_t> indices,
+    uint32_t vertexCount, uint32_t cacheSize
+) {
+    Expects(indices.size() % 3 == 0);
+    Expects(cacheSize > 0);
+    auto* mr = std::pmr::get_default_resource();
+
+    VertexCacheStatistics stats;
+    stats.mTriangleCount = gsl::narrow<uint32_t>(indices.size() / 3);
+
+    std::pmr::vector<uint32_t> cacheTime(vertexCount, 0, mr);
+    std::pmr::vector<bool> used(vertexCount, false, mr);
+    // fifo of cacheSize entries, a vertex is cached while fewer than cacheSize misses followed it
+    uint32_t timestamp = cacheSize + 1;
+
+    for (const auto& v : indices) {
+        Expects(v < vertexCount);
+        if (!used[v]) {
+            used[v] = true;
+            ++stats.mVertexCount;
+        }
+        if (timestamp - cacheTime[v] > cacheSize) {
+            cacheTime[v] = timestamp++;
+            ++stats.mTransformCount;
+        }
+    }
+    return stats;
+}
+
+void optimizeVertexCache(gsl::span<uint32_t> indices, uint32_t vertexCount,
+    uint32_t cacheSize, std::pmr::vector<uint32_t>* clusters
+) {
+    Expects(indices.size() % 3 == 0);
+    Expects(cacheSize > 0);
+
+    if (clusters) {
+        clusters->clear();
+    }
+
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    auto* mr = std::pmr::get_default_resource();
+
+    // vertex-triangle adjacency
+    std::pmr::vector<uint32_t> live(vertexCount, 0, mr);
+    for (const auto& v : indices) {
+        Expects(v < vertexCount);
+        ++live[v];
+    }
+
+    std::pmr::vector<uint32_t> offsets(size_t(vertexCount) + 1, 0, mr);
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        offsets[v + 1] = offsets[v] + live[v];
+    }
+
+    std::pmr::vector<uint32_t> adjacency(indices.size(), mr);
+    {
+        std::pmr::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1, mr);
+        for (uint32_t t = 0; t != triangleCount; ++t) {
+            for (uint32_t k = 0; k != 3; ++k) {
+                adjacency[fill[indices[3 * t + k]]++] = t;
+            }
+        }
+    }
+
+    std::pmr::vector<uint32_t> cacheTime(vertexCount, 0, mr);
+    std::pmr::vector<bool> emitted(triangleCount, false, mr);
+    std::pmr::vector<uint32_t> deadEnd(mr);
+    std::pmr::vector<uint32_t> candidates(mr);
+    std::pmr::vector<uint32_t> output(mr);
+    deadEnd.reserve(indices.size());
+    output.reserve(indices.size());
+
+    uint32_t timestamp = cacheSize + 1;
+    size_t cursor = 0;
+    int64_t fanning = indices[0];
+
+    if (clusters) {
+        clusters->emplace_back(0);
+    }
+
+    while (fanning >= 0) {
+        const auto f = gsl::narrow_cast<uint32_t>(fanning);
+
+        // emit all remaining triangles of the fanning vertex
+        candidates.clear();
+        for (auto i = offsets[f]; i != offsets[f + 1]; ++i) {
+            const auto t = adjacency[i];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            for (uint32_t k = 0; k != 3; ++k) {
+                const auto v = indices[3 * t + k];
+                output.emplace_back(v);
+                deadEnd.emplace_back(v);
+                candidates.emplace_back(v);
+                --live[v];
+                if (timestamp - cacheTime[v] > cacheSize) {
+                    cacheTime[v] = timestamp++;
+                }
+            }
+        }
+
+        // pick the oldest vertex that will still be in cache after its triangles are emitted
+        int64_t next = -1;
+        int64_t bestPriority = -1;
+        for (const auto& v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize) {
+                priority = timestamp - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0) {
+            // dead end, continue from recently used vertices, then in input order
+            while (!deadEnd.empty()) {
+                const auto v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) {
+                    next = v;
+                    break;
+                }
+            }
+            while (next < 0 && cursor != indices.size()) {
+                const auto v = indices[cursor];
+                if (live[v] > 0) {
+                    next = v;
+                } else {
+                    ++cursor;
+                }
+            }
+            if (next >= 0 && clusters) {
+                clusters->emplace_back(gsl::narrow<uint32_t>(output.size() / 3));
+            }
+        }
+        fanning = next;
+    }
+
+    Ensures(output.size() == indices.size());
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeOverdraw(gsl::span<uint32_t> indices, gsl::span<const Vector3f> positions,
+    gsl::span<const uint32_t> clusters
+) {
+    Expects(indices.size() % 3 == 0);
+    const auto triangleCount = gsl::narrow<uint32_t>(indices.size() / 3);
+    if (clusters.size() < 2 || triangleCount == 0) {
+        return;
+    }
+
+    auto* mr = std::pmr::get_default_resource();
+
+    Vector3f meshCentroid = Vector3f::Zero();
+    for (const auto& v : indices) {
+        Expects(v < positions.size());
+        meshCentroid += positions[v];
+    }
+    meshCentroid /= float(indices.size());
+
+    auto getClusterEnd = [&](size_t c) {
+        return c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+    };
+
+    // clusters facing away from the mesh center are likely occluders
+    std::pmr::vector<float> sortKeys(clusters.size(), mr);
+    for (size_t c = 0; c != clusters.size(); ++c) {
+        Vector3f centroid = Vector3f::Zero();
+        Vector3f normal = Vector3f::Zero();
+        float area = 0.0f;
+        for (auto t = clusters[c]; t != getClusterEnd(c); ++t) {
+            const auto& p0 = positions[indices[3 * t + 0]];
+            const auto& p1 = positions[indices[3 * t + 1]];
+            const auto& p2 = positions[indices[3 * t + 2]];
+            Vector3f n = (p1 - p0).cross(p2 - p0);
+            float a = n.norm();
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f) {
+            centroid /= area;
+        } else {
+            centroid = meshCentroid;
+        }
+        float len = normal.norm();
+        sortKeys[c] = len > 0.0f ? (centroid - meshCentroid).dot(normal / len) : 0.0f;
+    }
+
+    std::pmr::vector<uint32_t> order(clusters.size(), mr);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+        return sortKeys[lhs] > sortKeys[rhs];
+    });
+
+    std::pmr::vector<uint32_t> output(mr);
+    output.reserve(indices.size());
+    for (const auto& c : order) {
+        output.insert(output.end(),
+            indices.begin() + size_t(clusters[c]) * 3,
+            indices.begin() + size_t(getClusterEnd(c)) * 3);
+    }
+    Ensures(output.size() == indices.size());
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeVertexFetch(MeshData& mesh) {
+    if (mesh.mVertexBuffers.empty()) {
+        return;
+    }
+    auto* mr = std::pmr::get_default_resource();
+    const uint32_t vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+
+    std::pmr::vector<uint32_t> indices(mr);
+    readIndices(mesh.mIndexBuffer, indices);
+
+    const uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::pmr::vector<uint32_t> remap(vertexCount, unused, mr);
+    uint32_t next = 0;
+    for (const auto& v : indices) {
+        Expects(v < vertexCount);
+        if (remap[v] == unused) {
+            remap[v] = next++;
+        }
+    }
+    // unreferenced vertices are kept at the end
+    for (auto& v : remap) {
+        if (v == unused) {
+            v = next++;
+        }
+    }
+    Ensures(next == vertexCount);
+
+    std::pmr::vector<char> buffer(mr);
+    for (auto& vb : mesh.mVertexBuffers) {
+        Expects(vb.mVertexCount == vertexCount);
+        const auto stride = vb.mDesc.mVertexSize;
+        buffer.assign(vb.mBuffer.begin(), vb.mBuffer.end());
+        for (uint32_t v = 0; v != vertexCount; ++v) {
+            std::memcpy(vb.mBuffer.data() + size_t(remap[v]) * stride,
+                buffer.data() + size_t(v) * stride, stride);
+        }
+    }
+
+    for (auto& v : indices) {
+        v = remap[v];
+    }
+    writeIndices(indices, vertexCount, mesh.mIndexBuffer);
+}
+
+MeshOptimizationReport optimizeMesh(MeshData& mesh, uint32_t cacheSize) {
+    MeshOptimizationReport report;
+    if (mesh.mVertexBuffers.empty()) {
+        return report;
+    }
+    if (mesh.mIndexBuffer.mPrimitiveTopology != GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST) {
+        throw std::invalid_argument("mesh optimization only supports triangle list");
+    }
+
+    auto* mr = std::pmr::get_default_resource();
+    const uint32_t vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+
+    std::pmr::vector<uint32_t> indices(mr);
+    readIndices(mesh.mIndexBuffer, indices);
+    report.mBefore = analyzeVertexCache(indices, vertexCount, cacheSize);
+
+    std::pmr::vector<Vector3f> positions(mr);
+    const bool hasPositions = readPositions(mesh, positions);
+
+    std::pmr::vector<uint32_t> clusters(mr);
+    auto optimizeRange = [&](uint32_t offset, uint32_t count) {
+        if (!(size_t(offset) + count <= indices.size() && count % 3 == 0)) {
+            throw std::invalid_argument("submesh index range invalid");
+        }
+        auto range = gsl::span<uint32_t>(indices).subspan(offset, count);
+        optimizeVertexCache(range, vertexCount, cacheSize, &clusters);
+        if (hasPositions) {
+            optimizeOverdraw(range, positions, clusters);
+        }
+    };
+
+    if (mesh.mSubMeshes.empty()) {
+        optimizeRange(0, gsl::narrow<uint32_t>(indices.size()));
+    } else {
+        for (const auto& submesh : mesh.mSubMeshes) {
+            optimizeRange(submesh.mIndexOffset, submesh.mIndexCount);
+        }
+    }
+    writeIndices(indices, vertexCount, mesh.mIndexBuffer);
+
+    optimizeVertexFetch(mesh);
+
+    readIndices(mesh.mIndexBuffer, indices);
+    report.mAfter = analyzeVertexCache(indices, vertexCount, cacheSize);
+    return report;
+}
+
+void writeMeshReportHeader(std::ostream& os) {
+    os << "mesh,triangles,vertices,acmr_before,acmr_after,atvr_before,atvr_after\n";
+}
+
+void writeMeshReport(std::ostream& os, std::string_view meshName, const MeshOptimizationReport& report) {
+    // mesh names come from the fbx, quote them
+    os << '"';
+    for (const auto& c : meshName) {
+        if (c == '"') {
+            os << '"';
+        }
+        os << c;
+    }
+    os << '"';
+    os << str(boost::format(",%d,%d,%.4f,%.4f,%.4f,%.4f\n")
+        % report.mAfter.mTriangleCount % report.mAfter.mVertexCount
+        % report.mBefore.acmr() % report.mAfter.acmr()
+        % report.mBefore.atvr() % report.mAfter.atvr());
+}
+
+}
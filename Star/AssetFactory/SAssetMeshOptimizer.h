@@ -0,0 +1,66 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+#include <iosfwd>
+
+namespace Star::Asset {
+
+struct VertexCacheStatistics {
+    // average cache miss ratio, transformed vertices per triangle
+    float acmr() const noexcept {
+        return mTriangleCount ? float(mTransformCount) / float(mTriangleCount) : 0.0f;
+    }
+    // average transform to vertex ratio, 1.0 is optimal
+    float atvr() const noexcept {
+        return mVertexCount ? float(mTransformCount) / float(mVertexCount) : 0.0f;
+    }
+
+    uint32_t mTriangleCount = 0;
+    uint32_t mVertexCount = 0;
+    uint32_t mTransformCount = 0;
+};
+
+struct MeshOptimizationReport {
+    VertexCacheStatistics mBefore;
+    VertexCacheStatistics mAfter;
+};
+
+// simulate a FIFO post-transform cache
+VertexCacheStatistics analyzeVertexCache(gsl::span<const uint32_t> indices,
+    uint32_t vertexCount, uint32_t cacheSize);
+
+// Tipsify, Sander et al. 2007. clusters receives the first triangle of each cluster
+void optimizeVertexCache(gsl::span<uint32_t> indices, uint32_t vertexCount,
+    uint32_t cacheSize, std::pmr::vector<uint32_t>* clusters = nullptr);
+
+// sort clusters front to back from the outside of the mesh
+void optimizeOverdraw(gsl::span<uint32_t> indices, gsl::span<const Vector3f> positions,
+    gsl::span<const uint32_t> clusters);
+
+// reorder vertices by first use in the index buffer
+void optimizeVertexFetch(Graphics::Render::MeshData& mesh);
+
+// submesh index ranges are kept
+MeshOptimizationReport optimizeMesh(Graphics::Render::MeshData& mesh, uint32_t cacheSize = 16);
+
+// comma separated, one row per mesh after the header row
+void writeMeshReportHeader(std::ostream& os);
+void writeMeshReport(std::ostream& os, std::string_view meshName, const MeshOptimizationReport& report);
+
+}
@@ -0,0 +1,279 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SAssetMeshUtils.h"
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+struct ElementKey {
+    uint32_t mOffset = 0;
+    uint32_t mSize = 0;
+    uint32_t mComponentSize = 0; // 0: compare bytes, 2: half, 4: float
+    float mInvEpsilon = 0.0f;
+};
+
+ElementKey makeElementKey(const VertexElement& e, const VertexWeldSettings& settings) {
+    ElementKey key;
+    key.mOffset = e.mAlignedByteOffset;
+    key.mSize = getEncoding(e.mFormat).mBPE;
+    if (key.mSize == 0) {
+        throw std::invalid_argument("vertex element format not supported");
+    }
+
+    const auto epsilon = settings.mEpsilons.at(e.mType.index());
+    if (epsilon > 0.0f) {
+        switch (e.mFormat) {
+        case Format::R32G32B32A32_SFLOAT:
+        case Format::R32G32B32_SFLOAT:
+        case Format::R32G32_SFLOAT:
+        case Format::R32_SFLOAT:
+            key.mComponentSize = 4;
+            break;
+        case Format::R16G16B16A16_SFLOAT:
+        case Format::R16G16_SFLOAT:
+        case Format::R16_SFLOAT:
+            key.mComponentSize = 2;
+            break;
+        default:
+            // non-float formats are welded bitwise
+            break;
+        }
+        key.mInvEpsilon = 1.0f / epsilon;
+    }
+    return key;
+}
+
+uint32_t getKeySize(const ElementKey& key) noexcept {
+    if (key.mComponentSize) {
+        return key.mSize / key.mComponentSize * sizeof(int32_t);
+    }
+    return key.mSize;
+}
+
+// snap to a grid of epsilon, vertices falling into the same cell are welded
+int32_t quantize(float v, float invEpsilon) noexcept {
+    if (!std::isfinite(v)) {
+        return std::numeric_limits<int32_t>::max();
+    }
+    auto q = std::floor(v * invEpsilon + 0.5f);
+    q = std::clamp(q, -2147483520.0f, 2147483520.0f);
+    return static_cast<int32_t>(q);
+}
+
+char* writeKey(const ElementKey& key, const char* src, char* dst) noexcept {
+    src += key.mOffset;
+    if (key.mComponentSize == 0) {
+        std::memcpy(dst, src, key.mSize);
+        return dst + key.mSize;
+    }
+    const uint32_t count = key.mSize / key.mComponentSize;
+    for (uint32_t i = 0; i != count; ++i) {
+        float v = 0.0f;
+        if (key.mComponentSize == 4) {
+            std::memcpy(&v, src + i * 4, 4);
+        } else {
+            half h;
+            std::memcpy(&h, src + i * 2, 2);
+            v = static_cast<float>(h);
+        }
+        int32_t q = quantize(v, key.mInvEpsilon);
+        std::memcpy(dst, &q, sizeof(q));
+        dst += sizeof(q);
+    }
+    return dst;
+}
+
+}
+
+uint32_t getIndexCount(const IndexBufferData& ib) noexcept {
+    Expects(ib.mElementSize == 2 || ib.mElementSize == 4);
+    Expects(ib.mBuffer.size() % ib.mElementSize == 0);
+    return gsl::narrow_cast<uint32_t>(ib.mBuffer.size() / ib.mElementSize);
+}
+
+void readIndices(const IndexBufferData& ib, std::pmr::vector<uint32_t>& indices) {
+    const auto indexCount = getIndexCount(ib);
+    indices.resize(indexCount);
+    if (ib.mElementSize == 2) {
+        const auto* pIndex = reinterpret_cast<const uint16_t*>(ib.mBuffer.data());
+        std::copy(pIndex, pIndex + indexCount, indices.begin());
+    } else {
+        const auto* pIndex = reinterpret_cast<const uint32_t*>(ib.mBuffer.data());
+        std::copy(pIndex, pIndex + indexCount, indices.begin());
+    }
+}
+
+void writeIndices(gsl::span<const uint32_t> indices, uint32_t vertexCount, IndexBufferData& ib) {
+    Expects(ib.mPrimitiveTopology == GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    Expects(indices.size() % 3 == 0);
+
+    if (vertexCount <= 65536) {
+        ib.mElementSize = 2;
+    } else {
+        ib.mElementSize = 4;
+    }
+    ib.mPrimitiveCount = gsl::narrow<uint32_t>(indices.size() / 3);
+    ib.mBuffer.resize(ib.mElementSize * indices.size());
+
+    if (ib.mElementSize == 2) {
+        auto* pIndex = reinterpret_cast<uint16_t*>(ib.mBuffer.data());
+        for (size_t i = 0; i != indices.size(); ++i) {
+            Expects(indices[i] < vertexCount);
+            pIndex[i] = gsl::narrow_cast<uint16_t>(indices[i]);
+        }
+    } else {
+        auto* pIndex = reinterpret_cast<uint32_t*>(ib.mBuffer.data());
+        for (size_t i = 0; i != indices.size(); ++i) {
+            Expects(indices[i] < vertexCount);
+            pIndex[i] = indices[i];
+        }
+    }
+}
+
+bool readPositions(const MeshData& mesh, std::pmr::vector<Vector3f>& positions) {
+    for (const auto& vb : mesh.mVertexBuffers) {
+        for (const auto& e : vb.mDesc.mElements) {
+            if (!std::holds_alternative<SV_Position_>(e.mType)) {
+                continue;
+            }
+            positions.resize(vb.mVertexCount);
+            const auto stride = vb.mDesc.mVertexSize;
+            const char* src = vb.mBuffer.data() + e.mAlignedByteOffset;
+            switch (e.mFormat) {
+            case Format::R32G32B32A32_SFLOAT:
+            case Format::R32G32B32_SFLOAT:
+                for (uint32_t v = 0; v != vb.mVertexCount; ++v, src += stride) {
+                    float p[3];
+                    std::memcpy(p, src, sizeof(p));
+                    positions[v] = Vector3f(p[0], p[1], p[2]);
+                }
+                break;
+            case Format::R16G16B16A16_SFLOAT:
+                for (uint32_t v = 0; v != vb.mVertexCount; ++v, src += stride) {
+                    half p[3];
+                    std::memcpy(p, src, sizeof(p));
+                    positions[v] = Vector3f(static_cast<float>(p[0]),
+                        static_cast<float>(p[1]), static_cast<float>(p[2]));
+                }
+                break;
+            default:
+                throw std::invalid_argument("unsupported position format");
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t weldVertices(MeshData& mesh, const VertexWeldSettings& settings) {
+    if (mesh.mVertexBuffers.empty()) {
+        return 0;
+    }
+    auto* mr = std::pmr::get_default_resource();
+
+    const uint32_t vertexCount = mesh.mVertexBuffers.front().mVertexCount;
+    for (const auto& vb : mesh.mVertexBuffers) {
+        if (vb.mVertexCount != vertexCount) {
+            throw std::invalid_argument("vertex buffers have different vertex count");
+        }
+        Expects(vb.mBuffer.size() == size_t(vb.mDesc.mVertexSize) * vertexCount);
+    }
+
+    // build keys, a vertex is the concatenation of its elements in all streams
+    std::pmr::vector<std::pmr::vector<ElementKey>> elementKeys(mr);
+    elementKeys.reserve(mesh.mVertexBuffers.size());
+    size_t keySize = 0;
+    for (const auto& vb : mesh.mVertexBuffers) {
+        auto& keys = elementKeys.emplace_back();
+        keys.reserve(vb.mDesc.mElements.size());
+        for (const auto& e : vb.mDesc.mElements) {
+            const auto& key = keys.emplace_back(makeElementKey(e, settings));
+            if (key.mOffset + key.mSize > vb.mDesc.mVertexSize) {
+                throw std::invalid_argument("vertex element out of range");
+            }
+            keySize += getKeySize(key);
+        }
+    }
+
+    std::pmr::vector<char> keyBuffer(keySize * vertexCount, mr);
+    {
+        char* dst = keyBuffer.data();
+        for (uint32_t v = 0; v != vertexCount; ++v) {
+            for (size_t i = 0; i != mesh.mVertexBuffers.size(); ++i) {
+                const auto& vb = mesh.mVertexBuffers[i];
+                const char* src = vb.mBuffer.data() + size_t(v) * vb.mDesc.mVertexSize;
+                for (const auto& key : elementKeys[i]) {
+                    dst = writeKey(key, src, dst);
+                }
+            }
+        }
+        Ensures(dst == keyBuffer.data() + keyBuffer.size());
+    }
+
+    // first occurrence wins, so the result only depends on vertex order
+    std::pmr::vector<uint32_t> remap(vertexCount, mr);
+    uint32_t weldedCount = 0;
+    {
+        std::pmr::unordered_map<std::string_view, uint32_t> unique(mr);
+        unique.reserve(vertexCount);
+        for (uint32_t v = 0; v != vertexCount; ++v) {
+            std::string_view key(keyBuffer.data() + size_t(v) * keySize, keySize);
+            auto res = unique.try_emplace(key, weldedCount);
+            if (res.second) {
+                ++weldedCount;
+            }
+            remap[v] = res.first->second;
+        }
+    }
+
+    // compact vertex streams, in place since remap[v] <= v
+    for (auto& vb : mesh.mVertexBuffers) {
+        const auto stride = vb.mDesc.mVertexSize;
+        uint32_t next = 0;
+        for (uint32_t v = 0; v != vertexCount; ++v) {
+            if (remap[v] == next) {
+                if (next != v) {
+                    std::memcpy(vb.mBuffer.data() + size_t(next) * stride,
+                        vb.mBuffer.data() + size_t(v) * stride, stride);
+                }
+                ++next;
+            }
+        }
+        Ensures(next == weldedCount);
+        vb.mVertexCount = weldedCount;
+        vb.mBuffer.resize(size_t(weldedCount) * stride);
+        vb.mBuffer.shrink_to_fit();
+    }
+
+    // rebuild index buffer
+    std::pmr::vector<uint32_t> indices(mr);
+    readIndices(mesh.mIndexBuffer, indices);
+    for (auto& id : indices) {
+        Expects(id < vertexCount);
+        id = remap[id];
+    }
+    writeIndices(indices, weldedCount, mesh.mIndexBuffer);
+
+    return weldedCount;
+}
+
+}
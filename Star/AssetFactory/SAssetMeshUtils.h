@@ -0,0 +1,43 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+
+namespace Star::Asset {
+
+struct VertexWeldSettings {
+    void setEpsilon(const Graphics::Render::VertexElementType& type, float epsilon) {
+        Expects(epsilon >= 0.0f);
+        mEpsilons.at(type.index()) = epsilon;
+    }
+
+    // per semantic, 0 only welds bitwise identical elements
+    std::array<float, std::variant_size_v<Graphics::Render::VertexElementType>> mEpsilons = {};
+};
+
+uint32_t getIndexCount(const Graphics::Render::IndexBufferData& ib) noexcept;
+void readIndices(const Graphics::Render::IndexBufferData& ib, std::pmr::vector<uint32_t>& indices);
+void writeIndices(gsl::span<const uint32_t> indices, uint32_t vertexCount, Graphics::Render::IndexBufferData& ib);
+
+// returns false if mesh has no position element
+bool readPositions(const Graphics::Render::MeshData& mesh, std::pmr::vector<Vector3f>& positions);
+
+// merge duplicated vertices and rebuild the index buffer, returns welded vertex count
+uint32_t weldVertices(Graphics::Render::MeshData& mesh, const VertexWeldSettings& settings = {});
+
+}
@@ -0,0 +1,481 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SAssetMipMaps.h"
+#include <Star/Graphics/STextureUtils.h>
+#include <Star/Graphics/SRenderFormatUtils.h>
+#include <immintrin.h>
+
+namespace Star::Asset {
+
+using namespace Graphics::Render;
+
+namespace {
+
+enum class PixelLayout {
+    RGBA8,
+    RGBA16F,
+    R8,
+};
+
+PixelLayout getPixelLayout(Format format) {
+    switch (format) {
+    case Format::R8G8B8A8_UNORM:
+    case Format::R8G8B8A8_SRGB:
+        return PixelLayout::RGBA8;
+    case Format::R16G16B16A16_SFLOAT:
+        return PixelLayout::RGBA16F;
+    case Format::R8_UNORM:
+    case Format::R8_SRGB:
+        return PixelLayout::R8;
+    default:
+        throw std::invalid_argument("mip chain format not supported");
+    }
+}
+
+uint32_t getPixelSize(PixelLayout layout) noexcept {
+    switch (layout) {
+    case PixelLayout::RGBA8:
+        return 4;
+    case PixelLayout::RGBA16F:
+        return 8;
+    case PixelLayout::R8:
+        return 1;
+    }
+    return 0;
+}
+
+const std::array<float, 256>& getSRGBToLinearTable() {
+    static const auto sTable = []() {
+        std::array<float, 256> table{};
+        for (size_t i = 0; i != table.size(); ++i) {
+            float c = i / 255.0f;
+            table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return table;
+    }();
+    return sTable;
+}
+
+// linear value quantized to 16 bits, far below one 8 bit step even near black
+const std::vector<uint8_t>& getLinearToSRGBTable() {
+    static const auto sTable = []() {
+        std::vector<uint8_t> table(65536);
+        for (size_t i = 0; i != table.size(); ++i) {
+            float c = i / 65535.0f;
+            float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            table[i] = static_cast<uint8_t>(std::min(255.0f, s * 255.0f + 0.5f));
+        }
+        return table;
+    }();
+    return sTable;
+}
+
+uint8_t linearToSRGB(const std::vector<uint8_t>& table, float c) noexcept {
+    c = std::clamp(c, 0.0f, 1.0f);
+    return table[static_cast<size_t>(c * 65535.0f + 0.5f)];
+}
+
+float halfToFloat(uint16_t bits) noexcept {
+    return static_cast<float>(Eigen::numext::bit_cast<half>(bits));
+}
+
+uint16_t floatToHalf(float value) noexcept {
+    return Eigen::numext::bit_cast<uint16_t>(half(value));
+}
+
+// all levels are kept as 4 x float per texel, R8 only uses the first channel
+void decodeLevel(const std::byte* src, size_t rowPitch, PixelLayout layout, bool bSRGB,
+    uint32_t width, uint32_t height, float* dst
+) {
+    const auto& srgb = getSRGBToLinearTable();
+    for (uint32_t y = 0; y != height; ++y) {
+        const auto* row = src + y * rowPitch;
+        float* out = dst + size_t(y) * width * 4;
+        switch (layout) {
+        case PixelLayout::RGBA8: {
+            const auto* p = reinterpret_cast<const uint8_t*>(row);
+            for (uint32_t x = 0; x != width; ++x, p += 4, out += 4) {
+                if (bSRGB) {
+                    out[0] = srgb[p[0]];
+                    out[1] = srgb[p[1]];
+                    out[2] = srgb[p[2]];
+                } else {
+                    out[0] = p[0] / 255.0f;
+                    out[1] = p[1] / 255.0f;
+                    out[2] = p[2] / 255.0f;
+                }
+                out[3] = p[3] / 255.0f;
+            }
+            break;
+        }
+        case PixelLayout::RGBA16F: {
+            const auto* p = reinterpret_cast<const uint16_t*>(row);
+#if defined(__AVX2__)
+            for (uint32_t x = 0; x != width; ++x, p += 4, out += 4) {
+                _mm_storeu_ps(out, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+            }
+#else
+            for (uint32_t x = 0; x != width * 4; ++x) {
+                out[x] = halfToFloat(p[x]);
+            }
+#endif
+            break;
+        }
+        case PixelLayout::R8: {
+            const auto* p = reinterpret_cast<const uint8_t*>(row);
+            for (uint32_t x = 0; x != width; ++x, out += 4) {
+                out[0] = bSRGB ? srgb[p[x]] : p[x] / 255.0f;
+                out[1] = out[2] = out[3] = 0.0f;
+            }
+            break;
+        }
+        }
+    }
+}
+
+void encodePixel(const float* texel, PixelLayout layout, bool bSRGB,
+    const std::vector<uint8_t>& srgb, std::byte* dst
+) {
+    switch (layout) {
+    case PixelLayout::RGBA8: {
+        auto* p = reinterpret_cast<uint8_t*>(dst);
+        if (bSRGB) {
+            p[0] = linearToSRGB(srgb, texel[0]);
+            p[1] = linearToSRGB(srgb, texel[1]);
+            p[2] = linearToSRGB(srgb, texel[2]);
+            p[3] = static_cast<uint8_t>(std::clamp(texel[3], 0.0f, 1.0f) * 255.0f + 0.5f);
+        } else {
+            auto v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(texel), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+            auto i = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(255.0f)));
+            i = _mm_packs_epi32(i, i);
+            i = _mm_packus_epi16(i, i);
+            auto packed = static_cast<uint32_t>(_mm_cvtsi128_si32(i));
+            std::memcpy(p, &packed, sizeof(packed));
+        }
+        break;
+    }
+    case PixelLayout::RGBA16F: {
+        auto* p = reinterpret_cast<uint16_t*>(dst);
+#if defined(__AVX2__)
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p),
+            _mm_cvtps_ph(_mm_loadu_ps(texel), _MM_FROUND_TO_NEAREST_INT));
+#else
+        for (size_t c = 0; c != 4; ++c) {
+            p[c] = floatToHalf(texel[c]);
+        }
+#endif
+        break;
+    }
+    case PixelLayout::R8: {
+        auto* p = reinterpret_cast<uint8_t*>(dst);
+        p[0] = bSRGB ? linearToSRGB(srgb, texel[0])
+            : static_cast<uint8_t>(std::clamp(texel[0], 0.0f, 1.0f) * 255.0f + 0.5f);
+        break;
+    }
+    }
+}
+
+// 2x2 box, odd sizes round down and drop the last source row/column,
+// a source size of 1 reuses its single row/column
+void downsampleBox(const float* src, uint32_t width, uint32_t height,
+    float* dst, uint32_t width2, uint32_t height2
+) {
+    const auto quarter = _mm_set1_ps(0.25f);
+    for (uint32_t y = 0; y != height2; ++y) {
+        const float* row0 = src + size_t(std::min(2 * y, height - 1)) * width * 4;
+        const float* row1 = src + size_t(std::min(2 * y + 1, height - 1)) * width * 4;
+        float* out = dst + size_t(y) * width2 * 4;
+
+        uint32_t x = 0;
+#if defined(__AVX2__)
+        if (width > 1) {
+            const auto quarter8 = _mm256_set1_ps(0.25f);
+            for (; x + 2 <= width2; x += 2) {
+                auto s0 = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8), _mm256_loadu_ps(row1 + x * 8));
+                auto s1 = _mm256_add_ps(_mm256_loadu_ps(row0 + x * 8 + 8), _mm256_loadu_ps(row1 + x * 8 + 8));
+                auto sum = _mm256_add_ps(
+                    _mm256_permute2f128_ps(s0, s1, 0x20),
+                    _mm256_permute2f128_ps(s0, s1, 0x31));
+                _mm256_storeu_ps(out + x * 4, _mm256_mul_ps(sum, quarter8));
+            }
+        }
+#endif
+        for (; x != width2; ++x) {
+            uint32_t x0 = 2 * x;
+            uint32_t x1 = std::min(2 * x + 1, width - 1);
+            auto sum = _mm_add_ps(
+                _mm_add_ps(_mm_loadu_ps(row0 + x0 * 4), _mm_loadu_ps(row0 + x1 * 4)),
+                _mm_add_ps(_mm_loadu_ps(row1 + x0 * 4), _mm_loadu_ps(row1 + x1 * 4)));
+            _mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, quarter));
+        }
+    }
+}
+
+constexpr uint32_t sKaiserTaps = 8;
+
+double besselI0(double x) noexcept {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k != 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// windowed sinc for a 2x reduction, 2 destination texels on each side, alpha 4
+const std::array<float, sKaiserTaps>& getKaiserWeights() {
+    static const auto sWeights = []() {
+        const double alpha = 4.0;
+        const double radius = 2.0;
+        const double pi = 3.14159265358979323846;
+        std::array<double, sKaiserTaps> w{};
+        double sum = 0.0;
+        for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+            // source texel 2x - 3 + k, relative to the destination center 2x + 0.5
+            double t = (k - 3.5) / 2.0;
+            double sinc = std::sin(pi * t) / (pi * t);
+            double r = t / radius;
+            w[k] = sinc * besselI0(alpha * std::sqrt(1.0 - r * r)) / besselI0(alpha);
+            sum += w[k];
+        }
+        std::array<float, sKaiserTaps> weights{};
+        for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+            weights[k] = static_cast<float>(w[k] / sum);
+        }
+        return weights;
+    }();
+    return sWeights;
+}
+
+// separable, horizontal into tmp, then vertical into dst. edges are clamped
+void downsampleKaiser(const float* src, uint32_t width, uint32_t height,
+    float* tmp, float* dst, uint32_t width2, uint32_t height2
+) {
+    const auto& weights = getKaiserWeights();
+    const int w = gsl::narrow_cast<int>(width);
+    const int h = gsl::narrow_cast<int>(height);
+
+    for (uint32_t y = 0; y != height; ++y) {
+        const float* row = src + size_t(y) * width * 4;
+        float* out = tmp + size_t(y) * width2 * 4;
+
+        uint32_t x = 0;
+        auto filterTexel = [&](uint32_t x) {
+            auto acc = _mm_setzero_ps();
+            for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+                int i = std::clamp(int(2 * x) - 3 + int(k), 0, w - 1);
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(row + i * 4)));
+            }
+            _mm_storeu_ps(out + x * 4, acc);
+        };
+        // left border
+        for (; x != width2 && 2 * int(x) - 3 < 0; ++x) {
+            filterTexel(x);
+        }
+#if defined(__AVX2__)
+        // two destination texels per iteration, their taps are 2 source texels apart.
+        // mul + add without fma, rounds exactly like the sse2 path
+        for (; x + 2 <= width2 && 2 * int(x + 1) + 4 < w; x += 2) {
+            const float* base = row + (2 * x - 3) * 4;
+            auto acc = _mm256_setzero_ps();
+            for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+                auto v = _mm256_insertf128_ps(
+                    _mm256_castps128_ps256(_mm_loadu_ps(base + k * 4)),
+                    _mm_loadu_ps(base + (k + 2) * 4), 1);
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[k]), v));
+            }
+            _mm256_storeu_ps(out + x * 4, acc);
+        }
+#endif
+        for (; x != width2; ++x) {
+            filterTexel(x);
+        }
+    }
+
+    const size_t rowSize = size_t(width2) * 4;
+    for (uint32_t y = 0; y != height2; ++y) {
+        std::array<const float*, sKaiserTaps> rows;
+        for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+            int i = std::clamp(int(2 * y) - 3 + int(k), 0, h - 1);
+            rows[k] = tmp + i * rowSize;
+        }
+        float* out = dst + y * rowSize;
+
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= rowSize; i += 8) {
+            auto acc = _mm256_setzero_ps();
+            for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i)));
+            }
+            _mm256_storeu_ps(out + i, acc);
+        }
+#endif
+        for (; i != rowSize; i += 4) {
+            auto acc = _mm_setzero_ps();
+            for (uint32_t k = 0; k != sKaiserTaps; ++k) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+            }
+            _mm_storeu_ps(out + i, acc);
+        }
+    }
+}
+
+float getAlphaCoverage(const float* texels, size_t count, float alphaRef, float scale) noexcept {
+    size_t passed = 0;
+    for (size_t i = 0; i != count; ++i) {
+        if (std::min(texels[i * 4 + 3] * scale, 1.0f) > alphaRef) {
+            ++passed;
+        }
+    }
+    return float(passed) / float(count);
+}
+
+// Castano, "Computing Alpha Mipmaps"
+float findAlphaScale(const float* texels, size_t count, float alphaRef, float coverage) noexcept {
+    float lo = 0.0f;
+    float hi = 4.0f;
+    for (int i = 0; i != 16; ++i) {
+        float mid = (lo + hi) * 0.5f;
+        if (getAlphaCoverage(texels, count, alphaRef, mid) > coverage) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+    return (lo + hi) * 0.5f;
+}
+
+// same criterion as isAlphaTestPNG, not all texels fully opaque or fully transparent
+bool isAlphaTest(const float* texels, size_t count) noexcept {
+    size_t opaque = 0;
+    size_t transparent = 0;
+    for (size_t i = 0; i != count; ++i) {
+        float a = texels[i * 4 + 3];
+        if (a >= 1.0f) {
+            ++opaque;
+        } else if (a <= 0.0f) {
+            ++transparent;
+        }
+    }
+    return opaque != count && transparent != count;
+}
+
+}
+
+void generateMipChain(std::pmr::memory_resource* mr, std::byte* buffer,
+    Format format, uint32_t width, uint32_t height,
+    uint32_t blockX, uint32_t blockY, uint32_t mipCount,
+    const MipChainSettings& settings
+) {
+    Expects(mipCount > 0);
+
+    const auto layout = getPixelLayout(format);
+    const bool bSRGB = isSRGB(format);
+    const uint32_t pixelSize = getPixelSize(layout);
+    const uint32_t bpe = pixelSize * blockX * blockY;
+    const bool bKaiser = std::holds_alternative<KaiserFilter_>(settings.mFilter);
+    const auto& srgb = getLinearToSRGBTable();
+
+    std::pmr::vector<float> curr(size_t(width) * height * 4, mr);
+    std::pmr::vector<float> next(size_t(half_size(width)) * half_size(height) * 4, mr);
+    std::pmr::vector<float> tmp(mr);
+    if (bKaiser) {
+        tmp.resize(size_t(half_size(width)) * height * 4);
+    }
+
+    decodeLevel(buffer, size_t(boost::alignment::align_up(width, blockX)) * pixelSize,
+        layout, bSRGB, width, height, curr.data());
+
+    float coverage = -1.0f;
+    if (settings.mPreserveAlphaCoverage && layout != PixelLayout::R8 &&
+        isAlphaTest(curr.data(), size_t(width) * height))
+    {
+        coverage = getAlphaCoverage(curr.data(), size_t(width) * height,
+            settings.mAlphaReference, 1.0f);
+    }
+
+    size_t offset = 0;
+    for (uint32_t k = 1; k != mipCount; ++k) {
+        offset += mip_size(width, height, blockX, blockY, bpe);
+
+        uint32_t width2 = half_size(width);
+        uint32_t height2 = half_size(height);
+        const size_t count = size_t(width2) * height2;
+
+        if (bKaiser) {
+            downsampleKaiser(curr.data(), width, height, tmp.data(), next.data(), width2, height2);
+        } else {
+            downsampleBox(curr.data(), width, height, next.data(), width2, height2);
+        }
+
+        // the chain keeps unscaled alpha, the scale only applies to the stored level
+        float alphaScale = 1.0f;
+        if (coverage > 0.0f && coverage < 1.0f) {
+            alphaScale = findAlphaScale(next.data(), count, settings.mAlphaReference, coverage);
+        }
+
+        const uint32_t alignedWidth = boost::alignment::align_up(width2, blockX);
+        const uint32_t alignedHeight = boost::alignment::align_up(height2, blockY);
+        const size_t rowPitch = size_t(alignedWidth) * pixelSize;
+        auto* level = buffer + offset;
+
+        std::array<float, 4> avg{};
+        std::array<float, 4> texel{};
+        for (uint32_t y = 0; y != height2; ++y) {
+            const float* row = next.data() + size_t(y) * width2 * 4;
+            auto* out = level + y * rowPitch;
+            for (uint32_t x = 0; x != width2; ++x) {
+                std::memcpy(texel.data(), row + x * 4, sizeof(texel));
+                if (alphaScale != 1.0f) {
+                    texel[3] = std::min(texel[3] * alphaScale, 1.0f);
+                }
+                for (size_t c = 0; c != 4; ++c) {
+                    avg[c] += texel[c];
+                }
+                encodePixel(texel.data(), layout, bSRGB, srgb, out + x * pixelSize);
+            }
+        }
+
+        // see https://www.khronos.org/opengl/wiki/S3_Texture_Compression
+        // block compression reads whole 4x4 blocks, fill the padding with the level average
+        if (alignedWidth != width2 || alignedHeight != height2) {
+            for (auto& c : avg) {
+                c /= float(count);
+            }
+            std::array<std::byte, 8> pixel;
+            encodePixel(avg.data(), layout, bSRGB, srgb, pixel.data());
+            for (uint32_t y = 0; y != alignedHeight; ++y) {
+                auto* out = level + y * rowPitch;
+                for (uint32_t x = 0; x != alignedWidth; ++x) {
+                    if (y < height2 && x < width2)
+                        continue;
+                    std::memcpy(out + x * pixelSize, pixel.data(), pixelSize);
+                }
+            }
+        }
+
+        std::swap(curr, next);
+        width = width2;
+        height = height2;
+    }
+}
+
+}
@@ -0,0 +1,43 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+#include <Star/AssetFactory/SAssetTypes.h>
+
+namespace Star::Asset {
+
+struct MipChainSettings {
+    MipFilter mFilter = BoxFilter;
+    // rescale alpha of each mip, so the fraction of texels passing
+    // the alpha test matches the top level
+    bool mPreserveAlphaCoverage = false;
+    float mAlphaReference = 0.5f;
+};
+
+// buffer holds mipCount levels laid out as texture_size(width, height, blockX, blockY, BPE),
+// level 0 must be filled. rows are padded to blockX, columns to blockY,
+// padding texels are set to the average of the level.
+// supports R8G8B8A8_UNORM/SRGB, R16G16B16A16_SFLOAT and R8_UNORM/SRGB,
+// srgb formats are filtered in linear space.
+void generateMipChain(std::pmr::memory_resource* mr, std::byte* buffer,
+    Graphics::Render::Format format, uint32_t width, uint32_t height,
+    uint32_t blockX, uint32_t blockY, uint32_t mipCount,
+    const MipChainSettings& settings = {});
+
+}
@@ -43,12 +43,37 @@ void serialize(Archive& ar, Star::Asset::MeshInfo& v, const uint32_t version) {
     ar & boost::serialization::make_nvp("numSubMeshes", v.mNumSubMeshes);
 }
 
+STAR_CLASS_IMPLEMENTATION(Star::Asset::BoxFilter_, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::BoxFilter_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::BoxFilter_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Asset::KaiserFilter_, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::KaiserFilter_, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::KaiserFilter_& v, const uint32_t version) {
+}
+
+STAR_CLASS_IMPLEMENTATION(Star::Asset::TextureImportSettings, object_serializable);
+STAR_CLASS_TRACKING(Star::Asset::TextureImportSettings, track_never);
+template<class Archive>
+void serialize(Archive& ar, Star::Asset::TextureImportSettings& v, const uint32_t version) {
+    ar & boost::serialization::make_nvp("format", v.mFormat);
+    ar & boost::serialization::make_nvp("generateMipMaps", v.mGenerateMipMaps);
+    ar & boost::serialization::make_nvp("flipY", v.mFlipY);
+    ar & boost::serialization::make_nvp("mipFilter", v.mMipFilter);
+    ar & boost::serialization::make_nvp("preserveAlphaCoverage", v.mPreserveAlphaCoverage);
+    ar & boost::serialization::make_nvp("alphaReference", v.mAlphaReference);
+}
+
 STAR_CLASS_IMPLEMENTATION(Star::Asset::TextureInfo, object_serializable);
 STAR_CLASS_TRACKING(Star::Asset::TextureInfo, track_never);
 template<class Archive>
 void serialize(Archive& ar, Star::Asset::TextureInfo& v, const uint32_t version) {
     ar & boost::serialization::make_nvp("metaID", v.mMetaID);
     ar & boost::serialization::make_nvp("name", v.mName);
+    ar & boost::serialization::make_nvp("importSettings", v.mImportSettings);
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Asset::ShaderInfo, object_serializable);
@@ -132,15 +157,6 @@ template<class Archive>
 void serialize(Archive& ar, Star::Asset::ByPolygon_& v, const uint32_t version) {
 }
 
-STAR_CLASS_IMPLEMENTATION(Star::Asset::TextureImportSettings, object_serializable);
-STAR_CLASS_TRACKING(Star::Asset::TextureImportSettings, track_never);
-template<class Archive>
-void serialize(Archive& ar, Star::Asset::TextureImportSettings& v, const uint32_t version) {
-    ar & boost::serialization::make_nvp("format", v.mFormat);
-    ar & boost::serialization::make_nvp("generateMipMaps", v.mGenerateMipMaps);
-    ar & boost::serialization::make_nvp("flipY", v.mFlipY);
-}
-
 } // namespace serialization
 
 } // namespace boost
@@ -16,11 +16,14 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "SAssetTexture.h"
+#include "SAssetMipMaps.h"
+#include "SAssetBlockCompression.h"
 #include <Star/Graphics/STextureUtils.h>
 #include <Star/Graphics/SRenderFormat.h>
 #include <Star/Graphics/SRenderFormatUtils.h>
 #include <Star/Graphics/SRenderFormatDXGI.h>
 #include <Star/Graphics/SRenderFormatTextureUtils.h>
+#include <Star/Graphics/STextureDDS.h>
 #pragma warning(push)
 #pragma warning(disable:4996)
 #pragma warning(disable:4275)
@@ -29,13 +32,12 @@
 #include <boost/gil/extension/io/png.hpp>
 #include <boost/gil/extension/io/targa.hpp>
 #pragma warning(pop)
-#include <boost/gil/extension/numeric/sampler.hpp>
-#include <boost/gil/extension/numeric/resample.hpp>
 #include <3rdparty/DXTCompressor/DXTCompressorDLL.h>
 #include <Star/SAlignedBuffer.h>
 #include <StarCompiler/Graphics/SRenderFormatNames.h>
 #include <DirectXTex.h>
 #include <Star/SStreamUtils.h>
+#include <boost/algorithm/string/case_conv.hpp>
 
 namespace Star::Asset {
 
@@ -65,74 +67,10 @@ void readImageInfo(std::istream& is, RESOURCE_DESC& desc) {
     is.seekg(0);
 }
 
-// see https://www.khronos.org/opengl/wiki/S3_Texture_Compression
-// For non-power-of-two images that aren't a multiple of 4 in size,
-// the other colors of the 4x4 block are taken to be black.
-// Each 4x4 block is independent of any other, so it can be decompressed independently.
-template<class DstPixel>
-void generateImageMipMaps(std::byte* dstBuffer, uint32_t width, uint32_t height,
-    const uint32_t BlockX, const uint32_t BlockY,
-    const size_t AlignX, uint32_t mipCount
-) {
-    Expects(mipCount > 0);
-
-    size_t offset = 0;
-    const uint32_t BPE = sizeof(DstPixel) * BlockX * BlockY;
-    for (uint32_t k = 1; k != mipCount; ++k) {
-        uint32_t width1 = boost::alignment::align_up(width, BlockX);
-        uint32_t height1 = boost::alignment::align_up(height, BlockY);
-
-        size_t rowAlignment = width1 * sizeof(DstPixel);
-        auto srcView = interleaved_view(width, height, (const DstPixel*)(dstBuffer + offset), rowAlignment);
-
-        offset += mip_size(width, height, BlockX, BlockY, BPE);
-        Ensures(offset % AlignX == 0);
-
-        width = half_size(width);
-        height = half_size(height);
-
-        uint32_t width2 = boost::alignment::align_up(width, BlockX);
-        uint32_t height2 = boost::alignment::align_up(height, BlockY);
-
-        rowAlignment = width2 * sizeof(DstPixel);
-
-        auto dstView = interleaved_view(width, height, (DstPixel*)(dstBuffer + offset), rowAlignment);
-        resize_view(srcView, dstView, boost::gil::bilinear_sampler());
-
-        if (width2 == width && height2 == height) {
-            continue;
-        }
-
-        std::array<float, num_channels<DstPixel>::value> acc{};
-
-        float count = 0.0f;
-        for_each_pixel(dstView, [&](const DstPixel& pixel) {
-            for (size_t k = 0; k != num_channels<DstPixel>::value; ++k) {
-                acc[k] += pixel[k];
-            }
-            count += 1.0f;
-        });
-
-        DstPixel avg;
-        for (size_t k = 0; k != num_channels<DstPixel>::value; ++k) {
-            avg[k] = boost::numeric_cast<typename channel_type<DstPixel>::type>(acc[k] / count);
-        }
-
-        auto dstView2 = interleaved_view(width2, height2, (DstPixel*)(dstBuffer + offset), rowAlignment);
-        for (uint32_t i = 0; i != height2; ++i) {
-            for (uint32_t j = 0; j != width2; ++j) {
-                if (i < height && j < width)
-                    continue;
-                dstView2(j, i) = avg;
-            }
-        }
-    }
-    Ensures(width == 1 && height == 1);
-}
-
 template<class Tag, class SrcPixel, size_t AlignX>
 void prepareTextureForCompression(std::istream& is, uint32_t width, uint32_t height,
     const uint32_t BlockX, const uint32_t BlockY, uint32_t mipCount, AlignedBuffer<AlignX>& buffer,
+    Format srcFormat, const MipChainSettings& mipSettings,
     bool generateMipMaps = true,
     bool flipY = true
 ) {
@@ -159,8 +97,8 @@ void prepareTextureForCompression(std::istream& is, uint32_t width, uint32_t hei
     }
 
     if (generateMipMaps) {
-        generateImageMipMaps<SrcPixel>(buffer.data(), width, height,
-            BlockX, BlockY, AlignX, mipCount);
+        generateMipChain(buffer.get_allocator().resource(), buffer.data(), srcFormat,
+            width, height, BlockX, BlockY, mipCount, mipSettings);
     }
 }
 
@@ -187,10 +125,17 @@ void loadImage(std::istream& is, std::pmr::memory_resource* mr,
     uint32_t mipCount = mip_count(boost::alignment::align_up(width, BlockX), boost::alignment::align_up(height, BlockY));
     uint32_t srcBPE = sizeof(SrcPixel) * BlockX * BlockY;
 
+    static_assert(sizeof(SrcPixel) == 4, "mip chain expects rgba8 source pixels");
+    const auto srcFormat = isSRGB(info.mFormat) ? Format::R8G8B8A8_SRGB : Format::R8G8B8A8_UNORM;
+    MipChainSettings mipSettings;
+    mipSettings.mFilter = info.mMipFilter;
+    mipSettings.mPreserveAlphaCoverage = info.mPreserveAlphaCoverage;
+    mipSettings.mAlphaReference = info.mAlphaReference;
+
     const int AlignX = 16;
     AlignedBuffer<16> buffer(mr);
     prepareTextureForCompression<Tag, SrcPixel>(is, width, height, BlockX, BlockY, mipCount, buffer,
-        info.mGenerateMipMaps, info.mFlipY);
+        srcFormat, mipSettings, info.mGenerateMipMaps, info.mFlipY);
 
     auto [dstBPE, blockX, blockY] = getEncoding(info.mFormat);
     Expects(blockX == BlockX);
@@ -222,10 +167,13 @@ void loadImage(std::istream& is, std::pmr::memory_resource* mr,
             auto wa = boost::alignment::align_up(w, blockX);
             auto ha = boost::alignment::align_up(h, blockY);
             if (wa > blockX && ha > blockY) {
-                DXTC::CompressImageDXT1SSE2(
-                    reinterpret_cast<const uint8_t*>(buffer.data() + srcOffset),
-                    reinterpret_cast<uint8_t*>(tex.mBuffer.data() + dstOffset),
-                    wa, ha);
+                compressBlockRows(mr, buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                    wa, ha, blockX, blockY, srcBPE, dstBPE,
+                    [](const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+                        DXTC::CompressImageDXT1SSE2(
+                            reinterpret_cast<const uint8_t*>(src),
+                            reinterpret_cast<uint8_t*>(dst), w, h);
+                    });
             } else {
                 DXTC::CompressImageDXT1(
                     reinterpret_cast<const uint8_t*>(buffer.data() + srcOffset),
@@ -244,10 +192,14 @@ void loadImage(std::istream& is, std::pmr::memory_resource* mr,
     case Format::BC3_TYPELESS_BLOCK:
     {
         for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
-            DXTC::CompressImageDXT5SSE2(
-                reinterpret_cast<const uint8_t*>(buffer.data() + srcOffset),
-                reinterpret_cast<uint8_t*>(tex.mBuffer.data() + dstOffset),
-                boost::alignment::align_up(w, blockX), boost::alignment::align_up(h, blockY));
+            compressBlockRows(mr, buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                boost::alignment::align_up(w, blockX), boost::alignment::align_up(h, blockY),
+                blockX, blockY, srcBPE, dstBPE,
+                [](const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+                    DXTC::CompressImageDXT5SSE2(
+                        reinterpret_cast<const uint8_t*>(src),
+                        reinterpret_cast<uint8_t*>(dst), w, h);
+                });
             srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
             dstOffset += mip_size(w, h, blockX, blockX, dstBPE);
             w = half_size(w);
@@ -255,6 +207,64 @@ void loadImage(std::istream& is, std::pmr::memory_resource* mr,
         }
     }
     break;
+    case Format::BC4_UNORM_BLOCK:
+    case Format::BC4_TYPELESS_BLOCK:
+    {
+        for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
+            compressBlockRows(mr, buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                boost::alignment::align_up(w, blockX), boost::alignment::align_up(h, blockY),
+                blockX, blockY, srcBPE, dstBPE,
+                [](const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+                    DXTC::CompressImageBC4SSE2(
+                        reinterpret_cast<const uint8_t*>(src),
+                        reinterpret_cast<uint8_t*>(dst), w, h);
+                });
+            srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
+            dstOffset += mip_size(w, h, blockX, blockY, dstBPE);
+            w = half_size(w);
+            h = half_size(h);
+        }
+    }
+    break;
+    case Format::BC5_UNORM_BLOCK:
+    case Format::BC5_TYPELESS_BLOCK:
+    {
+        for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
+            compressBlockRows(mr, buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                boost::alignment::align_up(w, blockX), boost::alignment::align_up(h, blockY),
+                blockX, blockY, srcBPE, dstBPE,
+                [](const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+                    DXTC::CompressImageBC5SSE2(
+                        reinterpret_cast<const uint8_t*>(src),
+                        reinterpret_cast<uint8_t*>(dst), w, h);
+                });
+            srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
+            dstOffset += mip_size(w, h, blockX, blockY, dstBPE);
+            w = half_size(w);
+            h = half_size(h);
+        }
+    }
+    break;
+    case Format::BC7_UNORM_BLOCK:
+    case Format::BC7_SRGB_BLOCK:
+    case Format::BC7_TYPELESS_BLOCK:
+    {
+        for (int k = 0; k != tex.mDesc.mMipLevels; ++k) {
+            compressBlockRows(mr, buffer.data() + srcOffset, tex.mBuffer.data() + dstOffset,
+                boost::alignment::align_up(w, blockX), boost::alignment::align_up(h, blockY),
+                blockX, blockY, srcBPE, dstBPE,
+                [](const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+                    DXTC::CompressImageBC7Mode6SSE2(
+                        reinterpret_cast<const uint8_t*>(src),
+                        reinterpret_cast<uint8_t*>(dst), w, h);
+                });
+            srcOffset += mip_size(w, h, BlockX, BlockY, srcBPE);
+            dstOffset += mip_size(w, h, blockX, blockY, dstBPE);
+            w = half_size(w);
+            h = half_size(h);
+        }
+    }
+    break;
     case Format::UNKNOWN:
     default:
         S_ERROR << "Format not supported" << getName(info.mFormat) << std::endl;
@@ -303,147 +313,63 @@ bool isAlphaTestPNG(std::istream& is) {
     return alphaTest;
 }
 
+Format getTextureFormatByUsage(std::string_view usage) {
+    auto name = boost::algorithm::to_lower_copy(std::string(usage));
+    auto contains = [&name](std::string_view key) {
+        return name.find(key) != std::string::npos;
+    };
+    if (contains("normal") || contains("bump")) {
+        return Format::S_BC5_UNORM_BLOCK;
+    }
+    for (std::string_view key : { "roughness", "metallic", "metalness", "occlusion", "_ao",
+        "gloss", "smoothness", "height", "mask" }) {
+        if (contains(key)) {
+            return Format::S_BC4_UNORM_BLOCK;
+        }
+    }
+    return Format::S_BC7_SRGB_BLOCK;
+}
+
+Format getTextureFormatBySlot(std::string_view slot) {
+    if (slot == "MainTex") {
+        return Format::S_BC7_SRGB_BLOCK;
+    }
+    if (slot == "BumpMap" || slot == "NormalMap") {
+        return Format::S_BC5_UNORM_BLOCK;
+    }
+    if (slot == "Material") {
+        return Format::S_BC7_UNORM_BLOCK;
+    }
+    return Format::UNKNOWN;
+}
+
 void loadPNG(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, TextureData& tex) {
     const auto& img = read_image_info(is, png_tag())._info;
     is.seekg(0);
 
-    if (settings.mFormat == Format::UNKNOWN) {
-        if (img._bit_depth != 8) {
-            throw std::runtime_error("png only support 8 bit depth");
-        }
-        auto info = settings;
+    if (img._bit_depth != 8) {
+        throw std::runtime_error("png only support 8 bit depth");
+    }
+    auto info = settings;
+    if (info.mFormat == Format::UNKNOWN) {
         if (img._num_channels < 4) {
             info.mFormat = Format::S_BC1_SRGB_BLOCK;
         } else {
             info.mFormat = Format::S_BC3_SRGB_BLOCK;
         }
-        loadImage<png_tag, rgba8_pixel_t>(is, mr,
-            gsl::narrow_cast<uint32_t>(img._width),
-            gsl::narrow_cast<uint32_t>(img._height),
-            4, 4, info, tex);
     }
+    loadImage<png_tag, rgba8_pixel_t>(is, mr,
+        gsl::narrow_cast<uint32_t>(img._width),
+        gsl::narrow_cast<uint32_t>(img._height),
+        4, 4, info, tex);
 }
 
 void loadTGA(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, TextureData& tex) {
     throw std::runtime_error("tga not supported yet");
 }
 
-namespace {
-
-struct DDS_PIXELFORMAT {
-    uint32_t    size;
-    uint32_t    flags;
-    uint32_t    fourCC;
-    uint32_t    RGBBitCount;
-    uint32_t    RBitMask;
-    uint32_t    GBitMask;
-    uint32_t    BBitMask;
-    uint32_t    ABitMask;
-};
-
-struct DDS_HEADER {
-    uint32_t        size;
-    uint32_t        flags;
-    uint32_t        height;
-    uint32_t        width;
-    uint32_t        pitchOrLinearSize;
-    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
-    uint32_t        mipMapCount;
-    uint32_t        reserved1[11];
-    DDS_PIXELFORMAT ddspf;
-    uint32_t        caps;
-    uint32_t        caps2;
-    uint32_t        caps3;
-    uint32_t        caps4;
-    uint32_t        reserved2;
-};
-
-}
-
-void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::TextureData& tex, bool bSrgb) {
-    std::array<char, 4> fourcc;
-    read_data(is, fourcc);
-
-    DDS_HEADER header;
-    read_data(is, header);
-
-    memcpy(fourcc.data(), &header.ddspf.fourCC, sizeof(fourcc));
-
-    std::array<char, 4> dxt1{ 'D', 'X', 'T', '1' };
-    std::array<char, 4> dxt5{ 'D', 'X', 'T', '5' };
-
-    auto& desc = tex.mDesc;
-
-    if (memcmp(fourcc.data(), dxt1.data(), 4) == 0) {
-        desc.mDimension = Graphics::Render::RESOURCE_DIMENSION_TEXTURE2D;
-        desc.mAlignment = 0;
-        desc.mWidth = header.width;
-        desc.mHeight = header.height;
-        desc.mDepthOrArraySize = header.depth;
-        desc.mMipLevels = header.mipMapCount;
-        desc.mFormat = Graphics::Render::Format::BC1_TYPELESS_BLOCK;
-        if (bSrgb) {
-            tex.mFormat = makeTypelessSRGB(desc.mFormat);
-        } else {
-            tex.mFormat = makeTypelessUNorm(desc.mFormat);
-        }
-    } else if (memcmp(fourcc.data(), dxt5.data(), 4) == 0) {
-        desc.mDimension = Graphics::Render::RESOURCE_DIMENSION_TEXTURE2D;
-        desc.mAlignment = 0;
-        desc.mWidth = header.width;
-        desc.mHeight = header.height;
-        desc.mDepthOrArraySize = header.depth;
-        desc.mMipLevels = header.mipMapCount;
-        desc.mFormat = Graphics::Render::Format::BC3_TYPELESS_BLOCK;
-        if (bSrgb) {
-            tex.mFormat = makeTypelessSRGB(desc.mFormat);
-        } else {
-            tex.mFormat = makeTypelessUNorm(desc.mFormat);
-        }
-    } else {
-        throw std::runtime_error("dds file not found");
-    }
-    desc.mSampleDesc = { 1, 0 };
-
-    auto uploadSize = Graphics::Render::getTextureUploadSize(desc.mFormat,
-        gsl::narrow_cast<uint32_t>(desc.mWidth), gsl::narrow_cast<uint32_t>(desc.mHeight));
-    tex.mBuffer.resize_aligned(uploadSize);
-    
-    auto width = gsl::narrow_cast<uint32_t>(desc.mWidth);
-    auto height = gsl::narrow_cast<uint32_t>(desc.mHeight);
-    int64_t readCount = 0;
-    char* dstSliceBuffer = reinterpret_cast<char*>(tex.mBuffer.data());
-
-    for (int k = 0; k != desc.mMipLevels; ++k) {
-        auto [rowCount, rowPitch, uploadRowPitch, sliceSize, alignedSliceSize, uploadSliceSize] = getMipInfo(desc.mFormat, width, height);
-
-        auto dstPitchBuffer = dstSliceBuffer;
-        for (int i = 0; i != rowCount; ++i) {
-            is.read(dstPitchBuffer, rowPitch);
-            readCount += rowPitch;
-            dstPitchBuffer += uploadRowPitch;
-        }
-
-        width = half_size(width);
-        height = half_size(height);
-        dstSliceBuffer += uploadSliceSize;
-    }
-
-    auto texSize = getTextureSize(desc.mFormat,
-        gsl::narrow_cast<uint32_t>(desc.mWidth), gsl::narrow_cast<uint32_t>(desc.mHeight));
-
-    if (desc.mFormat == Graphics::Render::Format::BC1_TYPELESS_BLOCK ||
-        desc.mFormat == Graphics::Render::Format::BC1_UNORM_BLOCK ||
-        desc.mFormat == Graphics::Render::Format::BC1_SRGB_BLOCK) {
-        Expects(boost::alignment::align_up(readCount, 8) == texSize);
-    } else {
-        Expects(boost::alignment::align_up(readCount, 16) == texSize);
-    }
-
-    auto texUploadSize = getTextureUploadSize(desc.mFormat,
-        gsl::narrow_cast<uint32_t>(desc.mWidth), gsl::narrow_cast<uint32_t>(desc.mHeight));
-    auto diff = dstSliceBuffer - reinterpret_cast<char*>(tex.mBuffer.data());
-    Ensures(diff == texUploadSize);
+void loadDDS(std::istream& is, Graphics::Render::TextureData& tex, bool bSrgb) {
+    readDDS(is, tex, bSrgb);
 }
 
 void saveDDS(std::ostream& os, const Graphics::Render::TextureData& tex0) {
@@ -24,10 +24,18 @@ namespace Star::Asset {
 uint32_t getNumChannelsPNG(std::istream& is);
 bool isAlphaTestPNG(std::istream& is);
 
+// block compression from a material attribute or texture path:
+// normal maps BC5, single channel masks (roughness, metallic, AO...) BC4, color BC7
+Graphics::Render::Format getTextureFormatByUsage(std::string_view usage);
+
+// block compression of a known material slot, UNKNOWN for other slots:
+// MainTex BC7 sRGB, BumpMap BC5, packed Material (metallic, smoothness, occlusion) BC7 linear
+Graphics::Render::Format getTextureFormatBySlot(std::string_view slot);
+
 void loadPNG(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, Graphics::Render::TextureData& tex);
 void loadTGA(std::istream& is, std::pmr::memory_resource* mr, const TextureImportSettings& settings, Graphics::Render::TextureData& tex);
 
-void loadDDS(std::istream& is, std::pmr::memory_resource* mr, Graphics::Render::TextureData& tex, bool bSrgb);
+void loadDDS(std::istream& is, Graphics::Render::TextureData& tex, bool bSrgb);
 void saveDDS(std::ostream& os, const Graphics::Render::TextureData& tex);
 
 }
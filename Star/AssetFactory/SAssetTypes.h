@@ -48,6 +48,24 @@ struct MeshInfo {
     size_t mNumSubMeshes;
 };
 
+struct BoxFilter_ {} static constexpr BoxFilter;
+struct KaiserFilter_ {} static constexpr KaiserFilter;
+
+using MipFilter = std::variant<BoxFilter_, KaiserFilter_>;
+
+struct TextureImportSettings {
+    // UNKNOWN picks BC1/BC3 by channel count, BC1, BC3, BC4 (red),
+    // BC5 (red, green, e.g. normal xy) and BC7 (mode 6 only) can be selected explicitly
+    Graphics::Render::Format mFormat = Graphics::Render::Format::UNKNOWN;
+    bool mGenerateMipMaps = true;
+    bool mFlipY = true;
+    MipFilter mMipFilter = BoxFilter;
+    // optionally keep alpha test coverage of the top level in every mip,
+    // only applied to textures detected as alpha tested
+    bool mPreserveAlphaCoverage = false;
+    float mAlphaReference = 0.5f;
+};
+
 struct TextureInfo {
     TextureInfo() = default;
     TextureInfo(MetaID metaID, std::string_view name)
@@ -56,6 +74,8 @@ struct TextureInfo {
     {}
     MetaID mMetaID;
     std::string mName;
+    // format is chosen from material usage when the library is built
+    TextureImportSettings mImportSettings;
 };
 
 struct ShaderInfo {
@@ -130,12 +150,6 @@ struct ByPolygon_ {} static constexpr ByPolygon;
 
 using MappingMode = std::variant<ByControlPoint_, ByPolygonVertex_, ByPolygon_>;
 
-struct TextureImportSettings {
-    Graphics::Render::Format mFormat = Graphics::Render::Format::UNKNOWN;
-    bool mGenerateMipMaps = true;
-    bool mFlipY = true;
-};
-
 } // namespace Asset
 
 } // namespace Star
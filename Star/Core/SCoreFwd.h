@@ -30,6 +30,8 @@ struct RenderGraph_;
 
 using ResourceType = std::variant<Mesh_, Texture_, Shader_, Material_, Content_, RenderGraph_>;
 
+struct Handle;
+
 } // namespace Core
 
 } // namespace Star
@@ -18,6 +18,7 @@
 #include "SFetch.h"
 #include "SResource.h"
 #include "SManagerPrivate.h"
+#include <numeric>
 
 namespace Star::Core {
 
@@ -85,4 +86,106 @@ bool FetchBase::loading() const noexcept {
     return !mResource->mPointer;
 }
 
+FetchGroup::FetchGroup() noexcept = default;
+
+FetchGroup::FetchGroup(gsl::span<const MetaID> ids, gsl::span<const ResourceType> tags, int32_t priority)
+    : mResources(ids.size())
+    , mStatus(ids.size(), FetchStatus::Loading)
+    , mPending(ids.size())
+{
+    std::iota(mPending.begin(), mPending.end(), 0);
+    Manager::instance().acquire(ids, tags, mResources, priority);
+}
+
+FetchGroup::FetchGroup(gsl::span<const MetaID> ids, const ResourceType& tag, int32_t priority)
+    : mResources(ids.size())
+    , mStatus(ids.size(), FetchStatus::Loading)
+    , mPending(ids.size())
+{
+    std::iota(mPending.begin(), mPending.end(), 0);
+    std::vector<ResourceType> tags(ids.size(), tag);
+    Manager::instance().acquire(ids, tags, mResources, priority);
+}
+
+FetchGroup::FetchGroup(FetchGroup&& rhs) noexcept
+    : mResources(std::move(rhs.mResources))
+    , mStatus(std::move(rhs.mStatus))
+    , mPending(std::move(rhs.mPending))
+    , mLoadedCount(rhs.mLoadedCount)
+    , mFailedCount(rhs.mFailedCount)
+{
+    rhs.mResources.clear();
+    rhs.mStatus.clear();
+    rhs.mPending.clear();
+    rhs.mLoadedCount = 0;
+    rhs.mFailedCount = 0;
+}
+
+FetchGroup& FetchGroup::operator=(FetchGroup&& rhs) noexcept {
+    if (this != &rhs) {
+        release();
+        mResources = std::move(rhs.mResources);
+        mStatus = std::move(rhs.mStatus);
+        mPending = std::move(rhs.mPending);
+        mLoadedCount = rhs.mLoadedCount;
+        mFailedCount = rhs.mFailedCount;
+        rhs.mResources.clear();
+        rhs.mStatus.clear();
+        rhs.mPending.clear();
+        rhs.mLoadedCount = 0;
+        rhs.mFailedCount = 0;
+    }
+    return *this;
+}
+
+FetchGroup::~FetchGroup() noexcept {
+    release();
+}
+
+void FetchGroup::release() noexcept {
+    for (auto pResource : mResources) {
+        pResource->release();
+    }
+    mResources.clear();
+    mStatus.clear();
+    mPending.clear();
+    mLoadedCount = 0;
+    mFailedCount = 0;
+}
+
+void FetchGroup::poll() noexcept {
+    // loads finish in any order, settled members leave the pending list
+    for (size_t k = 0; k != mPending.size();) {
+        const auto i = mPending[k];
+        const auto* pResource = mResources[i];
+        if (pResource->mPointer) {
+            mStatus[i] = FetchStatus::Loaded;
+            ++mLoadedCount;
+        } else if (pResource->mFailed.load(std::memory_order_acquire)) {
+            mStatus[i] = FetchStatus::Failed;
+            ++mFailedCount;
+        } else {
+            ++k;
+            continue;
+        }
+        mPending[k] = mPending.back();
+        mPending.pop_back();
+    }
+}
+
+FetchStatus FetchGroup::status(size_t i) const noexcept {
+    Expects(i < mStatus.size());
+    return mStatus[i];
+}
+
+const MetaID& FetchGroup::metaID(size_t i) const noexcept {
+    Expects(i < mResources.size());
+    return mResources[i]->metaID();
+}
+
+const void* FetchGroup::get(size_t i) const noexcept {
+    Expects(i < mResources.size());
+    return mResources[i]->mPointer;
+}
+
 }
@@ -52,6 +52,68 @@ protected:
 #pragma warning(pop)
 };
 
+enum class FetchStatus : uint8_t {
+    Loading,
+    Loaded,
+    Failed, // stays failed until the group is released
+};
+
+// acquires a group of resources with one table pass and one load command,
+// done() is a single pollable completion for the whole group, failed members included
+class STAR_CORE_API FetchGroup {
+public:
+    FetchGroup() noexcept;
+    FetchGroup(gsl::span<const MetaID> ids, gsl::span<const ResourceType> tags, int32_t priority = 0);
+    FetchGroup(gsl::span<const MetaID> ids, const ResourceType& tag, int32_t priority = 0);
+    FetchGroup(FetchGroup&& rhs) noexcept;
+    FetchGroup& operator=(FetchGroup&& rhs) noexcept;
+    FetchGroup(const FetchGroup&) = delete;
+    FetchGroup& operator=(const FetchGroup&) = delete;
+    ~FetchGroup() noexcept;
+
+    size_t size() const noexcept {
+        return mResources.size();
+    }
+
+    // checks the members still loading, the ones already settled are not checked again
+    void poll() noexcept;
+    // every member is loaded
+    bool ready() noexcept {
+        poll();
+        return mLoadedCount == mResources.size();
+    }
+    // every member is loaded or failed
+    bool done() noexcept {
+        poll();
+        return mPending.empty();
+    }
+    // at least one member failed
+    bool failed() noexcept {
+        poll();
+        return mFailedCount != 0;
+    }
+    size_t loadedCount() const noexcept {
+        return mLoadedCount;
+    }
+    size_t failedCount() const noexcept {
+        return mFailedCount;
+    }
+    // as of the last poll
+    FetchStatus status(size_t i) const noexcept;
+    const MetaID& metaID(size_t i) const noexcept;
+    const void* get(size_t i) const noexcept;
+private:
+    void release() noexcept;
+#pragma warning(push)
+#pragma warning(disable: 4251)
+    std::vector<Resource*> mResources;
+    std::vector<FetchStatus> mStatus;
+    std::vector<uint32_t> mPending;
+#pragma warning(pop)
+    size_t mLoadedCount = 0;
+    size_t mFailedCount = 0;
+};
+
 template<class T>
 class Fetch : public FetchBase {
 public:
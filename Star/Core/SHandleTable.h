@@ -0,0 +1,161 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SCoreTypes.h>
+
+namespace Star::Core {
+
+// 32-bit generational handle, index in the low bits, generation in the high bits.
+// 0 is the null handle, generations start at 1 and never wrap, see HandleTable::erase
+struct Handle {
+    static constexpr uint32_t sIndexBits = 20;
+    static constexpr uint32_t sIndexMask = (1u << sIndexBits) - 1;
+    static constexpr uint32_t sGenerationMask = (1u << (32 - sIndexBits)) - 1;
+
+    uint32_t index() const noexcept {
+        return mValue & sIndexMask;
+    }
+    uint32_t generation() const noexcept {
+        return mValue >> sIndexBits;
+    }
+    explicit operator bool() const noexcept {
+        return mValue != 0;
+    }
+
+    uint32_t mValue = 0;
+};
+
+inline bool operator==(Handle lhs, Handle rhs) noexcept {
+    return lhs.mValue == rhs.mValue;
+}
+
+inline bool operator!=(Handle lhs, Handle rhs) noexcept {
+    return lhs.mValue != rhs.mValue;
+}
+
+// maps MetaID to a dense slot once, hot paths then dereference handles by indexing.
+// stale handles, whose slot was erased or reused, dereference to nullptr.
+// not synchronized, used by one thread
+template<class T>
+class HandleTable {
+    struct Slot {
+        MetaID mMetaID = {};
+        uint32_t mGeneration = 1;
+        uint32_t mNextFree = 0; // index + 1, 0 ends the list
+        std::optional<T> mValue;
+    };
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(mSlots.get_allocator().resource());
+    }
+
+    HandleTable(const allocator_type& alloc)
+        : mSlots(alloc)
+        , mIndex(alloc)
+    {}
+
+    // returns the existing handle if metaID is already in the table
+    template<class... Args>
+    std::pair<Handle, bool> try_emplace(const MetaID& metaID, Args&&... args) {
+        auto iter = mIndex.find(metaID);
+        if (iter != mIndex.end()) {
+            return { iter->second, false };
+        }
+        uint32_t index = 0;
+        if (mFreeList) {
+            index = mFreeList - 1;
+            mFreeList = mSlots[index].mNextFree;
+        } else {
+            if (mSlots.size() > Handle::sIndexMask) {
+                throw std::length_error("HandleTable: slot index out of range");
+            }
+            index = gsl::narrow_cast<uint32_t>(mSlots.size());
+            mSlots.emplace_back();
+        }
+        auto& slot = mSlots[index];
+        slot.mMetaID = metaID;
+        slot.mNextFree = 0;
+        slot.mValue.emplace(std::forward<Args>(args)...);
+        Handle handle{ (slot.mGeneration << Handle::sIndexBits) | index };
+        mIndex.emplace(metaID, handle);
+        return { handle, true };
+    }
+
+    // the slot is recycled with a new generation, outstanding handles become stale.
+    // a slot whose generations are used up is retired instead of wrapping,
+    // so a stale handle can never match a later entry
+    bool erase(Handle handle) noexcept {
+        if (!valid(handle))
+            return false;
+        auto& slot = mSlots[handle.index()];
+        mIndex.erase(slot.mMetaID);
+        slot.mValue.reset();
+        slot.mMetaID = {};
+        if (slot.mGeneration == Handle::sGenerationMask) {
+            ++mRetiredCount;
+            return true;
+        }
+        ++slot.mGeneration;
+        slot.mNextFree = mFreeList;
+        mFreeList = handle.index() + 1;
+        return true;
+    }
+
+    bool valid(Handle handle) const noexcept {
+        auto index = handle.index();
+        return handle && index < mSlots.size() &&
+            mSlots[index].mGeneration == handle.generation() &&
+            mSlots[index].mValue.has_value();
+    }
+
+    T* get(Handle handle) noexcept {
+        return valid(handle) ? &*mSlots[handle.index()].mValue : nullptr;
+    }
+    const T* get(Handle handle) const noexcept {
+        return valid(handle) ? &*mSlots[handle.index()].mValue : nullptr;
+    }
+
+    // lookup by MetaID, null handle if not found
+    Handle find(const MetaID& metaID) const noexcept {
+        auto iter = mIndex.find(metaID);
+        return iter != mIndex.end() ? iter->second : Handle{};
+    }
+
+    // handles are process local, serialize the MetaID and find it again on load
+    const MetaID& metaID(Handle handle) const noexcept {
+        Expects(valid(handle));
+        return mSlots[handle.index()].mMetaID;
+    }
+
+    size_t size() const noexcept {
+        return mIndex.size();
+    }
+
+    // slots never reused again
+    size_t retiredCount() const noexcept {
+        return mRetiredCount;
+    }
+private:
+    std::pmr::vector<Slot> mSlots;
+    std::pmr::unordered_map<MetaID, Handle, boost::hash<MetaID>> mIndex;
+    uint32_t mFreeList = 0; // index + 1, 0 is empty
+    size_t mRetiredCount = 0;
+};
+
+}
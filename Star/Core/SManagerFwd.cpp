@@ -20,8 +20,8 @@
 
 namespace Star::Core {
 
-void Workflow::init(size_t resourceCount, size_t taskCount) {
-    Manager::sInstance.reset(new Manager(resourceCount, taskCount));
+void Workflow::init(size_t resourceCount, size_t taskCount, size_t loaderCount) {
+    Manager::sInstance.reset(new Manager(resourceCount, taskCount, loaderCount));
 }
 
 STAR_CORE_API void Workflow::stop() noexcept {
@@ -48,4 +48,34 @@ void Workflow::updateResources() {
     Manager::sInstance->updateResources();
 }
 
+void Workflow::setBudget(const ResourceType& tag, uint64_t budget) noexcept {
+    Expects(Manager::sInstance);
+    Manager::sInstance->setBudget(tag, budget);
+}
+
+uint64_t Workflow::getUsage(const ResourceType& tag) noexcept {
+    Expects(Manager::sInstance);
+    return Manager::sInstance->getUsage(tag);
+}
+
+void Workflow::setStreamingBudget(const StreamingBudget& budget) noexcept {
+    Expects(Manager::sInstance);
+    Manager::sInstance->setStreamingBudget(budget);
+}
+
+Handle Workflow::getHandle(const MetaID& metaID) noexcept {
+    Expects(Manager::sInstance);
+    return Manager::sInstance->getHandle(metaID);
+}
+
+const void* Workflow::get(Handle handle) noexcept {
+    Expects(Manager::sInstance);
+    return Manager::sInstance->get(handle);
+}
+
+const MetaID& Workflow::getMetaID(Handle handle) noexcept {
+    Expects(Manager::sInstance);
+    return Manager::sInstance->getMetaID(handle);
+}
+
 }
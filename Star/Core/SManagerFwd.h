@@ -17,17 +17,42 @@
 
 #pragma once
 #include <Star/Core/SConfig.h>
+#include <Star/Core/SCoreFwd.h>
 
 namespace Star::Core {
 
+// limits on loads started by one Workflow::loadResources call, 0 means unlimited
+struct StreamingBudget {
+    uint32_t mLoadCount = 0;
+    uint64_t mLoadBytes = 0; // size of the previous load, producer estimate on the first one
+    std::chrono::microseconds mLoadTime{ 0 };
+};
+
 class Workflow {
 public:
-    STAR_CORE_API static void init(size_t resourceCount, size_t taskCount);
+    // resourceCount: distinct MetaIDs acquired over the run, the resource table is sized for twice that
+    // loaderCount: worker threads running loads of concurrent producers, 0 loads on the caller
+    STAR_CORE_API static void init(size_t resourceCount, size_t taskCount, size_t loaderCount = 0);
     STAR_CORE_API static void stop() noexcept;
     STAR_CORE_API static void terminate() noexcept;
     STAR_CORE_API static void processEvents();
     STAR_CORE_API static void loadResources();
     STAR_CORE_API static void updateResources();
+
+    // bytes kept resident per resource type, unused resources are evicted lru first
+    STAR_CORE_API static void setBudget(const ResourceType& tag, uint64_t budget) noexcept;
+    STAR_CORE_API static uint64_t getUsage(const ResourceType& tag) noexcept;
+
+    // pending async loads are started by priority, see Resource::setPriority
+    STAR_CORE_API static void setStreamingBudget(const StreamingBudget& budget) noexcept;
+
+    // handle of a loaded resource, null if it is not loaded. a handle is resolved once and
+    // dereferenced by index until the resource is unloaded, then it is stale
+    STAR_CORE_API static Handle getHandle(const MetaID& metaID) noexcept;
+    // payload of a loaded resource, nullptr if the handle is stale
+    STAR_CORE_API static const void* get(Handle handle) noexcept;
+    // handles are process local, serialize the MetaID and get the handle again on load
+    STAR_CORE_API static const MetaID& getMetaID(Handle handle) noexcept;
 };
 
 }
@@ -17,81 +17,181 @@
 
 #pragma once
 #include <Star/SLockFree.h>
+#include <Star/Log/SLog.h>
 #include <Star/Core/SResource.h>
 #include <Star/Core/SProducer.h>
+#include <Star/Core/SManagerFwd.h>
+#include <Star/Core/SHandleTable.h>
+#include <Star/Core/SResourceTable.h>
 
 namespace Star::Core {
 
 class Producer;
 
+// Manager commands, declared at namespace scope so the Command variant is
+// default constructible while Manager is still incomplete
+struct LoadResource {
+    Resource* mResource = nullptr;
+};
+// owns mResources, freed after the command is handled
+struct LoadResources {
+    Resource** mResources = nullptr;
+    uint32_t mCount = 0;
+};
+struct UnloadResource {
+    Resource* mResource = nullptr;
+};
+struct ResourceCreated {
+    Resource* mResource = nullptr;
+    void* mPointer = nullptr;
+    uint64_t mSize = 0;
+    bool mCancelled = false;
+    bool mFailed = false;
+    bool mStarted = true; // false if dropped before Producer::load ran
+};
+
 class Manager {
     static std::unique_ptr<Manager> sInstance;
 
-    struct LoadResource {
-        Resource* mResource = nullptr;
-    };
-    struct UnloadResource {
-        Resource* mResource = nullptr;
-    };
-    struct ResourceCreated {
+    struct PendingLoad {
         Resource* mResource = nullptr;
-        void* mPointer = nullptr;
+        uint64_t mFrameID = 0; // frame enqueued
+        uint64_t mSequence = 0; // enqueue order, breaks ties within a frame
+        int64_t mPriority = 0; // effective priority, updated each frame
     };
 
+    // queued resources gain one priority level every sAgingFrames frames
+    static constexpr uint64_t sAgingFrames = 8;
+
     using Command = std::variant<
-        LoadResource, UnloadResource, ResourceCreated
+        LoadResource, LoadResources, UnloadResource, ResourceCreated
+    >;
+
+    // loaded resources with zero refcount, least recently released first
+    using UnusedResources = boost::multi_index_container<Resource*,
+        boost::multi_index::indexed_by<
+            boost::multi_index::sequenced<>,
+            boost::multi_index::hashed_unique<boost::multi_index::identity<Resource*>>
+        >
     >;
 public:
     static Manager& instance() noexcept;
 
-    Manager(size_t resourceCount, size_t taskCount)
+    Manager(size_t resourceCount, size_t taskCount, size_t loaderCount)
         : mThreadID(std::this_thread::get_id())
         , mProducers(std::variant_size_v<ResourceType>)
+        , mConcurrentLoads(std::variant_size_v<ResourceType>, false)
+        , mMaxLoaderJobCount(gsl::narrow_cast<int64_t>(taskCount))
         , mCommands(taskCount * 4)
+        , mResources(resourceCount * 2)
+        , mBudgets(std::variant_size_v<ResourceType>, 0)
+        , mUsages(std::variant_size_v<ResourceType>, 0)
+        , mUnused(std::variant_size_v<ResourceType>)
+        , mHandles(std::pmr::get_default_resource())
     {
-        mResources.reserve(resourceCount * 2);
-        mQueueCurr.reserve(taskCount);
-        mQueueNext.reserve(taskCount);
+        mQueuePending.reserve(taskCount);
         mQueueCreated.reserve(taskCount);
+        if (loaderCount) {
+            mLoaders.emplace(loaderCount);
+        }
     }
 
     void stop() noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
+        // running loads still deliver into mCommands, wait for them first
+        if (mLoaders) {
+            mLoaders->join();
+        }
         mStopped = true;
     }
 
-    void registerProducer(const ResourceType& tag, Producer* producer) {
+    void registerProducer(const ResourceType& tag, Producer* producer, bool concurrent) {
         Expects(std::this_thread::get_id() == mThreadID);
         Expects(producer);
         Expects(tag.index() < mProducers.size());
         Expects(!mProducers[tag.index()]);
         mProducers[tag.index()] = producer;
+        mConcurrentLoads[tag.index()] = concurrent;
     }
 
     const Resource* get(const MetaID& metaID, const ResourceType& tag) const noexcept {
-        const std::lock_guard<std::mutex> lock(mResourceMutex);
-        auto iter = mResources.find(metaID);
-        if (iter == mResources.end()) {
-            bool succeeded;
-            std::tie(iter, succeeded) = mResources.emplace(metaID, tag);
-            Ensures(succeeded);
-        } else {
-            Expects(iter->mTag == tag);
+        return &mResources.try_emplace(metaID, tag);
+    }
+
+    // resolves and async acquires a group of resources
+    void acquire(gsl::span<const MetaID> metaIDs, gsl::span<const ResourceType> tags,
+        gsl::span<Resource*> resources, int32_t priority)
+    {
+        mResources.try_emplace(metaIDs, tags, resources);
+        acquire(resources, priority);
+    }
+
+    // the ones acquired for the first time are posted as one LoadResources command
+    void acquire(gsl::span<Resource* const> resources, int32_t priority) {
+        std::unique_ptr<Resource*[]> loads(new Resource*[resources.size()]);
+        uint32_t count = 0;
+        for (auto pResource : resources) {
+            if (atomicAddRef(pResource->mRefCount)) {
+                pResource->mPriority.store(priority, std::memory_order_relaxed);
+                pResource->mFailed.store(false, std::memory_order_relaxed);
+                loads[count++] = pResource;
+            }
+        }
+        if (count) {
+            Expects(!mStopped);
+            mCommands.push(LoadResources{ loads.release(), count });
         }
+    }
 
-        return &*iter;
+    // budget 0: unused resources are unloaded immediately
+    void setBudget(const ResourceType& tag, uint64_t budget) noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mBudgets[tag.index()] = budget;
+        evict(tag.index());
+    }
+
+    uint64_t getUsage(const ResourceType& tag) const noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        return mUsages[tag.index()];
+    }
+
+    void setStreamingBudget(const StreamingBudget& budget) noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mStreamingBudget = budget;
+    }
+
+    Handle getHandle(const MetaID& metaID) const noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        return mHandles.find(metaID);
+    }
+
+    const void* get(Handle handle) const noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        auto ppPayload = mHandles.get(handle);
+        return ppPayload ? *ppPayload : nullptr;
+    }
+
+    const MetaID& getMetaID(Handle handle) const noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        return mHandles.metaID(handle);
     }
 
     // functions
-    void sync_created(const Resource& resource, void* pointer) noexcept {
+    void sync_created(const Resource& resource, void* pointer, uint64_t size,
+        bool cancelled, bool failed) noexcept
+    {
         Expects(std::this_thread::get_id() == mThreadID);
         Expects(!mSyncCreated);
-        mSyncCreated = ResourceCreated{ const_cast<Resource*>(&resource), pointer };
+        Expects(!cancelled); // sync loads are never cancelled
+        Expects(!failed); // sync loads throw instead
+        mSyncCreated = ResourceCreated{ const_cast<Resource*>(&resource), pointer, size, cancelled, failed };
     }
 
-    void async_created(const Resource& resource, void* pointer) const noexcept {
+    void async_created(const Resource& resource, void* pointer, uint64_t size,
+        bool cancelled, bool failed) const noexcept
+    {
         Expects(!mStopped);
-        mCommands.push(ResourceCreated{ const_cast<Resource*>(&resource), pointer });
+        mCommands.push(ResourceCreated{ const_cast<Resource*>(&resource), pointer, size, cancelled, failed });
     }
 private:
     inline Producer* getProducer(const ResourceType& tag) const noexcept {
@@ -101,22 +201,57 @@ private:
         return ptr;
     }
 
+    inline bool isConcurrent(const ResourceType& tag) const noexcept {
+        return mLoaders && mConcurrentLoads[tag.index()];
+    }
+
+    // runs Producer::load on the loader pool, completion comes back as ResourceCreated
+    bool try_post(Resource& resource, Producer* pProducer) noexcept {
+        Expects(std::this_thread::get_id() == mThreadID);
+        Expects(!mStopped);
+        if (mLoaderJobCount >= mMaxLoaderJobCount)
+            return false; // loaders busy, stays pending
+
+        ++mLoaderJobCount;
+        ++mJobCount;
+        resource.mLoaderJob = true;
+        boost::asio::post(*mLoaders, [this, pResource = &resource, pProducer]() {
+            CancellationToken token(&pResource->mCancelled);
+            if (token.cancelled()) { // released while waiting for a loader, the producer never saw it
+                mCommands.push(ResourceCreated{ pResource, nullptr, 0, true, false, false });
+                return;
+            }
+            bool succeeded = false;
+            try {
+                succeeded = pProducer->load(*pResource, true, token);
+            } catch (const std::exception& e) {
+                S_ERROR << "resource load failed: " << e.what();
+            } catch (...) {
+                S_ERROR << "resource load failed: unknown exception";
+            }
+            if (!succeeded) { // nothing delivered, finish loading as failed on the owning thread
+                async_created(*pResource, nullptr, 0, false, true);
+            }
+        });
+        return true;
+    }
+
     // resource handler
     bool try_send(Resource& resource, bool async) noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
         auto pProducer = getProducer(resource.mTag);
         bool succeeded;
-        if (async) { // if async
-            succeeded = pProducer->load(resource, async);
+        if (async && isConcurrent(resource.mTag)) {
+            succeeded = try_post(resource, pProducer);
+        } else if (async) { // if async
+            succeeded = pProducer->load(resource, async, CancellationToken(&resource.mCancelled));
             if (succeeded) { // succeeded
                 ++mJobCount;
-            } else { // producer too busy, delayed to next frame
-                mQueueNext.emplace(&resource);
-            }
+            } // else producer too busy, stays pending
         } else {
             auto prevCount = mJobCount;
             ++mJobCount;
-            succeeded = pProducer->load(resource, async);
+            succeeded = pProducer->load(resource, async, CancellationToken());
             Ensures(succeeded);
         }
         return succeeded;
@@ -125,40 +260,191 @@ private:
     void enqueue(Resource& resource, bool async) {
         Expects(std::this_thread::get_id() == mThreadID);
         if (async) {
-            mQueueCurr.emplace(&resource);
+            mQueuePending.emplace_back(PendingLoad{ &resource, mFrameID, mSequence++ });
         }
     }
 
     void dequeue(Resource& resource, bool async) noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
         if (async) {
-            mQueueCurr.erase(&resource);
+            auto iter = std::find_if(mQueuePending.begin(), mQueuePending.end(),
+                [&](const PendingLoad& p) { return p.mResource == &resource; });
+            Expects(iter != mQueuePending.end());
+            *iter = mQueuePending.back();
+            mQueuePending.pop_back();
         }
     }
 
     void finishLoadingSucceeded(Resource& resource) {
         --mJobCount;
+        if (resource.mLoaderJob) {
+            resource.mLoaderJob = false;
+            --mLoaderJobCount;
+        }
         auto pProducer = getProducer(resource.mTag);
         Expects(pProducer);
         pProducer->created(resource);
+        mHandles.try_emplace(resource.mMetaID, resource.mPointer.load());
+        acquireDependencies(resource, pProducer);
+        mUsages[resource.mTag.index()] += resource.mSize;
+        evict(resource.mTag.index());
     }
 
-    void finishLoadingFailed(Resource& resource) noexcept {
+    // cancelled, abandoned or failed, the producer finishes its task and releases what it made.
+    // a load dropped before it started has no task in the producer
+    void finishLoadingFailed(Resource& resource, bool started) noexcept {
         --mJobCount;
+        if (resource.mLoaderJob) {
+            resource.mLoaderJob = false;
+            --mLoaderJobCount;
+        }
+        if (!started)
+            return;
         auto pProducer = getProducer(resource.mTag);
         Expects(pProducer);
+        pProducer->created(resource);
         pProducer->destroy(resource);
     }
 
-    void destroy(Resource& resource) const noexcept {
+    // producer gave up on the token, but the resource was acquired again meanwhile
+    void restartLoading(Resource& resource, bool started) {
+        finishLoadingFailed(resource, started);
+        enqueue(resource, true);
+    }
+
+    void destroy(Resource& resource) noexcept {
         auto pProducer = getProducer(resource.mTag);
         Expects(pProducer);
         pProducer->destroy(resource);
+        mHandles.erase(mHandles.find(resource.mMetaID));
+        auto& usage = mUsages[resource.mTag.index()];
+        Expects(usage >= resource.mSize);
+        usage -= resource.mSize;
+        releaseDependencies(resource);
+    }
+
+    // dependency closure
+    // a loaded resource keeps the dependencies declared by its producer acquired,
+    // so the next level of the closure is queued as soon as the resource is created
+    void acquireDependencies(Resource& resource, Producer* pProducer) {
+        Expects(std::this_thread::get_id() == mThreadID);
+        mDependencyIDs.clear();
+        mDependencyTags.clear();
+        pProducer->dependencies(resource, mDependencyIDs, mDependencyTags);
+        Expects(mDependencyIDs.size() == mDependencyTags.size());
+        if (mDependencyIDs.empty())
+            return;
+
+        std::vector<Resource*> dependencies(mDependencyIDs.size());
+        mResources.try_emplace(mDependencyIDs, mDependencyTags, dependencies);
+
+        // shared dependencies are acquired once
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+
+        // cyclic edges are dropped, a resource never keeps itself resident
+        dependencies.erase(std::remove_if(dependencies.begin(), dependencies.end(),
+            [&](Resource* pDependency) {
+                return dependsOn(*pDependency, resource);
+            }), dependencies.end());
+        if (dependencies.empty())
+            return;
+
+        acquire(dependencies, resource.mPriority.load(std::memory_order_relaxed));
+        auto res = mDependencies.emplace(&resource, std::move(dependencies));
+        Ensures(res.second);
+    }
+
+    void releaseDependencies(Resource& resource) noexcept {
+        auto iter = mDependencies.find(&resource);
+        if (iter == mDependencies.end())
+            return;
+        auto dependencies = std::move(iter->second);
+        mDependencies.erase(iter);
+        for (auto pDependency : dependencies) {
+            pDependency->release();
+        }
+    }
+
+    // true if target is reachable from source through recorded dependencies
+    bool dependsOn(const Resource& source, const Resource& target) {
+        if (&source == &target)
+            return true;
+        mDependencyStack.clear();
+        mDependencyVisited.clear();
+        mDependencyStack.emplace_back(&source);
+        while (!mDependencyStack.empty()) {
+            auto pResource = mDependencyStack.back();
+            mDependencyStack.pop_back();
+            auto iter = mDependencies.find(pResource);
+            if (iter == mDependencies.end())
+                continue;
+            for (auto pDependency : iter->second) {
+                if (pDependency == &target)
+                    return true;
+                if (mDependencyVisited.insert(pDependency).second) {
+                    mDependencyStack.emplace_back(pDependency);
+                }
+            }
+        }
+        return false;
+    }
+
+    // lru
+    static bool isUnloaded(const Resource& resource) noexcept {
+        return resource.current_state()[0] == 0;
+    }
+
+    static bool isLoaded(const Resource& resource) noexcept {
+        return resource.current_state()[0] == 4;
+    }
+
+    // returns true if resource was still resident
+    bool reuse(Resource& resource) noexcept {
+        auto& index = mUnused[resource.mTag.index()].get<1>();
+        auto iter = index.find(&resource);
+        if (iter != index.end()) {
+            index.erase(iter);
+        }
+        return isLoaded(resource);
+    }
+
+    void unuse(Resource& resource) noexcept {
+        const auto id = resource.mTag.index();
+        if (isUnloaded(resource)) { // load failed, nothing resident
+            return;
+        }
+        if (!isLoaded(resource)) {
+            resource.unload(true);
+            return;
+        }
+        if (!resource.unused()) { // acquired again before command processed
+            return;
+        }
+        if (mBudgets[id] == 0) {
+            resource.unload(true);
+            return;
+        }
+        mUnused[id].push_back(&resource);
+        evict(id);
+    }
+
+    void evict(size_t id) noexcept {
+        auto& unused = mUnused[id];
+        while (mUsages[id] > mBudgets[id] && !unused.empty()) {
+            auto pResource = unused.front();
+            unused.pop_front();
+            pResource->unload(true);
+            Ensures(pResource->current_state()[0] == 0); // Ensures unloaded
+        }
     }
 
     void loadNow(Resource& resource) noexcept {
         Expects(std::this_thread::get_id() == mThreadID);
         Expects(Resource::nr_regions::value == 1);
+        if (reuse(resource)) {
+            return;
+        }
         auto prevCount = mJobCount;
 
         resource.load(false);
@@ -169,7 +455,7 @@ private:
         Ensures(resource.current_state()[0] == 2); // Ensures loading
         Ensures(mSyncCreated);
 
-        mSyncCreated->mResource->created(mSyncCreated->mPointer);
+        mSyncCreated->mResource->created(mSyncCreated->mPointer, mSyncCreated->mSize, false, false);
         Ensures(resource.current_state()[0] == 4); // Ensures loaded
         Ensures(prevCount == mJobCount);
         mSyncCreated.reset();
@@ -202,10 +488,20 @@ private:
         Expects(std::this_thread::get_id() == mThreadID);
         visit(overload(
             [this](const LoadResource& c) {
-                c.mResource->load(true);
+                if (!reuse(*c.mResource)) {
+                    c.mResource->load(true);
+                }
+            },
+            [this](const LoadResources& c) {
+                std::unique_ptr<Resource*[]> resources(c.mResources);
+                for (uint32_t i = 0; i != c.mCount; ++i) {
+                    if (!reuse(*resources[i])) {
+                        resources[i]->load(true);
+                    }
+                }
             },
             [this](const UnloadResource& c) {
-                c.mResource->unload(true);
+                unuse(*c.mResource);
             },
             [this](const ResourceCreated& c) {
                 mQueueCreated.emplace_back(c);
@@ -215,17 +511,58 @@ private:
 
     void loadResources() {
         Expects(std::this_thread::get_id() == mThreadID);
-        for (auto& pResource : mQueueCurr) {
-            pResource->start(true);
+        ++mFrameID;
+        if (mQueuePending.empty())
+            return;
+
+        // priorities might be changed by any thread, snapshot them once per frame
+        for (auto& p : mQueuePending) {
+            auto age = (mFrameID - p.mFrameID) / sAgingFrames;
+            p.mPriority = int64_t(p.mResource->mPriority.load(std::memory_order_relaxed)) +
+                gsl::narrow_cast<int64_t>(age);
         }
-        mQueueCurr.clear();
-        std::swap(mQueueCurr, mQueueNext);
+        auto less = [](const PendingLoad& lhs, const PendingLoad& rhs) noexcept {
+            if (lhs.mPriority != rhs.mPriority)
+                return lhs.mPriority < rhs.mPriority;
+            return lhs.mSequence > rhs.mSequence; // older first
+        };
+        std::make_heap(mQueuePending.begin(), mQueuePending.end(), less);
+
+        const auto& budget = mStreamingBudget;
+        const auto startTime = std::chrono::steady_clock::now();
+        uint32_t count = 0;
+        uint64_t bytes = 0;
+
+        // popped entries are moved behind heapEnd, started ones are dropped afterwards
+        auto heapEnd = mQueuePending.end();
+        while (heapEnd != mQueuePending.begin()) {
+            if (budget.mLoadCount && count >= budget.mLoadCount)
+                break;
+            if (budget.mLoadBytes && bytes >= budget.mLoadBytes)
+                break;
+            if (budget.mLoadTime.count() &&
+                std::chrono::steady_clock::now() - startTime >= budget.mLoadTime)
+                break;
+
+            std::pop_heap(mQueuePending.begin(), heapEnd, less);
+            --heapEnd;
+            auto& resource = *heapEnd->mResource;
+            resource.start(true);
+            if (resource.current_state()[0] != 1) { // started, no longer queued
+                heapEnd->mResource = nullptr;
+                ++count;
+                bytes += resource.mSize ? resource.mSize // size of previous load
+                    : getProducer(resource.mTag)->estimateSize(resource);
+            }
+        }
+        mQueuePending.erase(std::remove_if(heapEnd, mQueuePending.end(),
+            [](const PendingLoad& p) { return p.mResource == nullptr; }), mQueuePending.end());
     }
 
     void updateResources() {
         Expects(std::this_thread::get_id() == mThreadID);
         for (const auto& c : mQueueCreated) {
-            mSyncCreated->mResource->created(mSyncCreated->mPointer);
+            c.mResource->created(c.mPointer, c.mSize, c.mCancelled, c.mFailed, c.mStarted);
         }
         mQueueCreated.clear();
     }
@@ -237,16 +574,38 @@ private:
     bool mStopped = false;
     std::thread::id mThreadID = {};
     int64_t mJobCount = 0;
-    mutable MessageQueue<Command> mCommands;
     std::vector<Producer*> mProducers;
+    std::vector<bool> mConcurrentLoads; // per ResourceType index
+    int64_t mLoaderJobCount = 0;
+    const int64_t mMaxLoaderJobCount;
+    mutable MessageQueue<Command> mCommands;
 
-    mutable std::mutex mResourceMutex;
-    mutable MetaIDHashMap<Resource> mResources;
+    mutable ResourceTable mResources;
 
-    boost::container::flat_set<Resource*> mQueueCurr;
-    boost::container::flat_set<Resource*> mQueueNext;
+    uint64_t mFrameID = 0;
+    uint64_t mSequence = 0;
+    StreamingBudget mStreamingBudget;
+    std::vector<PendingLoad> mQueuePending;
     std::vector<ResourceCreated> mQueueCreated;
     std::optional<ResourceCreated> mSyncCreated;
+
+    // per ResourceType index
+    std::vector<uint64_t> mBudgets;
+    std::vector<uint64_t> mUsages;
+    std::vector<UnusedResources> mUnused;
+
+    // loaded resources, handle to payload
+    HandleTable<void*> mHandles;
+
+    // acquired dependencies of loaded resources
+    std::unordered_map<const Resource*, std::vector<Resource*>> mDependencies;
+    std::vector<MetaID> mDependencyIDs;
+    std::vector<ResourceType> mDependencyTags;
+    std::vector<const Resource*> mDependencyStack;
+    std::unordered_set<const Resource*> mDependencyVisited;
+
+    // declared last, joined before the resources it loads are destroyed
+    std::optional<boost::asio::thread_pool> mLoaders;
 };
 
 }
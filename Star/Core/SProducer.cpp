@@ -23,16 +23,40 @@ namespace Star::Core {
 Producer::Producer() = default;
 Producer::~Producer() = default;
 
-void Producer::deliver(const Resource& resource, void* pointer, bool async) const {
+void Producer::deliver(const Resource& resource, void* pointer, bool async, uint64_t size) const {
     if (async) {
-        Manager::instance().async_created(resource, pointer);
+        Manager::instance().async_created(resource, pointer, size, false, false);
     } else {
-        Manager::instance().sync_created(resource, pointer);
+        Manager::instance().sync_created(resource, pointer, size, false, false);
     }
 }
 
-void Producer::registerProducer(const ResourceType& tag) {
-    Manager::instance().registerProducer(tag, this);
+void Producer::deliverCancelled(const Resource& resource, bool async) const {
+    if (async) {
+        Manager::instance().async_created(resource, nullptr, 0, true, false);
+    } else {
+        Manager::instance().sync_created(resource, nullptr, 0, true, false);
+    }
+}
+
+void Producer::deliverFailed(const Resource& resource, bool async) const {
+    if (async) {
+        Manager::instance().async_created(resource, nullptr, 0, false, true);
+    } else {
+        Manager::instance().sync_created(resource, nullptr, 0, false, true);
+    }
+}
+
+void Producer::dependencies(const Resource& resource,
+    std::vector<MetaID>& metaIDs, std::vector<ResourceType>& tags) const {
+}
+
+uint64_t Producer::estimateSize(const Resource& resource) const {
+    return 0;
+}
+
+void Producer::registerProducer(const ResourceType& tag, bool concurrent) {
+    Manager::instance().registerProducer(tag, this, concurrent);
 }
 
 }
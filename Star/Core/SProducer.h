@@ -24,6 +24,22 @@ namespace Star::Core {
 class Manager;
 class Resource;
 
+// set when a loading resource is released, cleared if it is acquired again before delivery.
+// producers poll it at points where giving up saves work and then call deliverCancelled
+class CancellationToken {
+public:
+    CancellationToken() noexcept = default;
+    explicit CancellationToken(const std::atomic_bool* pCancelled) noexcept
+        : mCancelled(pCancelled)
+    {}
+
+    bool cancelled() const noexcept {
+        return mCancelled && mCancelled->load(std::memory_order_relaxed);
+    }
+private:
+    const std::atomic_bool* mCancelled = nullptr;
+};
+
 class STAR_CORE_API Producer {
 public:
     Producer();
@@ -31,13 +47,28 @@ public:
     Producer& operator=(const Producer&) = delete;
     virtual ~Producer() = 0;
 protected:
-    void deliver(const Resource& resource, void* pointer, bool async) const;
-    void registerProducer(const ResourceType& tag);
+    // size: resident bytes, accounted against the budget of the resource type
+    void deliver(const Resource& resource, void* pointer, bool async, uint64_t size = 0) const;
+    // finishes a load abandoned on its cancellation token, destroy is called for cleanup
+    void deliverCancelled(const Resource& resource, bool async) const;
+    // finishes a load that could not complete, destroy is called for cleanup.
+    // the resource stays unloaded until it is released and acquired again
+    void deliverFailed(const Resource& resource, bool async) const;
+    // concurrent: async loads are run on the workflow loader pool, see Workflow::init
+    // load must then be thread safe and deliver with async true, throwing or returning false
+    // without delivering finishes the load as failed, see deliverFailed
+    void registerProducer(const ResourceType& tag, bool concurrent = false);
 private:
     friend class Manager;
-    virtual bool load(const Resource& resource, bool async) = 0;
+    virtual bool load(const Resource& resource, bool async, CancellationToken token) = 0;
     virtual void created(const Resource& resource) = 0;
     virtual void destroy(const Resource& resource) noexcept = 0;
+    // resources referenced by a created resource, kept acquired by the manager until it is unloaded
+    virtual void dependencies(const Resource& resource,
+        std::vector<MetaID>& metaIDs, std::vector<ResourceType>& tags) const;
+    // bytes a load is expected to deliver, charged against StreamingBudget::mLoadBytes
+    // when the resource has not been loaded before
+    virtual uint64_t estimateSize(const Resource& resource) const;
 };
 
 }
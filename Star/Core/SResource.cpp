@@ -34,17 +34,39 @@ void ControlBlock::queued_unloaded(const EventUnload& e) noexcept {
 
 void ControlBlock::loading_loaded(const EventCreated& e) {
     mPointer = e.mPointer;
+    mSize = e.mSize;
     Manager::instance().finishLoadingSucceeded(*static_cast<Resource*>(this));
 }
 
 void ControlBlock::cancelling_unloaded(const EventCreated& e) noexcept {
     mPointer = nullptr;
-    Manager::instance().finishLoadingFailed(*static_cast<Resource*>(this));
+    mCancelled.store(false, std::memory_order_relaxed);
+    Manager::instance().finishLoadingFailed(*static_cast<Resource*>(this), e.mStarted);
+}
+
+void ControlBlock::loading_unloaded(const EventCreated& e) noexcept {
+    mPointer = nullptr;
+    mFailed.store(true, std::memory_order_release);
+    Manager::instance().finishLoadingFailed(*static_cast<Resource*>(this), e.mStarted);
+}
+
+void ControlBlock::loading_cancelling(const EventUnload& e) noexcept {
+    mCancelled.store(true, std::memory_order_relaxed);
+}
+
+void ControlBlock::cancelling_loading(const EventLoad& e) noexcept {
+    // the producer might have seen the token already, then loading_queued restarts it
+    mCancelled.store(false, std::memory_order_relaxed);
+}
+
+void ControlBlock::loading_queued(const EventCreated& e) {
+    Manager::instance().restartLoading(*static_cast<Resource*>(this), e.mStarted);
 }
 
 void ControlBlock::loaded_unloaded(const EventUnload& e) noexcept {
     mPointer = nullptr;
     Manager::instance().destroy(*static_cast<Resource*>(this));
+    // mSize is kept as estimate for streaming budget of reload
 }
 
 void Resource::loadNow() noexcept {
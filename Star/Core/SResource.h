@@ -42,6 +42,10 @@ public:
     };
     struct EventCreated {
         void* mPointer = nullptr;
+        uint64_t mSize = 0;
+        bool mCancelled = false; // producer observed the cancellation token and gave up
+        bool mFailed = false; // producer could not load, stays unloaded until acquired again
+        bool mStarted = true; // false if cancelled before Producer::load ran
     };
 
     // config
@@ -57,11 +61,24 @@ public:
 
     // guard
     bool try_send(const EventTryStart& e) noexcept;
+    bool completed(const EventCreated& e) noexcept {
+        return !e.mCancelled && !e.mFailed;
+    }
+    bool cancelled(const EventCreated& e) noexcept {
+        return e.mCancelled;
+    }
+    bool failed(const EventCreated& e) noexcept {
+        return e.mFailed && !e.mCancelled;
+    }
 
     // actions
     void unloaded_queued(const EventLoad& e);   
     void loading_loaded(const EventCreated& e);
     void cancelling_unloaded(const EventCreated& e) noexcept;
+    void loading_unloaded(const EventCreated& e) noexcept;
+    void loading_cancelling(const EventUnload& e) noexcept;
+    void cancelling_loading(const EventLoad& e) noexcept;
+    void loading_queued(const EventCreated& e);
     void loaded_unloaded(const EventUnload& e) noexcept;
     void queued_unloaded(const EventUnload& e) noexcept;
 
@@ -73,11 +90,14 @@ public:
 
         g_row<  Queued      , EventTryStart , Loading                           , &t::try_send  >,
 
-         _row<  Loading     , EventUnload   , Cancelling                                        >,
-         _row<  Cancelling  , EventLoad     , Loading                                           >,
+        a_row<  Loading     , EventUnload   , Cancelling, &t::loading_cancelling                >,
+        a_row<  Cancelling  , EventLoad     , Loading   , &t::cancelling_loading                >,
 
         a_row<  Cancelling  , EventCreated  , Unloaded  , &t::cancelling_unloaded               >,
-        a_row<  Loading     , EventCreated  , Loaded    , &t::loading_loaded                    >,
+          row<  Loading     , EventCreated  , Loaded    , &t::loading_loaded    , &t::completed >,
+        // re-acquired after the producer gave up, load again
+          row<  Loading     , EventCreated  , Queued    , &t::loading_queued    , &t::cancelled >,
+          row<  Loading     , EventCreated  , Unloaded  , &t::loading_unloaded  , &t::failed    >,
         a_row<  Loaded      , EventUnload   , Unloaded  , &t::loaded_unloaded                   >>
     {};
 
@@ -93,6 +113,11 @@ public:
     mutable std::atomic_int32_t mRefCount = 0;
     mutable std::atomic<void*> mPointer = nullptr;
     const MetaID mMetaID;
+    uint64_t mSize = 0; // reported by producer, accounted against the type budget
+    mutable std::atomic_int32_t mPriority = 0; // higher is loaded first
+    std::atomic_bool mCancelled = false; // set while Cancelling, read by producers through CancellationToken
+    bool mLoaderJob = false; // load runs on the loader pool, owning thread only
+    mutable std::atomic_bool mFailed = false; // last load failed, cleared when acquired again
 };
 
 class Resource : public boost::msm::back::state_machine<ControlBlock> {
@@ -118,12 +143,19 @@ public:
         }
     }
 
-    inline void async_acquire() const noexcept {
+    inline void async_acquire(int32_t priority = 0) const noexcept {
         if (atomicAddRef(mRefCount)) {
+            mPriority.store(priority, std::memory_order_relaxed);
+            mFailed.store(false, std::memory_order_relaxed);
             this->startLoading();
         }
     }
 
+    // can be updated while queued, applied on next Workflow::loadResources
+    inline void setPriority(int32_t priority) const noexcept {
+        mPriority.store(priority, std::memory_order_relaxed);
+    }
+
     inline void release() const noexcept {
         if (atomicDecRef(mRefCount)) {
             atomicReleaseFence();
@@ -142,8 +174,8 @@ private:
     void start(bool async) {
         process_event(EventTryStart{ async });
     }
-    void created(void* pointer) {
-        process_event(EventCreated{ pointer });
+    void created(void* pointer, uint64_t size, bool cancelled, bool failed, bool started = true) {
+        process_event(EventCreated{ pointer, size, cancelled, failed, started });
     }
 private:
     void loadNow() noexcept;
@@ -151,7 +183,7 @@ private:
     void startUnloading() const noexcept;
 };
 
-CHECK_SIZE(ControlBlock, 32)
+CHECK_SIZE(ControlBlock, 48)
 //PRINT_SIZE(ControlBlock)
 
 }
@@ -0,0 +1,186 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SResource.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Star::Core {
+
+// MetaID -> Resource table shared by all threads.
+// Resources are never erased, so a published entry can be read without locking.
+// Inserts lock only the shard the MetaID hashes to.
+// Bucket arrays are sized once for the capacity and never rehashed, lock-free readers
+// would otherwise race the relinking. Capacity is a hint, past it the chains only grow longer.
+class ResourceTable {
+    static constexpr size_t sShardCount = 16;
+    static constexpr size_t sShardBits = 4;
+    static_assert((size_t(1) << sShardBits) == sShardCount);
+
+    struct Node {
+        Node(const MetaID& metaID, const ResourceType& tag, Node* next)
+            : mResource(metaID, tag)
+            , mNext(next)
+        {}
+        Resource mResource;
+        Node* const mNext;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mMutex;
+        std::unique_ptr<std::atomic<Node*>[]> mBuckets;
+        std::deque<Node> mNodes;
+    };
+public:
+    ResourceTable(size_t capacity)
+        : mShards(sShardCount)
+    {
+        size_t bucketCount = 16;
+        while (bucketCount * sShardCount < capacity) {
+            bucketCount *= 2;
+        }
+        mBucketMask = bucketCount - 1;
+
+        for (auto& shard : mShards) {
+            shard.mBuckets.reset(new std::atomic<Node*>[bucketCount]);
+            for (size_t i = 0; i != bucketCount; ++i) {
+                shard.mBuckets[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    ResourceTable(const ResourceTable&) = delete;
+    ResourceTable& operator=(const ResourceTable&) = delete;
+
+    // lock-free, returns nullptr if not found
+    Resource* find(const MetaID& metaID) const noexcept {
+        auto hash = boost::hash<MetaID>()(metaID);
+        const auto& shard = getShard(hash);
+        return findNode(shard.mBuckets[getBucketID(hash)], metaID);
+    }
+
+    // lock-free if found, otherwise locks the shard and inserts
+    Resource& try_emplace(const MetaID& metaID, const ResourceType& tag) {
+        auto hash = boost::hash<MetaID>()(metaID);
+        auto& shard = getShard(hash);
+        auto& bucket = shard.mBuckets[getBucketID(hash)];
+
+        auto ptr = findNode(bucket, metaID);
+        if (ptr) {
+            Expects(ptr->mTag == tag);
+            return *ptr;
+        }
+
+        const std::lock_guard<std::mutex> lock(shard.mMutex);
+        // another thread might have inserted the same metaID
+        auto head = bucket.load(std::memory_order_acquire);
+        ptr = findNode(head, metaID);
+        if (ptr) {
+            Expects(ptr->mTag == tag);
+            return *ptr;
+        }
+
+        auto& node = shard.mNodes.emplace_back(metaID, tag, head);
+        bucket.store(&node, std::memory_order_release);
+        mSize.fetch_add(1, std::memory_order_relaxed);
+        return node.mResource;
+    }
+
+    // batched try_emplace, misses are inserted shard by shard, locking each shard once
+    void try_emplace(gsl::span<const MetaID> metaIDs, gsl::span<const ResourceType> tags,
+        gsl::span<Resource*> resources)
+    {
+        Expects(metaIDs.size() == tags.size());
+        Expects(metaIDs.size() == resources.size());
+
+        // lock-free pass, misses are keyed by shard
+        std::vector<std::pair<size_t, size_t>> misses;
+        for (size_t i = 0; i != gsl::narrow_cast<size_t>(metaIDs.size()); ++i) {
+            auto hash = boost::hash<MetaID>()(metaIDs[i]);
+            auto ptr = findNode(getShard(hash).mBuckets[getBucketID(hash)], metaIDs[i]);
+            if (ptr) {
+                Expects(ptr->mTag == tags[i]);
+                resources[i] = ptr;
+            } else {
+                misses.emplace_back(hash, i);
+            }
+        }
+        if (misses.empty())
+            return;
+
+        std::sort(misses.begin(), misses.end(), [](const auto& lhs, const auto& rhs) noexcept {
+            return (lhs.first & (sShardCount - 1)) < (rhs.first & (sShardCount - 1));
+        });
+
+        auto iter = misses.begin();
+        while (iter != misses.end()) {
+            auto& shard = getShard(iter->first);
+            const std::lock_guard<std::mutex> lock(shard.mMutex);
+            for (; iter != misses.end() && &getShard(iter->first) == &shard; ++iter) {
+                const auto& metaID = metaIDs[iter->second];
+                const auto& tag = tags[iter->second];
+                auto& bucket = shard.mBuckets[getBucketID(iter->first)];
+                // inserted by another thread, or earlier in this batch
+                auto head = bucket.load(std::memory_order_acquire);
+                auto ptr = findNode(head, metaID);
+                if (!ptr) {
+                    auto& node = shard.mNodes.emplace_back(metaID, tag, head);
+                    bucket.store(&node, std::memory_order_release);
+                    mSize.fetch_add(1, std::memory_order_relaxed);
+                    ptr = &node.mResource;
+                }
+                Expects(ptr->mTag == tag);
+                resources[iter->second] = ptr;
+            }
+        }
+    }
+
+    size_t size() const noexcept {
+        return mSize.load(std::memory_order_relaxed);
+    }
+private:
+    size_t getBucketID(size_t hash) const noexcept {
+        return (hash >> sShardBits) & mBucketMask;
+    }
+
+    Shard& getShard(size_t hash) const noexcept {
+        return const_cast<Shard&>(mShards[hash & (sShardCount - 1)]);
+    }
+
+    static Resource* findNode(const std::atomic<Node*>& bucket, const MetaID& metaID) noexcept {
+        return findNode(bucket.load(std::memory_order_acquire), metaID);
+    }
+
+    static Resource* findNode(Node* node, const MetaID& metaID) noexcept {
+        for (; node; node = node->mNext) {
+            if (node->mResource.metaID() == metaID) {
+                return &node->mResource;
+            }
+        }
+        return nullptr;
+    }
+
+    std::vector<Shard> mShards;
+    size_t mBucketMask = 0;
+    std::atomic<size_t> mSize = 0;
+};
+
+}
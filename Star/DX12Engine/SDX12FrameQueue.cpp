@@ -20,6 +20,7 @@
 #include <Star/DX12Engine/SDX12Types.h>
 #include <Star/Graphics/SCamera.h>
 #include <Star/Graphics/SContentUtils.h>
+#include <Star/Graphics/SVisibility.h>
 #include "SDX12Material.h"
 
 namespace Star::Graphics::Render {
@@ -38,12 +39,15 @@ DX12FrameQueue::DX12FrameQueue(ID3D12Device* pDevice,
             configs.mShaderDescriptorCircularReserve,
             configs.mFrameQueueSize
         }, alloc)
-    , mUploadBuffer(pool, configs.mFrameQueueSize)
+    , mMaxRecordingJobs(std::max(configs.mMaxRecordingJobs, 1u))
 {
     mDirectQueue->GetTimestampFrequency(&mCommandQueuePerformanceFrequency);
     mFrames.reserve(configs.mFrameQueueSize);
     for (int i = 0; i != configs.mFrameQueueSize; ++i) {
-        mFrames.emplace_back(pDevice, "FrameContext: ", i);
+        mFrames.emplace_back(pDevice, "FrameContext: ", i, mMaxRecordingJobs);
+    }
+    for (uint32_t i = 0; i != mMaxRecordingJobs; ++i) {
+        mRecordingSlots.emplace_back(pool, configs.mFrameQueueSize);
     }
 }
 
@@ -107,7 +111,10 @@ const DX12FrameContext* DX12FrameQueue::beginFrame(const DX12SwapChain& sc) {
 
     // advance frame
     mDescriptors.advanceFrame();
-    mUploadBuffer.advanceFrame();
+    for (auto& slot : mRecordingSlots) {
+        slot.mUploadBuffer.advanceFrame();
+        slot.mConstantRing.advanceFrame();
+    }
 
     // resources
     pFrame->mRenderSolution = &sc.currentSolution();
@@ -121,17 +128,26 @@ const DX12FrameContext* DX12FrameQueue::beginFrame(const DX12SwapChain& sc) {
 
 namespace {
 
+// constant buffer view of an instance group in the object constant block of its batch
+struct ObjectConstantView {
+    const DX12BufferData* mBlock = nullptr;
+    uint32_t mOffset = 0;
+    uint32_t mSize = 0;
+};
+
 void buildDynamicDescriptors(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList,
-    DX12ShaderDescriptorHeap& shaderHeap, DX12UploadBuffer& uploadBuffer,
+    DX12ShaderDescriptorHeap& shaderHeap,
     const DX12ShaderSubpassData& shaderSubpass, const DX12MaterialSubpassData& subpassData,
-    const CameraData& cam, const DX12FlattenedObjects* pBatch, uint32_t objectID,
-    std::pmr::vector<std::byte>& perInstanceCB
+    const ObjectConstantView& objects, bool bindPersistent
 ) {
     // upload descriptors
     for (const auto& collection : subpassData.mCollections) {
         Expects(std::holds_alternative<Table_>(collection.mIndex.mType));
         visit(overload(
             [&](Persistent_) {
+                if (!bindPersistent) {
+                    return;
+                }
                 for (const auto& list : collection.mResourceViewLists) {
                     pCommandList->SetGraphicsRootDescriptorTable(list.mSlot, list.mGpuOffset);
                 }
@@ -159,10 +175,9 @@ void buildDynamicDescriptors(ID3D12Device* pDevice, ID3D12GraphicsCommandList* p
                                                         continue;
 
                                                     Expects(cb.mSize);
-                                                    auto sizeCB = boost::alignment::align_up(cb.mSize, 256);
-                                                    perInstanceCB.clear();
-                                                    perInstanceCB.resize(sizeCB);
-                                                    auto* pData = perInstanceCB.data();
+                                                    if (cb.mIndex.mUpdate != UpdateEnum::PerInstance) {
+                                                        throw std::runtime_error("dynamic constant buffer must be per instance");
+                                                    }
                                                     for (const auto& constant : cb.mConstants) {
                                                         visit(overload(
                                                             [&](EngineSource_) {
@@ -174,24 +189,8 @@ void buildDynamicDescriptors(ID3D12Device* pDevice, ID3D12GraphicsCommandList* p
                                                                         throw std::runtime_error("View cannot be per instance");
                                                                     },
                                                                     [&](Data::WorldView_) {
-                                                                        if (!pBatch) {
-                                                                            throw std::runtime_error("batch is nullptr");
-                                                                        }
-                                                                        const auto& batch = *pBatch;
-                                                                        Matrix4f worldView = cam.mView * batch.mWorldTransforms[objectID].mTransform.matrix();
-                                                                        Expects(pData + sizeof(worldView) <= perInstanceCB.data() + perInstanceCB.size());
-                                                                        memcpy(pData, worldView.data(), sizeof(worldView));
-                                                                        pData += sizeof(worldView);
                                                                     },
                                                                     [&](Data::WorldInvT_) {
-                                                                        if (!pBatch) {
-                                                                            throw std::runtime_error("batch is nullptr");
-                                                                        }
-                                                                        const auto& batch = *pBatch;
-                                                                        const Matrix4f& worldInvT = batch.mWorldTransformInvs[objectID].mTransform.matrix();
-                                                                        Expects(pData + sizeof(worldInvT) <= perInstanceCB.data() + perInstanceCB.size());
-                                                                        memcpy(pData, worldInvT.data(), sizeof(worldInvT));
-                                                                        pData += sizeof(worldInvT);
                                                                     },
                                                                     [](std::monostate) {
                                                                         throw std::runtime_error("engine source constant cannot be monostate");
@@ -206,9 +205,14 @@ void buildDynamicDescriptors(ID3D12Device* pDevice, ID3D12GraphicsCommandList* p
                                                             }
                                                         ), constant.mSource);
                                                     }
-                                                    auto pos2 = uploadBuffer.upload(perInstanceCB.data(), gsl::narrow_cast<uint32_t>(perInstanceCB.size()), 1, 256);
+                                                    // packed once per batch, the view covers the arrays of the group
+                                                    if (!objects.mBlock) {
+                                                        throw std::runtime_error("object constants not packed");
+                                                    }
                                                     D3D12_CONSTANT_BUFFER_VIEW_DESC desc{
-                                                        pos2.mResource->GetGPUVirtualAddress() + pos2.mBufferOffset, (uint32_t)perInstanceCB.size()
+                                                        objects.mBlock->mResource->GetGPUVirtualAddress() +
+                                                            objects.mBlock->mBufferOffset + objects.mOffset,
+                                                        objects.mSize
                                                     };
 
                                                     auto d = shaderHeap.advance(descs.first, descID);
@@ -263,33 +267,116 @@ void buildDynamicDescriptors(ID3D12Device* pDevice, ID3D12GraphicsCommandList* p
 
 }
 
+namespace {
+
+// draws a subpass is expected to record, batches count each mesh renderer
+uint64_t estimateRecordingCost(const DX12GraphicsSubpass& subpass) noexcept {
+    uint64_t cost = 0;
+    for (const auto& queue : subpass.mOrderedRenderQueue) {
+        for (const auto& pContent : queue.mContents) {
+            const auto& content = *pContent;
+            for (const auto& object : content.mIDs) {
+                visit(overload(
+                    [&](const DrawCall_&) {
+                        ++cost;
+                    },
+                    [&](const ObjectBatch_&) {
+                        cost += content.mFlattenedObjects.at(object.mIndex).mMeshRenderers.size();
+                    }
+                ), object.mType);
+            }
+        }
+    }
+    return std::max(cost, uint64_t(1));
+}
+
+// jobs below this draw count are not worth a command list of their own
+constexpr uint64_t sMinRecordingJobCost = 256;
+
+}
+
 void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::memory_resource* mr) {
-    // met BackBuffer's pre-condition
-    auto pCommandList = pContext->mCommandList.get();
-    {
-        D3D12_RESOURCE_BARRIER barriers[] = {
-            CD3DX12_RESOURCE_BARRIER::Transition(
-                pContext->mRenderWorks->mFramebuffers[pContext->mBackBufferIndex].get(),
-                D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET),
-        };
-        pCommandList->ResourceBarrier(_countof(barriers), barriers);
+    const auto& pipeline = pContext->currentPipeline();
+
+    // flatten subpasses in submission order, passes without subpasses still
+    // take a slot for their viewport and aliasing barriers
+    std::pmr::vector<DX12SubpassIndex> subpasses(mr);
+    std::pmr::vector<uint64_t> costs(mr);
+    for (uint32_t passID = 0; passID != pipeline.mPasses.size(); ++passID) {
+        const auto& pass = pipeline.mPasses[passID];
+        if (pass.mGraphicsSubpasses.empty()) {
+            subpasses.emplace_back(DX12SubpassIndex{ passID, 0 });
+            costs.emplace_back(1);
+            continue;
+        }
+        for (uint32_t subpassID = 0; subpassID != pass.mGraphicsSubpasses.size(); ++subpassID) {
+            subpasses.emplace_back(DX12SubpassIndex{ passID, subpassID });
+            costs.emplace_back(estimateRecordingCost(pass.mGraphicsSubpasses[subpassID]));
+        }
     }
 
+    std::pmr::vector<RecordingJob> jobs(mr);
+    partitionRecordingJobs(costs, mMaxRecordingJobs, sMinRecordingJobCost, jobs);
+    Expects(jobs.size() <= mRecordingSlots.size());
+
+    struct Backend {
+        void record(uint32_t listID, const RecordingJob& job) {
+            auto pCommandList = listID ?
+                mContext->mJobCommandLists[listID - 1].get() : mContext->mCommandList.get();
+            if (listID) {
+                auto pAllocator = mContext->mJobCommandAllocators[listID - 1].get();
+                V(pAllocator->Reset());
+                V(pCommandList->Reset(pAllocator, nullptr));
+            } else {
+                // met BackBuffer's pre-condition
+                D3D12_RESOURCE_BARRIER barriers[] = {
+                    CD3DX12_RESOURCE_BARRIER::Transition(
+                        mContext->mRenderWorks->mFramebuffers[mContext->mBackBufferIndex].get(),
+                        D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET),
+                };
+                pCommandList->ResourceBarrier(_countof(barriers), barriers);
+            }
+            mQueue->recordJob(mContext, mSubpasses, job, pCommandList, mQueue->mRecordingSlots[listID]);
+            pCommandList->Close();
+            mLists[listID] = pCommandList;
+        }
+        void submit(uint32_t listCount) {
+            mQueue->mDirectQueue->ExecuteCommandLists(listCount, mLists.data());
+        }
+
+        DX12FrameQueue* mQueue = nullptr;
+        const DX12FrameContext* mContext = nullptr;
+        gsl::span<const DX12SubpassIndex> mSubpasses;
+        std::pmr::vector<ID3D12CommandList*> mLists;
+    } backend{ this, pContext, subpasses, std::pmr::vector<ID3D12CommandList*>(jobs.size(), mr) };
+
+    recordJobs(backend, jobs);
+}
+
+void DX12FrameQueue::recordJob(const DX12FrameContext* pContext,
+    gsl::span<const DX12SubpassIndex> subpasses, const RecordingJob& job,
+    ID3D12GraphicsCommandList* pCommandList, DX12RecordingSlot& slot
+) {
+    Expects(job.mBegin < job.mEnd);
+    Expects(job.mEnd <= subpasses.size());
+
     // Render Passes
     const auto& rsl = *pContext->mRenderSolution;
     const auto& resource = *pContext->mRenderWorks;
 
     const auto& pipeline = rsl.mPipelines[pContext->mPipelineID];
 
-    std::pmr::vector<D3D12_CPU_DESCRIPTOR_HANDLE> rtvs(mr);
-    rtvs.reserve(16);
-    std::pmr::vector<D3D12_RESOURCE_BARRIER> barriers(mr);
-    barriers.reserve(32);
-
-    std::pmr::vector<std::byte> perPassCB(mr);
-    std::pmr::vector<std::byte> perInstanceCB(mr);
-    perPassCB.reserve(256);
-    perInstanceCB.reserve(256);
+    auto& rtvs = slot.mRTVs;
+    auto& barriers = slot.mBarriers;
+    auto& perPassCB = slot.mPerPassCB;
+    auto& constantRing = slot.mConstantRing;
+    auto& visibleObjects = slot.mVisibleObjects;
+    auto& instanceGroups = slot.mInstanceGroups;
+    auto& objectSlots = slot.mObjectSlots;
+    auto& drawItems = slot.mDrawItems;
+    auto& drawPackets = slot.mDrawPackets;
+    auto& drawPacketScratch = slot.mDrawPacketScratch;
+    auto& uploadBuffer = slot.mUploadBuffer;
 
     uint32_t solutionID = pContext->mSolutionID;
     uint32_t pipelineID = pContext->mPipelineID;
@@ -299,8 +386,14 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
     };
     pCommandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
-    for (uint32_t passID = 0; passID != pipeline.mPasses.size(); ++passID) {
+    const auto& first = subpasses[job.mBegin];
+    const auto& last = subpasses[job.mEnd - 1];
+    for (uint32_t passID = first.mPassID; passID <= last.mPassID; ++passID) {
         const auto& pass = pipeline.mPasses[passID];
+        const auto passSubpassCount = gsl::narrow_cast<uint32_t>(pass.mGraphicsSubpasses.size());
+        const uint32_t subpassBegin = passID == first.mPassID ? first.mSubpassID : 0;
+        const uint32_t subpassEnd = passID == last.mPassID ?
+            std::min(last.mSubpassID + 1, passSubpassCount) : passSubpassCount;
         if (!pass.mViewports.empty()) {
             Expects(pass.mViewports.size() == 1);
             static_assert(sizeof(D3D12_VIEWPORT) == sizeof(VIEWPORT));
@@ -313,8 +406,21 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
             pCommandList->RSSetScissorRects(gsl::narrow_cast<uint32_t>(pass.mScissorRects.size()),
                 alias_cast<const D3D12_RECT*>(&pass.mScissorRects[0]));
         }
+
+        // transient framebuffers take over their heap memory here, content is undefined until written
+        if (subpassBegin == 0 && !pass.mAliasingBarriers.empty()) {
+            barriers.clear();
+            for (const auto& fb : pass.mAliasingBarriers) {
+                barriers.emplace_back(CD3DX12_RESOURCE_BARRIER::Aliasing(
+                    nullptr, resource.mFramebuffers[fb.mHandle].get()));
+            }
+            pCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());
+            for (const auto& fb : pass.mAliasingBarriers) {
+                pCommandList->DiscardResource(resource.mFramebuffers[fb.mHandle].get(), nullptr);
+            }
+        }
         
-        for (uint32_t subpassID = 0; subpassID != pass.mGraphicsSubpasses.size(); ++subpassID) {
+        for (uint32_t subpassID = subpassBegin; subpassID < subpassEnd; ++subpassID) {
             const auto& subpass = pass.mGraphicsSubpasses[subpassID];
             //---------------------------------------------------
             // Pre-Subpass
@@ -376,12 +482,18 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
                 cam.mNDC = Direct3D;
                 //cam.lookAt(Vector3f(0, 2.0f, 0), Vector3f(0, 1, 0), Vector3f(0, 0, 1));
                 cam.lookTo(Vector3f(0, 0, 1.7f), Vector3f(-1.f, 0, 0.0f), Vector3f(0, 0.0f, 1.0f));
-                cam.perspective(0.25f * S_PI, 16.0f / 9.0f, 0.25f, 512.0f);
+                constexpr float farPlane = 512.0f;
+                cam.perspective(0.25f * S_PI, 16.0f / 9.0f, 0.25f, farPlane);
+                const auto frustum = makeFrustum(cam);
 
                 D3D12_PRIMITIVE_TOPOLOGY prevTopology = {};
                 ID3D12PipelineState* pPrevPSO = nullptr;
+                const DX12MeshData* pPrevMesh = nullptr;
+                const DX12MaterialSubpassData* pPrevSubpassData = nullptr;
                 for (const auto& queue : subpass.mOrderedRenderQueue) {
                     pCommandList->SetGraphicsRootSignature(subpass.mRootSignature.get());
+                    // root arguments do not survive a root signature change
+                    pPrevSubpassData = nullptr;
 
                     // PerPass Descriptors
                     for (const auto& collection : subpass.mDescriptors) {
@@ -455,7 +567,7 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
                                                                             }
                                                                         ), constant.mSource);
                                                                     }
-                                                                    auto pos = mUploadBuffer.upload(perPassCB.data(), gsl::narrow_cast<uint32_t>(perPassCB.size()), 1, 256);
+                                                                    auto pos = uploadBuffer.upload(perPassCB.data(), gsl::narrow_cast<uint32_t>(perPassCB.size()), 1, 256);
                                                                     D3D12_CONSTANT_BUFFER_VIEW_DESC desc{
                                                                         pos.mResource->GetGPUVirtualAddress() + pos.mBufferOffset, (uint32_t)perPassCB.size()
                                                                     };
@@ -518,6 +630,7 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
 
                                             pCommandList->IASetVertexBuffers(0, 0, nullptr);
                                             pCommandList->IASetIndexBuffer(nullptr);
+                                            pPrevMesh = nullptr;
 
                                             auto material = dc.mMaterial.get();
 
@@ -545,10 +658,10 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
                                                     mLevels.at(levelID).mPasses.at(variantID).mSubpasses.at(subpassID);
 
                                                 buildDynamicDescriptors(mDevice, pCommandList,
-                                                    mDescriptors, mUploadBuffer,
+                                                    mDescriptors,
                                                     shaderSubpass, subpassData,
-                                                    cam, nullptr, 0,
-                                                    perInstanceCB);
+                                                    {}, &subpassData != pPrevSubpassData);
+                                                pPrevSubpassData = &subpassData;
 
                                                 pCommandList->DrawInstanced(3, 1, 0, 0);
                                                 ++subpassID;
@@ -564,32 +677,79 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
                                     const auto& batch = content.mFlattenedObjects.at(id);
                                     Expects(batch.mWorldTransforms.size() == batch.mMeshRenderers.size());
                                     Expects(batch.mWorldTransformInvs.size() == batch.mMeshRenderers.size());
-                                    for (uint32_t objectID = 0; objectID != batch.mMeshRenderers.size(); ++objectID) {
+                                    Expects(batch.mBoundingBoxes.size() == batch.mMeshRenderers.size());
+                                    Expects(batch.mInstanceClasses.size() == batch.mMeshRenderers.size());
+                                    cullBoundingBoxes(frustum, batch.mBoundingBoxes, visibleObjects);
+                                    if (visibleObjects.empty()) {
+                                        return;
+                                    }
+                                    buildInstanceGroups(batch.mInstanceClasses, sMaxInstanceCount, visibleObjects, instanceGroups);
+
+                                    // per-instance constants of the batch in one pass, draws bind the view of their group
+                                    const auto objectLayout = placeObjectConstants(instanceGroups, objectSlots);
+                                    const auto objectBlock = constantRing.allocate(objectLayout.mSize);
+                                    packObjectConstants(cam.mView, batch.mWorldTransforms, batch.mWorldTransformInvs,
+                                        visibleObjects, instanceGroups, objectSlots,
+                                        gsl::span<std::byte>(objectBlock.second, objectLayout.mSize));
+
+                                    // one packet per group and submesh, sorted by state then front to back
+                                    drawItems.clear();
+                                    drawPackets.clear();
+                                    for (uint32_t groupID = 0; groupID != instanceGroups.size(); ++groupID) {
+                                        const auto objectID = visibleObjects[instanceGroups[groupID].mFirst];
                                         const auto& renderer = batch.mMeshRenderers[objectID];
+                                        const auto& mesh = *renderer.mMesh;
+                                        const Vector4f center = cam.mView * batch.mWorldTransforms[objectID].mTransform.translation().homogeneous();
+                                        const auto depthBucket = getDrawDepthBucket(-center.z(), farPlane);
 
-                                        size_t materialID = 0;
-                                        for (const auto& material : renderer.mMaterials) {
-                                            const auto& mesh = *renderer.mMesh;
+                                        for (uint32_t materialID = 0; materialID != renderer.mMaterials.size(); ++materialID) {
                                             if (materialID >= mesh.mSubMeshes.size()) {
                                                 break;
                                             }
-                                            const auto& submesh = mesh.mSubMeshes.at(materialID);
-
-                                            uint32_t shaderSolutionID{};
-                                            uint32_t shaderPipelineID{};
-                                            uint32_t shaderQueueID{};
-
-                                            const auto& queue = getSubpassData(*material,
+                                            const auto& material = renderer.mMaterials[materialID];
+                                            auto& item = drawItems.emplace_back();
+                                            item.mGroupID = groupID;
+                                            item.mMaterialID = materialID;
+                                            item.mQueue = &getSubpassData(*material,
                                                 solutionID, pipelineID, passID, subpassID,
-                                                shaderSolutionID, shaderPipelineID, shaderQueueID);
-
-                                            // mesh
-                                            auto primTopology = static_cast<D3D12_PRIMITIVE_TOPOLOGY>(mesh.mIndexBuffer.mPrimitiveTopology);
-                                            if (primTopology != prevTopology) {
-                                                pCommandList->IASetPrimitiveTopology(primTopology);
-                                                prevTopology = primTopology;
-                                            }
+                                                item.mShaderSolutionID, item.mShaderPipelineID, item.mShaderQueueID);
+
+                                            const auto& shaderSubpasses = item.mQueue->mLevels.at(0).mPasses.at(0).mSubpasses;
+                                            const ID3D12PipelineState* pPSO = shaderSubpasses.empty() ? nullptr :
+                                                shaderSubpasses[0].mStates.at(shaderSubpasses[0].mVertexLayoutIndex.at(mesh.mLayoutID)).mObject.get();
+
+                                            drawPackets.emplace_back(DrawPacket{
+                                                makeDrawSortKey(passID,
+                                                    reinterpret_cast<uintptr_t>(pPSO),
+                                                    reinterpret_cast<uintptr_t>(material.get()),
+                                                    reinterpret_cast<uintptr_t>(&mesh),
+                                                    depthBucket),
+                                                gsl::narrow_cast<uint32_t>(drawItems.size() - 1)
+                                            });
+                                        }
+                                    }
+                                    radixSortDrawPackets(drawPackets, drawPacketScratch);
+
+                                    for (const auto& packet : drawPackets) {
+                                        const auto& item = drawItems[packet.mIndex];
+                                        const auto& group = instanceGroups[item.mGroupID];
+                                        const auto& renderer = batch.mMeshRenderers[visibleObjects[group.mFirst]];
+                                        const ObjectConstantView objects{ &objectBlock.first,
+                                            getObjectConstantOffset(objectSlots[item.mGroupID]),
+                                            getObjectConstantViewSize(group.mCount) };
+                                        const auto& material = renderer.mMaterials[item.mMaterialID];
+                                        const auto& mesh = *renderer.mMesh;
+                                        const auto& submesh = mesh.mSubMeshes.at(item.mMaterialID);
+                                        const auto& queue = *item.mQueue;
+
+                                        // mesh
+                                        auto primTopology = static_cast<D3D12_PRIMITIVE_TOPOLOGY>(mesh.mIndexBuffer.mPrimitiveTopology);
+                                        if (primTopology != prevTopology) {
+                                            pCommandList->IASetPrimitiveTopology(primTopology);
+                                            prevTopology = primTopology;
+                                        }
 
+                                        if (pPrevMesh != &mesh) {
                                             pCommandList->IASetVertexBuffers(0,
                                                 gsl::narrow_cast<uint32_t>(mesh.mVertexBufferViews.size()),
                                                 mesh.mVertexBufferViews.data());
@@ -599,34 +759,34 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
                                             } else {
                                                 pCommandList->IASetIndexBuffer(nullptr);
                                             }
+                                            pPrevMesh = &mesh;
+                                        }
 
-                                            // materials
-                                            auto levelID = 0;
-                                            auto variantID = 0;
-                                            auto subpassID = 0;
-                                            for (const auto& shaderSubpass : queue.mLevels.at(levelID).mPasses.at(variantID).mSubpasses) {
-                                                // draw call
-                                                const auto& layoutID = shaderSubpass.mVertexLayoutIndex.at(mesh.mLayoutID);
-                                                if (pPrevPSO != shaderSubpass.mStates.at(layoutID).mObject.get()) {
-                                                    pCommandList->SetPipelineState(shaderSubpass.mStates.at(layoutID).mObject.get());
-                                                    pPrevPSO = shaderSubpass.mStates.at(layoutID).mObject.get();
-                                                }
+                                        // materials
+                                        auto levelID = 0;
+                                        auto variantID = 0;
+                                        auto subpassID = 0;
+                                        for (const auto& shaderSubpass : queue.mLevels.at(levelID).mPasses.at(variantID).mSubpasses) {
+                                            // draw call
+                                            const auto& layoutID = shaderSubpass.mVertexLayoutIndex.at(mesh.mLayoutID);
+                                            if (pPrevPSO != shaderSubpass.mStates.at(layoutID).mObject.get()) {
+                                                pCommandList->SetPipelineState(shaderSubpass.mStates.at(layoutID).mObject.get());
+                                                pPrevPSO = shaderSubpass.mStates.at(layoutID).mObject.get();
+                                            }
 
-                                                const auto& subpassData = material->mShaderData.at(shaderSolutionID).mPipelines.at(shaderPipelineID).mQueues.at(shaderQueueID).
-                                                    mLevels.at(levelID).mPasses.at(variantID).mSubpasses.at(subpassID);
+                                            const auto& subpassData = material->mShaderData.at(item.mShaderSolutionID).mPipelines.at(item.mShaderPipelineID).mQueues.at(item.mShaderQueueID).
+                                                mLevels.at(levelID).mPasses.at(variantID).mSubpasses.at(subpassID);
 
-                                                buildDynamicDescriptors(mDevice, pCommandList,
-                                                    mDescriptors, mUploadBuffer,
-                                                    shaderSubpass, subpassData,
-                                                    cam, &batch, objectID,
-                                                    perInstanceCB);
+                                            buildDynamicDescriptors(mDevice, pCommandList,
+                                                mDescriptors,
+                                                shaderSubpass, subpassData,
+                                                objects, &subpassData != pPrevSubpassData);
+                                            pPrevSubpassData = &subpassData;
 
-                                                pCommandList->DrawIndexedInstanced(submesh.mIndexCount, 1, submesh.mIndexOffset, 0, 0);
-                                                ++subpassID;
-                                            } // shader subpass
-                                            ++materialID;
-                                        } // material
-                                    } // mesh renderer
+                                            pCommandList->DrawIndexedInstanced(submesh.mIndexCount, group.mCount, submesh.mIndexOffset, 0, 0);
+                                            ++subpassID;
+                                        } // shader subpass
+                                    } // draw packet
                                 } // object batch
                             ), object.mType); // objects
                         } // content
@@ -655,10 +815,6 @@ void DX12FrameQueue::renderFrame(const DX12FrameContext* pContext, std::pmr::mem
             pCommandList->ResourceBarrier(gsl::narrow_cast<uint32_t>(barriers.size()), barriers.data());                            
         }
     }
-
-    pCommandList->Close();
-    ID3D12CommandList* lists[] = { pCommandList };
-    mDirectQueue->ExecuteCommandLists(_countof(lists), lists);
 }
 
 void DX12FrameQueue::endFrame(const DX12FrameContext* pFrame) {
@@ -667,7 +823,7 @@ void DX12FrameQueue::endFrame(const DX12FrameContext* pFrame) {
     check_hresult(mDirectQueue->Signal(mFence.get(), pFrame->mFrameFenceId));
 }
 
-DX12FrameContext::DX12FrameContext(ID3D12Device* pDevice, std::string_view name, uint32_t id) {
+DX12FrameContext::DX12FrameContext(ID3D12Device* pDevice, std::string_view name, uint32_t id, uint32_t jobCount) {
     V(pDevice->CreateCommandAllocator(
         D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(mCommandAllocator.put())));
     STAR_SET_DEBUG_NAME(mCommandAllocator, std::string(name) + std::to_string(id));
@@ -677,6 +833,21 @@ DX12FrameContext::DX12FrameContext(ID3D12Device* pDevice, std::string_view name,
     STAR_SET_DEBUG_NAME(mCommandList, std::string(name) + std::to_string(id));
 
     mCommandList->Close();
+
+    for (uint32_t jobID = 1; jobID < jobCount; ++jobID) {
+        auto jobName = std::string(name) + std::to_string(id) + " Job: " + std::to_string(jobID);
+        auto& allocator = mJobCommandAllocators.emplace_back();
+        V(pDevice->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(allocator.put())));
+        STAR_SET_DEBUG_NAME(allocator, jobName);
+
+        auto& commandList = mJobCommandLists.emplace_back();
+        V(pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+            allocator.get(), nullptr, IID_PPV_ARGS(commandList.put())));
+        STAR_SET_DEBUG_NAME(commandList, jobName);
+
+        commandList->Close();
+    }
 }
 
 const DX12RenderPipeline& DX12FrameContext::currentPipeline() const noexcept {
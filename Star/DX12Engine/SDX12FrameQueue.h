@@ -23,6 +23,10 @@
 #include <Star/DX12Engine/SDX12ShaderDescriptorHeap.h>
 #include <Star/DX12Engine/SDX12SamplerDescriptorHeap.h>
 #include <Star/DX12Engine/SDX12UploadBuffer.h>
+#include <Star/Graphics/SCommandRecording.h>
+#include <Star/Graphics/SInstanceBatching.h>
+#include <Star/Graphics/SDrawPacket.h>
+#include <Star/Graphics/SObjectConstants.h>
 
 namespace Star::Graphics::Render {
 
@@ -30,7 +34,7 @@ class DX12SwapChain;
 class DX12RenderResources;
 
 struct DX12FrameContext {
-    DX12FrameContext(ID3D12Device* pDevice, std::string_view name, uint32_t id);
+    DX12FrameContext(ID3D12Device* pDevice, std::string_view name, uint32_t id, uint32_t jobCount);
 
     DX12RenderPipeline const& currentPipeline() const noexcept;
     DX12RenderPipeline& currentPipeline() noexcept;
@@ -44,6 +48,9 @@ struct DX12FrameContext {
     D3D12_CPU_DESCRIPTOR_HANDLE mBackBufferRTVsRGB = {};
     com_ptr<ID3D12CommandAllocator> mCommandAllocator;
     com_ptr<ID3D12GraphicsCommandList> mCommandList;
+    // recording jobs after the first, which records into mCommandList
+    std::vector<com_ptr<ID3D12CommandAllocator>> mJobCommandAllocators;
+    std::vector<com_ptr<ID3D12GraphicsCommandList>> mJobCommandLists;
 
     const DX12RenderSolution* mRenderSolution = nullptr;
     const DX12RenderWorks* mRenderWorks = nullptr;
@@ -51,6 +58,42 @@ struct DX12FrameContext {
     uint32_t mPipelineID = 0;
 };
 
+// frame subpass in submission order, see RecordingJob
+struct DX12SubpassIndex {
+    uint32_t mPassID = 0;
+    uint32_t mSubpassID = 0;
+};
+
+// draw of one instance group and submesh, referenced by DrawPacket::mIndex
+struct DX12DrawItem {
+    uint32_t mGroupID = 0;
+    uint32_t mMaterialID = 0;
+    const DX12ShaderQueueData* mQueue = nullptr;
+    uint32_t mShaderSolutionID = 0;
+    uint32_t mShaderPipelineID = 0;
+    uint32_t mShaderQueueID = 0;
+};
+
+// scratch state owned by one recording job, never shared between threads
+struct DX12RecordingSlot {
+    DX12RecordingSlot(const DX12UploadBufferPool& pool, uint32_t frameQueueSize)
+        : mUploadBuffer(pool, frameQueueSize)
+        , mConstantRing(mUploadBuffer)
+    {}
+
+    DX12UploadBuffer mUploadBuffer;
+    DX12ConstantRing mConstantRing;
+    std::pmr::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mRTVs;
+    std::pmr::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+    std::pmr::vector<std::byte> mPerPassCB;
+    std::pmr::vector<uint32_t> mVisibleObjects;
+    std::pmr::vector<InstanceGroup> mInstanceGroups;
+    std::pmr::vector<uint32_t> mObjectSlots;
+    std::pmr::vector<DX12DrawItem> mDrawItems;
+    std::pmr::vector<DrawPacket> mDrawPackets;
+    std::pmr::vector<DrawPacket> mDrawPacketScratch;
+};
+
 class DX12FrameQueue {
 public:
     typedef std::pmr::polymorphic_allocator<std::byte> allocator_type;
@@ -67,6 +110,9 @@ public:
 
     const DX12FrameContext* beginFrame(const DX12SwapChain& sc);
     void renderFrame(const DX12FrameContext* pContext, std::pmr::memory_resource* mr);
+    void recordJob(const DX12FrameContext* pContext,
+        gsl::span<const DX12SubpassIndex> subpasses, const RecordingJob& job,
+        ID3D12GraphicsCommandList* pCommandList, DX12RecordingSlot& slot);
     void endFrame(const DX12FrameContext* pFrame);
 
     // Fence
@@ -87,8 +133,9 @@ public:
     DX12ShaderDescriptorHeap mDescriptors;
     DX12SamplerDescriptorHeap mSamplerDH;
 
-    // Upload Buffer
-    DX12UploadBuffer mUploadBuffer;
+    // Recording, one slot per job
+    uint32_t mMaxRecordingJobs = 1;
+    std::deque<DX12RecordingSlot> mRecordingSlots;
 };
 
 }
@@ -149,6 +149,7 @@ void intrusive_ptr_release(DX12RenderGraphData* p) {
         
         p->mRenderGraph.mSolutions.clear();
         p->mRenderGraph.mFramebuffers.clear();
+        p->mRenderGraph.mFramebufferHeap = nullptr;
         p->mRenderGraph.mRTVs.clear();
         p->mRenderGraph.mDSVs.clear();
         p->mRenderGraph.mCBV_SRV_UAVs.clear();
@@ -19,6 +19,7 @@
 #include "SDX12Types.h"
 #include "SDX12ShaderDescriptorHeap.h"
 #include <Star/Graphics/SRenderUtils.h>
+#include <Star/Graphics/SRenderGraphAliasing.h>
 
 namespace Star::Graphics::Render {
 
@@ -34,6 +35,14 @@ void createRenderSolutionRenderTargets(ID3D12Device* pDevice, IDXGISwapChain3* p
     auto pipelineID = at(solution.mPipelineIndex, pipelineName);
     auto& pipeline = solution.mPipelines.at(pipelineID);
 
+    struct TransientFramebuffer {
+        uint32_t mHandle;
+        D3D12_RESOURCE_DESC mDesc;
+        D3D12_CLEAR_VALUE mClearValue;
+        D3D12_RESOURCE_STATES mState;
+    };
+    std::pmr::vector<TransientFramebuffer> transients(rw.get_allocator());
+
     for (uint32_t i = 0; i != solution.mFramebuffers.size(); ++i) {
         const auto& rt = solution.mFramebuffers[i];
 
@@ -67,26 +76,69 @@ void createRenderSolutionRenderTargets(ID3D12Device* pDevice, IDXGISwapChain3* p
                 throw std::runtime_error("empty render target");
             }
 
+            D3D12_CLEAR_VALUE clearValue = {};
+            D3D12_RESOURCE_STATES state = {};
             visit(overload(
                 [&](const ClearColor& cv) {
-                    D3D12_CLEAR_VALUE clearValue = {
+                    clearValue = D3D12_CLEAR_VALUE{
                         getDXGIFormat(cv.mClearFormat),
                         { cv.mClearColor.x(), cv.mClearColor.y(), cv.mClearColor.z(), cv.mClearColor.w() }
                     };
-                    V(pDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE,
-                        &desc, D3D12_RESOURCE_STATE_RENDER_TARGET, &clearValue,
-                        IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+                    state = D3D12_RESOURCE_STATE_RENDER_TARGET;
                 },
                 [&](const ClearDepthStencil& cv) {
-                    D3D12_CLEAR_VALUE clearValue = {
-                        getDXGIFormat(cv.mClearFormat),
-                    };
+                    clearValue.Format = getDXGIFormat(cv.mClearFormat);
                     clearValue.DepthStencil = { cv.mDepthClearValue, cv.mStencilClearValue };
-                    V(pDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE,
-                        &desc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &clearValue,
-                        IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+                    state = D3D12_RESOURCE_STATE_DEPTH_WRITE;
                 }
             ), rt.mClear);
+
+            if (rt.mTransient) {
+                transients.emplace_back(TransientFramebuffer{ i, desc, clearValue, state });
+                continue;
+            }
+
+            V(pDevice->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE,
+                &desc, state, &clearValue,
+                IID_PPV_ARGS(rw.mFramebuffers[i].put())));
+        }
+    }
+
+    // transient framebuffers with disjoint lifetimes share memory in a single heap
+    if (!transients.empty()) {
+        Expects(!rw.mFramebufferHeap);
+
+        std::pmr::vector<TransientResourceDesc> descs(transients.size(), rw.get_allocator());
+        std::pmr::vector<uint64_t> offsets(transients.size(), rw.get_allocator());
+        uint64_t alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        for (size_t k = 0; k != transients.size(); ++k) {
+            const auto& fb = solution.mFramebuffers[transients[k].mHandle];
+            auto info = pDevice->GetResourceAllocationInfo(0, 1, &transients[k].mDesc);
+            if (info.SizeInBytes == UINT64_MAX) {
+                throw std::runtime_error("transient render target not placeable");
+            }
+            descs[k] = TransientResourceDesc{
+                fb.mLifetimeBegin, fb.mLifetimeEnd, info.SizeInBytes, info.Alignment
+            };
+            alignment = std::max(alignment, info.Alignment);
+        }
+
+        D3D12_HEAP_DESC heapDesc{
+            placeTransientResources(descs, offsets),
+            D3D12_HEAP_PROPERTIES{
+                D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+                D3D12_MEMORY_POOL_UNKNOWN, 1u, 1u
+            },
+            alignment,
+            D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+        };
+        V(pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(rw.mFramebufferHeap.put())));
+
+        for (size_t k = 0; k != transients.size(); ++k) {
+            auto& t = transients[k];
+            V(pDevice->CreatePlacedResource(rw.mFramebufferHeap.get(), offsets[k],
+                &t.mDesc, t.mState, &t.mClearValue,
+                IID_PPV_ARGS(rw.mFramebuffers[t.mHandle].put())));
         }
     }
 
@@ -250,6 +302,7 @@ void clearRenderTargets(DX12RenderWorks& rw, DX12ShaderDescriptorHeap* pDescript
     }
 
     rw.mFramebuffers.clear();
+    rw.mFramebufferHeap = nullptr;
 }
 
 }
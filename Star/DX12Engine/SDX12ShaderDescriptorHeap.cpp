@@ -33,6 +33,7 @@ DX12ShaderDescriptorHeap::DX12ShaderDescriptorHeap(ID3D12Device* pDevice,
 {}
 
 DX12ShaderDescriptorRange DX12ShaderDescriptorHeap::allocateCircular(uint32_t count) {
+    std::lock_guard<std::mutex> guard(mCircularMutex);
     auto range = mCircular.allocate(count);
     Ensures(range.first != range.second);
 
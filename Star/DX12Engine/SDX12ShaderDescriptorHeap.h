@@ -76,6 +76,7 @@ private:
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV> mHeap;
     Graphics::DescriptorPool mPool;
     Graphics::CircularDescriptorPool mCircular;
+    std::mutex mCircularMutex; // frame recording jobs allocate concurrently
     Graphics::PersistentDescriptorPool mPersistent;
     Graphics::MonotonicDescriptorPool mMonotonic;
 };
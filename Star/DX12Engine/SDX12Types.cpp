@@ -489,6 +489,7 @@ DX12FlattenedObjects::DX12FlattenedObjects(const allocator_type& alloc)
     , mWorldTransformInvs(alloc)
     , mBoundingBoxes(alloc)
     , mMeshRenderers(alloc)
+    , mInstanceClasses(alloc)
 {}
 
 DX12FlattenedObjects::DX12FlattenedObjects(DX12FlattenedObjects const& rhs, const allocator_type& alloc)
@@ -496,6 +497,7 @@ DX12FlattenedObjects::DX12FlattenedObjects(DX12FlattenedObjects const& rhs, cons
     , mWorldTransformInvs(rhs.mWorldTransformInvs, alloc)
     , mBoundingBoxes(rhs.mBoundingBoxes, alloc)
     , mMeshRenderers(rhs.mMeshRenderers, alloc)
+    , mInstanceClasses(rhs.mInstanceClasses, alloc)
 {}
 
 DX12FlattenedObjects::DX12FlattenedObjects(DX12FlattenedObjects&& rhs, const allocator_type& alloc)
@@ -503,6 +505,7 @@ DX12FlattenedObjects::DX12FlattenedObjects(DX12FlattenedObjects&& rhs, const all
     , mWorldTransformInvs(std::move(rhs.mWorldTransformInvs), alloc)
     , mBoundingBoxes(std::move(rhs.mBoundingBoxes), alloc)
     , mMeshRenderers(std::move(rhs.mMeshRenderers), alloc)
+    , mInstanceClasses(std::move(rhs.mInstanceClasses), alloc)
 {}
 
 DX12FlattenedObjects::~DX12FlattenedObjects() = default;
@@ -617,6 +620,7 @@ DX12RenderPass::DX12RenderPass(const allocator_type& alloc)
     , mScissorRects(alloc)
     , mFramebuffers(alloc)
     , mDependencies(alloc)
+    , mAliasingBarriers(alloc)
 {}
 
 DX12RenderPass::DX12RenderPass(DX12RenderPass const& rhs, const allocator_type& alloc)
@@ -625,6 +629,7 @@ DX12RenderPass::DX12RenderPass(DX12RenderPass const& rhs, const allocator_type&
     , mScissorRects(rhs.mScissorRects, alloc)
     , mFramebuffers(rhs.mFramebuffers, alloc)
     , mDependencies(rhs.mDependencies, alloc)
+    , mAliasingBarriers(rhs.mAliasingBarriers, alloc)
 {}
 
 DX12RenderPass::DX12RenderPass(DX12RenderPass&& rhs, const allocator_type& alloc)
@@ -633,6 +638,7 @@ DX12RenderPass::DX12RenderPass(DX12RenderPass&& rhs, const allocator_type& alloc
     , mScissorRects(std::move(rhs.mScissorRects), alloc)
     , mFramebuffers(std::move(rhs.mFramebuffers), alloc)
     , mDependencies(std::move(rhs.mDependencies), alloc)
+    , mAliasingBarriers(std::move(rhs.mAliasingBarriers), alloc)
 {}
 
 DX12RenderPass::~DX12RenderPass() = default;
@@ -737,6 +743,7 @@ DX12RenderWorks::DX12RenderWorks(const allocator_type& alloc)
 DX12RenderWorks::DX12RenderWorks(DX12RenderWorks const& rhs, const allocator_type& alloc)
     : mSolutions(rhs.mSolutions, alloc)
     , mFramebuffers(rhs.mFramebuffers, alloc)
+    , mFramebufferHeap(rhs.mFramebufferHeap)
     , mRTVs(rhs.mRTVs)
     , mDSVs(rhs.mDSVs)
     , mCBV_SRV_UAVs(rhs.mCBV_SRV_UAVs)
@@ -747,6 +754,7 @@ DX12RenderWorks::DX12RenderWorks(DX12RenderWorks const& rhs, const allocator_typ
 DX12RenderWorks::DX12RenderWorks(DX12RenderWorks&& rhs, const allocator_type& alloc)
     : mSolutions(std::move(rhs.mSolutions), alloc)
     , mFramebuffers(std::move(rhs.mFramebuffers), alloc)
+    , mFramebufferHeap(std::move(rhs.mFramebufferHeap))
     , mRTVs(std::move(rhs.mRTVs))
     , mDSVs(std::move(rhs.mDSVs))
     , mCBV_SRV_UAVs(std::move(rhs.mCBV_SRV_UAVs))
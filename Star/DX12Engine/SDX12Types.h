@@ -350,6 +350,8 @@ struct DX12FlattenedObjects {
     std::pmr::vector<WorldTransformInv> mWorldTransformInvs;
     std::pmr::vector<BoundingBox> mBoundingBoxes;
     std::pmr::vector<DX12MeshRenderer> mMeshRenderers;
+    // renderers with equal mesh and materials share a class, see buildInstanceGroups
+    std::pmr::vector<uint32_t> mInstanceClasses;
 };
 
 struct DX12ContentData {
@@ -418,6 +420,7 @@ struct DX12RenderPass {
     std::pmr::vector<RECT> mScissorRects;
     std::pmr::vector<FramebufferHandle> mFramebuffers;
     std::pmr::vector<GraphicsSubpassDependency> mDependencies;
+    std::pmr::vector<FramebufferHandle> mAliasingBarriers;
 };
 
 struct DX12RenderPipeline {
@@ -472,6 +475,7 @@ struct DX12RenderWorks {
 
     std::pmr::vector<DX12RenderSolution> mSolutions;
     std::pmr::vector<com_ptr<ID3D12Resource>> mFramebuffers;
+    com_ptr<ID3D12Heap> mFramebufferHeap;
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_RTV> mRTVs;
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_DSV> mDSVs;
     DX12DescriptorArray<D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV> mCBV_SRV_UAVs;
@@ -125,9 +125,18 @@ void DX12UploadBuffer::advanceFrame() noexcept {
 std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
     const void* pData, size_t bytesPerData, uint32_t dataCount, size_t alignment
 ) {
+    size_t size = bytesPerData * dataCount;
+    auto [data, pDst] = try_reserve(size, alignment);
+    if (!pDst)
+        return { DX12BufferData{}, false };
+
+    memcpy(pDst, pData, size);
+    return { data, true };
+}
+
+std::pair<DX12BufferData, std::byte*> DX12UploadBuffer::try_reserve(size_t size, size_t alignment) {
     Expects(DX12UploadBufferBlock::sAlignment >= alignment);
 
-    size_t size = bytesPerData * dataCount;
     size_t alignedSize = boost::alignment::align_up(size, alignment);
     Expects(alignedSize <= mPool->getMaxBufferSize());
 
@@ -149,9 +158,9 @@ std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
             std::tie(pDst, succeeded) = pBuffer->try_suballocate(size, alignment, mFrameID);
             Ensures(succeeded);
             if (!succeeded)
-                return { DX12BufferData{}, false };
+                return { DX12BufferData{}, nullptr };
         } else {
-            return { DX12BufferData{}, false };
+            return { DX12BufferData{}, nullptr };
         }
     }
 
@@ -159,11 +168,9 @@ std::pair<DX12BufferData, bool> DX12UploadBuffer::try_upload(
     Ensures(pBuffer->resource());
     Expects(pDst);
 
-    memcpy(pDst, pData, size);
-
     Expects(pDst >= mBuffers.back()->begin());
     auto diff = gsl::narrow_cast<uint64_t>(pDst - mBuffers.back()->begin());
-    return std::pair{ DX12BufferData{ pBuffer->resource(), diff }, true };
+    return { DX12BufferData{ pBuffer->resource(), diff }, pDst };
 }
 
 DX12BufferData DX12UploadBuffer::upload(const void* pData, size_t bytesPerData, uint32_t dataCount, size_t alignment) {
@@ -191,4 +198,24 @@ void DX12UploadBuffer::recycle_front() noexcept {
     mBuffers.pop_front();
 }
 
+std::pair<DX12BufferData, std::byte*> DX12ConstantRing::allocate(size_t size) {
+    size = boost::alignment::align_up(size, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    if (!mCurrent || size > gsl::narrow_cast<size_t>(mEnd - mCurrent)) {
+        auto chunkSize = std::max(sChunkSize, size);
+        auto [chunk, pChunk] = mUploadBuffer->try_reserve(chunkSize, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        if (!pChunk) {
+            throw std::runtime_error("reserve constant ring chunk failed");
+        }
+        mChunk = chunk;
+        mBegin = mCurrent = pChunk;
+        mEnd = pChunk + chunkSize;
+    }
+
+    DX12BufferData data{ mChunk.mResource,
+        mChunk.mBufferOffset + gsl::narrow_cast<uint64_t>(mCurrent - mBegin) };
+    auto* pData = mCurrent;
+    mCurrent += size;
+    return { data, pData };
+}
+
 }
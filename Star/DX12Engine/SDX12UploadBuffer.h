@@ -110,6 +110,9 @@ public:
 
     DX12BufferData upload(const void* pData,
         size_t bytesPerData, uint32_t dataCount = 1, size_t alignment = 16);
+
+    // uninitialized space to be written in place, the pointer is null on failure
+    std::pair<DX12BufferData, std::byte*> try_reserve(size_t size, size_t alignment = 16);
 private:
     bool try_allocate();
     void recycle_front() noexcept;
@@ -120,4 +123,30 @@ private:
     int64_t mFrameID = -1;
 };
 
+// per frame bump allocator for constant buffers. upload memory is reserved in chunks,
+// so constants are written in place without a suballocation per draw
+class DX12ConstantRing {
+public:
+    static constexpr size_t sChunkSize = 64 * 1024;
+
+    DX12ConstantRing(DX12UploadBuffer& uploadBuffer) noexcept
+        : mUploadBuffer(&uploadBuffer)
+    {}
+    DX12ConstantRing(const DX12ConstantRing&) = delete;
+    DX12ConstantRing& operator=(const DX12ConstantRing&) = delete;
+
+    // the chunk is owned by the upload buffer, which recycles it with its frame
+    void advanceFrame() noexcept {
+        mBegin = mCurrent = mEnd = nullptr;
+    }
+
+    std::pair<DX12BufferData, std::byte*> allocate(size_t size);
+private:
+    gsl::not_null<DX12UploadBuffer*> mUploadBuffer;
+    DX12BufferData mChunk;
+    std::byte* mBegin = nullptr;
+    std::byte* mCurrent = nullptr;
+    std::byte* mEnd = nullptr;
+};
+
 }
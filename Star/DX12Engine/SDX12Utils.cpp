@@ -17,6 +17,7 @@
 
 #include "SDX12Utils.h"
 #include <boost/range/combine.hpp>
+#include <numeric>
 #include <Star/Graphics/SRenderNames.h>
 #include <Star/Graphics/SRenderGraphNames.h>
 #include "SDX12UploadBuffer.h"
@@ -52,41 +53,43 @@ std::pair<DX12MeshData*, bool> try_createDX12MeshData(CreationContext& context,
                 mesh.mLayoutID = meshData.mLayoutID;
                 mesh.mLayoutName = meshData.mLayoutName;
 
-                if (!meshData.mIndexBuffer.mBuffer.empty()) {
-                    auto buffer = context.upload(meshData.mIndexBuffer.mBuffer, 16);
-                    mesh.mIndexBuffer.mBuffer = DX12::createBuffer(context.mDevice, meshData.mIndexBuffer.mBuffer.size());
+                const auto indices = meshData.mIndexBuffer.data();
+                if (!indices.empty()) {
+                    auto buffer = context.upload(indices.data(), indices.size(), 16);
+                    mesh.mIndexBuffer.mBuffer = DX12::createBuffer(context.mDevice, indices.size());
                     STAR_SET_DEBUG_NAME(mesh.mIndexBuffer.mBuffer.get(), to_string(metaID) + " index buffer");
 
                     context.mCommandList->CopyBufferRegion(mesh.mIndexBuffer.mBuffer.get(), 0,
-                        buffer.mResource, buffer.mBufferOffset, meshData.mIndexBuffer.mBuffer.size());
+                        buffer.mResource, buffer.mBufferOffset, indices.size());
 
                     mesh.mIndexBufferView.BufferLocation = mesh.mIndexBuffer.mBuffer->GetGPUVirtualAddress();
-                    mesh.mIndexBufferView.SizeInBytes = gsl::narrow_cast<uint32_t>(meshData.mIndexBuffer.mBuffer.size());
+                    mesh.mIndexBufferView.SizeInBytes = gsl::narrow_cast<uint32_t>(indices.size());
                     mesh.mIndexBufferView.Format = meshData.mIndexBuffer.mElementSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
                 }
 
                 mesh.mVertexBuffers.reserve(meshData.mVertexBuffers.size());
                 mesh.mVertexBufferViews.reserve(meshData.mVertexBuffers.size());
                 for (const auto& vertexBufferData : meshData.mVertexBuffers) {
-                    auto buffer = context.upload(vertexBufferData.mBuffer, 16);
+                    const auto vertices = vertexBufferData.data();
+                    auto buffer = context.upload(vertices.data(), vertices.size(), 16);
                     auto id = mesh.mVertexBuffers.size();
                     auto& vb = mesh.mVertexBuffers.emplace_back();
                     auto& vbv = mesh.mVertexBufferViews.emplace_back();
-                    vb.mBuffer = DX12::createBuffer(context.mDevice, vertexBufferData.mBuffer.size());
+                    vb.mBuffer = DX12::createBuffer(context.mDevice, vertices.size());
                     STAR_SET_DEBUG_NAME(vb.mBuffer.get(), to_string(metaID) + " vertex buffer " + std::to_string(id));
 
                     context.mCommandList->CopyBufferRegion(vb.mBuffer.get(), 0,
-                        buffer.mResource, buffer.mBufferOffset, vertexBufferData.mBuffer.size());
+                        buffer.mResource, buffer.mBufferOffset, vertices.size());
 
                     vbv.BufferLocation = vb.mBuffer->GetGPUVirtualAddress();
-                    vbv.SizeInBytes = gsl::narrow_cast<uint32_t>(vertexBufferData.mBuffer.size());
+                    vbv.SizeInBytes = gsl::narrow_cast<uint32_t>(vertices.size());
                     vbv.StrideInBytes = vertexBufferData.mDesc.mVertexSize;
                     Expects(vertexBufferData.mDesc.mVertexSize);
                 }
 
                 mesh.mSubMeshes = meshData.mSubMeshes;
 
-                auto barrierCount = mesh.mVertexBuffers.size() + !meshData.mIndexBuffer.mBuffer.empty();
+                auto barrierCount = mesh.mVertexBuffers.size() + !indices.empty();
 
                 auto pBarriers = pmr_make_unique<std::pmr::vector<D3D12_RESOURCE_BARRIER>>(context.mMemoryArena);
                 pBarriers->reserve(barrierCount);
@@ -829,6 +832,7 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
                         pass.mViewports = passData.mViewports;
                         pass.mScissorRects = passData.mScissorRects;
                         pass.mFramebuffers = passData.mFramebuffers;
+                        pass.mAliasingBarriers = passData.mAliasingBarriers;
                         pass.mDependencies = passData.mDependencies;
                         
                         for (const auto& subpassData : passData.mGraphicsSubpasses) {
@@ -910,6 +914,29 @@ std::pair<DX12RenderGraphData*, bool> try_createDX12RenderGraphData(CreationCont
     return { const_cast<DX12RenderGraphData*>(&*iter), created };
 }
 
+// class of a renderer is the index of the first renderer with the same mesh and materials
+void buildInstanceClasses(const std::pmr::vector<DX12MeshRenderer>& renderers,
+    std::pmr::vector<uint32_t>& classes
+) {
+    const auto count = gsl::narrow<uint32_t>(renderers.size());
+    std::pmr::vector<uint32_t> order(count, classes.get_allocator());
+    std::iota(order.begin(), order.end(), 0);
+    auto less = [&](uint32_t lhs, uint32_t rhs) {
+        return std::tie(renderers[lhs].mMesh, renderers[lhs].mMaterials) <
+            std::tie(renderers[rhs].mMesh, renderers[rhs].mMaterials);
+    };
+    std::stable_sort(order.begin(), order.end(), less);
+
+    classes.resize(count);
+    for (uint32_t i = 0; i != count; ++i) {
+        if (i && !less(order[i - 1], order[i])) {
+            classes[order[i]] = classes[order[i - 1]];
+        } else {
+            classes[order[i]] = order[i];
+        }
+    }
+}
+
 }
 
 bool try_createDX12(CreationContext& context, DX12Resources& resources, const MetaID& metaID,
@@ -977,6 +1004,7 @@ bool try_createDX12(CreationContext& context, DX12Resources& resources, const Me
                                         try_createDX12MaterialData(context, *iter, resources, materialID, async).first);
                                 }
                             }
+                            buildInstanceClasses(object.mMeshRenderers, object.mInstanceClasses);
                         }
                     }
                 }/*);*/
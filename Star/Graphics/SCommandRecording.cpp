@@ -0,0 +1,50 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SCommandRecording.h"
+#include <numeric>
+
+namespace Star::Graphics::Render {
+
+void partitionRecordingJobs(gsl::span<const uint64_t> costs,
+    uint32_t maxJobs, uint64_t minJobCost, std::pmr::vector<RecordingJob>& jobs
+) {
+    Expects(maxJobs);
+    jobs.clear();
+    if (costs.empty())
+        return;
+
+    auto total = std::accumulate(costs.begin(), costs.end(), uint64_t(0));
+    auto target = std::max(minJobCost, (total + maxJobs - 1) / maxJobs);
+
+    // greedy, order is kept so the lists can be submitted as they are
+    RecordingJob job{};
+    for (uint32_t i = 0; i != costs.size(); ++i) {
+        if (job.mEnd != job.mBegin && job.mCost >= target && jobs.size() + 1 < maxJobs) {
+            jobs.emplace_back(job);
+            job = RecordingJob{ i, i, 0 };
+        }
+        ++job.mEnd;
+        job.mCost += costs[i];
+    }
+    jobs.emplace_back(job);
+
+    Ensures(jobs.size() <= maxJobs);
+    Ensures(jobs.front().mBegin == 0 && jobs.back().mEnd == costs.size());
+}
+
+}
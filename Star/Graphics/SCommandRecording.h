@@ -0,0 +1,92 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+
+namespace Star::Graphics::Render {
+
+// range [mBegin, mEnd) of the frame's subpasses flattened in submission order,
+// recorded into its own command list
+struct RecordingJob {
+    uint32_t mBegin = 0;
+    uint32_t mEnd = 0;
+    uint64_t mCost = 0;
+};
+
+// costs[i] is the estimated draw count of flattened subpass i. Splits them into
+// at most maxJobs contiguous jobs of similar cost, each holding at least minJobCost if possible
+STAR_GRAPHICS_API void partitionRecordingJobs(gsl::span<const uint64_t> costs,
+    uint32_t maxJobs, uint64_t minJobCost, std::pmr::vector<RecordingJob>& jobs);
+
+// Backend requirements:
+//   void record(uint32_t listID, const RecordingJob& job); // called concurrently, one list per job
+//   void submit(uint32_t listCount);                        // lists [0, listCount) in order
+template<class Backend>
+void recordJobs(Backend& backend, gsl::span<const RecordingJob> jobs) {
+    if (jobs.size() == 1) {
+        backend.record(0, jobs[0]);
+    } else {
+        // exceptions must not escape a parallel algorithm, rethrow the first one here
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        std::for_each(std::execution::par, jobs.begin(), jobs.end(), [&](const RecordingJob& job) {
+            try {
+                backend.record(gsl::narrow_cast<uint32_t>(&job - jobs.data()), job);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        });
+        if (error)
+            std::rethrow_exception(error);
+    }
+    backend.submit(gsl::narrow_cast<uint32_t>(jobs.size()));
+}
+
+// records jobs without any graphics api, for partitioning and ordering checks
+class NullRecordingBackend {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+    allocator_type get_allocator() const noexcept {
+        return mLists.get_allocator().resource();
+    }
+
+    NullRecordingBackend(const allocator_type& alloc)
+        : mLists(alloc)
+        , mSubmitted(alloc)
+    {}
+
+    void reset(uint32_t listCount) {
+        mLists.clear();
+        mLists.resize(listCount);
+        mSubmitted.clear();
+    }
+    void record(uint32_t listID, const RecordingJob& job) {
+        mLists.at(listID) = job;
+    }
+    void submit(uint32_t listCount) {
+        Expects(listCount <= mLists.size());
+        mSubmitted.insert(mSubmitted.end(), mLists.begin(), mLists.begin() + listCount);
+    }
+
+    std::pmr::vector<RecordingJob> mLists;
+    std::pmr::vector<RecordingJob> mSubmitted;
+};
+
+}
@@ -91,6 +91,8 @@ STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::VertexBufferData, object_seria
 STAR_CLASS_TRACKING(Star::Graphics::Render::VertexBufferData, track_never);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::VertexBufferData& v, const uint32_t version) {
+    // mapped blobs are written by writeMeshContainer only
+    Expects(v.mMapped.empty());
     ar & v.mDesc;
     ar & v.mVertexCount;
     ar & v.mBuffer;
@@ -114,6 +116,7 @@ STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::IndexBufferData, object_serial
 STAR_CLASS_TRACKING(Star::Graphics::Render::IndexBufferData, track_never);
 template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::IndexBufferData& v, const uint32_t version) {
+    Expects(v.mMapped.empty());
     ar & v.mBuffer;
     ar & v.mElementSize;
     ar & v.mPrimitiveCount;
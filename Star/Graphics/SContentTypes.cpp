@@ -81,12 +81,14 @@ VertexBufferData::VertexBufferData(VertexBufferData const& rhs, const allocator_
     : mDesc(rhs.mDesc, alloc)
     , mVertexCount(rhs.mVertexCount)
     , mBuffer(rhs.mBuffer, alloc)
+    , mMapped(rhs.mMapped)
 {}
 
 VertexBufferData::VertexBufferData(VertexBufferData&& rhs, const allocator_type& alloc)
     : mDesc(std::move(rhs.mDesc), alloc)
     , mVertexCount(std::move(rhs.mVertexCount))
     , mBuffer(std::move(rhs.mBuffer), alloc)
+    , mMapped(rhs.mMapped)
 {}
 
 VertexBufferData::~VertexBufferData() = default;
@@ -101,6 +103,7 @@ IndexBufferData::IndexBufferData(const allocator_type& alloc)
 
 IndexBufferData::IndexBufferData(IndexBufferData const& rhs, const allocator_type& alloc)
     : mBuffer(rhs.mBuffer, alloc)
+    , mMapped(rhs.mMapped)
     , mElementSize(rhs.mElementSize)
     , mPrimitiveCount(rhs.mPrimitiveCount)
     , mPrimitiveTopology(rhs.mPrimitiveTopology)
@@ -108,6 +111,7 @@ IndexBufferData::IndexBufferData(IndexBufferData const& rhs, const allocator_typ
 
 IndexBufferData::IndexBufferData(IndexBufferData&& rhs, const allocator_type& alloc)
     : mBuffer(std::move(rhs.mBuffer), alloc)
+    , mMapped(rhs.mMapped)
     , mElementSize(std::move(rhs.mElementSize))
     , mPrimitiveCount(std::move(rhs.mPrimitiveCount))
     , mPrimitiveTopology(std::move(rhs.mPrimitiveTopology))
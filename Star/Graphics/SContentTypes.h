@@ -120,9 +120,16 @@ struct STAR_GRAPHICS_API VertexBufferData {
     VertexBufferData(VertexBufferData const& rhs, const allocator_type& alloc);
     ~VertexBufferData();
 
+    // mapped blob if set, owned buffer otherwise
+    gsl::span<const char> data() const noexcept {
+        return mMapped.empty() ? gsl::span<const char>(mBuffer) : mMapped;
+    }
+
     VertexBufferDesc mDesc;
     uint32_t mVertexCount;
     std::pmr::vector<char> mBuffer;
+    // view into memory kept alive by the producer, not serialized
+    gsl::span<const char> mMapped;
 };
 
 struct STAR_GRAPHICS_API IndexBufferData {
@@ -134,7 +141,14 @@ struct STAR_GRAPHICS_API IndexBufferData {
     IndexBufferData(IndexBufferData const& rhs, const allocator_type& alloc);
     ~IndexBufferData();
 
+    // mapped blob if set, owned buffer otherwise
+    gsl::span<const char> data() const noexcept {
+        return mMapped.empty() ? gsl::span<const char>(mBuffer) : mMapped;
+    }
+
     std::pmr::vector<char> mBuffer;
+    // view into memory kept alive by the producer, not serialized
+    gsl::span<const char> mMapped;
     uint32_t mElementSize;
     uint32_t mPrimitiveCount;
     GFX_PRIMITIVE_TOPOLOGY mPrimitiveTopology = GFX_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
@@ -75,6 +75,15 @@ void visitShaderSubpassData(ShaderData& sc, const Visitor& visitor) {
     }
 }
 
+// vertex and index bytes, mapped or owned
+inline uint64_t getMeshSize(const MeshData& mesh) noexcept {
+    uint64_t size = mesh.mIndexBuffer.data().size();
+    for (const auto& vb : mesh.mVertexBuffers) {
+        size += vb.data().size();
+    }
+    return size;
+}
+
 inline std::pair<const void*, uint32_t> getConstant(const ConstantMap& map, uint32_t key) {
     auto desc = map.mIndex.at(key);
     auto* pSrc = map.mBuffer.data() + desc.mOffset;
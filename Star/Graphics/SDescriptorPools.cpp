@@ -16,6 +16,7 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "SDescriptorPools.h"
+#include <thread>
 
 namespace Star {
 
@@ -27,7 +28,7 @@ DescriptorPool::DescriptorPool(
     : mBlockSize(blockSize)
     , mBlockCount(gsl::narrow_cast<uint32_t>(boost::alignment::align_up(capacity, blockSize)) / blockSize)
     , mAllocator(alloc.resource())
-    , mFreeBlocks(mAllocator)
+    , mSlots(mAllocator)
 {
     reset(0, mBlockCount * mBlockSize);
 }
@@ -35,53 +36,104 @@ DescriptorPool::DescriptorPool(
 DescriptorPool::~DescriptorPool() = default;
 
 DescriptorBlock DescriptorPool::allocateRange() const {
-    std::lock_guard<std::mutex> guard(mMutex);
-
-    if (mFreeBlocks.empty()) {
-        throw std::runtime_error("not enough descriptor block");
-    }
+    auto pos = mPopPosition.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    do {
+        slot = &mSlots[pos & mSlotMask];
+        const auto seq = slot->mSequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(seq - (pos + 1));
+        if (diff == 0) {
+            if (mPopPosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // empty, or a push claimed this slot and has not published it yet
+            if (pos == mPushPosition.load(std::memory_order_acquire)) {
+                throw std::runtime_error("not enough descriptor block");
+            }
+            std::this_thread::yield();
+            pos = mPopPosition.load(std::memory_order_relaxed);
+        } else {
+            pos = mPopPosition.load(std::memory_order_relaxed);
+        }
+    } while (true);
 
-    auto range = mFreeBlocks.front();
-    mFreeBlocks.pop_front();
+    const auto index = slot->mIndex;
+    // slot is free for the push one lap ahead
+    slot->mSequence.store(pos + mSlotMask + 1, std::memory_order_release);
 
-    ++mAllocatedCount;
-    return DescriptorBlock(*this, range.mBegin, range.mEnd);
+    mAllocatedCount.fetch_add(1, std::memory_order_relaxed);
+    const auto begin = mBlockStart + index * mBlockSize;
+    return DescriptorBlock(*this, begin, begin + mBlockSize);
 }
 
 void DescriptorPool::destroyBuffer(const std::pair<uint32_t, uint32_t>& block) const noexcept {
-    std::lock_guard<std::mutex> guard(mMutex);
-    mFreeBlocks.emplace_back(Range{ block.first, block.second });
-    --mAllocatedCount;
+    Expects(block.first >= mBlockStart);
+    Expects(block.second - block.first == mBlockSize);
+    const uint32_t index = (block.first - mBlockStart) / mBlockSize;
+    Expects(index < mBlockCount);
+
+    auto pos = mPushPosition.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    do {
+        slot = &mSlots[pos & mSlotMask];
+        const auto seq = slot->mSequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(seq - pos);
+        if (diff == 0) {
+            if (mPushPosition.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // ring holds every block, so it is never full. A pop of the previous
+            // lap claimed this slot and has not released it yet
+            std::this_thread::yield();
+            pos = mPushPosition.load(std::memory_order_relaxed);
+        } else {
+            pos = mPushPosition.load(std::memory_order_relaxed);
+        }
+    } while (true);
+
+    slot->mIndex = index;
+    slot->mSequence.store(pos + 1, std::memory_order_release);
+
+    mAllocatedCount.fetch_sub(1, std::memory_order_relaxed);
 }
 
 void DescriptorPool::reset(uint32_t offset, uint32_t descCount) {
-    std::lock_guard<std::mutex> guard(mMutex);
-
     Expects(mBlockSize);
     Expects(boost::alignment::align_up(descCount, mBlockSize) == descCount);
 
     descCount = gsl::narrow_cast<uint32_t>(
         boost::alignment::align_up(descCount, mBlockSize));
 
+    if (mAllocatedCount.load(std::memory_order_acquire) != 0) {
+        throw std::runtime_error("descriptors still in use");
+    }
+
     mBlockStart = offset;
     mBlockCount = descCount / mBlockSize;
 
-    if (mAllocatedCount == 0) {
-        while (!mFreeBlocks.empty()) {
-            mFreeBlocks.pop_front();
+    uint64_t slotCount = 1;
+    while (slotCount < mBlockCount) {
+        slotCount <<= 1;
+    }
+    mSlotMask = slotCount - 1;
+
+    // slots are never reallocated after reset, memory is one slot per block
+    std::pmr::vector<Slot> slots(slotCount, mAllocator);
+    for (uint64_t i = 0; i != slotCount; ++i) {
+        if (i < mBlockCount) {
+            slots[i].mIndex = gsl::narrow_cast<uint32_t>(i);
+            slots[i].mSequence.store(i + 1, std::memory_order_relaxed);
+        } else {
+            slots[i].mIndex = 0;
+            slots[i].mSequence.store(i, std::memory_order_relaxed);
         }
-    } else {
-        throw std::runtime_error("descriptors still in use");
     }
+    mSlots.swap(slots);
 
-    uint32_t count = 0;
-    for (int i = 0; i != mBlockCount; ++i) {
-        auto begin = mBlockStart + count;
-        mFreeBlocks.emplace_back(Range{ begin, begin + mBlockSize });
-        count += mBlockSize;
-    }
-    Ensures(count == descCount);
-    std::ignore = count;
+    mPopPosition.store(0, std::memory_order_relaxed);
+    mPushPosition.store(mBlockCount, std::memory_order_release);
 }
 
 // Persistent
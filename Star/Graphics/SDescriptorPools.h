@@ -99,24 +99,28 @@ private:
     void reset(uint32_t offset, uint32_t count);
     void destroyBuffer(const std::pair<uint32_t, uint32_t>& block) const noexcept;
 
-    struct Range {
-        uint32_t mBegin;
-        uint32_t mEnd;
+    // free list is a bounded MPMC ring of block indices. Blocks are reused FIFO,
+    // so a freed block waits behind every other free block before it is handed
+    // out again. Each slot carries a sequence number derived from the 64-bit
+    // push/pop positions, positions never repeat, so there is no ABA.
+    // Push and pop are one CAS each, a thread only yields when it meets a slot
+    // that another thread has claimed but not finished.
+    struct Slot {
+        std::atomic_uint64_t mSequence;
+        uint32_t mIndex;
     };
 
     const uint32_t mBlockSize = 0;
     uint32_t mBlockStart = 0;
     uint32_t mBlockCount = 0;
+    uint64_t mSlotMask = 0;
 #pragma warning(push)
 #pragma warning(disable: 4251)
-    std::pmr::polymorphic_allocator<Range> mAllocator;
-    mutable std::mutex mMutex;
-    mutable std::atomic_int32_t mAllocatedCount = 0;
-    mutable std::pmr::deque<Range> mFreeBlocks;
-
-    //mutable pmr_lockfree_queue<Range,
-    //    boost::lockfree::fixed_sized<true>
-    //> mFreeBlocks;
+    std::pmr::polymorphic_allocator<Slot> mAllocator;
+    alignas(64) mutable std::atomic_uint64_t mPopPosition = 0;
+    alignas(64) mutable std::atomic_uint64_t mPushPosition = 0;
+    alignas(64) mutable std::atomic_int32_t mAllocatedCount = 0;
+    mutable std::pmr::vector<Slot> mSlots;
 #pragma warning(pop)
 };
 
@@ -0,0 +1,104 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SDrawPacket.h"
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+constexpr uint32_t sRadixSortMinCount = 1024;
+
+uint64_t foldKeyField(uint64_t v, uint32_t bits) noexcept {
+    // mix pointer-like values so their low bits are not all alignment zeros
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdull;
+    v ^= v >> 33;
+    return v & ((uint64_t(1) << bits) - 1);
+}
+
+}
+
+uint64_t makeDrawSortKey(uint32_t passID, uint64_t pso,
+    uint64_t material, uint64_t mesh, uint32_t depthBucket
+) noexcept {
+    Expects(depthBucket < sDrawDepthBuckets);
+    return (uint64_t(passID & 0xff) << 56)
+        | (foldKeyField(pso, 16) << 40)
+        | (foldKeyField(material, 16) << 24)
+        | (foldKeyField(mesh, 16) << 8)
+        | depthBucket;
+}
+
+uint32_t getDrawDepthBucket(float depth, float farPlane) noexcept {
+    Expects(farPlane > 0);
+    if (!(depth > 0))
+        return 0;
+    if (depth >= farPlane)
+        return sDrawDepthBuckets - 1;
+    return std::min(static_cast<uint32_t>(depth / farPlane * sDrawDepthBuckets), sDrawDepthBuckets - 1);
+}
+
+void radixSortDrawPackets(std::pmr::vector<DrawPacket>& packets,
+    std::pmr::vector<DrawPacket>& scratch
+) {
+    const auto count = gsl::narrow<uint32_t>(packets.size());
+    if (count < 2)
+        return;
+
+    // clearing and scanning the histograms costs more than a comparison sort of few packets
+    if (count < sRadixSortMinCount) {
+        std::stable_sort(packets.begin(), packets.end(), [](const DrawPacket& lhs, const DrawPacket& rhs) {
+            return lhs.mKey < rhs.mKey;
+        });
+        return;
+    }
+
+    // all byte histograms in one read
+    std::array<std::array<uint32_t, 256>, 8> histograms{};
+    for (const auto& packet : packets) {
+        for (uint32_t b = 0; b != 8; ++b) {
+            ++histograms[b][(packet.mKey >> (b * 8)) & 0xff];
+        }
+    }
+
+    scratch.resize(count);
+    auto* pSrc = packets.data();
+    auto* pDst = scratch.data();
+    for (uint32_t b = 0; b != 8; ++b) {
+        auto& histogram = histograms[b];
+        if (histogram[(pSrc[0].mKey >> (b * 8)) & 0xff] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (auto& bucket : histogram) {
+            auto n = bucket;
+            bucket = offset;
+            offset += n;
+        }
+        for (uint32_t i = 0; i != count; ++i) {
+            pDst[histogram[(pSrc[i].mKey >> (b * 8)) & 0xff]++] = pSrc[i];
+        }
+        std::swap(pSrc, pDst);
+    }
+
+    if (pSrc != packets.data()) {
+        std::copy(scratch.begin(), scratch.end(), packets.begin());
+    }
+}
+
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+
+namespace Star::Graphics::Render {
+
+// sort key of a draw, most significant field first:
+// pass 8 | pipeline state 16 | material 16 | mesh 16 | depth bucket 8
+// fields wider than their bits are folded, equal keys only group draws and never skip state
+struct DrawPacket {
+    uint64_t mKey = 0;
+    uint32_t mIndex = 0;
+};
+
+static constexpr uint32_t sDrawDepthBuckets = 256;
+
+STAR_GRAPHICS_API uint64_t makeDrawSortKey(uint32_t passID, uint64_t pso,
+    uint64_t material, uint64_t mesh, uint32_t depthBucket) noexcept;
+
+// bucket of a view space distance in [0, farPlane], nearer draws sort first
+STAR_GRAPHICS_API uint32_t getDrawDepthBucket(float depth, float farPlane) noexcept;
+
+// stable lsd radix sort on mKey, byte passes shared by all keys are skipped.
+// scratch is resized to packets.size(), small inputs are merge sorted in place
+STAR_GRAPHICS_API void radixSortDrawPackets(std::pmr::vector<DrawPacket>& packets,
+    std::pmr::vector<DrawPacket>& scratch);
+
+}
@@ -0,0 +1,48 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SInstanceBatching.h"
+
+namespace Star::Graphics::Render {
+
+void buildInstanceGroups(gsl::span<const uint32_t> classes,
+    uint32_t maxInstanceCount, std::pmr::vector<uint32_t>& objects,
+    std::pmr::vector<InstanceGroup>& groups
+) {
+    Expects(maxInstanceCount);
+    groups.clear();
+    if (objects.empty())
+        return;
+
+    if (maxInstanceCount > 1) {
+        std::stable_sort(objects.begin(), objects.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return classes[lhs] < classes[rhs];
+        });
+    }
+
+    InstanceGroup group{ 0, 1 };
+    for (uint32_t i = 1; i != objects.size(); ++i) {
+        if (group.mCount == maxInstanceCount || classes[objects[i]] != classes[objects[i - 1]]) {
+            groups.emplace_back(group);
+            group = InstanceGroup{ i, 0 };
+        }
+        ++group.mCount;
+    }
+    groups.emplace_back(group);
+}
+
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+
+namespace Star::Graphics::Render {
+
+// instances per draw, generated vertex shaders declare per-instance constants
+// as an array of this size indexed by SV_InstanceID
+static constexpr uint32_t sMaxInstanceCount = 64;
+
+// run [mFirst, mFirst + mCount) of reordered visible objects, drawn as one instanced draw
+struct InstanceGroup {
+    uint32_t mFirst = 0;
+    uint32_t mCount = 0;
+};
+
+// classes[i] is the instance class of object i, objects of the same class share
+// mesh and materials. objects are stably reordered by class and split into
+// groups of at most maxInstanceCount
+STAR_GRAPHICS_API void buildInstanceGroups(gsl::span<const uint32_t> classes,
+    uint32_t maxInstanceCount, std::pmr::vector<uint32_t>& objects,
+    std::pmr::vector<InstanceGroup>& groups);
+
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SObjectConstants.h"
+
+namespace Star::Graphics::Render {
+
+ObjectConstantLayout placeObjectConstants(
+    gsl::span<const InstanceGroup> groups, std::pmr::vector<uint32_t>& slots
+) {
+    slots.clear();
+    slots.reserve(groups.size());
+
+    uint32_t end = 0;
+    for (const auto& group : groups) {
+        Expects(group.mCount && group.mCount <= sMaxInstanceCount);
+        auto slot = boost::alignment::align_up(end, sObjectConstantSlotAlignment);
+        if (slot % sMaxInstanceCount + group.mCount > sMaxInstanceCount) {
+            slot = boost::alignment::align_up(slot, sMaxInstanceCount);
+        }
+        slots.emplace_back(slot);
+        end = slot + group.mCount;
+    }
+
+    ObjectConstantLayout layout;
+    layout.mSlotCount = end;
+    if (end) {
+        // the last stripe is cut after the last slot of its last array
+        layout.mSize = boost::alignment::align_up(getObjectConstantOffset(end - 1)
+            + sObjectConstantStripeSize - sObjectConstantArraySize + sObjectConstantStride, 256u);
+    }
+    return layout;
+}
+
+uint32_t getObjectConstantOffset(uint32_t slot) noexcept {
+    return slot / sMaxInstanceCount * sObjectConstantStripeSize
+        + slot % sMaxInstanceCount * sObjectConstantStride;
+}
+
+uint32_t getObjectConstantViewSize(uint32_t count) noexcept {
+    Expects(count && count <= sMaxInstanceCount);
+    return boost::alignment::align_up(
+        sObjectConstantStripeSize - sObjectConstantArraySize + count * sObjectConstantStride, 256u);
+}
+
+void packObjectConstants(const Matrix4f& view,
+    gsl::span<const WorldTransform> worldTransforms,
+    gsl::span<const WorldTransformInv> worldTransformInvs,
+    gsl::span<const uint32_t> objects, gsl::span<const InstanceGroup> groups,
+    gsl::span<const uint32_t> slots, gsl::span<std::byte> dst
+) {
+    Expects(groups.size() == slots.size());
+    Expects(worldTransforms.size() == worldTransformInvs.size());
+
+    for (size_t groupID = 0; groupID != groups.size(); ++groupID) {
+        const auto& group = groups[groupID];
+        const auto offset = getObjectConstantOffset(slots[groupID]);
+        Expects(group.mFirst + group.mCount <= objects.size());
+        Expects(offset + getObjectConstantViewSize(group.mCount) <= dst.size());
+
+        auto* pWorldView = dst.data() + offset;
+        auto* pWorldInvT = pWorldView + sObjectConstantArraySize;
+        for (uint32_t i = 0; i != group.mCount; ++i) {
+            const auto objectID = objects[group.mFirst + i];
+            Expects(objectID < worldTransforms.size());
+            const Matrix4f worldView = view * worldTransforms[objectID].mTransform.matrix();
+            memcpy(pWorldView, worldView.data(), sizeof(Matrix4f));
+            memcpy(pWorldInvT, worldTransformInvs[objectID].mTransform.matrix().data(), sizeof(Matrix4f));
+            pWorldView += sObjectConstantStride;
+            pWorldInvT += sObjectConstantStride;
+        }
+    }
+}
+
+}
@@ -0,0 +1,59 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SContentTypes.h>
+#include <Star/Graphics/SInstanceBatching.h>
+
+namespace Star::Graphics::Render {
+
+// per-instance constants of a batch, packed once as structure of arrays.
+// instance groups are placed in stripes of sMaxInstanceCount slots, one array per constant:
+// [WorldView x sMaxInstanceCount][WorldInvT x sMaxInstanceCount]
+// a group starts 256-byte aligned and never crosses a stripe, so one constant buffer view
+// at its first WorldView covers all its arrays. shaders declare the arrays of a stripe
+// in this order and index them by SV_InstanceID
+static constexpr std::array<std::string_view, 2> sObjectConstantNames = { "WorldView", "WorldInvT" };
+static constexpr uint32_t sObjectConstantStride = sizeof(Matrix4f);
+static constexpr uint32_t sObjectConstantArraySize = sObjectConstantStride * sMaxInstanceCount;
+static constexpr uint32_t sObjectConstantStripeSize = sObjectConstantArraySize *
+    static_cast<uint32_t>(sObjectConstantNames.size());
+static constexpr uint32_t sObjectConstantSlotAlignment = 256 / sObjectConstantStride;
+
+struct ObjectConstantLayout {
+    uint32_t mSlotCount = 0; // up to the last slot of the last group
+    uint32_t mSize = 0; // bytes, 256-byte aligned
+};
+
+// first slot of every group, groups keep their order
+STAR_GRAPHICS_API ObjectConstantLayout placeObjectConstants(
+    gsl::span<const InstanceGroup> groups, std::pmr::vector<uint32_t>& slots);
+
+// constant buffer view of a group placed at slot, offset is 256-byte aligned
+STAR_GRAPHICS_API uint32_t getObjectConstantOffset(uint32_t slot) noexcept;
+STAR_GRAPHICS_API uint32_t getObjectConstantViewSize(uint32_t count) noexcept;
+
+// single pass over the grouped objects, objects[group.mFirst + i] goes to slot slots[groupID] + i
+STAR_GRAPHICS_API void packObjectConstants(const Matrix4f& view,
+    gsl::span<const WorldTransform> worldTransforms,
+    gsl::span<const WorldTransformInv> worldTransformInvs,
+    gsl::span<const uint32_t> objects, gsl::span<const InstanceGroup> groups,
+    gsl::span<const uint32_t> slots, gsl::span<std::byte> dst);
+
+}
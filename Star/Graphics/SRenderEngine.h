@@ -54,6 +54,7 @@ public:
         uint32_t mFrameQueueSize = 3;
         uint32_t mShaderDescriptorCapacity = 0;
         uint32_t mShaderDescriptorCircularReserve = 0;
+        uint32_t mMaxRecordingJobs = 4;
         MetaID mRenderGraph = {};
         std::string_view mSolutionName;
         std::string_view mPipelineName;
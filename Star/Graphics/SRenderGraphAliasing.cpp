@@ -0,0 +1,77 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SRenderGraphAliasing.h"
+#include <numeric>
+
+namespace Star::Graphics::Render {
+
+uint64_t placeTransientResources(
+    gsl::span<const TransientResourceDesc> resources, gsl::span<uint64_t> offsets
+) {
+    Expects(offsets.size() == resources.size());
+
+    std::vector<uint32_t> order(resources.size());
+    std::iota(order.begin(), order.end(), 0);
+    // larger alignments first, every occupied range then ends aligned for the
+    // resources placed after it, no padding is inserted and the heap never exceeds
+    // the dedicated total
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+        return std::forward_as_tuple(resources[lhs].mAlignment, resources[lhs].mSize) >
+            std::forward_as_tuple(resources[rhs].mAlignment, resources[rhs].mSize);
+    });
+    auto getFootprint = [](const TransientResourceDesc& r) {
+        return boost::alignment::align_up(r.mSize, r.mAlignment);
+    };
+
+    std::vector<uint32_t> placed;
+    placed.reserve(resources.size());
+    std::vector<std::pair<uint64_t, uint64_t>> occupied;
+
+    uint64_t heapSize = 0;
+    for (const auto id : order) {
+        const auto& r = resources[id];
+        Expects(r.mLifetimeBegin <= r.mLifetimeEnd);
+        Expects(r.mAlignment && (r.mAlignment & (r.mAlignment - 1)) == 0);
+
+        occupied.clear();
+        for (const auto other : placed) {
+            if (overlaps(r, resources[other])) {
+                occupied.emplace_back(offsets[other], offsets[other] + getFootprint(resources[other]));
+            }
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        // lowest aligned gap that fits
+        uint64_t offset = 0;
+        for (const auto& [begin, end] : occupied) {
+            if (boost::alignment::align_up(offset, r.mAlignment) + getFootprint(r) <= begin)
+                break;
+            offset = std::max(offset, end);
+        }
+        offset = boost::alignment::align_up(offset, r.mAlignment);
+
+        offsets[id] = offset;
+        heapSize = std::max(heapSize, offset + r.mSize);
+        placed.emplace_back(id);
+    }
+
+    return heapSize;
+}
+
+}
@@ -0,0 +1,43 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+
+namespace Star::Graphics::Render {
+
+// lifetime is the inclusive pass range the resource is used in
+struct TransientResourceDesc {
+    uint32_t mLifetimeBegin = 0;
+    uint32_t mLifetimeEnd = 0;
+    uint64_t mSize = 0;
+    uint64_t mAlignment = 1;
+};
+
+inline bool overlaps(const TransientResourceDesc& lhs, const TransientResourceDesc& rhs) noexcept {
+    return lhs.mLifetimeBegin <= rhs.mLifetimeEnd && rhs.mLifetimeBegin <= lhs.mLifetimeEnd;
+}
+
+// first-fit placement in decreasing alignment, then size order, resources with overlapping
+// lifetimes never share memory. each resource takes its size aligned up to its alignment,
+// so the heap is never larger than placing every resource in an allocation of its own.
+// offsets[i] receives the heap offset of resources[i], returns heap size
+STAR_GRAPHICS_API uint64_t placeTransientResources(
+    gsl::span<const TransientResourceDesc> resources, gsl::span<uint64_t> offsets);
+
+}
@@ -429,6 +429,7 @@ void serialize(Archive& ar, Star::Graphics::Render::RenderPass& v, const uint32_
     ar & v.mGraphicsSubpasses;
     ar & v.mDependencies;
     ar & v.mRaytracingSubpasses;
+    ar & v.mAliasingBarriers;
 }
 
 template<class Archive>
@@ -492,6 +493,9 @@ template<class Archive>
 void serialize(Archive& ar, Star::Graphics::Render::Framebuffer& v, const uint32_t version) {
     ar & v.mResource;
     ar & v.mClear;
+    ar & v.mTransient;
+    ar & v.mLifetimeBegin;
+    ar & v.mLifetimeEnd;
 }
 
 STAR_CLASS_IMPLEMENTATION(Star::Graphics::Render::RenderSolution, object_serializable);
@@ -269,6 +269,7 @@ RenderPass::RenderPass(const allocator_type& alloc)
     , mGraphicsSubpasses(alloc)
     , mDependencies(alloc)
     , mRaytracingSubpasses(alloc)
+    , mAliasingBarriers(alloc)
 {}
 
 RenderPass::RenderPass(RenderPass const& rhs, const allocator_type& alloc)
@@ -279,6 +280,7 @@ RenderPass::RenderPass(RenderPass const& rhs, const allocator_type& alloc)
     , mGraphicsSubpasses(rhs.mGraphicsSubpasses, alloc)
     , mDependencies(rhs.mDependencies, alloc)
     , mRaytracingSubpasses(rhs.mRaytracingSubpasses, alloc)
+    , mAliasingBarriers(rhs.mAliasingBarriers, alloc)
 {}
 
 RenderPass::RenderPass(RenderPass&& rhs, const allocator_type& alloc)
@@ -289,6 +291,7 @@ RenderPass::RenderPass(RenderPass&& rhs, const allocator_type& alloc)
     , mGraphicsSubpasses(std::move(rhs.mGraphicsSubpasses), alloc)
     , mDependencies(std::move(rhs.mDependencies), alloc)
     , mRaytracingSubpasses(std::move(rhs.mRaytracingSubpasses), alloc)
+    , mAliasingBarriers(std::move(rhs.mAliasingBarriers), alloc)
 {}
 
 RenderPass::~RenderPass() = default;
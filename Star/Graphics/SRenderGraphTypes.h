@@ -321,6 +321,7 @@ struct STAR_GRAPHICS_API RenderPass {
     std::pmr::vector<GraphicsSubpass> mGraphicsSubpasses;
     std::pmr::vector<GraphicsSubpassDependency> mDependencies;
     std::pmr::vector<RaytracingSubpass> mRaytracingSubpasses;
+    std::pmr::vector<FramebufferHandle> mAliasingBarriers;
 };
 
 struct RenderPassDependency {
@@ -358,6 +359,11 @@ struct STAR_GRAPHICS_API RenderPipeline {
 struct Framebuffer {
     RESOURCE_DESC mResource;
     OptimizedClearColor mClear;
+    // transient framebuffers are placed in a shared heap,
+    // passes [mLifetimeBegin, mLifetimeEnd] of the solution timeline
+    bool mTransient = false;
+    uint32_t mLifetimeBegin = 0;
+    uint32_t mLifetimeEnd = 0;
 };
 
 struct STAR_GRAPHICS_API RenderSolution {
@@ -0,0 +1,239 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "STextureDDS.h"
+#include <Star/Graphics/SRenderFormatUtils.h>
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
+#include <Star/SStreamUtils.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+constexpr uint32_t makeFourCC(char c0, char c1, char c2, char c3) noexcept {
+    return uint32_t(uint8_t(c0)) | (uint32_t(uint8_t(c1)) << 8) |
+        (uint32_t(uint8_t(c2)) << 16) | (uint32_t(uint8_t(c3)) << 24);
+}
+
+constexpr uint32_t DDS_MAGIC = makeFourCC('D', 'D', 'S', ' ');
+constexpr uint32_t DDS_FOURCC = 0x00000004;
+constexpr uint32_t DDS_HEADER_FLAGS_VOLUME = 0x00800000;
+constexpr uint32_t DDS_CUBEMAP = 0x00000200;
+constexpr uint32_t DDS_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+struct DDS_PIXELFORMAT {
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+struct DDS_HEADER {
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10 {
+    uint32_t    dxgiFormat;
+    uint32_t    resourceDimension;
+    uint32_t    miscFlag;
+    uint32_t    arraySize;
+    uint32_t    miscFlags2;
+};
+
+static_assert(sizeof(DDS_PIXELFORMAT) == 32);
+static_assert(sizeof(DDS_HEADER) == 124);
+static_assert(sizeof(DDS_HEADER_DXT10) == 20);
+
+// typeless block format of a legacy FourCC
+Format getFourCCFormat(uint32_t fourCC) noexcept {
+    switch (fourCC) {
+    case makeFourCC('D', 'X', 'T', '1'): return Format::BC1_TYPELESS_BLOCK;
+    case makeFourCC('D', 'X', 'T', '2'): return Format::BC2_TYPELESS_BLOCK;
+    case makeFourCC('D', 'X', 'T', '3'): return Format::BC2_TYPELESS_BLOCK;
+    case makeFourCC('D', 'X', 'T', '4'): return Format::BC3_TYPELESS_BLOCK;
+    case makeFourCC('D', 'X', 'T', '5'): return Format::BC3_TYPELESS_BLOCK;
+    case makeFourCC('A', 'T', 'I', '1'): return Format::BC4_TYPELESS_BLOCK;
+    case makeFourCC('B', 'C', '4', 'U'): return Format::BC4_TYPELESS_BLOCK;
+    case makeFourCC('A', 'T', 'I', '2'): return Format::BC5_TYPELESS_BLOCK;
+    case makeFourCC('B', 'C', '5', 'U'): return Format::BC5_TYPELESS_BLOCK;
+    default: return Format::UNKNOWN;
+    }
+}
+
+// DXGI_FORMAT values, kept numeric so that dxgiformat.h is not required
+Format getDXGIBlockFormat(uint32_t dxgiFormat) noexcept {
+    switch (dxgiFormat) {
+    case 70: return Format::BC1_TYPELESS_BLOCK;
+    case 71: return Format::BC1_UNORM_BLOCK;
+    case 72: return Format::BC1_SRGB_BLOCK;
+    case 73: return Format::BC2_TYPELESS_BLOCK;
+    case 74: return Format::BC2_UNORM_BLOCK;
+    case 75: return Format::BC2_SRGB_BLOCK;
+    case 76: return Format::BC3_TYPELESS_BLOCK;
+    case 77: return Format::BC3_UNORM_BLOCK;
+    case 78: return Format::BC3_SRGB_BLOCK;
+    case 79: return Format::BC4_TYPELESS_BLOCK;
+    case 80: return Format::BC4_UNORM_BLOCK;
+    case 81: return Format::BC4_SNORM_BLOCK;
+    case 82: return Format::BC5_TYPELESS_BLOCK;
+    case 83: return Format::BC5_UNORM_BLOCK;
+    case 84: return Format::BC5_SNORM_BLOCK;
+    case 94: return Format::BC6H_TYPELESS_BLOCK;
+    case 95: return Format::BC6H_UFLOAT_BLOCK;
+    case 96: return Format::BC6H_SFLOAT_BLOCK;
+    case 97: return Format::BC7_TYPELESS_BLOCK;
+    case 98: return Format::BC7_UNORM_BLOCK;
+    case 99: return Format::BC7_SRGB_BLOCK;
+    default: return Format::UNKNOWN;
+    }
+}
+
+Format getViewFormat(Format typeless, bool bSrgb) noexcept {
+    if (bSrgb) {
+        auto format = makeTypelessSRGB(typeless);
+        if (format != typeless)
+            return format;
+    }
+    auto format = makeTypelessUNorm(typeless);
+    if (format != typeless)
+        return format;
+    return makeTypelessUFloat(typeless);
+}
+
+void checkStream(const std::istream& is) {
+    if (!is) {
+        throw std::runtime_error("dds file truncated");
+    }
+}
+
+}
+
+void readDDSHeader(std::istream& is, TextureData& tex, bool bSrgb) {
+    uint32_t magic = 0;
+    read_data(is, magic);
+    checkStream(is);
+    if (magic != DDS_MAGIC) {
+        throw std::runtime_error("dds magic not found");
+    }
+
+    DDS_HEADER header;
+    read_data(is, header);
+    checkStream(is);
+    if (header.size != sizeof(DDS_HEADER) || header.ddspf.size != sizeof(DDS_PIXELFORMAT)) {
+        throw std::runtime_error("dds header size invalid");
+    }
+    if (!(header.ddspf.flags & DDS_FOURCC)) {
+        throw std::runtime_error("dds uncompressed format not supported");
+    }
+    if ((header.flags & DDS_HEADER_FLAGS_VOLUME) || (header.caps2 & DDS_CUBEMAP)) {
+        throw std::runtime_error("dds volume and cubemap not supported");
+    }
+
+    Format typeless = Format::UNKNOWN;
+    Format format = Format::UNKNOWN;
+    if (header.ddspf.fourCC == makeFourCC('D', 'X', '1', '0')) {
+        DDS_HEADER_DXT10 header10;
+        read_data(is, header10);
+        checkStream(is);
+        if (header10.resourceDimension != DDS_RESOURCE_DIMENSION_TEXTURE2D ||
+            header10.arraySize > 1 || (header10.miscFlag & 0x4)) {
+            throw std::runtime_error("dds texture array not supported");
+        }
+        auto stored = getDXGIBlockFormat(header10.dxgiFormat);
+        typeless = makeTypeless(stored);
+        // saveDDS always writes unorm, colorspace comes from the asset like the legacy path
+        if (stored == typeless || stored == makeTypelessUNorm(typeless)) {
+            format = getViewFormat(typeless, bSrgb);
+        } else {
+            format = stored;
+        }
+    } else {
+        typeless = getFourCCFormat(header.ddspf.fourCC);
+        format = getViewFormat(typeless, bSrgb);
+    }
+    if (typeless == Format::UNKNOWN) {
+        throw std::runtime_error("dds format not supported");
+    }
+    if (header.width == 0 || header.height == 0) {
+        throw std::runtime_error("dds texture size invalid");
+    }
+
+    auto& desc = tex.mDesc;
+    desc.mDimension = RESOURCE_DIMENSION_TEXTURE2D;
+    desc.mAlignment = 0;
+    desc.mWidth = header.width;
+    desc.mHeight = header.height;
+    desc.mDepthOrArraySize = 1;
+    desc.mMipLevels = gsl::narrow<uint16_t>(std::max(header.mipMapCount, 1u));
+    desc.mFormat = typeless;
+    desc.mSampleDesc = { 1, 0 };
+    tex.mFormat = format;
+}
+
+void readDDSMips(std::istream& is, TextureData& tex) {
+    const auto& desc = tex.mDesc;
+    auto width = gsl::narrow_cast<uint32_t>(desc.mWidth);
+    auto height = gsl::narrow_cast<uint32_t>(desc.mHeight);
+
+    auto uploadSize = getTextureUploadSize(desc.mFormat, width, height);
+    tex.mBuffer.resize_aligned(uploadSize);
+
+    char* dstSliceBuffer = reinterpret_cast<char*>(tex.mBuffer.data());
+    for (uint32_t k = 0; k != desc.mMipLevels; ++k) {
+        auto [rowCount, rowPitch, uploadRowPitch, sliceSize, alignedSliceSize, uploadSliceSize] = getMipInfo(desc.mFormat, width, height);
+
+        // mipMapCount comes from the file, never write past the upload buffer
+        auto offset = static_cast<uint64_t>(dstSliceBuffer - reinterpret_cast<char*>(tex.mBuffer.data()));
+        if (offset + uploadSliceSize > uploadSize)
+            throw std::runtime_error("dds mip chain exceeds texture size");
+
+        auto dstPitchBuffer = dstSliceBuffer;
+        for (uint32_t i = 0; i != rowCount; ++i) {
+            is.read(dstPitchBuffer, rowPitch);
+            dstPitchBuffer += uploadRowPitch;
+        }
+        checkStream(is);
+
+        width = half_size(width);
+        height = half_size(height);
+        dstSliceBuffer += uploadSliceSize;
+    }
+}
+
+void readDDS(std::istream& is, TextureData& tex, bool bSrgb) {
+    readDDSHeader(is, tex, bSrgb);
+    readDDSMips(is, tex);
+}
+
+}
@@ -0,0 +1,35 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Graphics/SContentTypes.h>
+
+namespace Star::Graphics::Render {
+
+// DDS container, independent of DirectXTex and the Windows headers.
+// Supports legacy FourCC (DXT1-5, ATI1/ATI2, BC4U/BC5U) and DX10 extended headers,
+// single 2D surface with a mip chain.
+
+// reads magic and headers, fills tex.mDesc (typeless) and tex.mFormat (view format)
+STAR_GRAPHICS_API void readDDSHeader(std::istream& is, TextureData& tex, bool bSrgb);
+
+// reads the mip chain into tex.mBuffer, laid out as upload slices (see getMipInfo)
+STAR_GRAPHICS_API void readDDSMips(std::istream& is, TextureData& tex);
+
+STAR_GRAPHICS_API void readDDS(std::istream& is, TextureData& tex, bool bSrgb);
+
+}
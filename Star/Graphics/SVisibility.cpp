@@ -0,0 +1,228 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SVisibility.h"
+#include <immintrin.h>
+
+namespace Star::Graphics::Render {
+
+namespace {
+
+// boxes per parallel task
+constexpr uint32_t sCullGrainSize = 4096;
+
+// BoundingBox is 2 x Box3f of 2 x Vector3f, all floats without padding
+constexpr uint32_t sBoxStride = 12;
+constexpr uint32_t sWorldMinOffset = 6;
+static_assert(sizeof(BoundingBox) == sBoxStride * sizeof(float));
+
+}
+
+Frustum makeFrustum(const Matrix4f& m) noexcept {
+    // Gribb, Hartmann. clip space z is in [0, w] for Direct3D and Vulkan
+    Frustum frustum;
+    frustum.mPlanes[0] = (m.row(3) + m.row(0)).transpose(); // left
+    frustum.mPlanes[1] = (m.row(3) - m.row(0)).transpose(); // right
+    frustum.mPlanes[2] = (m.row(3) + m.row(1)).transpose(); // bottom
+    frustum.mPlanes[3] = (m.row(3) - m.row(1)).transpose(); // top
+    frustum.mPlanes[4] = m.row(2).transpose();              // near
+    frustum.mPlanes[5] = (m.row(3) - m.row(2)).transpose(); // far
+
+    for (auto& plane : frustum.mPlanes) {
+        float len = plane.head<3>().norm();
+        if (len > 0.0f) {
+            plane /= len;
+        }
+    }
+    return frustum;
+}
+
+Frustum makeFrustum(const CameraData& cam) noexcept {
+    return makeFrustum(Matrix4f(cam.mProj * cam.mView));
+}
+
+Box3f transformBounds(const Box3f& bounds, const Affine3f& transform) noexcept {
+    // Arvo, "Transforming Axis-Aligned Bounding Boxes"
+    const Vector3f center = (bounds.min_corner() + bounds.max_corner()) * 0.5f;
+    const Vector3f extent = (bounds.max_corner() - bounds.min_corner()) * 0.5f;
+
+    const Vector3f c = transform * center;
+    const Vector3f e = transform.linear().cwiseAbs() * extent;
+    return Box3f(Vector3f(c - e), Vector3f(c + e));
+}
+
+void cullBoundingBoxes(const Frustum& frustum,
+    gsl::span<const BoundingBox> boxes, uint32_t begin, uint32_t end,
+    std::pmr::vector<uint32_t>& visible
+) {
+    Expects(begin <= end);
+    Expects(end <= boxes.size());
+    if (begin == end)
+        return;
+
+    const float* base = boxes[0].mWorldBounds.min_corner().data() - sWorldMinOffset;
+    Expects(reinterpret_cast<const void*>(base) == reinterpret_cast<const void*>(&boxes[0]));
+    Expects(boxes[0].mWorldBounds.max_corner().data() == base + sWorldMinOffset + 3);
+
+    auto appendMask = [&visible](uint32_t first, uint32_t mask) {
+        for (uint32_t k = first; mask; ++k, mask >>= 1) {
+            if (mask & 1) {
+                visible.emplace_back(k);
+            }
+        }
+    };
+
+    uint32_t i = begin;
+#if defined(__AVX2__)
+    {
+        __m256 nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+        for (size_t p = 0; p != 6; ++p) {
+            const auto& plane = frustum.mPlanes[p];
+            nx[p] = _mm256_set1_ps(plane[0]);
+            ny[p] = _mm256_set1_ps(plane[1]);
+            nz[p] = _mm256_set1_ps(plane[2]);
+            nd[p] = _mm256_set1_ps(plane[3]);
+            ax[p] = _mm256_set1_ps(std::abs(plane[0]));
+            ay[p] = _mm256_set1_ps(std::abs(plane[1]));
+            az[p] = _mm256_set1_ps(std::abs(plane[2]));
+        }
+        const auto half = _mm256_set1_ps(0.5f);
+        const auto stride = _mm256_setr_epi32(0, 12, 24, 36, 48, 60, 72, 84);
+
+        for (; i + 8 <= end; i += 8) {
+            const float* p = base + size_t(i) * sBoxStride + sWorldMinOffset;
+            auto minX = _mm256_i32gather_ps(p + 0, stride, 4);
+            auto minY = _mm256_i32gather_ps(p + 1, stride, 4);
+            auto minZ = _mm256_i32gather_ps(p + 2, stride, 4);
+            auto maxX = _mm256_i32gather_ps(p + 3, stride, 4);
+            auto maxY = _mm256_i32gather_ps(p + 4, stride, 4);
+            auto maxZ = _mm256_i32gather_ps(p + 5, stride, 4);
+
+            auto cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+            auto cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+            auto cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+            auto ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+            auto ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+            auto ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+            // invalid boxes, including NaN, are kept
+            auto valid = _mm256_and_ps(
+                _mm256_and_ps(_mm256_cmp_ps(minX, maxX, _CMP_LE_OQ), _mm256_cmp_ps(minY, maxY, _CMP_LE_OQ)),
+                _mm256_cmp_ps(minZ, maxZ, _CMP_LE_OQ));
+
+            auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (size_t k = 0; k != 6; ++k) {
+                auto dist = _mm256_fmadd_ps(nx[k], cx, _mm256_fmadd_ps(ny[k], cy, _mm256_fmadd_ps(nz[k], cz, nd[k])));
+                auto radius = _mm256_fmadd_ps(ax[k], ex, _mm256_fmadd_ps(ay[k], ey, _mm256_mul_ps(az[k], ez)));
+                inside = _mm256_and_ps(inside,
+                    _mm256_cmp_ps(_mm256_add_ps(dist, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            auto mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_or_ps(inside,
+                _mm256_andnot_ps(valid, _mm256_castsi256_ps(_mm256_set1_epi32(-1))))));
+            appendMask(i, mask);
+        }
+    }
+#endif
+    {
+        __m128 nx[6], ny[6], nz[6], nd[6], ax[6], ay[6], az[6];
+        for (size_t p = 0; p != 6; ++p) {
+            const auto& plane = frustum.mPlanes[p];
+            nx[p] = _mm_set1_ps(plane[0]);
+            ny[p] = _mm_set1_ps(plane[1]);
+            nz[p] = _mm_set1_ps(plane[2]);
+            nd[p] = _mm_set1_ps(plane[3]);
+            ax[p] = _mm_set1_ps(std::abs(plane[0]));
+            ay[p] = _mm_set1_ps(std::abs(plane[1]));
+            az[p] = _mm_set1_ps(std::abs(plane[2]));
+        }
+        const auto half = _mm_set1_ps(0.5f);
+        const auto allOnes = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (; i < end; i += 4) {
+            // the tail repeats the last box, extra lanes are masked out
+            const uint32_t count = std::min(end - i, 4u);
+            std::array<const float*, 4> p;
+            for (uint32_t k = 0; k != 4; ++k) {
+                p[k] = base + size_t(i + std::min(k, count - 1)) * sBoxStride + sWorldMinOffset;
+            }
+            auto minX = _mm_setr_ps(p[0][0], p[1][0], p[2][0], p[3][0]);
+            auto minY = _mm_setr_ps(p[0][1], p[1][1], p[2][1], p[3][1]);
+            auto minZ = _mm_setr_ps(p[0][2], p[1][2], p[2][2], p[3][2]);
+            auto maxX = _mm_setr_ps(p[0][3], p[1][3], p[2][3], p[3][3]);
+            auto maxY = _mm_setr_ps(p[0][4], p[1][4], p[2][4], p[3][4]);
+            auto maxZ = _mm_setr_ps(p[0][5], p[1][5], p[2][5], p[3][5]);
+
+            auto cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+            auto cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+            auto cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+            auto ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+            auto ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+            auto ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+            auto valid = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(minX, maxX), _mm_cmple_ps(minY, maxY)),
+                _mm_cmple_ps(minZ, maxZ));
+
+            auto inside = allOnes;
+            for (size_t k = 0; k != 6; ++k) {
+                auto dist = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(nx[k], cx), _mm_mul_ps(ny[k], cy)),
+                    _mm_add_ps(_mm_mul_ps(nz[k], cz), nd[k]));
+                auto radius = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(ax[k], ex), _mm_mul_ps(ay[k], ey)),
+                    _mm_mul_ps(az[k], ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+            }
+            auto mask = static_cast<uint32_t>(_mm_movemask_ps(
+                _mm_or_ps(inside, _mm_andnot_ps(valid, allOnes))));
+            appendMask(i, mask & ((1u << count) - 1));
+        }
+    }
+}
+
+void cullBoundingBoxes(const Frustum& frustum,
+    gsl::span<const BoundingBox> boxes, std::pmr::vector<uint32_t>& visible
+) {
+    visible.clear();
+    const auto count = gsl::narrow<uint32_t>(boxes.size());
+    if (count <= sCullGrainSize) {
+        cullBoundingBoxes(frustum, boxes, 0, count, visible);
+        return;
+    }
+
+    const uint32_t taskCount = (count + sCullGrainSize - 1) / sCullGrainSize;
+    std::pmr::vector<std::pmr::vector<uint32_t>> ranges(taskCount, visible.get_allocator());
+    std::for_each(std::execution::par, ranges.begin(), ranges.end(),
+        [&](std::pmr::vector<uint32_t>& range) {
+            const auto taskID = gsl::narrow_cast<uint32_t>(&range - ranges.data());
+            const auto begin = taskID * sCullGrainSize;
+            const auto end = std::min(begin + sCullGrainSize, count);
+            range.reserve(end - begin);
+            cullBoundingBoxes(frustum, boxes, begin, end, range);
+        });
+
+    size_t sz = 0;
+    for (const auto& range : ranges) {
+        sz += range.size();
+    }
+    visible.reserve(sz);
+    for (const auto& range : ranges) {
+        visible.insert(visible.end(), range.begin(), range.end());
+    }
+}
+
+}
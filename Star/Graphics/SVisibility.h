@@ -0,0 +1,46 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <Star/Graphics/SConfig.h>
+#include <Star/Graphics/SContentTypes.h>
+
+namespace Star::Graphics::Render {
+
+// normalized planes, a point p is inside when dot(n, p) + d >= 0 for all planes
+struct Frustum {
+    std::array<Vector4f, 6> mPlanes;
+};
+
+STAR_GRAPHICS_API Frustum makeFrustum(const Matrix4f& viewProj) noexcept;
+STAR_GRAPHICS_API Frustum makeFrustum(const CameraData& cam) noexcept;
+
+STAR_GRAPHICS_API Box3f transformBounds(const Box3f& bounds, const Affine3f& transform) noexcept;
+
+// test world bounds of [begin, end), append the visible indices in order.
+// boxes with min > max (never computed) are always visible
+STAR_GRAPHICS_API void cullBoundingBoxes(const Frustum& frustum,
+    gsl::span<const BoundingBox> boxes, uint32_t begin, uint32_t end,
+    std::pmr::vector<uint32_t>& visible);
+
+// cull all boxes, large batches are split into ranges culled in parallel.
+// visible is cleared and receives the sorted visible indices
+STAR_GRAPHICS_API void cullBoundingBoxes(const Frustum& frustum,
+    gsl::span<const BoundingBox> boxes, std::pmr::vector<uint32_t>& visible);
+
+}
@@ -28,7 +28,9 @@
 #include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/sinks/text_file_backend.hpp>
+#ifdef _MSC_VER
 #include <boost/log/sinks/debug_output_backend.hpp>
+#endif
 
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
@@ -40,6 +42,21 @@
 #include <boost/log/support/date_time.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
+#include <boost/log/sinks/unlocked_frontend.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/circular_buffer.hpp>
+
+#include <Star/SLockFree.h>
+#include <Star/SCircularBuffer.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+
 namespace Star {
 
 namespace logging = boost::log;
@@ -76,6 +93,223 @@ namespace keywords = boost::log::keywords;
 //    std::cout << colorSet(h, RED) << rec[expr::smessage] << colorSet(h, GRAY);
 //}
 
+namespace {
+
+BOOST_LOG_ATTRIBUTE_KEYWORD(timestamp, "TimeStamp", boost::posix_time::ptime)
+
+const boost::posix_time::ptime sEpoch(boost::gregorian::date(1970, 1, 1));
+
+constexpr char sBinaryLogMagic[8] = { 'S', 'L', 'O', 'G', 'B', 'I', 'N', '1' };
+constexpr uint32_t sInlineMessageSize = 200;
+constexpr uint32_t sBatchSize = 256;
+
+// trivially copyable, long messages are moved to the heap and freed by the writer
+struct LogRecord {
+    int64_t mTime; // local time, microseconds since epoch
+    uint32_t mSeverity;
+    uint32_t mSize;
+    char* mHeapMessage;
+    char mInlineMessage[sInlineMessageSize];
+
+    std::string_view message() const noexcept {
+        return std::string_view(mHeapMessage ? mHeapMessage : mInlineMessage, mSize);
+    }
+};
+
+void appendText(std::string& text, int64_t time, uint32_t severity, std::string_view message) {
+    auto secondsOfDay = (time / 1000000) % 86400;
+    char header[16];
+    std::snprintf(header, sizeof(header), "[%02d:%02d:%02d] <",
+        static_cast<int>(secondsOfDay / 3600),
+        static_cast<int>(secondsOfDay / 60 % 60),
+        static_cast<int>(secondsOfDay % 60));
+    text += header;
+
+    auto name = logging::trivial::to_string(static_cast<logging::trivial::severity_level>(severity));
+    text += name ? name : "unknown";
+    text += "> ";
+    text += message;
+    text += '\n';
+}
+
+class AsyncLogBackend : public logging::sinks::basic_sink_backend<logging::sinks::concurrent_feeding> {
+public:
+    AsyncLogBackend(const char* filename, const AsyncLogSettings& settings)
+        : mSettings(settings)
+        , mRecords(settings.mCapacity)
+        , mBatch(sBatchSize, std::pmr::polymorphic_allocator<LogRecord>(&mPool))
+    {
+        if (filename && filename != std::string("")) {
+            mFile.open(filename, std::ios::out | std::ios::trunc |
+                (settings.mBinary ? std::ios::binary : std::ios::openmode{}));
+            if (!mFile) {
+                throw std::runtime_error("log file open failed");
+            }
+            if (settings.mBinary) {
+                mFile.write(sBinaryLogMagic, sizeof(sBinaryLogMagic));
+            }
+        }
+        mWriter = std::thread([this]() { run(); });
+    }
+
+    ~AsyncLogBackend() {
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            mStopped.store(true, std::memory_order_release);
+        }
+        mWakeUp.notify_one();
+        mWriter.join();
+    }
+
+    // caller thread, never formats or touches the streams
+    void consume(const logging::record_view& rec) {
+        LogRecord r;
+        auto time = rec[timestamp];
+        r.mTime = ((time ? *time : boost::posix_time::microsec_clock::local_time()) - sEpoch)
+            .total_microseconds();
+        auto severity = rec[logging::trivial::severity];
+        r.mSeverity = severity ? *severity : logging::trivial::info;
+
+        std::string_view message;
+        if (auto msg = rec[expr::smessage]) {
+            message = *msg;
+        }
+        r.mSize = static_cast<uint32_t>(message.size());
+        r.mHeapMessage = nullptr;
+        if (message.size() > sInlineMessageSize) {
+            r.mHeapMessage = new char[message.size()];
+            std::memcpy(r.mHeapMessage, message.data(), message.size());
+        } else {
+            std::memcpy(r.mInlineMessage, message.data(), message.size());
+        }
+
+        while (!mRecords.bounded_push(r)) {
+            if (mSettings.mOverflow == LogOverflowPolicy::Block) {
+                std::this_thread::yield();
+                continue;
+            }
+            delete[] r.mHeapMessage;
+            if (mSettings.mOverflow == LogOverflowPolicy::Count) {
+                mDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+
+        // pairs with the fence in run(), either the writer sees the record
+        // or we see it sleeping. The mutex is only taken to wake it up
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mSleeping.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+                mSleeping.store(false, std::memory_order_relaxed);
+            }
+            mWakeUp.notify_one();
+        }
+    }
+
+private:
+    void run() {
+        for (;;) {
+            // records pushed before the stop request are drained before leaving
+            bool bStopped = mStopped.load(std::memory_order_acquire);
+
+            LogRecord r;
+            while (!mBatch.full() && mRecords.pop(r)) {
+                mBatch.push_back(r);
+            }
+
+            auto dropped = mDropped.exchange(0, std::memory_order_relaxed);
+            if (mBatch.empty() && !dropped) {
+                if (bStopped)
+                    break;
+                // sleep until consume pushes a record or the backend stops
+                std::unique_lock<std::mutex> lock(mMutex);
+                mSleeping.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!mRecords.empty() || mStopped.load(std::memory_order_acquire)) {
+                    mSleeping.store(false, std::memory_order_relaxed);
+                    continue;
+                }
+                mWakeUp.wait(lock, [this]() {
+                    return !mSleeping.load(std::memory_order_relaxed) ||
+                        mStopped.load(std::memory_order_acquire);
+                });
+                mSleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+
+            write(dropped);
+
+            for (const auto& rec : mBatch) {
+                delete[] rec.mHeapMessage;
+            }
+            mBatch.clear();
+        }
+    }
+
+    void write(uint64_t dropped) {
+        mText.clear();
+        for (const auto& rec : mBatch) {
+            appendText(mText, rec.mTime, rec.mSeverity, rec.message());
+        }
+        if (dropped) {
+            auto time = (boost::posix_time::microsec_clock::local_time() - sEpoch).total_microseconds();
+            appendText(mText, time, logging::trivial::warning,
+                std::to_string(dropped) + " log records dropped");
+        }
+
+        std::clog.write(mText.data(), mText.size());
+
+        if (mFile.is_open()) {
+            if (mSettings.mBinary) {
+                mBinary.clear();
+                for (const auto& rec : mBatch) {
+                    auto message = rec.message();
+                    uint8_t severity = static_cast<uint8_t>(rec.mSeverity);
+                    mBinary.append(reinterpret_cast<const char*>(&rec.mTime), sizeof(rec.mTime));
+                    mBinary.append(reinterpret_cast<const char*>(&severity), sizeof(severity));
+                    mBinary.append(reinterpret_cast<const char*>(&rec.mSize), sizeof(rec.mSize));
+                    mBinary.append(message.data(), message.size());
+                }
+                mFile.write(mBinary.data(), mBinary.size());
+            } else {
+                mFile.write(mText.data(), mText.size());
+            }
+            mFile.flush();
+        }
+
+#ifdef _MSC_VER
+        if (IsDebuggerPresent()) {
+            mBinary.clear();
+            for (const auto& rec : mBatch) {
+                mBinary += rec.message();
+                mBinary += "\r\n";
+            }
+            OutputDebugStringA(mBinary.c_str());
+        }
+#endif
+    }
+
+    AsyncLogSettings mSettings;
+    MessageQueue<LogRecord, 64> mRecords;
+    std::atomic_uint64_t mDropped = 0;
+    std::atomic_bool mStopped = false;
+    std::atomic_bool mSleeping = false;
+
+    // writer thread only
+    std::pmr::unsynchronized_pool_resource mPool;
+    pmr_circular_buffer<LogRecord> mBatch;
+    std::string mText;
+    std::string mBinary;
+    std::ofstream mFile;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+    std::thread mWriter;
+};
+
+}
+
 void initLogging(boost::log::trivial::severity_level level, const char* filename) {
 
     boost::log::aux::add_console_log(std::clog, 
@@ -100,11 +334,30 @@ void initLogging(boost::log::trivial::severity_level level, const char* filename
 
     boost::log::add_common_attributes();
 
+    auto core = logging::core::get();
+
+#ifdef _MSC_VER
     typedef logging::sinks::synchronous_sink< logging::sinks::debug_output_backend > sink_t;
     boost::shared_ptr< sink_t > sink(new sink_t());
     sink->set_filter(expr::is_debugger_present());
     sink->set_formatter(expr::stream << expr::smessage << "\r\n");
 
+    core->add_sink(sink);
+#endif
+
+    core->set_filter(
+        logging::trivial::severity >= level
+    );
+}
+
+void initAsyncLogging(boost::log::trivial::severity_level level, const char* filename,
+    const AsyncLogSettings& settings
+) {
+    boost::log::add_common_attributes();
+
+    typedef logging::sinks::unlocked_sink<AsyncLogBackend> sink_t;
+    boost::shared_ptr<sink_t> sink(new sink_t(boost::make_shared<AsyncLogBackend>(filename, settings)));
+
     auto core = logging::core::get();
     core->add_sink(sink);
 
@@ -117,4 +370,34 @@ void exitLogging() {
     logging::core::get()->remove_all_sinks();
 }
 
-}
\ No newline at end of file
+void decodeLogFile(std::istream& is, std::ostream& os) {
+    char magic[sizeof(sBinaryLogMagic)] = {};
+    is.read(magic, sizeof(magic));
+    if (!is || std::memcmp(magic, sBinaryLogMagic, sizeof(magic)) != 0) {
+        throw std::runtime_error("not a binary log file");
+    }
+
+    std::string message;
+    std::string text;
+    for (;;) {
+        int64_t time = 0;
+        uint8_t severity = 0;
+        uint32_t size = 0;
+        is.read(reinterpret_cast<char*>(&time), sizeof(time));
+        if (is.gcount() == 0)
+            break;
+        is.read(reinterpret_cast<char*>(&severity), sizeof(severity));
+        is.read(reinterpret_cast<char*>(&size), sizeof(size));
+        message.resize(size);
+        is.read(message.data(), size);
+        if (!is) {
+            throw std::runtime_error("binary log file truncated");
+        }
+
+        text.clear();
+        appendText(text, time, severity, message);
+        os.write(text.data(), text.size());
+    }
+}
+
+}
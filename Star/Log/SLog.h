@@ -19,14 +19,40 @@
 #include <Star/Log/SConfig.h>
 #include <boost/log/trivial.hpp>
 
+#include <cstdint>
+#include <iosfwd>
+
 namespace Star {
+
+enum class LogOverflowPolicy : uint32_t {
+    Drop,   // discard records when the queue is full
+    Block,  // wait until the writer thread catches up
+    Count,  // discard records, the writer reports how many were lost
+};
+
+struct AsyncLogSettings {
+    // records in flight, preallocated
+    uint32_t mCapacity = 4096;
+    LogOverflowPolicy mOverflow = LogOverflowPolicy::Count;
+    // write compact binary records to the log file, see decodeLogFile
+    bool mBinary = false;
+};
     
 void STAR_LOG_API initLogging(
     boost::log::trivial::severity_level level = boost::log::trivial::info, 
     const char* filename  ="");
 
+// records are queued lock-free, formatted and written in batches by a background thread
+void STAR_LOG_API initAsyncLogging(
+    boost::log::trivial::severity_level level = boost::log::trivial::info,
+    const char* filename = "",
+    const AsyncLogSettings& settings = {});
+
 void STAR_LOG_API exitLogging();
 
+// converts a binary log file to the text format
+void STAR_LOG_API decodeLogFile(std::istream& is, std::ostream& os);
+
 }
 
 //#ifndef _DEBUG
@@ -97,6 +97,36 @@ inline std::pair<uint32_t, bool> find_msb(uint64_t mask) {
 
 #endif
 
+#else // _MSC_VER
+
+inline uint32_t log2i_intrinsic(uint32_t num) noexcept {
+    return num ? 31u - gsl::narrow_cast<uint32_t>(__builtin_clz(num)) : 0u;
+}
+
+inline std::pair<uint32_t, bool> find_lsb(uint32_t mask) {
+    if (!mask)
+        return std::pair(0u, false);
+    return std::pair(gsl::narrow_cast<uint32_t>(__builtin_ctz(mask)), true);
+}
+
+inline std::pair<uint32_t, bool> find_msb(uint32_t mask) {
+    if (!mask)
+        return std::pair(0u, false);
+    return std::pair(31u - gsl::narrow_cast<uint32_t>(__builtin_clz(mask)), true);
+}
+
+inline std::pair<uint32_t, bool> find_lsb(uint64_t mask) {
+    if (!mask)
+        return std::pair(0u, false);
+    return std::pair(gsl::narrow_cast<uint32_t>(__builtin_ctzll(mask)), true);
+}
+
+inline std::pair<uint32_t, bool> find_msb(uint64_t mask) {
+    if (!mask)
+        return std::pair(0u, false);
+    return std::pair(63u - gsl::narrow_cast<uint32_t>(__builtin_clzll(mask)), true);
+}
+
 #endif // _MSC_VER
 
 }
@@ -17,6 +17,7 @@
 
 #pragma once
 #include <filesystem>
+#include <fstream>
 #include <sstream>
 #include <memory>
 #include <string>
@@ -41,7 +42,7 @@ inline std::string readFile(const std::filesystem::path& file) {
 }
 
 inline void readFileBuffer(std::string_view file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
+    std::ifstream ifs(std::filesystem::path(file), std::ios::binary);
     ifs.exceptions(std::ifstream::failbit);
 
     auto sz = getFileSize(ifs);
@@ -50,7 +51,7 @@ inline void readFileBuffer(std::string_view file, std::pmr::string& buffer) {
 }
 
 inline void readFileBuffer(std::wstring_view file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
+    std::ifstream ifs(std::filesystem::path(file), std::ios::binary);
     ifs.exceptions(std::ifstream::failbit);
 
     auto sz = getFileSize(ifs);
@@ -82,14 +83,14 @@ inline bool copyFile(const std::filesystem::path& src, const std::filesystem::pa
 }
 
 inline std::string readBinary(std::string_view file) {
-    std::ifstream ifs(file, std::ios::binary);
+    std::ifstream ifs(std::filesystem::path(file), std::ios::binary);
     std::stringstream buffer;
     buffer << ifs.rdbuf();
     return buffer.str();
 }
 
 inline void readBinary(std::string_view file, std::pmr::string& buffer) {
-    std::ifstream ifs(file, std::ios::binary);
+    std::ifstream ifs(std::filesystem::path(file), std::ios::binary);
     auto sz = getFileSize(ifs);
     buffer.resize(sz);
     ifs.read(buffer.data(), sz);
@@ -98,7 +99,7 @@ inline void readBinary(std::string_view file, std::pmr::string& buffer) {
 inline bool updateBinary(std::string_view file, std::string_view content) {
     std::string orig = readBinary(file);
     if (orig != content) {
-        std::ofstream ofs(file, std::ios::binary);
+        std::ofstream ofs(std::filesystem::path(file), std::ios::binary);
         ofs.exceptions(std::ostream::failbit);
         ofs.write(content.data(), content.size());
         return true;
@@ -23,8 +23,8 @@ template<class Tag, class Key, typename Value, typename IndexSpecifierList, type
 const Value& at(const boost::multi_index::multi_index_container<Value,
     IndexSpecifierList, Allocator>& container, const Key& key
 ) {
-    auto iter = container.get<Tag>().find(key);
-    if (iter != container.get<Tag>().end()) {
+    auto iter = container.template get<Tag>().find(key);
+    if (iter != container.template get<Tag>().end()) {
         return *iter;
     }
     throw std::runtime_error("multi_index value not found");
@@ -45,8 +45,8 @@ template<class Tag, class Key, typename Value, typename IndexSpecifierList, type
 bool exists(const boost::multi_index::multi_index_container<Value,
     IndexSpecifierList, Allocator>& container, const Key& key
 ) {
-    auto iter = container.get<Tag>().find(key);
-    if (iter != container.get<Tag>().end()) {
+    auto iter = container.template get<Tag>().find(key);
+    if (iter != container.template get<Tag>().end()) {
         return true;
     }
     return false;
@@ -67,10 +67,10 @@ template<class Tag, class Key, typename Value, typename IndexSpecifierList, type
 uint32_t index(const boost::multi_index::multi_index_container<Value,
     IndexSpecifierList, Allocator>& container, const Key& key
 ) {
-    auto iter = container.get<Tag>().find(key);
-    if (iter != container.get<Tag>().end()) {
+    auto iter = container.template get<Tag>().find(key);
+    if (iter != container.template get<Tag>().end()) {
         return gsl::narrow<uint32_t>(
-            std::distance(container.get<Index::Index>().begin(), container.project<Index::Index>(iter)));
+            std::distance(container.template get<Index::Index>().begin(), container.template project<Index::Index>(iter)));
     }
     throw std::runtime_error("multi_index value not found");
 }
@@ -82,7 +82,7 @@ uint32_t index(const boost::multi_index::multi_index_container<Value,
     auto iter = container.find(key);
     if (iter != container.end()) {
         return gsl::narrow<uint32_t>(
-            std::distance(container.get<Index::Index>().begin(), container.project<Index::Index>(iter)));
+            std::distance(container.template get<Index::Index>().begin(), container.template project<Index::Index>(iter)));
     }
     throw std::runtime_error("multi_index value not found");
 }
@@ -32,7 +32,7 @@ void read_data(std::istream& is, T& value) {
 
 template<class T>
 void read_data(std::istream& is, T* data, size_t objcount) {
-    return is.read(reinterpret_cast<char*>(data), sizeof(T) * objcount);
+    is.read(reinterpret_cast<char*>(data), sizeof(T) * objcount);
 }
 
 template<class T, class Traits, class Alloc>
@@ -16,5 +16,20 @@
 // along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "SPmrBinaryInArchive.h"
+#include <boost/archive/detail/archive_serializer_map.hpp>
+
+// explicitly instantiate for this type of binary stream
+#include <boost/archive/impl/archive_serializer_map.ipp>
 #include <boost/archive/impl/basic_binary_iprimitive.ipp>
 #include <boost/archive/impl/basic_binary_iarchive.ipp>
+
+namespace boost {
+namespace archive {
+
+template class detail::archive_serializer_map<Star::PmrBinaryInArchive>;
+template class basic_binary_iprimitive<Star::PmrBinaryInArchive, std::istream::char_type, std::istream::traits_type>;
+template class basic_binary_iarchive<Star::PmrBinaryInArchive>;
+template class binary_iarchive_impl<Star::PmrBinaryInArchive, std::istream::char_type, std::istream::traits_type>;
+
+} // namespace archive
+} // namespace boost
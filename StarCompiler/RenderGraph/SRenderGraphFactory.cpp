@@ -25,6 +25,8 @@
 #include <Star/Graphics/SRenderGraphReflection.h>
 #include <StarCompiler/ShaderGraph/SShaderModules.h>
 #include <Star/Graphics/SRenderUtils.h>
+#include <Star/Graphics/SRenderGraphAliasing.h>
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
 #include <StarCompiler/ShaderGraph/SShaderTypes.h>
 
 namespace Star {
@@ -33,6 +35,27 @@ namespace Graphics {
 
 namespace Render {
 
+namespace {
+
+// the device reports the exact placement size, this is only used for the report
+TransientResourceDesc estimateTransientResource(const Framebuffer& fb) {
+    const auto& desc = fb.mResource;
+    const uint32_t width = gsl::narrow<uint32_t>(desc.mWidth);
+    uint64_t size = 0;
+    for (uint32_t mip = 0; mip != std::max<uint32_t>(desc.mMipLevels, 1); ++mip) {
+        size += getMipSize(desc.mFormat, std::max(1u, width >> mip), std::max(1u, desc.mHeight >> mip));
+    }
+    size *= desc.mDepthOrArraySize * std::max(1u, desc.mSampleDesc.mCount);
+
+    const uint64_t alignment = desc.mSampleDesc.mCount > 1 ? 4 * 1024 * 1024 : 64 * 1024;
+    return TransientResourceDesc{
+        fb.mLifetimeBegin, fb.mLifetimeEnd,
+        boost::alignment::align_up(size, alignment), alignment
+    };
+}
+
+}
+
 void RenderSolutionFactory::addPipeline(GraphicsRenderNodeGraph&& graph) {
     auto name = graph.mName;
     mGraphOrder.emplace_back(name);
@@ -347,6 +370,109 @@ void RenderSolutionFactory::buildFramebuffers(
     }
 }
 
+void RenderSolutionFactory::buildTransientFramebuffers(
+    const OrderedNameMap<RenderTargetResource>& bbs,
+    const std::map<std::string, uint32_t>& rtIndex,
+    RenderSolution& sl,
+    lifetime_map& lifetimes
+) const {
+    Expects(lifetimes.empty());
+
+    // a render target is transient if every pipeline overwrites it in the pass it is first used,
+    // its content never crosses frames or pipelines, so it can alias other transient targets
+    std::map<std::string, bool> transient;
+    for (const auto& [graphName, graph] : mNodeGraphs) {
+        auto& graphLifetimes = lifetimes[graphName];
+        const auto passCount = gsl::narrow<uint32_t>(graph.mNodeSorted.size());
+
+        // passes are executed in reverse sorted order
+        for (uint32_t passID = 0; passID != passCount; ++passID) {
+            const auto& node = graph.mNodeGraph[graph.mNodeSorted[passCount - 1 - passID]];
+
+            auto use = [&](const RenderValue& v, bool bOutput) {
+                if (exists(bbs, v.mName))
+                    return;
+
+                auto res = graphLifetimes.emplace(v.mName, std::pair(passID, passID));
+                res.first->second.second = passID;
+                if (res.first->second.first != passID)
+                    return;
+
+                bool bOverwrite = bOutput && visit(overload(
+                    [](const Load_&) { return false; },
+                    [](const auto&) { return true; }
+                ), v.mLoadOp);
+                bOverwrite = bOverwrite && (
+                    std::holds_alternative<RenderTarget_>(v.mState) ||
+                    std::holds_alternative<DepthWrite_>(v.mState));
+
+                auto iter = transient.emplace(v.mName, true).first;
+                iter->second = iter->second && bOverwrite;
+            };
+
+            for (const auto& output : node.mOutputs) {
+                use(output, true);
+            }
+            for (const auto& input : node.mInputs) {
+                use(input, false);
+            }
+        }
+    }
+
+    for (auto& [graphName, graphLifetimes] : lifetimes) {
+        for (auto iter = graphLifetimes.begin(); iter != graphLifetimes.end();) {
+            if (transient.at(iter->first)) {
+                ++iter;
+            } else {
+                iter = graphLifetimes.erase(iter);
+            }
+        }
+    }
+
+    // pipelines are laid out one after another on the solution timeline
+    uint32_t passOffset = 0;
+    for (const auto& graphName : mGraphOrder) {
+        const auto& graph = mNodeGraphs.at(graphName);
+        auto& pipeline = sl.mPipelines.at(at(sl.mPipelineIndex, graphName));
+
+        for (const auto& [name, passes] : lifetimes.at(graphName)) {
+            const auto handle = rtIndex.at(name);
+            auto& fb = sl.mFramebuffers.at(handle);
+            const auto begin = passOffset + passes.first;
+            const auto end = passOffset + passes.second;
+            if (fb.mTransient) {
+                fb.mLifetimeBegin = std::min(fb.mLifetimeBegin, begin);
+                fb.mLifetimeEnd = std::max(fb.mLifetimeEnd, end);
+            } else {
+                fb.mTransient = true;
+                fb.mLifetimeBegin = begin;
+                fb.mLifetimeEnd = end;
+            }
+            const auto& node = graph.mNodeGraph[graph.mNodeSorted[graph.mNodeSorted.size() - 1 - passes.first]];
+            const auto& subpassIndex = at(pipeline.mSubpassIndex, node.mName);
+            pipeline.mPasses.at(subpassIndex.mPassID).mAliasingBarriers.emplace_back(FramebufferHandle{ handle });
+        }
+        passOffset += gsl::narrow<uint32_t>(graph.mNodeSorted.size());
+    }
+
+    // report
+    std::vector<TransientResourceDesc> descs;
+    uint64_t dedicatedSize = 0;
+    for (const auto& fb : sl.mFramebuffers) {
+        if (!fb.mTransient)
+            continue;
+        descs.emplace_back(estimateTransientResource(fb));
+        // a committed resource takes whole alignment units as well
+        dedicatedSize += boost::alignment::align_up(descs.back().mSize, descs.back().mAlignment);
+    }
+    std::vector<uint64_t> offsets(descs.size());
+    auto heapSize = placeTransientResources(descs, offsets);
+
+    std::cout << "transient framebuffers: " << descs.size()
+        << ", dedicated: " << (dedicatedSize >> 10) << " KB"
+        << ", aliased: " << (heapSize >> 10) << " KB" << std::endl;
+}
+
 void RenderSolutionFactory::collectRTVsMinimal(
     size_t rtvOffset,
     const OrderedNameMap<RenderTargetResource>& bbs,
@@ -589,6 +715,9 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
     std::map<std::string, uint32_t> rtIndex;
     buildFramebuffers(bbs, rts, sl, rtIndex);
 
+    lifetime_map transientLifetimes;
+    buildTransientFramebuffers(bbs, rtIndex, sl, transientLifetimes);
+
     // rtvs
     OrderedIdentityMap<GraphicsRenderNodeGraph::rtv_type> rtvs;
     std::map<rtv_key, size_t> rtvIndex;
@@ -745,6 +874,29 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
             }
         }
 
+        const auto& graphLifetimes = transientLifetimes.at(graphName);
+        const auto passCount = gsl::narrow<uint32_t>(graph.mNodeSorted.size());
+
+        // transient targets start every frame in the state they are first written
+        {
+            size_t rtvID = 0;
+            for (const auto& rtv : rtvs) {
+                if (graphLifetimes.find(std::get<0>(rtv)) != graphLifetimes.end()) {
+                    pipeline.mRTVInitialStates[rtvOffset + rtvID] = buildResourceStates({ RenderTarget });
+                }
+                ++rtvID;
+            }
+        }
+        {
+            size_t dsvID = 0;
+            for (const auto& dsv : dsvs) {
+                if (graphLifetimes.find(std::get<0>(dsv)) != graphLifetimes.end()) {
+                    pipeline.mDSVInitialStates[dsvID] = buildResourceStates({ DepthWrite });
+                }
+                ++dsvID;
+            }
+        }
+
         for (size_t k = graph.mNodeSorted.size(); k --> 0;) {
             bool bOutput = (k == 0);
             const auto& nodeID = graph.mNodeSorted[k];
@@ -1043,8 +1195,24 @@ void RenderSolutionFactory::build(const Shader::AttributeDatabase& attrs, std::s
             //}
 
             for (const auto& path : graph.mViewStates) {
+                // transient targets must be back in their first state after their last use,
+                // move the wrap-around transition there, so the next aliasing barrier can discard it
+                const std::pair<uint32_t, uint32_t>* transientPasses = nullptr;
+                if (auto iter = graphLifetimes.find(path.first.first); iter != graphLifetimes.end()) {
+                    transientPasses = &iter->second;
+                }
+
                 for (const auto& trans : path.second.mTransitions) {
-                    if (trans.mNodeID != nodeID)
+                    auto transNodeID = trans.mNodeID;
+                    if (transientPasses) {
+                        auto iter = std::find(graph.mNodeSorted.begin(), graph.mNodeSorted.end(), transNodeID);
+                        Expects(iter != graph.mNodeSorted.end());
+                        auto passID = passCount - 1 - gsl::narrow<uint32_t>(iter - graph.mNodeSorted.begin());
+                        if (passID < transientPasses->first || passID > transientPasses->second) {
+                            transNodeID = graph.mNodeSorted[passCount - 1 - transientPasses->second];
+                        }
+                    }
+                    if (transNodeID != nodeID)
                         continue;
                     auto resourceKey = path.first;
 
@@ -39,6 +39,9 @@ public:
     using cbv_srv_uav_key = std::tuple<std::string/*graphName*/, size_t/*nodeID*/,
         ShaderDescriptorType, std::string, ResourceDataView, PixelModel>;
 
+    using lifetime_map = std::map<std::string/*graphName*/,
+        std::map<std::string/*rtName*/, std::pair<uint32_t, uint32_t>/*passes*/>>;
+
     RenderSolutionFactory(std::string name)
         : mName(std::move(name))
     {}
@@ -75,6 +78,13 @@ private:
         std::map<std::string, uint32_t>& rtIndex
     ) const;
 
+    void buildTransientFramebuffers(
+        const OrderedNameMap<RenderTargetResource>& bbs,
+        const std::map<std::string, uint32_t>& rtIndex,
+        RenderSolution& renderWorks,
+        lifetime_map& lifetimes
+    ) const;
+
     void collectRTVsMinimal(
         size_t rtvOffset,
         const OrderedNameMap<RenderTargetResource>& bbs,
@@ -371,7 +371,8 @@ tangentToWorld2 = half4(worldTangent.z, worldBinormal.z, worldNormal.z, 0.0h);
         Inputs{
             { "uv", float2, TEXCOORD },
         },
-        Content{ R"(tangentNormal = NormalMap.Sample(LinearSampler, uv).xyz * 2 - 1;
+        Content{ R"(tangentNormal.xy = NormalMap.Sample(LinearSampler, uv).xy * 2 - 1;
+tangentNormal.z = sqrt(saturate(1 - dot(tangentNormal.xy, tangentNormal.xy)));
 )" }
     );
 
@@ -23,6 +23,7 @@
 #include <StarCompiler/ShaderGraph/SShaderDescriptor.h>
 #include <StarCompiler/ShaderGraph/SShaderNames.h>
 #include <StarCompiler/Graphics/SRenderNames.h>
+#include <Star/Graphics/SObjectConstants.h>
 
 namespace Star::Graphics::Render::Shader {
 
@@ -190,14 +191,61 @@ void outputAttribute(std::ostream& oss, std::string& space,
     ), attr.mDescriptor.mBoundedness);
 }
 
+// per-instance constants of a vertex shader, one array per object constant indexed by SV_InstanceID
+struct InstanceArray {
+    uint32_t mMaxInstanceCount = 0;
+    std::ostringstream mLoads; // body of loadPerInstance
+};
+
+void outputInstanceArray(std::ostream& oss, const ConstantBuffer& cb,
+    uint32_t slotID, uint32_t spaceID, const DescriptorIndex& index, InstanceArray& instances
+) {
+    if (!std::holds_alternative<VS_>(index.mVisibility)) {
+        throw std::runtime_error("per-instance constants must be read in vertex shader");
+    }
+    if (instances.mMaxInstanceCount != sMaxInstanceCount) {
+        throw std::runtime_error("per-instance constants are laid out for sMaxInstanceCount instances");
+    }
+    for (const auto& c : cb.mValues) {
+        if (std::find(sObjectConstantNames.begin(), sObjectConstantNames.end(), c.mName) == sObjectConstantNames.end()) {
+            throw std::runtime_error("per-instance constant " + c.mName + " is not an object constant");
+        }
+    }
+
+    // every array of the object constant stripe is declared, so offsets match the packed block
+    oss << "cbuffer " << getName(index.mUpdate) << " : register(b" << slotID;
+    if (spaceID) {
+        oss << ", space" << spaceID;
+    }
+    oss << ") {\n";
+    for (const auto& name : sObjectConstantNames) {
+        oss << "    float4x4 g" << name << "[" << instances.mMaxInstanceCount << "];\n";
+    }
+    oss << "};\n";
+
+    // modules read the constants of the current instance as globals
+    for (const auto& c : cb.mValues) {
+        oss << "static " << getHLSLName(c.mType) << " m" << c.mName << ";\n";
+        instances.mLoads << "    m" << c.mName << " = g" << c.mName << "[instanceID];\n";
+    }
+}
+
 void outputAttribute(std::ostream& oss, std::string& space,
     const ShaderAttribute& attr, uint32_t& slotID, uint32_t spaceID,
     const ShaderGroup& parent,
     const DescriptorIndex& index,
-    const RootSignature* pRSG = nullptr
+    const RootSignature* pRSG = nullptr,
+    InstanceArray* pInstances = nullptr
 ) {
     visit(overload(
         [&](CBuffer_) {
+            const auto& cb = pRSG ? pRSG->mDatabase.mConstantBuffers.at(index)
+                : parent.getConstantBuffer(index);
+            if (pInstances && index.mUpdate == PerInstance) {
+                outputInstanceArray(oss, cb, slotID, spaceID, index, *pInstances);
+                slotID += getDescriptorCapacity(attr);
+                return;
+            }
             oss << "cbuffer " << getName(index.mUpdate) << " : register(b"
                 << slotID;
             if (spaceID) {
@@ -206,16 +254,8 @@ void outputAttribute(std::ostream& oss, std::string& space,
             oss << ") {\n";
             {
                 INDENT();
-                if (pRSG) {
-                    const auto& cb = pRSG->mDatabase.mConstantBuffers.at(index);
-                    for (const auto& c : cb.mValues) {
-                        oss << space << getHLSLName(c.mType) << " m" << c.mName << ";\n";
-                    }
-                } else {
-                    const auto& cb = parent.getConstantBuffer(index);
-                    for (const auto& c : cb.mValues) {
-                        oss << space << getHLSLName(c.mType) << " m" << c.mName << ";\n";
-                    }
+                for (const auto& c : cb.mValues) {
+                    oss << space << getHLSLName(c.mType) << " m" << c.mName << ";\n";
                 }
             }
             oss << "};\n";
@@ -298,7 +338,7 @@ void outputAttribute(std::ostream& oss, std::string& space,
 
 void outputAttributes(std::ostream& oss, std::string& space, const ShaderGroup& parent,
     const DescriptorList& list, const DescriptorIndex& index,
-    const RootSignature* pRSG = nullptr
+    const RootSignature* pRSG = nullptr, InstanceArray* pInstances = nullptr
 ) {
     for (const auto& rangePair : list.mRanges) {
         const auto& type = rangePair.first;
@@ -312,7 +352,7 @@ void outputAttributes(std::ostream& oss, std::string& space, const ShaderGroup&
             const auto& subrange = subrangePair.second;
             oss << "// " << getVariantName(source) << "\n";
             for (const auto& attr : subrange.mAttributes) {
-                outputAttribute(oss, space, attr, slotID, spaceID, parent, index, pRSG);
+                outputAttribute(oss, space, attr, slotID, spaceID, parent, index, pRSG, pInstances);
             }
         }
         Ensures(slotID - range.mStart <= range.mCount);
@@ -323,7 +363,7 @@ void outputAttributes(std::ostream& oss, std::string& space, const ShaderGroup&
         oss << "// " << getVariantName(unbounded.mAttribute.mDescriptor.mSource) << "\n";
         auto slotID = unbounded.mStart;
         auto spaceID = unbounded.mSpace;
-        outputAttribute(oss, space, unbounded.mAttribute, slotID, spaceID, parent, index, pRSG);
+        outputAttribute(oss, space, unbounded.mAttribute, slotID, spaceID, parent, index, pRSG, pInstances);
     }
 }
 
@@ -337,6 +377,9 @@ std::string HLSLGenerator::generateAttributes(const AttributeMap& attrs,
     std::ostringstream oss;
     std::string space;
     int count = 0;
+    InstanceArray instances;
+    instances.mMaxInstanceCount = mMaxInstanceCount;
+    InstanceArray* pInstances = isInstanced(stage) ? &instances : nullptr;
     for (int i = UpdateEnum::UpdateCount; i --> static_cast<int>(rsgGroup.mUpdateFrequency);) {
         for (const auto& collectionPair : rsgGroup.mRootSignature.mDatabase.mDescriptors) {
             const auto& index = collectionPair.first;
@@ -355,13 +398,13 @@ std::string HLSLGenerator::generateAttributes(const AttributeMap& attrs,
             for (const auto& listPair : collection.mResourceViewLists) {
                 const auto& spaceName = listPair.first;
                 const auto& list = listPair.second;
-                outputAttributes(oss, space, rsgGroup, list, index);
+                outputAttributes(oss, space, rsgGroup, list, index, nullptr, pInstances);
             }
 
             for (const auto& listPair : collection.mSamplerLists) {
                 const auto& spaceName = listPair.first;
                 const auto& list = listPair.second;
-                outputAttributes(oss, space, rsgGroup, list, index);
+                outputAttributes(oss, space, rsgGroup, list, index, nullptr, pInstances);
             }
         }
     }
@@ -384,20 +427,41 @@ std::string HLSLGenerator::generateAttributes(const AttributeMap& attrs,
             for (const auto& listPair : collection.mResourceViewLists) {
                 const auto& spaceName = listPair.first;
                 const auto& list = listPair.second;
-                outputAttributes(oss, space, rsgGroup, list, index, &rsg);
+                outputAttributes(oss, space, rsgGroup, list, index, &rsg, pInstances);
             }
 
             for (const auto& listPair : collection.mSamplerLists) {
                 const auto& spaceName = listPair.first;
                 const auto& list = listPair.second;
-                outputAttributes(oss, space, rsgGroup, list, index, &rsg);
+                outputAttributes(oss, space, rsgGroup, list, index, &rsg, pInstances);
             }
         }
     }
 
+    // called first in main, empty if the stage reads no per-instance constants
+    if (pInstances) {
+        if (count)
+            oss << "\n";
+        oss << "void loadPerInstance(uint instanceID) {\n";
+        oss << instances.mLoads.str();
+        oss << "}\n";
+    }
+
     return oss.str();
 }
 
+bool HLSLGenerator::isInstanced(const ShaderStageType& stage) const noexcept {
+    return mMaxInstanceCount && std::holds_alternative<VS_>(stage);
+}
+
+const ShaderSemanticValue* HLSLGenerator::getInstanceIDInput(const ShaderStageType& stage) const {
+    for (const auto& v : mInputs.at(stage)) {
+        if (std::holds_alternative<SV_InstanceID_>(v.mSemantic))
+            return &v;
+    }
+    return nullptr;
+}
+
 std::string HLSLGenerator::renameAttributes(const ShaderModule& node) const {
     auto content = std::string(getContent(node));
     for (const auto& attr : node.mAttributes) {
@@ -495,7 +559,15 @@ std::string HLSLGenerator::generateMain(const ShaderStageType& stage) const {
         copyString(oss, space, generateMainSignature(shader, declared) + " {\n");
     }
 
-    INDENT();    
+    INDENT();
+    if (isInstanced(stage)) {
+        if (auto pInstanceID = getInstanceIDInput(stage)) {
+            OSS << "loadPerInstance(" << mNamings.at(stage).mInputVariable
+                << "." << pInstanceID->mName << ");\n";
+        } else {
+            OSS << "loadPerInstance(instanceID);\n";
+        }
+    }
     copyString(oss, space, generateInputCopy(shader, declared));
     
     int count = 0;
@@ -530,12 +602,16 @@ std::string HLSLGenerator::generateMainSignature(const ShaderStage& shader, std:
     const auto& naming = mNamings.at(stage);
 
     const auto& inputs = mInputs.at(stage);
-    if (inputs.empty()) {
-        oss << naming.mOutputStruct << " " << naming.mMain << "()";
-    } else {
-        oss << naming.mOutputStruct << " " << naming.mMain << "("
-            << naming.mInputStruct << " " << naming.mInputVariable << ")";
+    oss << naming.mOutputStruct << " " << naming.mMain << "(";
+    if (!inputs.empty()) {
+        oss << naming.mInputStruct << " " << naming.mInputVariable;
+    }
+    if (isInstanced(stage) && !getInstanceIDInput(stage)) {
+        if (!inputs.empty())
+            oss << ", ";
+        oss << "uint instanceID : SV_InstanceID";
     }
+    oss << ")";
 
     return oss.str();
 }
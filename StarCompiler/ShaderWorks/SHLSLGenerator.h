@@ -42,6 +42,8 @@ private:
     std::string renameAttributes(const ShaderModule& node) const;
     std::string generateModule(const ShaderModule& node) const;
     std::string_view getContent(const ShaderModule& node) const;
+    bool isInstanced(const ShaderStageType& stage) const noexcept;
+    const ShaderSemanticValue* getInstanceIDInput(const ShaderStageType& stage) const;
 
     // main body generator
     std::string generateMainSignature(const ShaderStage& shader, std::set<std::string>& locals) const;
@@ -59,6 +61,9 @@ public:
     std::map<ShaderStageType, IdentityMap<ShaderSemanticValue>> mOutputs;
     Language mLanguage;
     bool mDebug = true;
+    // per-instance constants of vertex shaders become object constant arrays of this size,
+    // indexed by SV_InstanceID. 0 declares a single instance
+    uint32_t mMaxInstanceCount = 0;
 };
 
 }
@@ -23,6 +23,7 @@
 #include <StarCompiler/STextUtils.h>
 #include <Star/Graphics/SRenderGraphReflection.h>
 #include <Star/Graphics/SRenderUtils.h>
+#include <Star/Graphics/SInstanceBatching.h>
 
 namespace Star::Graphics::Render::Shader {
 
@@ -77,6 +78,7 @@ void ShaderAssetBuilder::buildShaders(const ShaderDatabase& database, const Shad
 
                                 const auto& [pProgram, rsg] = group.mPrograms.at(shaderName);
                                 HLSLGenerator hlsl(*pProgram);
+                                hlsl.mMaxInstanceCount = sMaxInstanceCount;
 
                                 passData.mSubpasses.emplace_back();
                                 auto& subpassData = passData.mSubpasses.back();
@@ -217,6 +219,7 @@ void buildShaderData(const ShaderPrototype& prototype, const ShaderModules& modu
 
                             const auto& [pProgram, rsg] = group.mPrograms.at(shaderName);
                             HLSLGenerator hlsl(*pProgram);
+                            hlsl.mMaxInstanceCount = sMaxInstanceCount;
 
                             subpassData.mState.mStreamOutput = {};
                             subpassData.mState.mBlendState = getRenderType(subpass.mShaderState.mBlendState);
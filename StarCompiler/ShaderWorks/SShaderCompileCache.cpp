@@ -0,0 +1,374 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SShaderCompileCache.h"
+#include <boost/asio/post.hpp>
+#include <condition_variable>
+
+namespace Star::Graphics::Render::Shader {
+
+std::string_view FakeShaderCompiler::name() const noexcept {
+    return "fake";
+}
+
+uint32_t FakeShaderCompiler::defaultFlags() const noexcept {
+    return 0;
+}
+
+bool FakeShaderCompiler::preprocess(const ShaderCompileRequest& request,
+    std::string& output, std::string& error
+) const {
+    if (request.mSource.empty()) {
+        error = "empty shader source";
+        return false;
+    }
+    // like a real preprocessor, the order of the defines does not show in the output
+    std::vector<std::string_view> keywords(request.mKeywords.begin(), request.mKeywords.end());
+    std::sort(keywords.begin(), keywords.end());
+    output.clear();
+    for (const auto& keyword : keywords) {
+        output += "#define ";
+        output += keyword;
+        output += " 1\n";
+    }
+    output += request.mSource;
+    return true;
+}
+
+bool FakeShaderCompiler::compile(const ShaderCompileRequest& request,
+    std::pmr::string& output, std::string& error
+) const {
+    mCompileCount.fetch_add(1, std::memory_order_relaxed);
+
+    std::string source;
+    if (!preprocess(request, source, error))
+        return false;
+
+    output.clear();
+    output.append(request.mTarget);
+    output.push_back('\0');
+    output.append(request.mEntryPoint);
+    output.push_back('\0');
+    output.append(source);
+    return true;
+}
+
+ShaderCompileCache::ShaderCompileCache(const ShaderCompilerBackend& backend,
+    std::filesystem::path folder, uint32_t threadCount, uint64_t diskBudget)
+    : mBackend(backend)
+    , mFolder(std::move(folder))
+    , mThreadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+    , mDiskBudget(diskBudget)
+{
+    if (!mFolder.empty()) {
+        if (!exists(mFolder)) {
+            create_directories(mFolder);
+        }
+        trimDisk();
+    }
+    if (mThreadCount > 1) {
+        mPool.emplace(mThreadCount - 1);
+    }
+}
+
+ShaderCompileCache::~ShaderCompileCache() {
+    if (mPool) {
+        mPool->join();
+    }
+}
+
+// func must not throw
+template<class Func>
+void ShaderCompileCache::parallelFor(size_t count, Func&& func) {
+    auto threadCount = std::min<size_t>(mThreadCount, count);
+    std::atomic<size_t> next = 0;
+    auto run = [&]() {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            func(i);
+        }
+    };
+    if (threadCount <= 1) {
+        run();
+        return;
+    }
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t helperCount = threadCount - 1;
+    for (size_t t = 0; t != threadCount - 1; ++t) {
+        boost::asio::post(*mPool, [&]() {
+            run();
+            std::lock_guard<std::mutex> guard(mutex);
+            if (--helperCount == 0) {
+                finished.notify_one();
+            }
+        });
+    }
+    run();
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return helperCount == 0; });
+}
+
+boost::uuids::uuid ShaderCompileCache::makeKey(const ShaderCompileRequest& request,
+    std::string_view preprocessed
+) const {
+    std::string key;
+    key.reserve(preprocessed.size() + 256);
+
+    auto appendSize = [&key](uint64_t sz) {
+        key.append(reinterpret_cast<const char*>(&sz), sizeof(sz));
+    };
+    auto append = [&](std::string_view str) {
+        appendSize(str.size());
+        key.append(str);
+    };
+
+    append(mBackend.name());
+    append(request.mTarget);
+    append(request.mEntryPoint);
+    appendSize(request.mFlags);
+
+    // keywords are all defined to 1, their order does not change the output
+    std::vector<std::string_view> keywords(request.mKeywords.begin(), request.mKeywords.end());
+    std::sort(keywords.begin(), keywords.end());
+    appendSize(keywords.size());
+    for (const auto& keyword : keywords) {
+        append(keyword);
+    }
+    append(preprocessed);
+
+    boost::uuids::name_generator_sha1 gen(boost::uuids::ns::oid());
+    return gen(key.data(), key.size());
+}
+
+bool ShaderCompileCache::find(const boost::uuids::uuid& key, std::pmr::string& binary) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto iter = mBinaries.find(key);
+        if (iter != mBinaries.end()) {
+            binary = iter->second;
+            return true;
+        }
+    }
+
+    if (mFolder.empty())
+        return false;
+
+    auto filename = mFolder / (to_string(key) + ".cso");
+    if (!exists(filename))
+        return false;
+
+    readBinary(filename, binary);
+    if (binary.empty())
+        return false;
+
+    // the write time orders binaries for trimDisk, a hit makes it recently used
+    std::error_code ec;
+    std::filesystem::last_write_time(filename, std::filesystem::file_time_type::clock::now(), ec);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBinaries.try_emplace(key, binary);
+    return true;
+}
+
+void ShaderCompileCache::store(const boost::uuids::uuid& key, const std::pmr::string& binary) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBinaries.try_emplace(key, binary);
+    }
+
+    if (mFolder.empty())
+        return;
+
+    // write to a temporary file first, concurrent builds never see partial binaries.
+    // a failed write only loses the disk entry, the binary is compiled again next run
+    auto filename = mFolder / (to_string(key) + ".cso");
+    auto tmp = filename;
+    tmp += ".tmp";
+    std::error_code ec;
+    try {
+        std::ofstream ofs(tmp, std::ios::binary);
+        ofs.exceptions(std::ostream::failbit | std::ostream::badbit);
+        ofs.write(binary.data(), binary.size());
+    } catch (const std::exception&) {
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+    std::filesystem::rename(tmp, filename, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+    }
+}
+
+void ShaderCompileCache::compile(gsl::span<const ShaderCompileRequest> requests,
+    gsl::span<ShaderCompileResult> results
+) {
+    Expects(requests.size() == results.size());
+    const auto count = gsl::narrow<size_t>(requests.size());
+
+    // preprocess and hash
+    std::vector<std::string> sources(count);
+    std::vector<boost::uuids::uuid> keys(count);
+    std::vector<char> valid(count, 0);
+    parallelFor(count, [&](size_t i) {
+        auto& result = results[i];
+        result.mSucceeded = false;
+        result.mCacheHit = false;
+        result.mBinary.clear();
+        result.mError.clear();
+        try {
+            if (mBackend.preprocess(requests[i], sources[i], result.mError)) {
+                keys[i] = makeKey(requests[i], sources[i]);
+                valid[i] = 1;
+            }
+        } catch (const std::exception& e) {
+            result.mError = e.what();
+        }
+        sources[i] = std::string();
+    });
+
+    // resolve cache hits, identical keys in the batch are compiled once
+    constexpr size_t npos = std::numeric_limits<size_t>::max();
+    std::vector<size_t> misses;
+    std::vector<size_t> owners(count, npos);
+    std::unordered_map<boost::uuids::uuid, size_t,
+        boost::hash<boost::uuids::uuid>> firsts;
+    for (size_t i = 0; i != count; ++i) {
+        if (!valid[i])
+            continue;
+
+        auto& result = results[i];
+        if (find(keys[i], result.mBinary)) {
+            result.mSucceeded = true;
+            result.mCacheHit = true;
+            mHitCount.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        auto res = firsts.try_emplace(keys[i], i);
+        if (res.second) {
+            misses.emplace_back(i);
+        } else {
+            owners[i] = res.first->second;
+        }
+    }
+
+    // compile
+    mMissCount.fetch_add(gsl::narrow<uint32_t>(misses.size()), std::memory_order_relaxed);
+    parallelFor(misses.size(), [&](size_t j) {
+        auto i = misses[j];
+        auto& result = results[i];
+        try {
+            if (mBackend.compile(requests[i], result.mBinary, result.mError)) {
+                store(keys[i], result.mBinary);
+                result.mSucceeded = true;
+            } else {
+                result.mBinary.clear();
+            }
+        } catch (const std::exception& e) {
+            result.mSucceeded = false;
+            result.mBinary.clear();
+            result.mError = e.what();
+        }
+    });
+
+    if (mDiskBudget && !misses.empty()) {
+        trimDisk();
+    }
+
+    for (size_t i = 0; i != count; ++i) {
+        if (owners[i] == npos)
+            continue;
+        const auto& owner = results[owners[i]];
+        auto& result = results[i];
+        result.mSucceeded = owner.mSucceeded;
+        result.mCacheHit = owner.mSucceeded;
+        result.mBinary = owner.mBinary;
+        result.mError = owner.mError;
+        if (owner.mSucceeded) {
+            mHitCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+ShaderCompileResult ShaderCompileCache::compile(const ShaderCompileRequest& request) {
+    ShaderCompileResult result;
+    compile(gsl::span<const ShaderCompileRequest>(&request, 1),
+        gsl::span<ShaderCompileResult>(&result, 1));
+    return result;
+}
+
+void ShaderCompileCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBinaries.clear();
+}
+
+void ShaderCompileCache::trimDisk() {
+    if (mFolder.empty())
+        return;
+
+    struct Entry {
+        std::filesystem::file_time_type mTime;
+        uint64_t mSize;
+        std::filesystem::path mPath;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    // other builds might share the folder, every file can vanish while we look at it
+    const auto now = std::filesystem::file_time_type::clock::now();
+    std::error_code ec;
+    for (std::filesystem::directory_iterator iter(mFolder, ec), end; !ec && iter != end; iter.increment(ec)) {
+        const auto& path = iter->path();
+        std::error_code fileError;
+        auto time = iter->last_write_time(fileError);
+        if (fileError)
+            continue;
+
+        if (path.extension() == ".tmp") {
+            // left behind by an interrupted build, live ones are only seconds old
+            if (now - time > std::chrono::hours(1)) {
+                std::filesystem::remove(path, fileError);
+            }
+            continue;
+        }
+        if (path.extension() != ".cso")
+            continue;
+
+        auto size = iter->file_size(fileError);
+        if (fileError)
+            continue;
+        entries.emplace_back(Entry{ time, size, path });
+        total += size;
+    }
+
+    if (mDiskBudget == 0 || total <= mDiskBudget)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.mTime < rhs.mTime;
+    });
+    for (const auto& entry : entries) {
+        if (total <= mDiskBudget)
+            break;
+        std::error_code fileError;
+        std::filesystem::remove(entry.mPath, fileError);
+        total -= entry.mSize;
+    }
+}
+
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+#include <boost/uuid/uuid.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <gsl/span>
+#include <mutex>
+#include <unordered_map>
+
+namespace Star::Graphics::Render::Shader {
+
+struct ShaderCompileRequest {
+    std::string mName;
+    std::string mSource;
+    std::string mEntryPoint = "main";
+    std::string mTarget;
+    // variant keywords, passed to the compiler as macros defined to 1
+    std::vector<std::string> mKeywords;
+    uint32_t mFlags = 0;
+};
+
+struct ShaderCompileResult {
+    bool mSucceeded = false;
+    bool mCacheHit = false;
+    std::pmr::string mBinary;
+    std::string mError;
+};
+
+// Compiler backends must be thread safe, preprocess and compile are called
+// concurrently from the cache's worker threads.
+class ShaderCompilerBackend {
+public:
+    virtual ~ShaderCompilerBackend() = default;
+
+    // identifies the compiler and its version, part of the cache key
+    virtual std::string_view name() const noexcept = 0;
+    virtual uint32_t defaultFlags() const noexcept = 0;
+
+    // expand includes and macros, the result is hashed for the cache key
+    virtual bool preprocess(const ShaderCompileRequest& request,
+        std::string& output, std::string& error) const = 0;
+
+    virtual bool compile(const ShaderCompileRequest& request,
+        std::pmr::string& output, std::string& error) const = 0;
+};
+
+// Backend without any platform dependency, "compiles" by copying the
+// preprocessed source. Lets the cache and the scheduler run off Windows.
+class FakeShaderCompiler final : public ShaderCompilerBackend {
+public:
+    std::string_view name() const noexcept override;
+    uint32_t defaultFlags() const noexcept override;
+    bool preprocess(const ShaderCompileRequest& request,
+        std::string& output, std::string& error) const override;
+    bool compile(const ShaderCompileRequest& request,
+        std::pmr::string& output, std::string& error) const override;
+
+    uint32_t compileCount() const noexcept {
+        return mCompileCount.load(std::memory_order_relaxed);
+    }
+private:
+    mutable std::atomic<uint32_t> mCompileCount = 0;
+};
+
+// Content addressed shader cache, keyed by the preprocessed source, keywords,
+// entry point, profile, flags and backend name. Binaries are kept in memory
+// and, when a folder is given, in <folder>/<key>.cso across runs.
+class ShaderCompileCache {
+public:
+    // diskBudget: bytes of binaries kept in folder, least recently used are removed first, 0 keeps all
+    ShaderCompileCache(const ShaderCompilerBackend& backend,
+        std::filesystem::path folder = {}, uint32_t threadCount = 0, uint64_t diskBudget = 0);
+    ShaderCompileCache(const ShaderCompileCache&) = delete;
+    ShaderCompileCache& operator=(const ShaderCompileCache&) = delete;
+    ~ShaderCompileCache();
+
+    // compile all requests on the thread pool, identical keys are compiled once
+    void compile(gsl::span<const ShaderCompileRequest> requests,
+        gsl::span<ShaderCompileResult> results);
+
+    ShaderCompileResult compile(const ShaderCompileRequest& request);
+
+    void clear();
+
+    // removes abandoned temporary files and trims the folder to the disk budget
+    void trimDisk();
+
+    uint32_t hitCount() const noexcept {
+        return mHitCount.load(std::memory_order_relaxed);
+    }
+    uint32_t missCount() const noexcept {
+        return mMissCount.load(std::memory_order_relaxed);
+    }
+private:
+    boost::uuids::uuid makeKey(const ShaderCompileRequest& request,
+        std::string_view preprocessed) const;
+    bool find(const boost::uuids::uuid& key, std::pmr::string& binary);
+    void store(const boost::uuids::uuid& key, const std::pmr::string& binary);
+
+    template<class Func>
+    void parallelFor(size_t count, Func&& func);
+
+    const ShaderCompilerBackend& mBackend;
+    std::filesystem::path mFolder;
+    uint32_t mThreadCount = 1;
+    uint64_t mDiskBudget = 0;
+    // helpers of parallelFor, the calling thread is the remaining worker
+    std::optional<boost::asio::thread_pool> mPool;
+
+    std::mutex mMutex;
+    std::unordered_map<boost::uuids::uuid, std::pmr::string,
+        boost::hash<boost::uuids::uuid>> mBinaries;
+
+    std::atomic<uint32_t> mHitCount = 0;
+    std::atomic<uint32_t> mMissCount = 0;
+};
+
+}
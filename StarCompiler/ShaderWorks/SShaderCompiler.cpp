@@ -26,76 +26,131 @@
 
 namespace Star::Graphics::Render::Shader {
 
-void compileShader(std::pmr::string& buffer, const std::string& target,
+namespace {
+
+std::string_view getBlobString(ID3DBlob* blob) noexcept {
+    if (!blob)
+        return {};
+    return std::string_view(static_cast<const char*>(blob->GetBufferPointer()),
+        blob->GetBufferSize());
+}
+
+std::vector<D3D_SHADER_MACRO> getMacros(const ShaderCompileRequest& request) {
+    std::vector<D3D_SHADER_MACRO> macros;
+    macros.reserve(request.mKeywords.size() + 1);
+    for (const auto& keyword : request.mKeywords) {
+        macros.emplace_back(D3D_SHADER_MACRO{ keyword.c_str(), "1" });
+    }
+    macros.emplace_back(D3D_SHADER_MACRO{ nullptr, nullptr });
+    return macros;
+}
+
+const D3DShaderCompiler sD3DCompiler;
+
+// binaries kept in <output>/cache, least recently used are removed past it
+constexpr uint64_t sShaderCacheDiskBudget = 512ull << 20;
+
+ShaderCompileRequest makeRequest(const std::string& target,
     const std::string& name, const std::string& content
 ) {
+    ShaderCompileRequest request;
+    request.mName = name;
+    request.mSource = content;
+    request.mTarget = target;
+    request.mFlags = sD3DCompiler.defaultFlags();
+    return request;
+}
+
+}
+
+std::string_view D3DShaderCompiler::name() const noexcept {
+    return "d3dcompiler_47";
+}
+
+uint32_t D3DShaderCompiler::defaultFlags() const noexcept {
     UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
 #if defined( DEBUG ) || defined( _DEBUG )
     flags |= D3DCOMPILE_DEBUG;
 #endif
+    return flags;
+}
 
-    com_ptr<ID3DBlob> shaderBlob;
-    com_ptr<ID3DBlob> errorBlob;
+bool D3DShaderCompiler::preprocess(const ShaderCompileRequest& request,
+    std::string& output, std::string& error
+) const {
+    auto macros = getMacros(request);
 
-    HRESULT hr = S_OK;
+    com_ptr<ID3DBlob> textBlob;
+    com_ptr<ID3DBlob> errorBlob;
 
-    hr = D3DCompile(content.data(), content.size(), name.c_str(),
-        nullptr,
+    HRESULT hr = D3DPreprocess(request.mSource.data(), request.mSource.size(),
+        request.mName.c_str(), macros.data(),
         D3D_COMPILE_STANDARD_FILE_INCLUDE,
-        "main", target.c_str(),
-        flags, 0, shaderBlob.put(), errorBlob.put());
+        textBlob.put(), errorBlob.put());
 
     if (FAILED(hr)) {
-        std::cout << "compile shader: " << name << " failed, " <<
-            std::string_view(static_cast<const char*>(errorBlob->GetBufferPointer()),
-                errorBlob->GetBufferSize()) << std::endl;
-        return;
+        error = getBlobString(errorBlob.get());
+        return false;
     }
 
-    buffer.resize(shaderBlob->GetBufferSize());
-    std::memcpy(buffer.data(), shaderBlob->GetBufferPointer(), buffer.size());
+    output = getBlobString(textBlob.get());
+    return true;
 }
 
-void compileShaderFile(const std::filesystem::path& filename, const std::string& target,
-    const std::string& name, const std::string& content
-) {
-    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_WARNINGS_ARE_ERRORS;
-#if defined( DEBUG ) || defined( _DEBUG )
-    flags |= D3DCOMPILE_DEBUG;
-#endif
+bool D3DShaderCompiler::compile(const ShaderCompileRequest& request,
+    std::pmr::string& output, std::string& error
+) const {
+    auto macros = getMacros(request);
 
     com_ptr<ID3DBlob> shaderBlob;
     com_ptr<ID3DBlob> errorBlob;
 
-    HRESULT hr = S_OK;
-
-    hr = D3DCompile(content.data(), content.size(), name.c_str(),
-        nullptr,
+    HRESULT hr = D3DCompile(request.mSource.data(), request.mSource.size(),
+        request.mName.c_str(), macros.data(),
         D3D_COMPILE_STANDARD_FILE_INCLUDE,
-        "main", target.c_str(),
-        flags, 0, shaderBlob.put(), errorBlob.put());
+        request.mEntryPoint.c_str(), request.mTarget.c_str(),
+        request.mFlags, 0, shaderBlob.put(), errorBlob.put());
 
     if (FAILED(hr)) {
+        error = getBlobString(errorBlob.get());
+        return false;
+    }
+
+    output = getBlobString(shaderBlob.get());
+    return true;
+}
+
+ShaderCompileCache& getShaderCompileCache() {
+    static ShaderCompileCache sCache(sD3DCompiler);
+    return sCache;
+}
+
+void compileShader(std::pmr::string& buffer, const std::string& target,
+    const std::string& name, const std::string& content
+) {
+    auto result = getShaderCompileCache().compile(makeRequest(target, name, content));
+
+    if (!result.mSucceeded) {
         std::cout << "compile shader: " << name << " failed, " <<
-            std::string_view(static_cast<const char*>(errorBlob->GetBufferPointer()),
-                errorBlob->GetBufferSize()) << std::endl;
+            result.mError << std::endl;
         return;
     }
 
+    buffer = result.mBinary;
+}
 
-    if (exists(filename)) {
-        com_ptr<ID3DBlob> origShaderBlob;
-        ThrowIfFailed(D3DReadFileToBlob(filename.wstring().c_str(), origShaderBlob.put()));
-        if (std::string_view(static_cast<const char*>(origShaderBlob->GetBufferPointer()),
-            origShaderBlob->GetBufferSize()) !=
-            std::string_view(static_cast<const char*>(shaderBlob->GetBufferPointer()),
-                shaderBlob->GetBufferSize()))
-        {
-            ThrowIfFailed(D3DWriteBlobToFile(shaderBlob.get(), filename.wstring().c_str(), true));
-        }
-    } else {
-        ThrowIfFailed(D3DWriteBlobToFile(shaderBlob.get(), filename.wstring().c_str(), true));
+void compileShaderFile(const std::filesystem::path& filename, const std::string& target,
+    const std::string& name, const std::string& content
+) {
+    auto result = getShaderCompileCache().compile(makeRequest(target, name, content));
+
+    if (!result.mSucceeded) {
+        std::cout << "compile shader: " << name << " failed, " <<
+            result.mError << std::endl;
+        return;
     }
+
+    updateBinary(filename, result.mBinary);
 }
 
 void compileShaders(const ShaderGroups& shaderWorks,
@@ -104,22 +159,29 @@ void compileShaders(const ShaderGroups& shaderWorks,
     if (!exists(binaryFolder)) {
         create_directories(binaryFolder);
     }
+
+    // collect all jobs first, then compile them on the cache's thread pool.
+    // unchanged shaders are found in binaryFolder/cache and skip D3DCompile
+    std::vector<ShaderCompileRequest> requests;
+    std::vector<std::filesystem::path> outputs;
+    auto addShader = [&](const std::string& filename, const char* target) {
+        requests.emplace_back(makeRequest(target, filename,
+            readFile(folder / (filename + ".hlsl"))));
+        outputs.emplace_back(binaryFolder / (filename + ".cso"));
+    };
+
     std::string filename;
-    std::string filename2;
     filename.reserve(500);
-    filename2.reserve(500);
     for (const auto& [bundleName, bundle] : shaderWorks.mSolutions) {
         for (const auto& [pipelineName, pipeline] : bundle) {
             for (uint32_t i = 0; i != UpdateCount; ++i) {
                 for (const auto& [name, group] : pipeline[i]) {
-                    filename += camelToUnderscore(name);
                     if (group.mGenerateRootSignature) {
                         filename = camelToUnderscore(bundleName) + "-";
                         group.getShaderPrefix(filename);
 
                         filename += "-rs";
-                        auto content = readFile(folder / (filename + ".hlsl"));
-                        compileShaderFile(binaryFolder / (filename + ".cso"), "rootsig_1_1", filename, content);
+                        addShader(filename, "rootsig_1_1");
                     }
 
                     for (const auto& [name, pair] : group.mPrograms) {
@@ -131,29 +193,19 @@ void compileShaders(const ShaderGroups& shaderWorks,
                             auto filename2 = filename + "-" + camelToUnderscore(name);
                             visit(overload(
                                 [&](PS_) {
-                                    filename2 += "-ps";
-                                    auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "ps_5_0", filename2, content);
+                                    addShader(filename2 + "-ps", "ps_5_0");
                                 },
                                 [&](GS_) {
-                                    filename2 += "-gs";
-                                    auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "gs_5_0", filename2, content);
+                                    addShader(filename2 + "-gs", "gs_5_0");
                                 },
                                 [&](DS_) {
-                                    filename2 += "-ds";
-                                    auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "ds_5_0", filename2, content);
+                                    addShader(filename2 + "-ds", "ds_5_0");
                                 },
                                 [&](HS_) {
-                                    filename2 += "-hs";
-                                    auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "hs_5_0", filename2, content);
+                                    addShader(filename2 + "-hs", "hs_5_0");
                                 },
                                 [&](VS_) {
-                                    filename2 += "-vs";
-                                    auto content = readFile(folder / (filename2 + ".hlsl"));
-                                    compileShaderFile(binaryFolder / (filename2 + ".cso"), "vs_5_0", filename2, content);
+                                    addShader(filename2 + "-vs", "vs_5_0");
                                 },
                                 [](auto) {}
                             ), stage);
@@ -163,6 +215,20 @@ void compileShaders(const ShaderGroups& shaderWorks,
             }
         }
     }
+
+    ShaderCompileCache cache(sD3DCompiler, binaryFolder / "cache", 0, sShaderCacheDiskBudget);
+    std::vector<ShaderCompileResult> results(requests.size());
+    cache.compile(requests, results);
+
+    for (size_t i = 0; i != results.size(); ++i) {
+        const auto& result = results[i];
+        if (!result.mSucceeded) {
+            std::cout << "compile shader: " << requests[i].mName << " failed, " <<
+                result.mError << std::endl;
+            continue;
+        }
+        updateBinary(outputs[i], result.mBinary);
+    }
 }
 
 }
@@ -17,9 +17,23 @@
 
 #pragma once
 #include <StarCompiler/ShaderGraph/SShaderGroups.h>
+#include <StarCompiler/ShaderWorks/SShaderCompileCache.h>
 
 namespace Star::Graphics::Render::Shader {
 
+class D3DShaderCompiler final : public ShaderCompilerBackend {
+public:
+    std::string_view name() const noexcept override;
+    uint32_t defaultFlags() const noexcept override;
+    bool preprocess(const ShaderCompileRequest& request,
+        std::string& output, std::string& error) const override;
+    bool compile(const ShaderCompileRequest& request,
+        std::pmr::string& output, std::string& error) const override;
+};
+
+// process wide in-memory cache used by compileShader and compileShaderFile
+ShaderCompileCache& getShaderCompileCache();
+
 void compileShader(std::pmr::string& buffer,
     const std::string& target, const std::string& name,
     const std::string& content);
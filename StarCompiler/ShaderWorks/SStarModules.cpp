@@ -549,7 +549,9 @@ tspace2 = half4(worldTangent.z, worldBinormal.z, worldNormal.z, viewDir.z);
             { "deviceUV", float2, TEXCOORD },
         },
         Contents{
-            { "normalTS = BumpMap.Sample(BumpMapSampler, deviceUV).xyz;\n" },
+            { R"(normalTS.xy = BumpMap.Sample(BumpMapSampler, deviceUV).xy * 2 - 1;
+normalTS.z = sqrt(saturate(1 - dot(normalTS.xy, normalTS.xy)));
+)" },
             { "normalTS = UnpackNormal(tex2D(BumpMap, deviceUV)).xyz;\n", UnityCG }
         }
     );
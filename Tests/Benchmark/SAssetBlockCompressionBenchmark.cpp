@@ -0,0 +1,136 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/AssetFactory/SAssetBlockCompression.h>
+#include <Star/SAlignedBuffer.h>
+#include <3rdparty/DXTCompressor/DXTCompressorDLL.h>
+#include <benchmark/benchmark.h>
+#include <random>
+#ifdef STAR_TBB
+#include <tbb/global_control.h>
+#endif
+
+using namespace Star;
+using namespace Star::Asset;
+
+namespace {
+
+constexpr uint32_t sBlockSize = 4;
+constexpr uint32_t sSrcBPE = 4 * sBlockSize * sBlockSize;
+
+void makeImage(AlignedBuffer16& image, uint32_t size) {
+    image.resize_aligned(size_t(size) * size * 4);
+    std::mt19937 rng(42);
+    auto* texels = reinterpret_cast<uint8_t*>(image.data());
+    for (size_t i = 0; i != image.size(); ++i) {
+        texels[i] = static_cast<uint8_t>(rng());
+    }
+}
+
+void compressBC1(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageDXT1SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void compressBC3(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageDXT5SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void compressBC4(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageBC4SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void compressBC5(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageBC5SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void compressBC7(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageBC7Mode6SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void setCounters(benchmark::State& state, uint32_t size) {
+    state.SetItemsProcessed(state.iterations() * (size / sBlockSize) * (size / sBlockSize));
+    state.SetBytesProcessed(state.iterations() * size_t(size) * size * 4);
+}
+
+// one encoder call over the whole mip, how loadImage compressed before the strips
+template<auto Compress, uint32_t DstBPE>
+void BM_CompressSerial(benchmark::State& state) {
+    const auto size = static_cast<uint32_t>(state.range(0));
+    AlignedBuffer16 image(std::pmr::get_default_resource());
+    makeImage(image, size);
+    std::vector<std::byte> dst(size_t(size / sBlockSize) * (size / sBlockSize) * DstBPE);
+    for (auto _ : state) {
+        Compress(image.data(), dst.data(), size, size);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    setCounters(state, size);
+}
+
+// block-row strips on range(1) worker threads. without TBB the
+// parallel algorithms ignore the limit and the runs are identical
+template<auto Compress, uint32_t DstBPE>
+void BM_CompressStrips(benchmark::State& state) {
+    const auto size = static_cast<uint32_t>(state.range(0));
+    const auto threads = static_cast<size_t>(state.range(1));
+#ifdef STAR_TBB
+    tbb::global_control limit(tbb::global_control::max_allowed_parallelism, threads);
+#endif
+    AlignedBuffer16 image(std::pmr::get_default_resource());
+    makeImage(image, size);
+    std::vector<std::byte> dst(size_t(size / sBlockSize) * (size / sBlockSize) * DstBPE);
+    for (auto _ : state) {
+        compressBlockRows(std::pmr::get_default_resource(), image.data(), dst.data(),
+            size, size, sBlockSize, sBlockSize, sSrcBPE, DstBPE, Compress);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    setCounters(state, size);
+}
+
+void applySizes(benchmark::internal::Benchmark* b) {
+    b->ArgName("size")->Arg(2048)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+// powers of two up to the hardware concurrency, and the hardware concurrency itself
+void applyThreads(benchmark::internal::Benchmark* b) {
+    b->ArgNames({ "size", "threads" });
+    const int64_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (int64_t size : { 2048, 4096 }) {
+        for (int64_t threads = 1; threads < hardware; threads *= 2) {
+            b->Args({ size, threads });
+        }
+        b->Args({ size, hardware });
+    }
+    b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+BENCHMARK_TEMPLATE(BM_CompressSerial, compressBC1, 8)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_CompressStrips, compressBC1, 8)->Apply(applyThreads);
+BENCHMARK_TEMPLATE(BM_CompressSerial, compressBC3, 16)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_CompressStrips, compressBC3, 16)->Apply(applyThreads);
+BENCHMARK_TEMPLATE(BM_CompressSerial, compressBC4, 8)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_CompressStrips, compressBC4, 8)->Apply(applyThreads);
+BENCHMARK_TEMPLATE(BM_CompressSerial, compressBC5, 16)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_CompressStrips, compressBC5, 16)->Apply(applyThreads);
+BENCHMARK_TEMPLATE(BM_CompressSerial, compressBC7, 16)->Apply(applySizes);
+BENCHMARK_TEMPLATE(BM_CompressStrips, compressBC7, 16)->Apply(applyThreads);
+
+}
@@ -0,0 +1,172 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/AssetFactory/SAssetMeshContainer.h>
+#include <Star/AssetFactory/SAssetMeshUtils.h>
+#include <Star/Serialization/SRuntime.h>
+#include <Star/Serialization/SPmrBinaryInArchive.h>
+#include <Star/Graphics/SContentSerialization.h>
+#include <benchmark/benchmark.h>
+
+using namespace Star;
+using namespace Star::Asset;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// peak bytes held by the loaded mesh, allocator caching does not hide them
+// the way it hides them from the resident set
+class CountingResource : public std::pmr::memory_resource {
+public:
+    uint64_t peak() const noexcept {
+        return mPeak;
+    }
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        mAllocated += bytes;
+        mPeak = std::max(mPeak, mAllocated);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        mAllocated -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override {
+        return this == &rhs;
+    }
+
+    uint64_t mAllocated = 0;
+    uint64_t mPeak = 0;
+};
+
+// position stream and a 32 byte attribute stream, 32 bit indices
+MeshData makeMesh(uint32_t vertexCount) {
+    MeshData mesh(std::pmr::get_default_resource());
+    mesh.mVertexBuffers.reserve(2);
+    auto& positions = mesh.mVertexBuffers.emplace_back();
+    positions.mDesc.mElements.emplace_back(VertexElement{ SV_Position, 0, Format::R32G32B32_SFLOAT });
+    positions.mDesc.mVertexSize = 12;
+    positions.mVertexCount = vertexCount;
+    positions.mBuffer.resize(size_t(vertexCount) * 12, 1);
+
+    auto& attributes = mesh.mVertexBuffers.emplace_back();
+    attributes.mDesc.mElements.emplace_back(VertexElement{ NORMAL, 0, Format::R32G32B32_SFLOAT });
+    attributes.mDesc.mElements.emplace_back(VertexElement{ TANGENT, 12, Format::R32G32B32A32_SFLOAT });
+    attributes.mDesc.mElements.emplace_back(VertexElement{ TEXCOORD, 28, Format::R32_UINT });
+    attributes.mDesc.mVertexSize = 32;
+    attributes.mVertexCount = vertexCount;
+    attributes.mBuffer.resize(size_t(vertexCount) * 32, 2);
+
+    std::vector<uint32_t> indices(size_t(vertexCount) * 6);
+    for (size_t i = 0; i != indices.size(); ++i) {
+        indices[i] = static_cast<uint32_t>((i * 7919) % vertexCount);
+    }
+    writeIndices(indices, std::max(vertexCount, 65537u), mesh.mIndexBuffer);
+    mesh.mSubMeshes.emplace_back(SubMeshData{ 0, gsl::narrow<uint32_t>(indices.size()) });
+    return mesh;
+}
+
+// one file per format and size, written once per process
+const std::filesystem::path& getMeshFile(uint32_t vertexCount, bool container) {
+    static std::map<std::pair<uint32_t, bool>, std::filesystem::path> sFiles;
+    auto& filename = sFiles[{ vertexCount, container }];
+    if (filename.empty()) {
+        filename = std::filesystem::temp_directory_path() /
+            ("star_mesh_" + std::to_string(vertexCount) + (container ? ".mesh" : ".archive"));
+        const auto mesh = makeMesh(vertexCount);
+        std::ofstream ofs(filename, std::ios::binary);
+        if (container) {
+            std::string content;
+            writeMeshContainer(mesh, content);
+            ofs.write(content.data(), content.size());
+        } else {
+            boost::archive::binary_oarchive oa(ofs);
+            oa << mesh;
+        }
+    }
+    return filename;
+}
+
+// bytes a gpu upload reads, touches every page of the loaded mesh
+uint64_t readBlobs(const MeshData& mesh) {
+    uint64_t sum = 0;
+    auto touch = [&sum](gsl::span<const char> data) {
+        for (size_t i = 0; i < data.size(); i += 4096) {
+            sum += data[i];
+        }
+    };
+    for (const auto& vb : mesh.mVertexBuffers) {
+        touch(vb.data());
+    }
+    touch(mesh.mIndexBuffer.data());
+    return sum;
+}
+
+enum class LoadMode : int64_t {
+    Archive,
+    ContainerRead,
+    ContainerView,
+};
+
+// the file stays in the page cache, so this measures parsing and copies, not the disk.
+// peak memory of a load is the heap it allocates plus the mapped pages it touches,
+// reported as heap and mapped
+void BM_MeshLoad(benchmark::State& state) {
+    const auto vertexCount = static_cast<uint32_t>(state.range(0));
+    const auto mode = static_cast<LoadMode>(state.range(1));
+    const auto& filename = getMeshFile(vertexCount, mode != LoadMode::Archive);
+    const auto fileSize = std::filesystem::file_size(filename);
+
+    uint64_t heap = 0;
+    for (auto _ : state) {
+        CountingResource counter;
+        {
+            MeshData mesh(&counter);
+            std::optional<MappedMeshFile> file;
+            if (mode == LoadMode::Archive) {
+                std::ifstream ifs(filename, std::ios::binary);
+                PmrBinaryInArchive ia(ifs, &counter);
+                ia >> mesh;
+            } else {
+                file.emplace(filename);
+                MeshContainerView view(file->data());
+                if (mode == LoadMode::ContainerRead) {
+                    view.read(mesh);
+                } else {
+                    view.view(mesh);
+                }
+            }
+            benchmark::DoNotOptimize(readBlobs(mesh));
+        }
+        heap = counter.peak();
+    }
+    state.counters["heap"] = benchmark::Counter(static_cast<double>(heap),
+        benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+    state.counters["mapped"] = benchmark::Counter(
+        mode == LoadMode::Archive ? 0.0 : static_cast<double>(fileSize),
+        benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+    state.SetBytesProcessed(state.iterations() * fileSize);
+    state.SetLabel(mode == LoadMode::Archive ? "archive"
+        : mode == LoadMode::ContainerRead ? "container read" : "container view");
+}
+BENCHMARK(BM_MeshLoad)
+    ->ArgNames({ "vertices", "mode" })
+    ->ArgsProduct({ { 16 << 10, 1 << 20 }, { 0, 1, 2 } })
+    ->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,129 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/AssetFactory/SAssetMipMaps.h>
+#include <Star/Graphics/STextureUtils.h>
+#include <benchmark/benchmark.h>
+#include <boost/gil.hpp>
+#include <boost/gil/extension/numeric/sampler.hpp>
+#include <boost/gil/extension/numeric/resample.hpp>
+#include <random>
+
+using namespace Star;
+using namespace Star::Asset;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// the gil path generateMipChain replaced, bilinear resize_view per level,
+// kept here as the baseline. bc padding is filled the same way
+void generateGilMipMaps(std::byte* buffer, uint32_t width, uint32_t height,
+    uint32_t blockX, uint32_t blockY, uint32_t mipCount
+) {
+    using namespace boost::gil;
+    using Pixel = rgba8_pixel_t;
+
+    size_t offset = 0;
+    const uint32_t bpe = sizeof(Pixel) * blockX * blockY;
+    for (uint32_t k = 1; k != mipCount; ++k) {
+        uint32_t width1 = boost::alignment::align_up(width, blockX);
+        auto srcView = interleaved_view(width, height,
+            reinterpret_cast<const Pixel*>(buffer + offset), width1 * sizeof(Pixel));
+
+        offset += mip_size(width, height, blockX, blockY, bpe);
+        width = half_size(width);
+        height = half_size(height);
+        uint32_t width2 = boost::alignment::align_up(width, blockX);
+        uint32_t height2 = boost::alignment::align_up(height, blockY);
+
+        auto dstView = interleaved_view(width, height,
+            reinterpret_cast<Pixel*>(buffer + offset), width2 * sizeof(Pixel));
+        resize_view(srcView, dstView, bilinear_sampler());
+        if (width2 == width && height2 == height)
+            continue;
+
+        std::array<float, 4> acc{};
+        for_each_pixel(dstView, [&](const Pixel& pixel) {
+            for (size_t c = 0; c != 4; ++c) {
+                acc[c] += pixel[c];
+            }
+        });
+        Pixel avg;
+        for (size_t c = 0; c != 4; ++c) {
+            avg[c] = static_cast<uint8_t>(acc[c] / float(width * height));
+        }
+        auto paddedView = interleaved_view(width2, height2,
+            reinterpret_cast<Pixel*>(buffer + offset), width2 * sizeof(Pixel));
+        for (uint32_t y = 0; y != height2; ++y) {
+            for (uint32_t x = 0; x != width2; ++x) {
+                if (y < height && x < width)
+                    continue;
+                paddedView(x, y) = avg;
+            }
+        }
+    }
+}
+
+// bc blocks, as the texture import lays out rgba8 sources
+std::vector<std::byte> makeImage(uint32_t size) {
+    std::vector<std::byte> buffer(texture_size(size, size, 4, 4, 4 * 16));
+    std::mt19937 rng(42);
+    for (size_t i = 0; i != size_t(size) * size * 4; ++i) {
+        buffer[i] = static_cast<std::byte>(rng());
+    }
+    return buffer;
+}
+
+// the chain is regenerated in place, level 0 is only read
+
+void BM_GilMipChain(benchmark::State& state) {
+    const auto size = static_cast<uint32_t>(state.range(0));
+    auto buffer = makeImage(size);
+    for (auto _ : state) {
+        generateGilMipMaps(buffer.data(), size, size, 4, 4, mip_count(size, size));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * int64_t(size) * size * 4);
+}
+BENCHMARK(BM_GilMipChain)->ArgName("size")->Arg(256)->Arg(1024)->Arg(2048)->Unit(benchmark::kMillisecond);
+
+void BM_MipChain(benchmark::State& state) {
+    const auto size = static_cast<uint32_t>(state.range(0));
+    const auto format = static_cast<Format>(state.range(1));
+    MipChainSettings settings;
+    if (state.range(2)) {
+        settings.mFilter = KaiserFilter;
+    }
+    auto buffer = makeImage(size);
+    std::pmr::unsynchronized_pool_resource pool;
+    for (auto _ : state) {
+        generateMipChain(&pool, buffer.data(), format, size, size, 4, 4,
+            mip_count(size, size), settings);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(std::string(format == Format::R8G8B8A8_SRGB ? "srgb" : "unorm") +
+        (state.range(2) ? " kaiser" : " box"));
+    state.SetBytesProcessed(state.iterations() * int64_t(size) * size * 4);
+}
+BENCHMARK(BM_MipChain)
+    ->ArgNames({ "size", "format", "kaiser" })
+    ->ArgsProduct({ { 256, 1024, 2048 },
+        { int64_t(Format::R8G8B8A8_UNORM), int64_t(Format::R8G8B8A8_SRGB) }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond);
+
+}
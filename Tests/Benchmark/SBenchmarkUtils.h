@@ -0,0 +1,88 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <benchmark/benchmark.h>
+
+namespace Star {
+
+namespace Benchmark {
+
+// memory resources every allocator benchmark runs under, passed as range(0)
+enum class ResourceType : int64_t {
+    Monotonic,
+    Pool,
+    NewDelete,
+};
+
+class BenchmarkResource {
+public:
+    BenchmarkResource(const benchmark::State& state)
+        : mType(static_cast<ResourceType>(state.range(0)))
+    {}
+
+    std::pmr::memory_resource* get() noexcept {
+        switch (mType) {
+        case ResourceType::Monotonic:
+            return &mMonotonic;
+        case ResourceType::Pool:
+            return &mPool;
+        default:
+            return std::pmr::new_delete_resource();
+        }
+    }
+
+    // call at the end of each iteration, monotonic memory is only released here
+    void release() noexcept {
+        if (mType == ResourceType::Monotonic) {
+            mMonotonic.release();
+        }
+    }
+
+    static const char* name(ResourceType type) noexcept {
+        switch (type) {
+        case ResourceType::Monotonic:
+            return "monotonic";
+        case ResourceType::Pool:
+            return "pool";
+        default:
+            return "new_delete";
+        }
+    }
+private:
+    ResourceType mType;
+    std::pmr::monotonic_buffer_resource mMonotonic;
+    std::pmr::unsynchronized_pool_resource mPool;
+};
+
+// registers range(0) for every resource type and range(1) for each size
+inline void applyResources(benchmark::internal::Benchmark* b, std::initializer_list<int64_t> sizes) {
+    b->ArgNames({ "resource", "n" });
+    for (auto type : { ResourceType::Monotonic, ResourceType::Pool, ResourceType::NewDelete }) {
+        for (auto n : sizes) {
+            b->Args({ static_cast<int64_t>(type), n });
+        }
+    }
+}
+
+inline void setLabel(benchmark::State& state) {
+    state.SetLabel(BenchmarkResource::name(static_cast<ResourceType>(state.range(0))));
+}
+
+}
+
+}
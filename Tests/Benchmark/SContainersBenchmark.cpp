@@ -0,0 +1,216 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/SLockFree.h>
+#include "SBenchmarkUtils.h"
+
+using namespace Star;
+using namespace Star::Benchmark;
+
+namespace {
+
+struct NamedValue {
+    std::pmr::string mName;
+    uint32_t mValue;
+};
+
+struct MetaIDValue {
+    const MetaID& metaID() const noexcept {
+        return mMetaID;
+    }
+    MetaID mMetaID;
+    uint32_t mValue;
+};
+
+std::vector<std::string> makeNames(int64_t count) {
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (int64_t i = 0; i != count; ++i) {
+        names.emplace_back("Assets/Textures/texture_" + std::to_string(i * 7919 % count) + ".png");
+    }
+    return names;
+}
+
+std::vector<MetaID> makeMetaIDs(int64_t count) {
+    std::vector<MetaID> ids(count);
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (auto& id : ids) {
+        for (auto& b : id.data) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            b = static_cast<uint8_t>(seed >> 56);
+        }
+    }
+    return ids;
+}
+
+void BM_AlignedBuffer_Resize(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto size = static_cast<size_t>(state.range(1));
+    for (auto _ : state) {
+        {
+            AlignedBuffer16 buffer(resource.get());
+            for (size_t sz = 16; sz <= size; sz *= 2) {
+                buffer.resize_aligned(sz);
+                benchmark::DoNotOptimize(buffer.data());
+            }
+        }
+        resource.release();
+    }
+    setLabel(state);
+}
+BENCHMARK(BM_AlignedBuffer_Resize)->Apply([](auto* b) { applyResources(b, { 1 << 12, 1 << 20 }); });
+
+void BM_MessageQueue_PushPop(benchmark::State& state) {
+    MessageQueue<uint64_t, 64> queue(static_cast<size_t>(state.range(0)));
+    const auto count = state.range(0);
+    for (auto _ : state) {
+        for (int64_t i = 0; i != count; ++i) {
+            queue.bounded_push(static_cast<uint64_t>(i));
+        }
+        uint64_t value = 0;
+        while (queue.pop(value)) {
+            benchmark::DoNotOptimize(value);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_MessageQueue_PushPop)->ArgName("n")->Arg(64)->Arg(4096);
+
+void BM_MessageQueue_Contended(benchmark::State& state) {
+    static MessageQueue<uint64_t, 64> sQueue(4096);
+    for (auto _ : state) {
+        // every thread pushes and pops its own item, the queue never fills
+        while (!sQueue.bounded_push(1)) {
+        }
+        uint64_t value = 0;
+        while (!sQueue.pop(value)) {
+        }
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MessageQueue_Contended)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_PmrFlatMap_Insert(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto count = state.range(1);
+    const auto ids = makeMetaIDs(count);
+    for (auto _ : state) {
+        {
+            PmrFlatMap<uint32_t, uint64_t> map(resource.get());
+            for (int64_t i = 0; i != count; ++i) {
+                map.emplace(static_cast<uint32_t>(ids[i].data[0] << 16 | i), i);
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        resource.release();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    setLabel(state);
+}
+BENCHMARK(BM_PmrFlatMap_Insert)->Apply([](auto* b) { applyResources(b, { 64, 4096 }); });
+
+void BM_PmrFlatMap_Find(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto count = state.range(1);
+    PmrFlatMap<uint32_t, uint64_t> map(resource.get());
+    for (int64_t i = 0; i != count; ++i) {
+        map.emplace(static_cast<uint32_t>(i * 3), i);
+    }
+    uint32_t key = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(key));
+        key = (key + 7) % static_cast<uint32_t>(count * 3);
+    }
+    setLabel(state);
+}
+BENCHMARK(BM_PmrFlatMap_Find)->Apply([](auto* b) { applyResources(b, { 64, 4096 }); });
+
+void BM_PmrOrderedNameMap_Insert(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto count = state.range(1);
+    const auto names = makeNames(count);
+    for (auto _ : state) {
+        {
+            PmrOrderedNameMap<NamedValue> map(resource.get());
+            for (int64_t i = 0; i != count; ++i) {
+                map.emplace(NamedValue{ std::pmr::string(names[i], resource.get()), static_cast<uint32_t>(i) });
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        resource.release();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    setLabel(state);
+}
+BENCHMARK(BM_PmrOrderedNameMap_Insert)->Apply([](auto* b) { applyResources(b, { 64, 4096 }); });
+
+void BM_PmrOrderedNameMap_Find(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto count = state.range(1);
+    const auto names = makeNames(count);
+    PmrOrderedNameMap<NamedValue> map(resource.get());
+    for (int64_t i = 0; i != count; ++i) {
+        map.emplace(NamedValue{ std::pmr::string(names[i], resource.get()), static_cast<uint32_t>(i) });
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        // transparent lookup, no string is constructed
+        benchmark::DoNotOptimize(map.find(std::string_view(names[i])));
+        i = (i + 1) % names.size();
+    }
+    setLabel(state);
+}
+BENCHMARK(BM_PmrOrderedNameMap_Find)->Apply([](auto* b) { applyResources(b, { 64, 4096 }); });
+
+void BM_PmrMetaIDHashMap_Insert(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto count = state.range(1);
+    const auto ids = makeMetaIDs(count);
+    for (auto _ : state) {
+        {
+            PmrMetaIDHashMap<MetaIDValue> map(resource.get());
+            for (int64_t i = 0; i != count; ++i) {
+                map.emplace(MetaIDValue{ ids[i], static_cast<uint32_t>(i) });
+            }
+            benchmark::DoNotOptimize(map.size());
+        }
+        resource.release();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    setLabel(state);
+}
+BENCHMARK(BM_PmrMetaIDHashMap_Insert)->Apply([](auto* b) { applyResources(b, { 64, 4096 }); });
+
+void BM_PmrMetaIDHashMap_Find(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    const auto count = state.range(1);
+    const auto ids = makeMetaIDs(count);
+    PmrMetaIDHashMap<MetaIDValue> map(resource.get());
+    for (int64_t i = 0; i != count; ++i) {
+        map.emplace(MetaIDValue{ ids[i], static_cast<uint32_t>(i) });
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map.find(ids[i]));
+        i = (i + 1) % ids.size();
+    }
+    setLabel(state);
+}
+BENCHMARK(BM_PmrMetaIDHashMap_Find)->Apply([](auto* b) { applyResources(b, { 64, 4096 }); });
+
+}
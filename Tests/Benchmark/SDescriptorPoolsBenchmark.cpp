@@ -0,0 +1,129 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/SDescriptorPools.h>
+#include "SBenchmarkUtils.h"
+
+using namespace Star::Benchmark;
+using namespace Star::Graphics;
+
+namespace {
+
+constexpr uint32_t sBlockSize = 8;
+constexpr uint32_t sBlockCount = 4096;
+constexpr int sBatch = 8;
+
+// previous implementation, mutex guarded deque of ranges, kept as baseline
+class MutexDescriptorPool {
+public:
+    struct Range {
+        uint32_t mBegin;
+        uint32_t mEnd;
+    };
+
+    MutexDescriptorPool(uint32_t blockSize, uint32_t blockCount) {
+        for (uint32_t i = 0; i != blockCount; ++i) {
+            mFreeBlocks.emplace_back(Range{ i * blockSize, (i + 1) * blockSize });
+        }
+    }
+
+    Range allocateRange() {
+        std::lock_guard<std::mutex> guard(mMutex);
+        if (mFreeBlocks.empty()) {
+            throw std::runtime_error("not enough descriptor block");
+        }
+        auto range = mFreeBlocks.front();
+        mFreeBlocks.pop_front();
+        ++mAllocatedCount;
+        return range;
+    }
+
+    void destroyBuffer(const Range& range) {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mFreeBlocks.emplace_back(range);
+        --mAllocatedCount;
+    }
+private:
+    std::mutex mMutex;
+    int32_t mAllocatedCount = 0;
+    std::deque<Range> mFreeBlocks;
+};
+
+void BM_DescriptorPool(benchmark::State& state) {
+    static DescriptorPool sPool(sBlockSize, sBlockSize * sBlockCount, std::pmr::get_default_resource());
+    std::array<DescriptorBlock, sBatch> blocks;
+    for (auto _ : state) {
+        for (auto& block : blocks) {
+            block = sPool.allocateRange();
+        }
+        for (auto& block : blocks) {
+            block = DescriptorBlock();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sBatch);
+}
+BENCHMARK(BM_DescriptorPool)->ThreadRange(1, 32)->UseRealTime();
+
+void BM_MutexDescriptorPool(benchmark::State& state) {
+    static MutexDescriptorPool sPool(sBlockSize, sBlockCount);
+    std::array<MutexDescriptorPool::Range, sBatch> blocks;
+    for (auto _ : state) {
+        for (auto& block : blocks) {
+            block = sPool.allocateRange();
+        }
+        for (const auto& block : blocks) {
+            sPool.destroyBuffer(block);
+        }
+        benchmark::DoNotOptimize(blocks);
+    }
+    state.SetItemsProcessed(state.iterations() * sBatch);
+}
+BENCHMARK(BM_MutexDescriptorPool)->ThreadRange(1, 32)->UseRealTime();
+
+// one frame of persistent descriptors: allocate, release, then retire the
+// deallocation lists of every swapchain image
+void BM_PersistentDescriptorTable(benchmark::State& state) {
+    BenchmarkResource resource(state);
+    constexpr uint32_t swapchainCount = 3;
+    constexpr uint32_t vectorSize = 4;
+    constexpr uint32_t binSize = 64;
+    const auto count = static_cast<uint32_t>(state.range(1));
+    DescriptorPool pool(vectorSize * binSize, vectorSize * binSize * 64, std::pmr::get_default_resource());
+    std::vector<uint32_t> ranges(count);
+    for (auto _ : state) {
+        {
+            PersistentDescriptorTable table(swapchainCount, 64,
+                PersistentDescriptorBlock::VectorSize{ vectorSize },
+                PersistentDescriptorBlock::BinSize{ binSize }, resource.get());
+            for (auto& range : ranges) {
+                range = table.allocate(&pool).first;
+            }
+            for (auto range : ranges) {
+                table.deallocate(range);
+            }
+            for (uint32_t i = 0; i != swapchainCount; ++i) {
+                table.advanceFrame();
+            }
+        }
+        resource.release();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    setLabel(state);
+}
+BENCHMARK(BM_PersistentDescriptorTable)->Apply([](auto* b) { applyResources(b, { 64, 1024 }); });
+
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SDrawPacket.h>
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// one batch of a scene, a few dozen psos, materials and meshes and random depth
+std::pmr::vector<DrawPacket> makePackets(size_t count) {
+    std::mt19937 rng(42);
+    auto address = [&](uint32_t pool, uint32_t n) {
+        return 0x10000000ull * (pool + 1) + 0x140ull * (rng() % n);
+    };
+    std::pmr::vector<DrawPacket> packets;
+    packets.reserve(count);
+    for (uint32_t i = 0; i != count; ++i) {
+        const auto pso = address(0, 16);
+        const auto material = address(1, 64);
+        const auto mesh = address(2, 256);
+        packets.emplace_back(DrawPacket{
+            makeDrawSortKey(0, pso, material, mesh, rng() % sDrawDepthBuckets), i });
+    }
+    return packets;
+}
+
+// each iteration restores the unsorted packets and sorts them, as once per batch
+
+void BM_RadixSortDrawPackets(benchmark::State& state) {
+    const auto input = makePackets(static_cast<size_t>(state.range(0)));
+    std::pmr::vector<DrawPacket> packets;
+    std::pmr::vector<DrawPacket> scratch;
+    packets.reserve(input.size());
+    scratch.reserve(input.size());
+    for (auto _ : state) {
+        packets.assign(input.begin(), input.end());
+        radixSortDrawPackets(packets, scratch);
+        benchmark::DoNotOptimize(packets.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RadixSortDrawPackets)->RangeMultiplier(8)->Range(64, 64 << 12);
+
+void BM_StdSortDrawPackets(benchmark::State& state) {
+    const auto input = makePackets(static_cast<size_t>(state.range(0)));
+    std::pmr::vector<DrawPacket> packets;
+    packets.reserve(input.size());
+    for (auto _ : state) {
+        packets.assign(input.begin(), input.end());
+        std::sort(packets.begin(), packets.end(), [](const DrawPacket& lhs, const DrawPacket& rhs) {
+            return lhs.mKey < rhs.mKey;
+        });
+        benchmark::DoNotOptimize(packets.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StdSortDrawPackets)->RangeMultiplier(8)->Range(64, 64 << 12);
+
+// the radix sort is stable, this is the like for like baseline
+void BM_StdStableSortDrawPackets(benchmark::State& state) {
+    const auto input = makePackets(static_cast<size_t>(state.range(0)));
+    std::pmr::vector<DrawPacket> packets;
+    packets.reserve(input.size());
+    for (auto _ : state) {
+        packets.assign(input.begin(), input.end());
+        std::stable_sort(packets.begin(), packets.end(), [](const DrawPacket& lhs, const DrawPacket& rhs) {
+            return lhs.mKey < rhs.mKey;
+        });
+        benchmark::DoNotOptimize(packets.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StdStableSortDrawPackets)->RangeMultiplier(8)->Range(64, 64 << 12);
+
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Core/SHandleTable.h>
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Star;
+using namespace Star::Core;
+
+namespace {
+
+// n resources, looked up in random order as a frame would touch them
+
+std::vector<MetaID> makeMetaIDs(size_t count) {
+    boost::uuids::basic_random_generator<std::mt19937> gen;
+    std::vector<MetaID> ids(count);
+    for (auto& id : ids) {
+        id = gen();
+    }
+    return ids;
+}
+
+std::vector<uint32_t> makeOrder(size_t count) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> order(count * 4);
+    for (auto& i : order) {
+        i = static_cast<uint32_t>(rng() % count);
+    }
+    return order;
+}
+
+void BM_HandleGet(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto ids = makeMetaIDs(count);
+    const auto order = makeOrder(count);
+    HandleTable<uint64_t> table(std::pmr::get_default_resource());
+    std::vector<Handle> handles(count);
+    for (size_t i = 0; i != count; ++i) {
+        handles[i] = table.try_emplace(ids[i], i).first;
+    }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (auto i : order) {
+            sum += *table.get(handles[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+BENCHMARK(BM_HandleGet)->Arg(1000)->Arg(100000);
+
+void BM_HandleFind(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto ids = makeMetaIDs(count);
+    const auto order = makeOrder(count);
+    HandleTable<uint64_t> table(std::pmr::get_default_resource());
+    for (size_t i = 0; i != count; ++i) {
+        table.try_emplace(ids[i], i);
+    }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (auto i : order) {
+            sum += *table.get(table.find(ids[i]));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+BENCHMARK(BM_HandleFind)->Arg(1000)->Arg(100000);
+
+void BM_MetaIDHashFind(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto ids = makeMetaIDs(count);
+    const auto order = makeOrder(count);
+    std::pmr::unordered_map<MetaID, uint64_t, boost::hash<MetaID>> map;
+    for (size_t i = 0; i != count; ++i) {
+        map.emplace(ids[i], i);
+    }
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (auto i : order) {
+            sum += map.find(ids[i])->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+}
+BENCHMARK(BM_MetaIDHashFind)->Arg(1000)->Arg(100000);
+
+}
@@ -0,0 +1,65 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/SInstanceBatching.h>
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// objects and their instance classes are shuffled once, each iteration restores
+// the visible list and groups it again, as the frame queue does per batch
+
+void BM_BuildInstanceGroups(benchmark::State& state) {
+    const auto objectCount = static_cast<uint32_t>(state.range(0));
+    const auto classCount = static_cast<uint32_t>(state.range(1));
+    const auto maxInstanceCount = static_cast<uint32_t>(state.range(2));
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> classes(objectCount);
+    for (auto& c : classes) {
+        c = rng() % classCount;
+    }
+    std::vector<uint32_t> visible(objectCount);
+    std::iota(visible.begin(), visible.end(), 0u);
+    std::shuffle(visible.begin(), visible.end(), rng);
+
+    std::pmr::vector<uint32_t> objects(std::pmr::get_default_resource());
+    std::pmr::vector<InstanceGroup> groups(std::pmr::get_default_resource());
+    objects.reserve(objectCount);
+    groups.reserve(objectCount);
+    for (auto _ : state) {
+        objects.assign(visible.begin(), visible.end());
+        buildInstanceGroups(classes, maxInstanceCount, objects, groups);
+        benchmark::DoNotOptimize(groups.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["groups"] = static_cast<double>(groups.size());
+    state.SetItemsProcessed(state.iterations() * objectCount);
+}
+BENCHMARK(BM_BuildInstanceGroups)
+    ->ArgNames({ "objects", "classes", "maxInstances" })
+    ->Args({ 1024, 16, 1 })
+    ->Args({ 1024, 16, 64 })
+    ->Args({ 16384, 16, 64 })
+    ->Args({ 16384, 1024, 64 })
+    ->Args({ 16384, 1024, 512 });
+
+}
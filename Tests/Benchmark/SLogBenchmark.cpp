@@ -0,0 +1,135 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Log/SLog.h>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+using namespace Star;
+
+namespace {
+
+enum class LogMode : int64_t {
+    Sync,
+    Async,
+    AsyncBinary,
+};
+
+// swallows console output, the benchmark measures the caller, not the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+    }
+};
+
+NullBuffer sNullBuffer;
+std::streambuf* sConsoleBuffer = nullptr;
+
+std::string logFilename() {
+    return (std::filesystem::temp_directory_path() / "star_log_benchmark.log").string();
+}
+
+void beginLogging(LogMode mode) {
+    sConsoleBuffer = std::clog.rdbuf(&sNullBuffer);
+    auto filename = logFilename();
+    switch (mode) {
+    case LogMode::Sync:
+        initLogging(boost::log::trivial::info, filename.c_str());
+        break;
+    case LogMode::Async:
+        initAsyncLogging(boost::log::trivial::info, filename.c_str());
+        break;
+    case LogMode::AsyncBinary: {
+        AsyncLogSettings settings;
+        settings.mBinary = true;
+        initAsyncLogging(boost::log::trivial::info, filename.c_str(), settings);
+        break;
+    }
+    }
+}
+
+void endLogging() {
+    // joins the writer, every queued record is written before the console is restored
+    exitLogging();
+    std::clog.rdbuf(sConsoleBuffer);
+    std::error_code ec;
+    std::filesystem::remove(logFilename(), ec);
+}
+
+double percentile(std::vector<int64_t>& samples, double p) {
+    if (samples.empty())
+        return 0;
+    auto nth = samples.begin() + static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return static_cast<double>(*nth);
+}
+
+// time spent in the calling thread per S_INFO, p50/p99 in nanoseconds averaged over threads
+void BM_LogLatency(benchmark::State& state) {
+    const auto mode = static_cast<LogMode>(state.range(0));
+    if (state.thread_index() == 0) {
+        beginLogging(mode);
+    }
+
+    std::vector<int64_t> samples;
+    samples.reserve(1 << 20);
+    int64_t i = 0;
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        S_INFO << "frame " << i << " thread " << state.thread_index() << " draw calls " << 1024;
+        auto stop = std::chrono::steady_clock::now();
+        if (samples.size() < samples.capacity()) {
+            samples.emplace_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+        ++i;
+    }
+
+    if (state.thread_index() == 0) {
+        endLogging();
+    }
+
+    state.counters["p50_ns"] = benchmark::Counter(percentile(samples, 0.5), benchmark::Counter::kAvgThreads);
+    state.counters["p99_ns"] = benchmark::Counter(percentile(samples, 0.99), benchmark::Counter::kAvgThreads);
+    state.SetItemsProcessed(state.iterations());
+    switch (mode) {
+    case LogMode::Sync:
+        state.SetLabel("sync");
+        break;
+    case LogMode::Async:
+        state.SetLabel("async");
+        break;
+    case LogMode::AsyncBinary:
+        state.SetLabel("async_binary");
+        break;
+    }
+}
+BENCHMARK(BM_LogLatency)->ArgName("mode")
+    ->Arg(static_cast<int64_t>(LogMode::Sync))
+    ->Arg(static_cast<int64_t>(LogMode::Async))
+    ->Arg(static_cast<int64_t>(LogMode::AsyncBinary))
+    ->Threads(1)->Threads(2)->Threads(4)->UseRealTime();
+
+}
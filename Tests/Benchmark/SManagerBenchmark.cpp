@@ -0,0 +1,220 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Core/SManagerPrivate.h>
+#include <Star/Core/SFetch.h>
+#include <benchmark/benchmark.h>
+
+using namespace Star;
+using namespace Star::Core;
+
+namespace {
+
+// small resources that are ready as soon as they are loaded, measures the manager alone
+class NullProducer : public Producer {
+public:
+    NullProducer(const ResourceType& tag, bool concurrent) {
+        registerProducer(tag, concurrent);
+    }
+
+    std::atomic<size_t> mStarted = 0;
+    size_t mCreated = 0;
+    size_t mDestroyed = 0;
+private:
+    bool load(const Resource& resource, bool async, CancellationToken token) override {
+        ++mStarted;
+        deliver(resource, &mPayload, async, 64);
+        return true;
+    }
+
+    void created(const Resource& resource) override {
+        ++mCreated;
+    }
+
+    void destroy(const Resource& resource) noexcept override {
+        ++mDestroyed;
+    }
+
+    uint64_t mPayload = 0;
+};
+
+MetaID makeMetaID(uint64_t i) noexcept {
+    MetaID id{};
+    for (size_t k = 0; k != sizeof(i); ++k) {
+        id.data[k] = static_cast<uint8_t>(i >> (k * 8));
+    }
+    return id;
+}
+
+void frame() {
+    Workflow::processEvents();
+    Workflow::loadResources();
+    Workflow::processEvents();
+    Workflow::updateResources();
+}
+
+// acquires range(0) resources, runs frames until all are loaded, then releases them
+// and runs frames until all are unloaded. range(1) is the loader thread count,
+// 0 loads on the calling thread
+void BM_ManagerLoadRelease(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto loaderCount = static_cast<size_t>(state.range(1));
+    Workflow::init(count * 2, 64, loaderCount);
+    {
+        NullProducer producer(Mesh, loaderCount != 0);
+        std::vector<const Resource*> resources(count);
+        for (size_t i = 0; i != count; ++i) {
+            resources[i] = Manager::instance().get(makeMetaID(i), Mesh);
+        }
+        size_t frames = 0;
+        for (auto _ : state) {
+            for (auto pResource : resources) {
+                pResource->async_acquire();
+            }
+            const auto created = producer.mCreated + count;
+            while (producer.mCreated != created) {
+                frame();
+                ++frames;
+            }
+            for (auto pResource : resources) {
+                pResource->release();
+            }
+            const auto destroyed = producer.mDestroyed + count;
+            while (producer.mDestroyed != destroyed) {
+                frame();
+                ++frames;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.counters["frames"] = benchmark::Counter(
+            static_cast<double>(frames), benchmark::Counter::kAvgIterations);
+        Workflow::stop();
+        Workflow::terminate();
+    }
+}
+BENCHMARK(BM_ManagerLoadRelease)
+    ->ArgNames({ "n", "loaders" })
+    ->Args({ 10000, 0 })
+    ->Args({ 10000, 4 })
+    ->Unit(benchmark::kMillisecond);
+
+// acquires and releases range(0) resources every frame for 8 frames, so loads are
+// cancelled while queued, waiting for a loader or running, then runs frames until all
+// are unloaded. range(1) is the loader thread count
+void BM_ManagerThrash(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    const auto loaderCount = static_cast<size_t>(state.range(1));
+    Workflow::init(count * 2, 64, loaderCount);
+    {
+        NullProducer producer(Mesh, loaderCount != 0);
+        std::vector<const Resource*> resources(count);
+        for (size_t i = 0; i != count; ++i) {
+            resources[i] = Manager::instance().get(makeMetaID(i), Mesh);
+        }
+        auto settled = [&]() {
+            return producer.mStarted.load() == producer.mCreated &&
+                std::all_of(resources.begin(), resources.end(), [](const Resource* pResource) {
+                    return pResource->current_state()[0] == 0;
+                });
+        };
+        for (auto _ : state) {
+            for (int cycle = 0; cycle != 8; ++cycle) {
+                for (auto pResource : resources) {
+                    pResource->async_acquire();
+                }
+                frame();
+                for (auto pResource : resources) {
+                    pResource->release();
+                }
+                frame();
+            }
+            while (!settled()) {
+                frame();
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0) * 8);
+        Workflow::stop();
+        Workflow::terminate();
+    }
+}
+BENCHMARK(BM_ManagerThrash)
+    ->ArgNames({ "n", "loaders" })
+    ->Args({ 1000, 0 })
+    ->Args({ 1000, 4 })
+    ->Unit(benchmark::kMillisecond);
+
+// acquires range(0) loaded resources and polls them until all are ready, one Fetch
+// and one load command per resource, or one FetchGroup for all of them
+void BM_AcquirePerResource(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    Workflow::init(count * 2, 64);
+    {
+        NullProducer producer(Mesh, false);
+        Workflow::setBudget(Mesh, count * 64);
+        std::vector<MetaID> ids(count);
+        for (size_t i = 0; i != count; ++i) {
+            ids[i] = makeMetaID(i);
+        }
+        std::vector<FetchBase> fetches;
+        fetches.reserve(count);
+        for (auto _ : state) {
+            for (const auto& id : ids) {
+                fetches.emplace_back(id, Mesh, true);
+            }
+            for (bool ready = false; !ready; ) {
+                frame();
+                ready = std::none_of(fetches.begin(), fetches.end(),
+                    [](const FetchBase& fetch) { return fetch.loading(); });
+            }
+            fetches.clear();
+            frame();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        Workflow::stop();
+        Workflow::terminate();
+    }
+}
+BENCHMARK(BM_AcquirePerResource)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+void BM_AcquireGroup(benchmark::State& state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    Workflow::init(count * 2, 64);
+    {
+        NullProducer producer(Mesh, false);
+        Workflow::setBudget(Mesh, count * 64);
+        std::vector<MetaID> ids(count);
+        for (size_t i = 0; i != count; ++i) {
+            ids[i] = makeMetaID(i);
+        }
+        for (auto _ : state) {
+            FetchGroup group(ids, Mesh);
+            while (!group.done()) {
+                frame();
+            }
+            benchmark::DoNotOptimize(group.ready());
+            group = FetchGroup();
+            frame();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        Workflow::stop();
+        Workflow::terminate();
+    }
+}
+BENCHMARK(BM_AcquireGroup)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+}
@@ -0,0 +1,126 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SObjectConstants.h>
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Star;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// a culled batch: transforms of every object, the visible ones grouped by instance class
+struct Batch {
+    std::vector<WorldTransform> mWorlds;
+    std::vector<WorldTransformInv> mWorldInvs;
+    std::pmr::vector<uint32_t> mObjects;
+    std::pmr::vector<InstanceGroup> mGroups;
+    Matrix4f mView = Matrix4f::Identity();
+};
+
+Batch makeBatch(uint32_t objectCount, uint32_t classCount) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    Batch batch;
+    batch.mWorlds.resize(objectCount);
+    batch.mWorldInvs.resize(objectCount);
+    std::vector<uint32_t> classes(objectCount);
+    for (uint32_t i = 0; i != objectCount; ++i) {
+        batch.mWorlds[i].mTransform = Translation3f(dist(rng), dist(rng), dist(rng))
+            * AngleAxisf(dist(rng), Vector3f::UnitY());
+        batch.mWorldInvs[i].mTransform = batch.mWorlds[i].mTransform.inverse().matrix().transpose();
+        classes[i] = rng() % classCount;
+    }
+    batch.mView = (Translation3f(0, 0, -50) * AngleAxisf(0.3f, Vector3f::UnitX())).matrix();
+
+    // about half of the batch is visible
+    for (uint32_t i = 0; i != objectCount; ++i) {
+        if (rng() % 2) {
+            batch.mObjects.emplace_back(i);
+        }
+    }
+    buildInstanceGroups(classes, sMaxInstanceCount, batch.mObjects, batch.mGroups);
+    return batch;
+}
+
+// structure of arrays, one pass over the visible objects per batch
+void BM_PackObjectConstants(benchmark::State& state) {
+    const auto batch = makeBatch(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+    std::pmr::vector<uint32_t> slots;
+    std::vector<std::byte> block;
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        const auto layout = placeObjectConstants(batch.mGroups, slots);
+        block.resize(layout.mSize);
+        packObjectConstants(batch.mView, batch.mWorlds, batch.mWorldInvs,
+            batch.mObjects, batch.mGroups, slots, block);
+        benchmark::DoNotOptimize(block.data());
+        benchmark::ClobberMemory();
+        bytes += layout.mSize;
+    }
+    state.counters["groups"] = static_cast<double>(batch.mGroups.size());
+    state.SetItemsProcessed(state.iterations() * batch.mObjects.size());
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_PackObjectConstants)
+    ->ArgNames({ "objects", "classes" })
+    ->Args({ 1024, 1024 })
+    ->Args({ 1024, 16 })
+    ->Args({ 16384, 16384 })
+    ->Args({ 16384, 256 });
+
+// previous path: every draw packs its instances into its own 256-byte aligned record,
+// a renderer with several materials draws and packs once per material
+void BM_PackPerDraw(benchmark::State& state) {
+    const auto batch = makeBatch(static_cast<uint32_t>(state.range(0)), static_cast<uint32_t>(state.range(1)));
+    const auto materialCount = static_cast<uint32_t>(state.range(2));
+    constexpr size_t stride = 2 * sizeof(Matrix4f);
+    std::vector<std::byte> ring(materialCount * (batch.mObjects.size() * stride + batch.mGroups.size() * 256));
+    uint64_t bytes = 0;
+    for (auto _ : state) {
+        auto* pRecord = ring.data();
+        for (uint32_t draw = 0; draw != batch.mGroups.size() * materialCount; ++draw) {
+            const auto& group = batch.mGroups[draw / materialCount];
+            auto* pData = pRecord;
+            for (uint32_t i = 0; i != group.mCount; ++i) {
+                const auto objectID = batch.mObjects[group.mFirst + i];
+                const Matrix4f worldView = batch.mView * batch.mWorlds[objectID].mTransform.matrix();
+                memcpy(pData, worldView.data(), sizeof(Matrix4f));
+                memcpy(pData + sizeof(Matrix4f), batch.mWorldInvs[objectID].mTransform.matrix().data(), sizeof(Matrix4f));
+                pData += stride;
+            }
+            pRecord += boost::alignment::align_up(group.mCount * stride, 256);
+        }
+        benchmark::DoNotOptimize(ring.data());
+        benchmark::ClobberMemory();
+        bytes += pRecord - ring.data();
+    }
+    state.counters["groups"] = static_cast<double>(batch.mGroups.size());
+    state.SetItemsProcessed(state.iterations() * batch.mObjects.size());
+    state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_PackPerDraw)
+    ->ArgNames({ "objects", "classes", "materials" })
+    ->Args({ 1024, 1024, 1 })
+    ->Args({ 1024, 16, 1 })
+    ->Args({ 16384, 16384, 1 })
+    ->Args({ 16384, 256, 1 })
+    ->Args({ 16384, 256, 3 });
+
+}
@@ -0,0 +1,125 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Core/SResourceTable.h>
+#include "SBenchmarkUtils.h"
+
+using namespace Star;
+using namespace Star::Core;
+
+namespace {
+
+constexpr int64_t sResourceCount = 4096;
+constexpr int sBatch = 64;
+
+// previous Manager::get, one mutex around a MetaID hash map, kept as baseline
+class MutexResourceMap {
+public:
+    const Resource* get(const MetaID& metaID, const ResourceType& tag) {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        auto iter = mResources.find(metaID);
+        if (iter == mResources.end()) {
+            iter = mResources.emplace(metaID, tag).first;
+        }
+        return &*iter;
+    }
+private:
+    std::mutex mMutex;
+    MetaIDHashMap<Resource> mResources;
+};
+
+std::vector<MetaID> makeMetaIDs(int64_t count) {
+    std::vector<MetaID> ids(count);
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (auto& id : ids) {
+        for (auto& b : id.data) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            b = static_cast<uint8_t>(seed >> 56);
+        }
+    }
+    return ids;
+}
+
+const std::vector<MetaID>& getMetaIDs() {
+    static const auto sIDs = makeMetaIDs(sResourceCount);
+    return sIDs;
+}
+
+// every thread looks up resources already in the table, the common Manager::get case
+void BM_MutexResourceMap_Get(benchmark::State& state) {
+    static MutexResourceMap sMap;
+    const auto& ids = getMetaIDs();
+    if (state.thread_index() == 0) {
+        for (const auto& id : ids) {
+            sMap.get(id, Mesh);
+        }
+    }
+    size_t i = state.thread_index() * 997;
+    for (auto _ : state) {
+        for (int k = 0; k != sBatch; ++k) {
+            benchmark::DoNotOptimize(sMap.get(ids[i++ % ids.size()], Mesh));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sBatch);
+}
+BENCHMARK(BM_MutexResourceMap_Get)->ThreadRange(1, 16)->UseRealTime();
+
+void BM_ResourceTable_Get(benchmark::State& state) {
+    static ResourceTable sTable(sResourceCount * 2);
+    const auto& ids = getMetaIDs();
+    if (state.thread_index() == 0) {
+        for (const auto& id : ids) {
+            sTable.try_emplace(id, Mesh);
+        }
+    }
+    size_t i = state.thread_index() * 997;
+    for (auto _ : state) {
+        for (int k = 0; k != sBatch; ++k) {
+            benchmark::DoNotOptimize(&sTable.try_emplace(ids[i++ % ids.size()], Mesh));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * sBatch);
+}
+BENCHMARK(BM_ResourceTable_Get)->ThreadRange(1, 16)->UseRealTime();
+
+// first acquire of a whole resource set, every lookup inserts
+void BM_MutexResourceMap_Insert(benchmark::State& state) {
+    const auto& ids = getMetaIDs();
+    for (auto _ : state) {
+        MutexResourceMap map;
+        for (const auto& id : ids) {
+            benchmark::DoNotOptimize(map.get(id, Mesh));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ids.size());
+}
+BENCHMARK(BM_MutexResourceMap_Insert);
+
+void BM_ResourceTable_Insert(benchmark::State& state) {
+    const auto& ids = getMetaIDs();
+    for (auto _ : state) {
+        ResourceTable table(ids.size() * 2);
+        for (const auto& id : ids) {
+            benchmark::DoNotOptimize(&table.try_emplace(id, Mesh));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * ids.size());
+}
+BENCHMARK(BM_ResourceTable_Insert);
+
+}
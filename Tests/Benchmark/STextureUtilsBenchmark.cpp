@@ -0,0 +1,66 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/STextureUtils.h>
+#include <benchmark/benchmark.h>
+
+using namespace Star;
+
+namespace {
+
+// sizes are read through DoNotOptimize, so the constexpr math runs at run time
+
+void BM_TextureSize(benchmark::State& state) {
+    uint32_t width = static_cast<uint32_t>(state.range(0));
+    uint32_t height = width / 2;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(width);
+        benchmark::DoNotOptimize(height);
+        // BC7, 4x4 blocks of 16 bytes, D3D12 row and placement alignment
+        auto size = texture_size(width, height, 4, 4, 16, 256, 512);
+        benchmark::DoNotOptimize(size);
+    }
+}
+BENCHMARK(BM_TextureSize)->ArgName("width")->Arg(256)->Arg(4096)->Arg(16384);
+
+void BM_MipInfo(benchmark::State& state) {
+    uint32_t width = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(width);
+        uint32_t x = width;
+        uint32_t y = width;
+        for (uint32_t level = 0; level != mip_count(width, width); ++level) {
+            auto info = mip_info(x, y, 4, 4, 16, 256);
+            benchmark::DoNotOptimize(info);
+            x = half_size(x);
+            y = half_size(y);
+        }
+    }
+}
+BENCHMARK(BM_MipInfo)->ArgName("width")->Arg(256)->Arg(4096);
+
+void BM_YUV420TextureSize(benchmark::State& state) {
+    uint32_t width = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(width);
+        auto size = y_uv_420_texture_size(width, width, 1, 256);
+        benchmark::DoNotOptimize(size);
+    }
+}
+BENCHMARK(BM_YUV420TextureSize)->ArgName("width")->Arg(1920)->Arg(3840);
+
+}
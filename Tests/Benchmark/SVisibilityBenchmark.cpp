@@ -0,0 +1,112 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SVisibility.h>
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Star;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// boxes scattered around the unit clip cube, about one in twenty visible
+std::vector<BoundingBox> makeBoxes(size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> ext(0.0f, 0.5f);
+    std::vector<BoundingBox> boxes(count);
+    for (auto& box : boxes) {
+        Vector3f c(pos(rng), pos(rng), pos(rng));
+        Vector3f e(ext(rng), ext(rng), ext(rng));
+        box.mWorldBounds = Box3f(Vector3f(c - e), Vector3f(c + e));
+        box.mLocalBounds = box.mWorldBounds;
+    }
+    return boxes;
+}
+
+// one box at a time against each plane, the loop the kernels replace
+void cullScalar(const Frustum& frustum, gsl::span<const BoundingBox> boxes,
+    std::pmr::vector<uint32_t>& visible
+) {
+    visible.clear();
+    for (uint32_t i = 0; i != boxes.size(); ++i) {
+        const auto& b = boxes[i].mWorldBounds;
+        const Vector3f c = (b.min_corner() + b.max_corner()) * 0.5f;
+        const Vector3f e = (b.max_corner() - b.min_corner()) * 0.5f;
+        bool inside = true;
+        for (const auto& plane : frustum.mPlanes) {
+            if (plane.head<3>().dot(c) + plane[3] + plane.head<3>().cwiseAbs().dot(e) < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside) {
+            visible.emplace_back(i);
+        }
+    }
+}
+
+void setCounters(benchmark::State& state, size_t visibleCount) {
+    state.counters["visible"] = static_cast<double>(visibleCount);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CullScalar(benchmark::State& state) {
+    const auto boxes = makeBoxes(state.range(0));
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    std::pmr::vector<uint32_t> visible;
+    visible.reserve(boxes.size());
+    for (auto _ : state) {
+        cullScalar(frustum, boxes, visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+    setCounters(state, visible.size());
+}
+BENCHMARK(BM_CullScalar)->ArgName("boxes")->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+// one range, the simd kernel on the calling thread
+void BM_CullRange(benchmark::State& state) {
+    const auto boxes = makeBoxes(state.range(0));
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    std::pmr::vector<uint32_t> visible;
+    visible.reserve(boxes.size());
+    for (auto _ : state) {
+        visible.clear();
+        cullBoundingBoxes(frustum, boxes, 0, gsl::narrow<uint32_t>(boxes.size()), visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+    setCounters(state, visible.size());
+}
+BENCHMARK(BM_CullRange)->ArgName("boxes")->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+
+// split into 4096 box ranges culled in parallel, as the frame queue calls it
+void BM_CullParallel(benchmark::State& state) {
+    const auto boxes = makeBoxes(state.range(0));
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    std::pmr::vector<uint32_t> visible;
+    for (auto _ : state) {
+        cullBoundingBoxes(frustum, boxes, visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+    setCounters(state, visible.size());
+}
+BENCHMARK(BM_CullParallel)->ArgName("boxes")->Arg(100000)->Arg(1000000)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+}
@@ -0,0 +1,481 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/AssetFactory/SAssetBlockCompression.h>
+#include <Star/SAlignedBuffer.h>
+#include <3rdparty/DXTCompressor/DXTCompressorDLL.h>
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace Star;
+using namespace Star::Asset;
+
+namespace {
+
+constexpr uint32_t sBlockSize = 4;
+constexpr uint32_t sSrcBPE = 4 * sBlockSize * sBlockSize;
+
+// rgba8 noise over a smooth gradient, so endpoints differ from block to block
+void makeImage(AlignedBuffer16& image, uint32_t width, uint32_t height, int noiseAmplitude = 24) {
+    image.resize_aligned(size_t(width) * height * 4);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> noise(-noiseAmplitude, noiseAmplitude);
+    auto* texels = reinterpret_cast<uint8_t*>(image.data());
+    for (uint32_t y = 0; y != height; ++y) {
+        for (uint32_t x = 0; x != width; ++x) {
+            auto* t = texels + (size_t(y) * width + x) * 4;
+            t[0] = static_cast<uint8_t>(std::clamp<int>(x * 255 / width + noise(rng), 0, 255));
+            t[1] = static_cast<uint8_t>(std::clamp<int>(y * 255 / height + noise(rng), 0, 255));
+            t[2] = static_cast<uint8_t>(std::clamp<int>(128 + noise(rng), 0, 255));
+            t[3] = static_cast<uint8_t>(std::clamp<int>((x + y) * 255 / (width + height) + noise(rng), 0, 255));
+        }
+    }
+}
+
+void compressBC1(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageDXT1SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void compressBC3(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageDXT5SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+struct StripCase {
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mGrainBlocks;
+};
+
+// small grains split test sized images into many strips, including a short last one
+constexpr StripCase sStripCases[] = {
+    { 256, 256, 64 },
+    { 1024, 36, 256 },
+    { 8, 1024, 4 },
+    { 512, 128, 100 },
+    { 64, 64, 1 },
+};
+
+template<class Compress>
+void expectStripsMatchSingleCall(uint32_t dstBPE, Compress compress) {
+    for (const auto& c : sStripCases) {
+        SCOPED_TRACE(testing::Message() << c.mWidth << "x" << c.mHeight << " grain " << c.mGrainBlocks);
+        AlignedBuffer16 image(std::pmr::get_default_resource());
+        makeImage(image, c.mWidth, c.mHeight);
+        const size_t dstSize = size_t(c.mWidth / sBlockSize) * (c.mHeight / sBlockSize) * dstBPE;
+
+        std::vector<std::byte> expected(dstSize);
+        compress(image.data(), expected.data(), c.mWidth, c.mHeight);
+
+        std::vector<std::byte> strips(dstSize);
+        compressBlockRows(std::pmr::get_default_resource(), image.data(), strips.data(),
+            c.mWidth, c.mHeight, sBlockSize, sBlockSize, sSrcBPE, dstBPE, compress, c.mGrainBlocks);
+        EXPECT_EQ(strips, expected);
+    }
+}
+
+
+void compressBC4(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h, int channel = 0) {
+    DXTC::CompressImageBC4SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h, channel);
+}
+
+void compressBC5(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageBC5SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+void compressBC7(const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+    DXTC::CompressImageBC7Mode6SSE2(reinterpret_cast<const uint8_t*>(src),
+        reinterpret_cast<uint8_t*>(dst), w, h);
+}
+
+// reference decoders written from the format specification, independent of the encoders
+
+// 8 byte bc4 unorm block to 16 values
+std::array<uint8_t, 16> decodeBC4(const uint8_t* block) {
+    const int r0 = block[0];
+    const int r1 = block[1];
+    int palette[8] = { r0, r1 };
+    if (r0 > r1) {
+        for (int i = 1; i != 7; ++i) {
+            palette[i + 1] = ((7 - i) * r0 + i * r1 + 3) / 7;
+        }
+    } else {
+        for (int i = 1; i != 5; ++i) {
+            palette[i + 1] = ((5 - i) * r0 + i * r1 + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i != 6; ++i) {
+        bits |= uint64_t(block[2 + i]) << (8 * i);
+    }
+    std::array<uint8_t, 16> values;
+    for (int i = 0; i != 16; ++i) {
+        values[i] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7]);
+    }
+    return values;
+}
+
+uint32_t readBits(const uint8_t* block, uint32_t& position, uint32_t count) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i != count; ++i, ++position) {
+        value |= uint32_t((block[position >> 3] >> (position & 7)) & 1) << i;
+    }
+    return value;
+}
+
+// 16 byte bc7 block to 16 rgba8 texels, mode 6 only
+std::array<uint8_t, 64> decodeBC7Mode6(const uint8_t* block) {
+    constexpr int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    uint32_t position = 7;
+    int endpoints[2][4];
+    for (int c = 0; c != 4; ++c) {
+        endpoints[0][c] = readBits(block, position, 7);
+        endpoints[1][c] = readBits(block, position, 7);
+    }
+    for (int e = 0; e != 2; ++e) {
+        const auto pbit = readBits(block, position, 1);
+        for (int c = 0; c != 4; ++c) {
+            endpoints[e][c] = (endpoints[e][c] << 1) | pbit;
+        }
+    }
+    std::array<uint8_t, 64> texels;
+    for (int i = 0; i != 16; ++i) {
+        const auto w = weights[readBits(block, position, i == 0 ? 3 : 4)];
+        for (int c = 0; c != 4; ++c) {
+            texels[i * 4 + c] = static_cast<uint8_t>(
+                ((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6);
+        }
+    }
+    return texels;
+}
+
+struct DecodedImage {
+    uint32_t mWidth = 0;
+    uint32_t mHeight = 0;
+    uint32_t mChannels = 0;
+    std::vector<uint8_t> mTexels;
+};
+
+// decodeBlock(block, texels) writes 16 texels of the given channel count
+template<class DecodeBlock>
+DecodedImage decodeImage(const std::vector<std::byte>& data, uint32_t width, uint32_t height,
+    uint32_t channels, uint32_t blockBytes, DecodeBlock decodeBlock
+) {
+    DecodedImage decoded{ width, height, channels,
+        std::vector<uint8_t>(size_t(width) * height * channels) };
+    const auto* block = reinterpret_cast<const uint8_t*>(data.data());
+    uint8_t texels[64];
+    for (uint32_t by = 0; by != height; by += sBlockSize) {
+        for (uint32_t bx = 0; bx != width; bx += sBlockSize, block += blockBytes) {
+            decodeBlock(block, texels);
+            for (uint32_t i = 0; i != 16; ++i) {
+                const auto x = bx + i % sBlockSize;
+                const auto y = by + i / sBlockSize;
+                std::copy_n(texels + i * channels, channels,
+                    decoded.mTexels.data() + (size_t(y) * width + x) * channels);
+            }
+        }
+    }
+    return decoded;
+}
+
+DecodedImage decodeBC4Image(const std::vector<std::byte>& data, uint32_t width, uint32_t height) {
+    return decodeImage(data, width, height, 1, 8, [](const uint8_t* block, uint8_t* texels) {
+        auto values = decodeBC4(block);
+        std::copy(values.begin(), values.end(), texels);
+    });
+}
+
+DecodedImage decodeBC5Image(const std::vector<std::byte>& data, uint32_t width, uint32_t height) {
+    return decodeImage(data, width, height, 2, 16, [](const uint8_t* block, uint8_t* texels) {
+        auto red = decodeBC4(block);
+        auto green = decodeBC4(block + 8);
+        for (int i = 0; i != 16; ++i) {
+            texels[i * 2] = red[i];
+            texels[i * 2 + 1] = green[i];
+        }
+    });
+}
+
+DecodedImage decodeBC7Image(const std::vector<std::byte>& data, uint32_t width, uint32_t height) {
+    return decodeImage(data, width, height, 4, 16, [](const uint8_t* block, uint8_t* texels) {
+        auto values = decodeBC7Mode6(block);
+        std::copy(values.begin(), values.end(), texels);
+    });
+}
+
+// image channels against the decoded channels in the same order
+double psnr(const AlignedBuffer16& image, const DecodedImage& decoded,
+    std::initializer_list<uint32_t> channels
+) {
+    Expects(channels.size() == decoded.mChannels);
+    const auto* texels = reinterpret_cast<const uint8_t*>(image.data());
+    double error = 0;
+    size_t count = 0;
+    for (uint32_t y = 0; y != decoded.mHeight; ++y) {
+        for (uint32_t x = 0; x != decoded.mWidth; ++x) {
+            uint32_t k = 0;
+            for (auto c : channels) {
+                const double d = double(texels[(size_t(y) * decoded.mWidth + x) * 4 + c]) -
+                    decoded.mTexels[(size_t(y) * decoded.mWidth + x) * decoded.mChannels + k];
+                error += d * d;
+                ++count;
+                ++k;
+            }
+        }
+    }
+    if (error == 0)
+        return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10(255.0 * 255.0 / (error / count));
+}
+}
+
+TEST(SAssetBlockCompressionTest, BC1StripsMatchSingleCall) {
+    expectStripsMatchSingleCall(8, compressBC1);
+}
+
+TEST(SAssetBlockCompressionTest, BC3StripsMatchSingleCall) {
+    expectStripsMatchSingleCall(16, compressBC3);
+}
+
+TEST(SAssetBlockCompressionTest, SmallMipIsOneCall) {
+    std::atomic<uint32_t> calls = 0;
+    std::atomic<uint32_t> rows = 0;
+    auto count = [&](const std::byte*, std::byte*, uint32_t w, uint32_t h) {
+        EXPECT_EQ(w, 256u);
+        ++calls;
+        rows += h;
+    };
+    // 64 x 64 blocks fit in the default grain
+    compressBlockRows(std::pmr::get_default_resource(), nullptr, nullptr,
+        256, 256, sBlockSize, sBlockSize, sSrcBPE, 8, count);
+    EXPECT_EQ(calls, 1u);
+    EXPECT_EQ(rows, 256u);
+}
+
+TEST(SAssetBlockCompressionTest, StripsCoverEveryBlockRowOnce) {
+    constexpr uint32_t width = 64;
+    constexpr uint32_t height = 4 * 103;
+    constexpr uint32_t dstBPE = 8;
+    constexpr uint32_t blocksPerRow = width / sBlockSize;
+    std::vector<std::atomic<uint32_t>> visits(height / sBlockSize);
+    std::atomic<uint32_t> calls = 0;
+
+    // strips start on block rows, the source and destination offsets name the same row
+    std::vector<std::byte> src(size_t(width) * height * 4);
+    std::vector<std::byte> dst(size_t(blocksPerRow) * (height / sBlockSize) * dstBPE);
+    const std::byte* src0 = src.data();
+    std::byte* dst0 = dst.data();
+    compressBlockRows(std::pmr::get_default_resource(), src0, dst0,
+        width, height, sBlockSize, sBlockSize, sSrcBPE, dstBPE,
+        [&](const std::byte* src, std::byte* dst, uint32_t w, uint32_t h) {
+            EXPECT_EQ(w, width);
+            EXPECT_EQ(h % sBlockSize, 0u);
+            const auto row = static_cast<uint32_t>((src - src0) / (size_t(blocksPerRow) * sSrcBPE));
+            EXPECT_EQ(size_t(dst - dst0), size_t(row) * blocksPerRow * dstBPE);
+            for (uint32_t y = 0; y != h / sBlockSize; ++y) {
+                ++visits[row + y];
+            }
+            ++calls;
+        }, 10 * blocksPerRow);
+
+    EXPECT_EQ(calls, 11u);
+    for (const auto& v : visits) {
+        EXPECT_EQ(v, 1u);
+    }
+}
+
+namespace {
+
+// one 4x4 rgba8 block: red ramps, green falls, blue repeats per row, alpha steps
+struct GoldenBlock {
+    GoldenBlock() {
+        for (int i = 0; i != 16; ++i) {
+            mTexels[i * 4 + 0] = static_cast<uint8_t>(16 * i);
+            mTexels[i * 4 + 1] = static_cast<uint8_t>(255 - 12 * i);
+            mTexels[i * 4 + 2] = static_cast<uint8_t>(i % 4 * 60);
+            mTexels[i * 4 + 3] = static_cast<uint8_t>(i < 8 ? 255 : 40);
+        }
+    }
+    void fill(uint8_t value) {
+        std::fill(std::begin(mTexels), std::end(mTexels), value);
+    }
+    const std::byte* data() const noexcept {
+        return reinterpret_cast<const std::byte*>(mTexels);
+    }
+    alignas(16) uint8_t mTexels[64];
+};
+
+template<size_t N, class Compress>
+std::array<uint8_t, N> compressBlock(const GoldenBlock& block, Compress compress) {
+    std::array<uint8_t, N> bytes;
+    compress(block.data(), reinterpret_cast<std::byte*>(bytes.data()), 4, 4);
+    return bytes;
+}
+
+template<class Compress>
+double compressPSNR(const AlignedBuffer16& image, uint32_t size, uint32_t blockBytes,
+    Compress compress, DecodedImage (*decode)(const std::vector<std::byte>&, uint32_t, uint32_t),
+    std::initializer_list<uint32_t> channels
+) {
+    std::vector<std::byte> data(size_t(size / sBlockSize) * (size / sBlockSize) * blockBytes);
+    compress(image.data(), data.data(), size, size);
+    return psnr(image, decode(data, size, size), channels);
+}
+
+}
+
+// encoder output locked for one block, each golden decodes close to the source
+TEST(SAssetBlockCompressionTest, BC4Golden) {
+    GoldenBlock block;
+    const auto bytes = compressBlock<8>(block, [](auto src, auto dst, auto w, auto h) {
+        compressBC4(src, dst, w, h);
+    });
+    const std::array<uint8_t, 8> golden = { 0xe1, 0x0f, 0xc9, 0x6f, 0xb7, 0xe4, 0x26, 0x01 };
+    EXPECT_EQ(bytes, golden);
+
+    // 8 value mode, the endpoints inset by 1/16 of the range
+    EXPECT_GT(bytes[0], bytes[1]);
+    const auto values = decodeBC4(bytes.data());
+    for (int i = 0; i != 16; ++i) {
+        EXPECT_NEAR(values[i], block.mTexels[i * 4], 15) << i;
+    }
+}
+
+TEST(SAssetBlockCompressionTest, BC5Golden) {
+    GoldenBlock block;
+    const auto bytes = compressBlock<16>(block, compressBC5);
+    const std::array<uint8_t, 16> golden = {
+        0xe1, 0x0f, 0xc9, 0x6f, 0xb7, 0xe4, 0x26, 0x01,
+        0xf4, 0x56, 0x80, 0xb4, 0x91, 0xad, 0xfd, 0x27,
+    };
+    EXPECT_EQ(bytes, golden);
+
+    // red and green are the bc4 blocks of channels 0 and 1
+    for (int c = 0; c != 2; ++c) {
+        const auto channel = compressBlock<8>(block, [c](auto src, auto dst, auto w, auto h) {
+            compressBC4(src, dst, w, h, c);
+        });
+        EXPECT_TRUE(std::equal(channel.begin(), channel.end(), bytes.begin() + 8 * c)) << c;
+    }
+}
+
+TEST(SAssetBlockCompressionTest, BC7Golden) {
+    GoldenBlock block;
+    const auto bytes = compressBlock<16>(block, compressBC7);
+    const std::array<uint8_t, 16> golden = {
+        0x40, 0xc4, 0x3b, 0xbf, 0xe2, 0xf4, 0xfe, 0x81,
+        0x01, 0x21, 0x21, 0x43, 0xba, 0xdc, 0xdc, 0xfe,
+    };
+    EXPECT_EQ(bytes, golden);
+
+    // mode 6 is six zero bits and a one
+    EXPECT_EQ(bytes[0] & 0x7f, 0x40);
+    // one endpoint line for all four channels, blue and alpha do not follow it
+    const auto texels = decodeBC7Mode6(bytes.data());
+    double error = 0;
+    for (int i = 0; i != 64; ++i) {
+        const double d = double(texels[i]) - block.mTexels[i];
+        error += d * d;
+    }
+    EXPECT_GT(10.0 * std::log10(255.0 * 255.0 * 64 / error), 15.0);
+}
+
+// texels on one rgb line, the inset endpoints bound the error at the ends of the ramp
+TEST(SAssetBlockCompressionTest, BC7LineBlock) {
+    GoldenBlock block;
+    for (int i = 0; i != 16; ++i) {
+        block.mTexels[i * 4 + 0] = static_cast<uint8_t>(16 * i);
+        block.mTexels[i * 4 + 1] = static_cast<uint8_t>(255 - 16 * i);
+        block.mTexels[i * 4 + 2] = static_cast<uint8_t>(8 * i);
+        block.mTexels[i * 4 + 3] = 255;
+    }
+    const auto texels = decodeBC7Mode6(compressBlock<16>(block, compressBC7).data());
+    for (int i = 0; i != 64; ++i) {
+        EXPECT_NEAR(texels[i], block.mTexels[i], 14) << i;
+    }
+    // monotonic along the ramp
+    for (int i = 1; i != 16; ++i) {
+        EXPECT_GE(texels[i * 4], texels[(i - 1) * 4]) << i;
+        EXPECT_LE(texels[i * 4 + 1], texels[(i - 1) * 4 + 1]) << i;
+    }
+}
+
+TEST(SAssetBlockCompressionTest, ConstantBlocksAreExact) {
+    GoldenBlock block;
+    for (int value : { 0, 1, 77, 128, 254, 255 }) {
+        SCOPED_TRACE(value);
+        block.fill(static_cast<uint8_t>(value));
+
+        const auto bc4 = decodeBC4(compressBlock<8>(block, [](auto src, auto dst, auto w, auto h) {
+            compressBC4(src, dst, w, h);
+        }).data());
+        for (auto v : bc4) {
+            EXPECT_EQ(v, value);
+        }
+
+        const auto bc5 = compressBlock<16>(block, compressBC5);
+        for (auto v : decodeBC4(bc5.data() + 8)) {
+            EXPECT_EQ(v, value);
+        }
+
+        const auto bc7 = decodeBC7Mode6(compressBlock<16>(block, compressBC7).data());
+        for (auto v : bc7) {
+            EXPECT_EQ(v, value);
+        }
+    }
+}
+
+// mode 6 shares one p-bit per endpoint, channels of mixed parity are off by at most one
+TEST(SAssetBlockCompressionTest, BC7ConstantColorWithinOne) {
+    GoldenBlock block;
+    const uint8_t color[4] = { 10, 11, 200, 255 };
+    for (int i = 0; i != 64; ++i) {
+        block.mTexels[i] = color[i % 4];
+    }
+    const auto texels = decodeBC7Mode6(compressBlock<16>(block, compressBC7).data());
+    for (int i = 0; i != 64; ++i) {
+        EXPECT_NEAR(texels[i], color[i % 4], 1) << i;
+    }
+}
+
+// thresholds sit about 1 dB under the measured quality, the smooth bc4/bc5 images are exact
+TEST(SAssetBlockCompressionTest, PSNR) {
+    constexpr uint32_t size = 256;
+    AlignedBuffer16 noisy(std::pmr::get_default_resource());
+    makeImage(noisy, size, size);
+    AlignedBuffer16 smooth(std::pmr::get_default_resource());
+    makeImage(smooth, size, size, 0);
+
+    auto bc4 = [](auto src, auto dst, auto w, auto h) {
+        compressBC4(src, dst, w, h);
+    };
+    EXPECT_GT(compressPSNR(noisy, size, 8, bc4, decodeBC4Image, { 0 }), 42.0);
+    EXPECT_GT(compressPSNR(smooth, size, 8, bc4, decodeBC4Image, { 0 }), 60.0);
+    EXPECT_GT(compressPSNR(noisy, size, 16, compressBC5, decodeBC5Image, { 0, 1 }), 42.0);
+    EXPECT_GT(compressPSNR(smooth, size, 16, compressBC5, decodeBC5Image, { 0, 1 }), 60.0);
+    EXPECT_GT(compressPSNR(noisy, size, 16, compressBC7, decodeBC7Image, { 0, 1, 2, 3 }), 26.5);
+    EXPECT_GT(compressPSNR(smooth, size, 16, compressBC7, decodeBC7Image, { 0, 1, 2, 3 }), 50.0);
+}
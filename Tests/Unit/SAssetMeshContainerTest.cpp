@@ -0,0 +1,220 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/AssetFactory/SAssetMeshContainer.h>
+#include <Star/AssetFactory/SAssetMeshUtils.h>
+#include <gtest/gtest.h>
+
+using namespace Star;
+using namespace Star::Asset;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// position stream and a normal + uv stream, 16 bit indices, two submeshes
+MeshData makeMesh(uint32_t vertexCount) {
+    MeshData mesh(std::pmr::get_default_resource());
+    mesh.mLayoutID = 3;
+    mesh.mLayoutName = "PositionNormalUV";
+    mesh.mVertexBuffers.reserve(2);
+
+    auto& positions = mesh.mVertexBuffers.emplace_back();
+    positions.mDesc.mElements.emplace_back(VertexElement{ SV_Position, 0, Format::R32G32B32_SFLOAT });
+    positions.mDesc.mVertexSize = 12;
+    positions.mVertexCount = vertexCount;
+    positions.mBuffer.resize(size_t(vertexCount) * 12);
+
+    auto& attributes = mesh.mVertexBuffers.emplace_back();
+    attributes.mDesc.mElements.emplace_back(VertexElement{ NORMAL, 0, Format::R32G32B32_SFLOAT });
+    attributes.mDesc.mElements.emplace_back(VertexElement{ TEXCOORD, 12, Format::R32G32_SFLOAT });
+    attributes.mDesc.mVertexSize = 20;
+    attributes.mVertexCount = vertexCount;
+    attributes.mBuffer.resize(size_t(vertexCount) * 20);
+
+    for (auto* vb : { &positions, &attributes }) {
+        for (size_t i = 0; i != vb->mBuffer.size(); ++i) {
+            vb->mBuffer[i] = static_cast<char>(i * 7 + vb->mDesc.mVertexSize);
+        }
+    }
+
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i + 2 < vertexCount; ++i) {
+        indices.insert(indices.end(), { i, i + 1, i + 2 });
+    }
+    writeIndices(indices, vertexCount, mesh.mIndexBuffer);
+    const auto half = gsl::narrow<uint32_t>(indices.size() / 6 * 3);
+    mesh.mSubMeshes.emplace_back(SubMeshData{ 0, half });
+    mesh.mSubMeshes.emplace_back(SubMeshData{ half, gsl::narrow<uint32_t>(indices.size()) - half });
+    return mesh;
+}
+
+gsl::span<const std::byte> asBytes(const std::string& content) {
+    return { reinterpret_cast<const std::byte*>(content.data()), content.size() };
+}
+
+void expectSameMesh(const MeshData& lhs, const MeshData& rhs) {
+    EXPECT_EQ(lhs.mLayoutID, rhs.mLayoutID);
+    EXPECT_EQ(lhs.mLayoutName, rhs.mLayoutName);
+    ASSERT_EQ(lhs.mVertexBuffers.size(), rhs.mVertexBuffers.size());
+    for (size_t i = 0; i != lhs.mVertexBuffers.size(); ++i) {
+        const auto& a = lhs.mVertexBuffers[i];
+        const auto& b = rhs.mVertexBuffers[i];
+        EXPECT_EQ(a.mDesc.mElements, b.mDesc.mElements);
+        EXPECT_EQ(a.mDesc.mVertexSize, b.mDesc.mVertexSize);
+        EXPECT_EQ(a.mVertexCount, b.mVertexCount);
+        EXPECT_TRUE(std::equal(a.data().begin(), a.data().end(), b.data().begin(), b.data().end()));
+    }
+    const auto& a = lhs.mIndexBuffer;
+    const auto& b = rhs.mIndexBuffer;
+    EXPECT_TRUE(std::equal(a.data().begin(), a.data().end(), b.data().begin(), b.data().end()));
+    EXPECT_EQ(a.mElementSize, b.mElementSize);
+    EXPECT_EQ(a.mPrimitiveCount, b.mPrimitiveCount);
+    EXPECT_EQ(a.mPrimitiveTopology, b.mPrimitiveTopology);
+    ASSERT_EQ(lhs.mSubMeshes.size(), rhs.mSubMeshes.size());
+    for (size_t i = 0; i != lhs.mSubMeshes.size(); ++i) {
+        EXPECT_EQ(lhs.mSubMeshes[i].mIndexOffset, rhs.mSubMeshes[i].mIndexOffset);
+        EXPECT_EQ(lhs.mSubMeshes[i].mIndexCount, rhs.mSubMeshes[i].mIndexCount);
+    }
+}
+
+template<class T>
+T& at(std::string& content, uint64_t offset) {
+    return *reinterpret_cast<T*>(content.data() + offset);
+}
+
+}
+
+TEST(MeshContainer, AlignsEveryBlob) {
+    const auto mesh = makeMesh(100);
+    std::string content;
+    writeMeshContainer(mesh, content);
+
+    ASSERT_TRUE(isMeshContainer(asBytes(content)));
+    MeshContainerView view(asBytes(content));
+    EXPECT_EQ(view.header().mFileSize, content.size());
+    EXPECT_EQ(content.size() % sMeshContainerAlignment, 0u);
+    // layout name, 2 x (elements + vertices), indices, submeshes
+    EXPECT_EQ(view.header().mChunkCount, 7u);
+    for (uint32_t i = 0; i != view.header().mChunkCount; ++i) {
+        const auto& chunk = at<MeshContainerChunk>(content,
+            view.header().mChunkTableOffset + i * sizeof(MeshContainerChunk));
+        EXPECT_EQ(chunk.mOffset % sMeshContainerAlignment, 0u);
+    }
+    EXPECT_EQ(view.vertexBufferCount(), 2u);
+    EXPECT_EQ(view.vertexCount(1), 100u);
+    EXPECT_EQ(view.vertexSize(1), 20u);
+    EXPECT_EQ(view.indexElementSize(), 2u);
+    EXPECT_EQ(view.layoutName(), "PositionNormalUV");
+}
+
+TEST(MeshContainer, ReadCopiesBlobs) {
+    const auto mesh = makeMesh(100);
+    std::string content;
+    writeMeshContainer(mesh, content);
+
+    MeshData loaded(std::pmr::get_default_resource());
+    MeshContainerView(asBytes(content)).read(loaded);
+    expectSameMesh(mesh, loaded);
+    EXPECT_TRUE(loaded.mVertexBuffers[0].mMapped.empty());
+    EXPECT_TRUE(loaded.mIndexBuffer.mMapped.empty());
+
+    // the copy outlives the container
+    content.assign(content.size(), '\0');
+    expectSameMesh(mesh, loaded);
+}
+
+TEST(MeshContainer, ViewReferencesTheContainer) {
+    const auto mesh = makeMesh(100);
+    std::string content;
+    writeMeshContainer(mesh, content);
+
+    MeshData viewed(std::pmr::get_default_resource());
+    MeshContainerView(asBytes(content)).view(viewed);
+    expectSameMesh(mesh, viewed);
+    const auto* first = content.data();
+    const auto* last = content.data() + content.size();
+    for (const auto& vb : viewed.mVertexBuffers) {
+        EXPECT_TRUE(vb.mBuffer.empty());
+        EXPECT_GE(vb.data().data(), first);
+        EXPECT_LE(vb.data().data() + vb.data().size(), last);
+    }
+    EXPECT_TRUE(viewed.mIndexBuffer.mBuffer.empty());
+    EXPECT_GE(viewed.mIndexBuffer.data().data(), first);
+
+    // a viewed mesh writes the same container
+    std::string rewritten;
+    writeMeshContainer(viewed, rewritten);
+    EXPECT_EQ(rewritten, content);
+}
+
+TEST(MeshContainer, MapsFiles) {
+    const auto mesh = makeMesh(1000);
+    std::string content;
+    writeMeshContainer(mesh, content);
+    const auto filename = std::filesystem::temp_directory_path() / "star_mesh_container_test.mesh";
+    std::ofstream(filename, std::ios::binary).write(content.data(), content.size());
+    {
+        MappedMeshFile file(filename);
+        MeshData viewed(std::pmr::get_default_resource());
+        MeshContainerView(file.data()).view(viewed);
+        expectSameMesh(mesh, viewed);
+    }
+    std::filesystem::remove(filename);
+}
+
+TEST(MeshContainer, RejectsMalformedContainers) {
+    const auto mesh = makeMesh(100);
+    std::string content;
+    writeMeshContainer(mesh, content);
+    const auto& header = at<MeshContainerHeader>(content, 0);
+    const auto chunkTable = header.mChunkTableOffset;
+
+    auto expectRejected = [&content](auto modify) {
+        auto broken = content;
+        modify(broken);
+        EXPECT_THROW(MeshContainerView{ asBytes(broken) }, std::runtime_error);
+    };
+    expectRejected([](std::string& s) { s[0] = 'X'; });
+    expectRejected([](std::string& s) { at<MeshContainerHeader>(s, 0).mVersion = 2; });
+    expectRejected([](std::string& s) { s.resize(s.size() - sMeshContainerAlignment); });
+    expectRejected([](std::string& s) { at<MeshContainerHeader>(s, 0).mChunkCount = 1000; });
+    // first chunk is the layout name
+    expectRejected([&](std::string& s) { at<MeshContainerChunk>(s, chunkTable).mOffset += 1; });
+    expectRejected([&](std::string& s) { at<MeshContainerChunk>(s, chunkTable).mOffset = s.size(); });
+    expectRejected([&](std::string& s) { at<MeshContainerChunk>(s, chunkTable).mCount += 1; });
+    expectRejected([&](std::string& s) {
+        at<MeshContainerChunk>(s, chunkTable).mType = static_cast<MeshChunkType>(99);
+    });
+    expectRejected([&](std::string& s) {
+        // second vertex element chunk claims slot 0 again
+        for (uint32_t i = 0; i != at<MeshContainerHeader>(s, 0).mChunkCount; ++i) {
+            auto& chunk = at<MeshContainerChunk>(s, chunkTable + i * sizeof(MeshContainerChunk));
+            if (chunk.mType == MeshChunkType::VertexElements && chunk.mIndex == 1) {
+                chunk.mIndex = 0;
+            }
+        }
+    });
+    expectRejected([&](std::string& s) {
+        for (uint32_t i = 0; i != at<MeshContainerHeader>(s, 0).mChunkCount; ++i) {
+            const auto& chunk = at<MeshContainerChunk>(s, chunkTable + i * sizeof(MeshContainerChunk));
+            if (chunk.mType == MeshChunkType::SubMeshes) {
+                at<SubMeshData>(s, chunk.mOffset + sizeof(SubMeshData)).mIndexCount += 3;
+            }
+        }
+    });
+}
@@ -0,0 +1,146 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/AssetFactory/SAssetMeshOptimizer.h>
+#include <Star/AssetFactory/SAssetMeshUtils.h>
+#include <gtest/gtest.h>
+
+using namespace Star;
+using namespace Star::Asset;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// n x n quads, triangles emitted row by row with shuffled rows
+std::vector<uint32_t> makeGrid(uint32_t n) {
+    std::vector<uint32_t> rows(n);
+    std::iota(rows.begin(), rows.end(), 0);
+    for (uint32_t i = 0; i != n; ++i) {
+        std::swap(rows[i], rows[(i * 7919) % n]);
+    }
+    std::vector<uint32_t> indices;
+    for (auto y : rows) {
+        for (uint32_t x = 0; x != n; ++x) {
+            const uint32_t v = y * (n + 1) + x;
+            indices.insert(indices.end(), { v, v + 1, v + n + 1, v + 1, v + n + 2, v + n + 1 });
+        }
+    }
+    return indices;
+}
+
+std::multiset<std::array<uint32_t, 3>> getTriangles(const std::vector<uint32_t>& indices) {
+    std::multiset<std::array<uint32_t, 3>> triangles;
+    for (size_t i = 0; i != indices.size(); i += 3) {
+        // rotate the smallest index first, the winding is kept
+        std::array<uint32_t, 3> t{ indices[i], indices[i + 1], indices[i + 2] };
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.emplace(t);
+    }
+    return triangles;
+}
+
+}
+
+TEST(MeshOptimizer, AnalyzesVertexCache) {
+    // two triangles sharing an edge, 4 transforms
+    std::vector<uint32_t> indices{ 0, 1, 2, 2, 1, 3 };
+    auto stats = analyzeVertexCache(indices, 4, 16);
+    EXPECT_EQ(stats.mTriangleCount, 2u);
+    EXPECT_EQ(stats.mVertexCount, 4u);
+    EXPECT_EQ(stats.mTransformCount, 4u);
+    EXPECT_FLOAT_EQ(stats.acmr(), 2.0f);
+    EXPECT_FLOAT_EQ(stats.atvr(), 1.0f);
+
+    // a cache of 3 evicts vertex 0 before it is used again
+    indices = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    stats = analyzeVertexCache(indices, 6, 3);
+    EXPECT_EQ(stats.mTransformCount, 9u);
+
+    // a cache of 3 still holds vertex 0 after two more misses
+    indices = { 0, 1, 2, 0, 1, 2 };
+    stats = analyzeVertexCache(indices, 3, 3);
+    EXPECT_EQ(stats.mTransformCount, 3u);
+    indices = { 0, 1, 2, 3, 1, 2 };
+    stats = analyzeVertexCache(indices, 4, 3);
+    EXPECT_EQ(stats.mTransformCount, 4u);
+    indices = { 0, 1, 2, 3, 0, 1 };
+    stats = analyzeVertexCache(indices, 4, 3);
+    EXPECT_EQ(stats.mTransformCount, 6u);
+}
+
+TEST(MeshOptimizer, ImprovesVertexCacheAndKeepsTriangles) {
+    constexpr uint32_t n = 32;
+    constexpr uint32_t vertexCount = (n + 1) * (n + 1);
+    const auto input = makeGrid(n);
+    auto indices = input;
+
+    const auto before = analyzeVertexCache(indices, vertexCount, 16);
+    std::pmr::vector<uint32_t> clusters;
+    optimizeVertexCache(indices, vertexCount, 16, &clusters);
+    const auto after = analyzeVertexCache(indices, vertexCount, 16);
+
+    EXPECT_EQ(getTriangles(indices), getTriangles(input));
+    EXPECT_LT(after.acmr(), before.acmr());
+    EXPECT_LT(after.acmr(), 1.0f);
+    ASSERT_FALSE(clusters.empty());
+    EXPECT_EQ(clusters.front(), 0u);
+    EXPECT_TRUE(std::is_sorted(clusters.begin(), clusters.end()));
+    EXPECT_LT(clusters.back(), n * n * 2);
+}
+
+TEST(MeshOptimizer, ReportsOptimizedMesh) {
+    constexpr uint32_t n = 16;
+    constexpr uint32_t vertexCount = (n + 1) * (n + 1);
+    MeshData mesh(std::pmr::get_default_resource());
+    auto& vb = mesh.mVertexBuffers.emplace_back();
+    vb.mDesc.mElements.emplace_back(VertexElement{ SV_Position, 0, Format::R32G32B32_SFLOAT });
+    vb.mDesc.mVertexSize = 12;
+    vb.mVertexCount = vertexCount;
+    vb.mBuffer.resize(size_t(vertexCount) * 12);
+    for (uint32_t v = 0; v != vertexCount; ++v) {
+        const float p[3] = { float(v % (n + 1)), float(v / (n + 1)), 0.0f };
+        std::memcpy(vb.mBuffer.data() + v * 12, p, sizeof(p));
+    }
+    writeIndices(makeGrid(n), vertexCount, mesh.mIndexBuffer);
+
+    const auto report = optimizeMesh(mesh);
+    EXPECT_EQ(report.mBefore.mTriangleCount, n * n * 2);
+    EXPECT_EQ(report.mAfter.mTriangleCount, n * n * 2);
+    EXPECT_EQ(report.mAfter.mVertexCount, vertexCount);
+    EXPECT_LT(report.mAfter.acmr(), report.mBefore.acmr());
+
+    // vertex fetch order follows the index buffer
+    std::pmr::vector<uint32_t> indices;
+    readIndices(mesh.mIndexBuffer, indices);
+    uint32_t next = 0;
+    for (auto v : indices) {
+        EXPECT_LE(v, next);
+        next = std::max(next, v + 1);
+    }
+
+    std::ostringstream oss;
+    writeMeshReportHeader(oss);
+    writeMeshReport(oss, "grid \"a\"", report);
+    std::istringstream iss(oss.str());
+    std::string header, row;
+    std::getline(iss, header);
+    std::getline(iss, row);
+    EXPECT_EQ(header, "mesh,triangles,vertices,acmr_before,acmr_after,atvr_before,atvr_after");
+    EXPECT_EQ(row.rfind("\"grid \"\"a\"\"\",512,289,", 0), 0u) << row;
+    EXPECT_EQ(std::count(row.begin(), row.end(), ','), 6);
+}
@@ -0,0 +1,188 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/AssetFactory/SAssetMeshUtils.h>
+#include <gtest/gtest.h>
+
+using namespace Star;
+using namespace Star::Asset;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+using Position = std::array<float, 3>;
+
+void addStream(MeshData& mesh, const VertexElementType& type, const std::vector<Position>& values) {
+    auto& vb = mesh.mVertexBuffers.emplace_back();
+    vb.mDesc.mElements.emplace_back(VertexElement{ type, 0, Format::R32G32B32_SFLOAT });
+    vb.mDesc.mVertexSize = sizeof(Position);
+    vb.mVertexCount = gsl::narrow<uint32_t>(values.size());
+    vb.mBuffer.resize(values.size() * sizeof(Position));
+    std::memcpy(vb.mBuffer.data(), values.data(), vb.mBuffer.size());
+}
+
+MeshData makeMesh(const std::vector<Position>& positions, const std::vector<uint32_t>& indices) {
+    MeshData mesh(std::pmr::get_default_resource());
+    addStream(mesh, SV_Position, positions);
+    writeIndices(indices, gsl::narrow<uint32_t>(positions.size()), mesh.mIndexBuffer);
+    return mesh;
+}
+
+std::vector<Position> readStream(const MeshData& mesh, size_t stream) {
+    const auto& vb = mesh.mVertexBuffers.at(stream);
+    std::vector<Position> values(vb.mVertexCount);
+    std::memcpy(values.data(), vb.mBuffer.data(), vb.mBuffer.size());
+    return values;
+}
+
+std::vector<uint32_t> readIndices(const MeshData& mesh) {
+    std::pmr::vector<uint32_t> indices;
+    Star::Asset::readIndices(mesh.mIndexBuffer, indices);
+    return std::vector<uint32_t>(indices.begin(), indices.end());
+}
+
+}
+
+TEST(WeldVertices, WeldsIdenticalVertices) {
+    // two triangles of a quad, the shared edge is duplicated
+    auto mesh = makeMesh({
+        { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+        { 0, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+    }, { 0, 1, 2, 3, 4, 5 });
+
+    EXPECT_EQ(weldVertices(mesh), 4u);
+    EXPECT_EQ(mesh.mVertexBuffers[0].mVertexCount, 4u);
+    EXPECT_EQ(mesh.mVertexBuffers[0].mBuffer.size(), 4 * sizeof(Position));
+    // first occurrence wins, so the order of unique vertices is kept
+    EXPECT_EQ(readStream(mesh, 0), (std::vector<Position>{
+        { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } }));
+    EXPECT_EQ(readIndices(mesh), (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+    EXPECT_EQ(mesh.mIndexBuffer.mPrimitiveCount, 2u);
+}
+
+TEST(WeldVertices, ComparesEveryStream) {
+    auto mesh = makeMesh({ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 0, 0 }, { 1, 0, 0 } }, { 0, 1, 2, 1, 3, 2 });
+    // vertices 0 and 2 share position and normal, 1 and 3 only the position
+    addStream(mesh, NORMAL, { { 0, 0, 1 }, { 0, 0, 1 }, { 0, 0, 1 }, { 0, 1, 0 } });
+
+    EXPECT_EQ(weldVertices(mesh), 3u);
+    EXPECT_EQ(mesh.mVertexBuffers[1].mVertexCount, 3u);
+    EXPECT_EQ(readStream(mesh, 1), (std::vector<Position>{ { 0, 0, 1 }, { 0, 0, 1 }, { 0, 1, 0 } }));
+    EXPECT_EQ(readIndices(mesh), (std::vector<uint32_t>{ 0, 1, 0, 1, 2, 0 }));
+}
+
+TEST(WeldVertices, QuantizesWithEpsilon) {
+    const std::vector<Position> positions{
+        { 0.0f, 0.0f, 0.0f }, { 0.00001f, 0.0f, 0.0f }, { -0.00001f, 0.0f, 0.0f },
+        { 0.01f, 0.0f, 0.0f }, { 0.0f, 0.0f, -0.0f }, { 1.0f, 1.0f, 1.0f },
+    };
+    const std::vector<uint32_t> indices{ 0, 1, 5, 2, 3, 4 };
+
+    {
+        // bitwise, only identical bits weld, -0.0 differs from 0.0
+        auto mesh = makeMesh(positions, indices);
+        EXPECT_EQ(weldVertices(mesh), 6u);
+    }
+    {
+        VertexWeldSettings settings;
+        settings.setEpsilon(SV_Position, 0.001f);
+        auto mesh = makeMesh(positions, indices);
+        EXPECT_EQ(weldVertices(mesh, settings), 3u);
+        EXPECT_EQ(readIndices(mesh), (std::vector<uint32_t>{ 0, 0, 2, 0, 1, 0 }));
+        // the first vertex of a cell is kept, not the cell center
+        EXPECT_EQ(readStream(mesh, 0)[0], (Position{ 0, 0, 0 }));
+    }
+    {
+        // epsilon of another semantic does not apply to positions
+        VertexWeldSettings settings;
+        settings.setEpsilon(NORMAL, 0.001f);
+        auto mesh = makeMesh(positions, indices);
+        EXPECT_EQ(weldVertices(mesh, settings), 6u);
+    }
+}
+
+TEST(WeldVertices, SwitchesIndexSizeAt65536) {
+    auto makeGrid = [](uint32_t uniqueCount, uint32_t duplicateCount) {
+        std::vector<Position> positions;
+        for (uint32_t i = 0; i != uniqueCount + duplicateCount; ++i) {
+            positions.push_back({ float(i % uniqueCount), 0.0f, 0.0f });
+        }
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i + 3 <= positions.size(); i += 3) {
+            indices.insert(indices.end(), { i, i + 1, i + 2 });
+        }
+        return makeMesh(positions, indices);
+    };
+
+    {
+        auto mesh = makeGrid(65536, 0);
+        EXPECT_EQ(mesh.mIndexBuffer.mElementSize, 2u);
+        EXPECT_EQ(weldVertices(mesh), 65536u);
+        EXPECT_EQ(mesh.mIndexBuffer.mElementSize, 2u);
+    }
+    {
+        auto mesh = makeGrid(65537, 1);
+        EXPECT_EQ(mesh.mIndexBuffer.mElementSize, 4u);
+        EXPECT_EQ(weldVertices(mesh), 65537u);
+        EXPECT_EQ(mesh.mIndexBuffer.mElementSize, 4u);
+    }
+    {
+        // welding brings a 32-bit mesh back under the limit
+        auto mesh = makeGrid(65536, 4466);
+        EXPECT_EQ(mesh.mIndexBuffer.mElementSize, 4u);
+        EXPECT_EQ(weldVertices(mesh), 65536u);
+        EXPECT_EQ(mesh.mIndexBuffer.mElementSize, 2u);
+        const auto indices = readIndices(mesh);
+        EXPECT_EQ(indices.size(), 70002u);
+        EXPECT_EQ(indices[65536], 0u);
+        EXPECT_EQ(*std::max_element(indices.begin(), indices.end()), 65535u);
+    }
+}
+
+TEST(WeldVertices, HandlesDegenerateInput) {
+    {
+        MeshData mesh(std::pmr::get_default_resource());
+        EXPECT_EQ(weldVertices(mesh), 0u);
+    }
+    {
+        auto mesh = makeMesh({}, {});
+        EXPECT_EQ(weldVertices(mesh), 0u);
+        EXPECT_EQ(getIndexCount(mesh.mIndexBuffer), 0u);
+    }
+    {
+        // degenerate triangles are kept, welding does not drop primitives
+        auto mesh = makeMesh({ { 1, 2, 3 }, { 1, 2, 3 }, { 1, 2, 3 } }, { 0, 1, 2 });
+        EXPECT_EQ(weldVertices(mesh), 1u);
+        EXPECT_EQ(readIndices(mesh), (std::vector<uint32_t>{ 0, 0, 0 }));
+    }
+    {
+        // non-finite values quantize to one key
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float inf = std::numeric_limits<float>::infinity();
+        VertexWeldSettings settings;
+        settings.setEpsilon(SV_Position, 0.001f);
+        auto mesh = makeMesh({ { nan, 0, 0 }, { inf, 0, 0 }, { 0, 0, 0 } }, { 0, 1, 2 });
+        EXPECT_EQ(weldVertices(mesh, settings), 2u);
+        EXPECT_EQ(readIndices(mesh), (std::vector<uint32_t>{ 0, 0, 1 }));
+    }
+    {
+        auto mesh = makeMesh({ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } }, { 0, 1, 2 });
+        addStream(mesh, NORMAL, { { 0, 0, 1 } });
+        EXPECT_THROW(weldVertices(mesh), std::invalid_argument);
+    }
+}
@@ -0,0 +1,383 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/AssetFactory/SAssetMipMaps.h>
+#include <Star/Graphics/STextureUtils.h>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Star;
+using namespace Star::Asset;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// a full chain in the layout generateMipChain writes, level 0 filled by the caller
+class MipChain {
+public:
+    MipChain(uint32_t width, uint32_t height, uint32_t pixelSize,
+        uint32_t blockX = 1, uint32_t blockY = 1)
+        : mWidth(width)
+        , mHeight(height)
+        , mPixelSize(pixelSize)
+        , mBlockX(blockX)
+        , mBlockY(blockY)
+        , mMipCount(mip_count(boost::alignment::align_up(width, blockX),
+            boost::alignment::align_up(height, blockY)))
+        , mBuffer(texture_size(width, height, blockX, blockY, pixelSize * blockX * blockY))
+    {}
+
+    void generate(Format format, const MipChainSettings& settings = {}) {
+        generateMipChain(std::pmr::get_default_resource(), mBuffer.data(), format,
+            mWidth, mHeight, mBlockX, mBlockY, mMipCount, settings);
+    }
+
+    uint32_t width(uint32_t level) const noexcept {
+        uint32_t x = mWidth;
+        for (uint32_t k = 0; k != level; ++k) {
+            x = half_size(x);
+        }
+        return x;
+    }
+    uint32_t height(uint32_t level) const noexcept {
+        uint32_t y = mHeight;
+        for (uint32_t k = 0; k != level; ++k) {
+            y = half_size(y);
+        }
+        return y;
+    }
+
+    template<class T>
+    T* texel(uint32_t level, uint32_t x, uint32_t y) noexcept {
+        size_t offset = 0;
+        for (uint32_t k = 0; k != level; ++k) {
+            offset += mip_size(width(k), height(k), mBlockX, mBlockY, mPixelSize * mBlockX * mBlockY);
+        }
+        const size_t rowPitch = size_t(boost::alignment::align_up(width(level), mBlockX)) * mPixelSize;
+        return reinterpret_cast<T*>(mBuffer.data() + offset + y * rowPitch + x * mPixelSize);
+    }
+
+    uint32_t mipCount() const noexcept {
+        return mMipCount;
+    }
+private:
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mPixelSize;
+    uint32_t mBlockX;
+    uint32_t mBlockY;
+    uint32_t mMipCount;
+    std::vector<std::byte> mBuffer;
+};
+
+using RGBA8 = std::array<uint8_t, 4>;
+
+RGBA8 readRGBA8(MipChain& chain, uint32_t level, uint32_t x, uint32_t y) {
+    RGBA8 texel;
+    std::memcpy(texel.data(), chain.texel<uint8_t>(level, x, y), sizeof(texel));
+    return texel;
+}
+
+void writeRGBA8(MipChain& chain, uint32_t x, uint32_t y, const RGBA8& texel) {
+    std::memcpy(chain.texel<uint8_t>(0, x, y), texel.data(), sizeof(texel));
+}
+
+// peak signal to noise ratio of the red channel of a level against f(u, v),
+// u and v are normalized texture coordinates of the texel centers
+template<class Function>
+double getPSNR(MipChain& chain, uint32_t level, Function f) {
+    const uint32_t w = chain.width(level);
+    const uint32_t h = chain.height(level);
+    double sum = 0.0;
+    for (uint32_t y = 0; y != h; ++y) {
+        for (uint32_t x = 0; x != w; ++x) {
+            double expected = 255.0 * f((x + 0.5) / w, (y + 0.5) / h);
+            double diff = *chain.texel<uint8_t>(level, x, y) - expected;
+            sum += diff * diff;
+        }
+    }
+    double mse = sum / (double(w) * h);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+template<class Function>
+void fillR8(MipChain& chain, uint32_t width, uint32_t height, Function f) {
+    for (uint32_t y = 0; y != height; ++y) {
+        for (uint32_t x = 0; x != width; ++x) {
+            double value = f((x + 0.5) / width, (y + 0.5) / height);
+            *chain.texel<uint8_t>(0, x, y) = static_cast<uint8_t>(std::lround(255.0 * value));
+        }
+    }
+}
+
+float getCoverage(MipChain& chain, uint32_t level, float alphaRef) {
+    const uint32_t w = chain.width(level);
+    const uint32_t h = chain.height(level);
+    size_t passed = 0;
+    for (uint32_t y = 0; y != h; ++y) {
+        for (uint32_t x = 0; x != w; ++x) {
+            if (readRGBA8(chain, level, x, y)[3] / 255.0f > alphaRef) {
+                ++passed;
+            }
+        }
+    }
+    return float(passed) / float(w * h);
+}
+
+constexpr double sPi = 3.14159265358979323846;
+
+}
+
+TEST(MipChain, BoxAveragesUnormTexels) {
+    MipChain chain(4, 2, 4);
+    ASSERT_EQ(chain.mipCount(), 3u);
+    writeRGBA8(chain, 0, 0, { 0, 0, 0, 255 });
+    writeRGBA8(chain, 1, 0, { 40, 80, 120, 255 });
+    writeRGBA8(chain, 2, 0, { 100, 0, 0, 0 });
+    writeRGBA8(chain, 3, 0, { 200, 0, 0, 0 });
+    writeRGBA8(chain, 0, 1, { 0, 0, 0, 255 });
+    writeRGBA8(chain, 1, 1, { 40, 80, 120, 255 });
+    writeRGBA8(chain, 2, 1, { 60, 0, 0, 0 });
+    writeRGBA8(chain, 3, 1, { 40, 0, 0, 0 });
+    chain.generate(Format::R8G8B8A8_UNORM);
+
+    EXPECT_EQ(readRGBA8(chain, 1, 0, 0), (RGBA8{ 20, 40, 60, 255 }));
+    EXPECT_EQ(readRGBA8(chain, 1, 1, 0), (RGBA8{ 100, 0, 0, 0 }));
+    // 127.5 rounds to even
+    EXPECT_EQ(readRGBA8(chain, 2, 0, 0), (RGBA8{ 60, 20, 30, 128 }));
+}
+
+TEST(MipChain, FiltersSRGBInLinearSpace) {
+    MipChain chain(2, 2, 4);
+    writeRGBA8(chain, 0, 0, { 0, 0, 0, 0 });
+    writeRGBA8(chain, 1, 0, { 255, 255, 255, 255 });
+    writeRGBA8(chain, 0, 1, { 255, 255, 255, 255 });
+    writeRGBA8(chain, 1, 1, { 0, 0, 0, 0 });
+    chain.generate(Format::R8G8B8A8_SRGB);
+
+    // half the light is 188 in srgb, averaging the encoded values would give 128.
+    // alpha is linear
+    EXPECT_EQ(readRGBA8(chain, 1, 0, 0), (RGBA8{ 188, 188, 188, 128 }));
+}
+
+TEST(MipChain, AveragesSingleChannelTexels) {
+    MipChain chain(2, 2, 1);
+    const std::array<uint8_t, 4> texels = { 0, 64, 128, 255 };
+    std::memcpy(chain.texel<uint8_t>(0, 0, 0), texels.data(), texels.size());
+    chain.generate(Format::R8_UNORM);
+    EXPECT_EQ(*chain.texel<uint8_t>(1, 0, 0), 112);
+
+    chain.generate(Format::R8_SRGB);
+    EXPECT_EQ(*chain.texel<uint8_t>(1, 0, 0), 153);
+}
+
+TEST(MipChain, AveragesHalfFloatTexels) {
+    MipChain chain(2, 2, 8);
+    // 1.0, 0.5, 2.0 and 0.0 in half precision
+    constexpr uint16_t one = 0x3C00;
+    constexpr uint16_t half = 0x3800;
+    constexpr uint16_t two = 0x4000;
+    const std::array<std::array<uint16_t, 4>, 4> texels = { {
+        { one, 0, two, one },
+        { half, 0, two, one },
+        { one, 0, two, one },
+        { half, one, two, one },
+    } };
+    std::memcpy(chain.texel<uint16_t>(0, 0, 0), texels.data(), sizeof(texels));
+    chain.generate(Format::R16G16B16A16_SFLOAT);
+
+    // 0.75 and 0.25, values above 1 are kept
+    std::array<uint16_t, 4> level1;
+    std::memcpy(level1.data(), chain.texel<uint16_t>(1, 0, 0), sizeof(level1));
+    EXPECT_EQ(level1, (std::array<uint16_t, 4>{ 0x3A00, 0x3400, two, one }));
+}
+
+TEST(MipChain, PadsBlocksWithTheLevelAverage) {
+    MipChain chain(8, 8, 4, 4, 4);
+    ASSERT_EQ(chain.mipCount(), 4u);
+    for (uint32_t y = 0; y != 8; ++y) {
+        for (uint32_t x = 0; x != 8; ++x) {
+            // 2x2 level has 4 distinct texels
+            uint8_t value = x < 4 ? (y < 4 ? 0 : 80) : (y < 4 ? 160 : 240);
+            writeRGBA8(chain, x, y, { value, value, value, 255 });
+        }
+    }
+    chain.generate(Format::R8G8B8A8_UNORM);
+
+    EXPECT_EQ(readRGBA8(chain, 2, 0, 0), (RGBA8{ 0, 0, 0, 255 }));
+    EXPECT_EQ(readRGBA8(chain, 2, 1, 1), (RGBA8{ 240, 240, 240, 255 }));
+    for (uint32_t y = 0; y != 4; ++y) {
+        for (uint32_t x = 0; x != 4; ++x) {
+            if (x < 2 && y < 2)
+                continue;
+            EXPECT_EQ(readRGBA8(chain, 2, x, y), (RGBA8{ 120, 120, 120, 255 })) << x << ", " << y;
+        }
+    }
+    EXPECT_EQ(readRGBA8(chain, 3, 0, 0), (RGBA8{ 120, 120, 120, 255 }));
+    EXPECT_EQ(readRGBA8(chain, 3, 3, 3), (RGBA8{ 120, 120, 120, 255 }));
+}
+
+TEST(MipChain, BoxMatchesScalarReference) {
+    // odd sizes, down to levels one texel wide
+    const uint32_t width = 37;
+    const uint32_t height = 5;
+    MipChain chain(width, height, 4);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> dist(0, 255);
+
+    std::vector<double> curr(size_t(width) * height * 4);
+    for (uint32_t y = 0; y != height; ++y) {
+        for (uint32_t x = 0; x != width; ++x) {
+            RGBA8 texel;
+            for (size_t c = 0; c != 4; ++c) {
+                texel[c] = static_cast<uint8_t>(dist(rng));
+                curr[(y * width + x) * 4 + c] = texel[c] / 255.0;
+            }
+            writeRGBA8(chain, x, y, texel);
+        }
+    }
+    chain.generate(Format::R8G8B8A8_UNORM);
+
+    uint32_t w = width;
+    uint32_t h = height;
+    for (uint32_t level = 1; level != chain.mipCount(); ++level) {
+        const uint32_t w2 = half_size(w);
+        const uint32_t h2 = half_size(h);
+        std::vector<double> next(size_t(w2) * h2 * 4);
+        for (uint32_t y = 0; y != h2; ++y) {
+            for (uint32_t x = 0; x != w2; ++x) {
+                const uint32_t x0 = 2 * x;
+                const uint32_t x1 = std::min(2 * x + 1, w - 1);
+                const uint32_t y0 = std::min(2 * y, h - 1);
+                const uint32_t y1 = std::min(2 * y + 1, h - 1);
+                const auto texel = readRGBA8(chain, level, x, y);
+                for (size_t c = 0; c != 4; ++c) {
+                    double v = 0.25 * (curr[(y0 * w + x0) * 4 + c] + curr[(y0 * w + x1) * 4 + c] +
+                        curr[(y1 * w + x0) * 4 + c] + curr[(y1 * w + x1) * 4 + c]);
+                    next[(y * w2 + x) * 4 + c] = v;
+                    EXPECT_NEAR(texel[c], v * 255.0, 0.5 + 1e-3)
+                        << "level " << level << " texel " << x << ", " << y;
+                }
+            }
+        }
+        curr = std::move(next);
+        w = w2;
+        h = h2;
+    }
+    EXPECT_EQ(w, 1u);
+    EXPECT_EQ(h, 1u);
+}
+
+TEST(MipChain, KaiserKeepsConstantImages) {
+    MipChain chain(24, 16, 4);
+    for (uint32_t y = 0; y != 16; ++y) {
+        for (uint32_t x = 0; x != 24; ++x) {
+            writeRGBA8(chain, x, y, { 10, 128, 250, 255 });
+        }
+    }
+    MipChainSettings settings;
+    settings.mFilter = KaiserFilter;
+    chain.generate(Format::R8G8B8A8_UNORM, settings);
+
+    // the weights sum to one, clamped borders included
+    for (uint32_t level = 1; level != chain.mipCount(); ++level) {
+        for (uint32_t y = 0; y != chain.height(level); ++y) {
+            for (uint32_t x = 0; x != chain.width(level); ++x) {
+                EXPECT_EQ(readRGBA8(chain, level, x, y), (RGBA8{ 10, 128, 250, 255 }));
+            }
+        }
+    }
+}
+
+TEST(MipChain, KeepsSmoothImagesAboveTargetPSNR) {
+    const uint32_t size = 256;
+    auto f = [](double u, double v) {
+        return 0.5 + 0.4 * std::sin(2.0 * sPi * 3.0 * u) * std::cos(2.0 * sPi * 2.0 * v);
+    };
+    for (auto filter : { MipFilter(BoxFilter), MipFilter(KaiserFilter) }) {
+        MipChain chain(size, size, 1);
+        fillR8(chain, size, size, f);
+        MipChainSettings settings;
+        settings.mFilter = filter;
+        chain.generate(Format::R8_UNORM, settings);
+        EXPECT_GT(getPSNR(chain, 1, f), 45.0) << filter.index();
+        EXPECT_GT(getPSNR(chain, 3, f), 35.0) << filter.index();
+    }
+}
+
+TEST(MipChain, KaiserAttenuatesDetailPastTheNewNyquist) {
+    // 0.4 cycles per texel survives level 0, but not the 0.25 limit of level 1
+    const uint32_t size = 128;
+    auto f = [](double u, double) {
+        return 0.5 + 0.4 * std::sin(2.0 * sPi * 0.4 * size * u);
+    };
+    auto flat = [](double, double) {
+        return 0.5;
+    };
+    double psnr[2] = {};
+    int i = 0;
+    for (auto filter : { MipFilter(BoxFilter), MipFilter(KaiserFilter) }) {
+        MipChain chain(size, size, 1);
+        fillR8(chain, size, size, f);
+        MipChainSettings settings;
+        settings.mFilter = filter;
+        chain.generate(Format::R8_UNORM, settings);
+        psnr[i++] = getPSNR(chain, 1, flat);
+    }
+    // the box lets aliased detail through, kaiser mostly removes it
+    EXPECT_GT(psnr[1], psnr[0] + 10.0);
+    EXPECT_GT(psnr[1], 30.0);
+}
+
+TEST(MipChain, PreservesAlphaCoverage) {
+    const uint32_t size = 64;
+    const float alphaRef = 0.7f;
+    auto fill = [&](MipChain& chain) {
+        for (uint32_t y = 0; y != size; ++y) {
+            for (uint32_t x = 0; x != size; ++x) {
+                double a = 0.5 + 0.5 * std::sin(x * 1.3) * std::sin(y * 1.1);
+                writeRGBA8(chain, x, y, { 0, 255, 0, static_cast<uint8_t>(std::lround(255.0 * a)) });
+            }
+        }
+    };
+
+    MipChain plain(size, size, 4);
+    fill(plain);
+    plain.generate(Format::R8G8B8A8_UNORM);
+
+    MipChain preserved(size, size, 4);
+    fill(preserved);
+    MipChainSettings settings;
+    settings.mPreserveAlphaCoverage = true;
+    settings.mAlphaReference = alphaRef;
+    preserved.generate(Format::R8G8B8A8_UNORM, settings);
+
+    const float coverage = getCoverage(plain, 0, alphaRef);
+    ASSERT_GT(coverage, 0.05f);
+    for (uint32_t level = 1; level != 4; ++level) {
+        EXPECT_LT(getCoverage(plain, level, alphaRef), coverage - 0.05f) << level;
+        EXPECT_NEAR(getCoverage(preserved, level, alphaRef), coverage, 0.02f) << level;
+    }
+    // color is not touched
+    EXPECT_EQ(readRGBA8(preserved, 1, 3, 5)[1], 255);
+}
+
+TEST(MipChain, RejectsUnsupportedFormats) {
+    MipChain chain(4, 4, 16);
+    EXPECT_THROW(chain.generate(Format::R32G32B32A32_SFLOAT), std::invalid_argument);
+}
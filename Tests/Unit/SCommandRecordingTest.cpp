@@ -0,0 +1,167 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/SCommandRecording.h>
+#include <gtest/gtest.h>
+
+using namespace Star::Graphics::Render;
+
+namespace Star::Graphics::Render {
+
+// found by argument dependent lookup from gtest and std::equal
+bool operator==(const RecordingJob& lhs, const RecordingJob& rhs) noexcept {
+    return lhs.mBegin == rhs.mBegin && lhs.mEnd == rhs.mEnd && lhs.mCost == rhs.mCost;
+}
+
+}
+
+namespace {
+
+std::pmr::vector<RecordingJob> partition(const std::vector<uint64_t>& costs,
+    uint32_t maxJobs, uint64_t minJobCost
+) {
+    std::pmr::vector<RecordingJob> jobs(std::pmr::get_default_resource());
+    partitionRecordingJobs(costs, maxJobs, minJobCost, jobs);
+    return jobs;
+}
+
+// jobs are non-empty, contiguous and cover every subpass in order
+void expectCovers(const std::pmr::vector<RecordingJob>& jobs, const std::vector<uint64_t>& costs) {
+    ASSERT_FALSE(jobs.empty());
+    EXPECT_EQ(jobs.front().mBegin, 0u);
+    EXPECT_EQ(jobs.back().mEnd, costs.size());
+    for (size_t i = 0; i != jobs.size(); ++i) {
+        const auto& job = jobs[i];
+        EXPECT_LT(job.mBegin, job.mEnd);
+        if (i) {
+            EXPECT_EQ(job.mBegin, jobs[i - 1].mEnd);
+        }
+        uint64_t cost = 0;
+        for (auto k = job.mBegin; k != job.mEnd; ++k) {
+            cost += costs[k];
+        }
+        EXPECT_EQ(job.mCost, cost);
+    }
+}
+
+struct ThrowingBackend {
+    void record(uint32_t listID, const RecordingJob& job) {
+        if (listID == 2)
+            throw std::runtime_error("record failed");
+    }
+    void submit(uint32_t listCount) {
+        ++mSubmitCount;
+    }
+    std::atomic_uint32_t mSubmitCount = 0;
+};
+
+}
+
+TEST(PartitionRecordingJobs, EmptyFrameHasNoJobs) {
+    auto jobs = partition({}, 4, 0);
+    EXPECT_TRUE(jobs.empty());
+}
+
+TEST(PartitionRecordingJobs, SplitsEvenCostsEvenly) {
+    std::vector<uint64_t> costs(16, 10);
+    auto jobs = partition(costs, 4, 0);
+    expectCovers(jobs, costs);
+    ASSERT_EQ(jobs.size(), 4u);
+    for (const auto& job : jobs) {
+        EXPECT_EQ(job.mEnd - job.mBegin, 4u);
+        EXPECT_EQ(job.mCost, 40u);
+    }
+}
+
+TEST(PartitionRecordingJobs, KeepsOrderWithUnevenCosts) {
+    std::vector<uint64_t> costs{ 100, 1, 1, 1, 50, 50, 1, 200, 3, 3 };
+    auto jobs = partition(costs, 3, 0);
+    expectCovers(jobs, costs);
+    EXPECT_LE(jobs.size(), 3u);
+}
+
+TEST(PartitionRecordingJobs, NeverExceedsMaxJobs) {
+    std::vector<uint64_t> costs(1000);
+    for (size_t i = 0; i != costs.size(); ++i) {
+        costs[i] = (i * 7919) % 97;
+    }
+    for (uint32_t maxJobs : { 1u, 2u, 3u, 8u, 64u, 2000u }) {
+        auto jobs = partition(costs, maxJobs, 0);
+        expectCovers(jobs, costs);
+        EXPECT_LE(jobs.size(), maxJobs);
+    }
+}
+
+TEST(PartitionRecordingJobs, SingleJobCoversEverything) {
+    std::vector<uint64_t> costs{ 5, 6, 7 };
+    auto jobs = partition(costs, 1, 0);
+    ASSERT_EQ(jobs.size(), 1u);
+    EXPECT_EQ(jobs[0], (RecordingJob{ 0, 3, 18 }));
+}
+
+TEST(PartitionRecordingJobs, MinJobCostLimitsSmallFrames) {
+    std::vector<uint64_t> costs(10, 1);
+    auto jobs = partition(costs, 8, 5);
+    expectCovers(jobs, costs);
+    ASSERT_EQ(jobs.size(), 2u);
+    for (const auto& job : jobs) {
+        EXPECT_GE(job.mCost, 5u);
+    }
+}
+
+TEST(PartitionRecordingJobs, ZeroCostSubpassesStayInOrder) {
+    std::vector<uint64_t> costs(7, 0);
+    auto jobs = partition(costs, 4, 0);
+    expectCovers(jobs, costs);
+    EXPECT_LE(jobs.size(), 4u);
+}
+
+TEST(RecordJobs, SubmitsListsInJobOrder) {
+    std::vector<uint64_t> costs(256);
+    for (size_t i = 0; i != costs.size(); ++i) {
+        costs[i] = 1 + i % 13;
+    }
+    auto jobs = partition(costs, 16, 0);
+    ASSERT_GT(jobs.size(), 1u);
+
+    NullRecordingBackend backend(std::pmr::get_default_resource());
+    for (int repeat = 0; repeat != 100; ++repeat) {
+        backend.reset(static_cast<uint32_t>(jobs.size()));
+        recordJobs(backend, jobs);
+        ASSERT_EQ(backend.mSubmitted.size(), jobs.size());
+        EXPECT_TRUE(std::equal(jobs.begin(), jobs.end(), backend.mSubmitted.begin()));
+    }
+}
+
+TEST(RecordJobs, SingleJobIsRecordedInline) {
+    std::vector<uint64_t> costs{ 3, 4 };
+    auto jobs = partition(costs, 1, 0);
+    NullRecordingBackend backend(std::pmr::get_default_resource());
+    backend.reset(1);
+    recordJobs(backend, jobs);
+    ASSERT_EQ(backend.mSubmitted.size(), 1u);
+    EXPECT_EQ(backend.mSubmitted[0], (RecordingJob{ 0, 2, 7 }));
+}
+
+TEST(RecordJobs, RethrowsAndSkipsSubmitOnFailure) {
+    std::vector<uint64_t> costs(8, 1);
+    auto jobs = partition(costs, 4, 0);
+    ASSERT_EQ(jobs.size(), 4u);
+    ThrowingBackend backend;
+    EXPECT_THROW(recordJobs(backend, jobs), std::runtime_error);
+    EXPECT_EQ(backend.mSubmitCount, 0u);
+}
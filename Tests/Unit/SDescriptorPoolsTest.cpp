@@ -0,0 +1,145 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/SDescriptorPools.h>
+#include <gtest/gtest.h>
+
+using namespace Star::Graphics;
+
+namespace {
+
+std::vector<uint32_t> beginsOf(const std::vector<DescriptorBlock>& blocks) {
+    std::vector<uint32_t> begins;
+    begins.reserve(blocks.size());
+    for (const auto& block : blocks) {
+        begins.emplace_back(block.begin());
+    }
+    return begins;
+}
+
+}
+
+TEST(DescriptorPool, AllocatesEveryBlockOnce) {
+    DescriptorPool pool(4, 16, std::pmr::get_default_resource());
+    EXPECT_EQ(pool.getBlockCount(), 4u);
+
+    std::vector<DescriptorBlock> blocks;
+    for (uint32_t i = 0; i != pool.getBlockCount(); ++i) {
+        blocks.emplace_back(pool.allocateRange());
+        EXPECT_EQ(blocks.back().end() - blocks.back().begin(), 4u);
+    }
+    EXPECT_EQ(beginsOf(blocks), (std::vector<uint32_t>{ 0, 4, 8, 12 }));
+}
+
+TEST(DescriptorPool, ReusesFreedBlocksFifo) {
+    DescriptorPool pool(1, 4, std::pmr::get_default_resource());
+    std::vector<DescriptorBlock> blocks;
+    blocks.emplace_back(pool.allocateRange());
+    blocks.emplace_back(pool.allocateRange());
+    // block 0 is freed first, but blocks 2 and 3 are older in the free list
+    blocks[0] = DescriptorBlock();
+    blocks[1] = DescriptorBlock();
+
+    std::vector<DescriptorBlock> next;
+    for (int i = 0; i != 4; ++i) {
+        next.emplace_back(pool.allocateRange());
+    }
+    EXPECT_EQ(beginsOf(next), (std::vector<uint32_t>{ 2, 3, 0, 1 }));
+}
+
+TEST(DescriptorPool, KeepsFifoAcrossRingWrap) {
+    // 5 blocks use a ring of 8 slots, cycle through it many times
+    DescriptorPool pool(2, 10, std::pmr::get_default_resource());
+    std::deque<DescriptorBlock> live;
+    for (int i = 0; i != 3; ++i) {
+        live.emplace_back(pool.allocateRange());
+    }
+    uint32_t expected = 3;
+    for (int i = 0; i != 1000; ++i) {
+        live.pop_front();
+        live.emplace_back(pool.allocateRange());
+        EXPECT_EQ(live.back().begin(), expected * 2);
+        expected = (expected + 1) % 5;
+    }
+}
+
+TEST(DescriptorPool, ThrowsWhenExhausted) {
+    DescriptorPool pool(8, 16, std::pmr::get_default_resource());
+    auto a = pool.allocateRange();
+    auto b = pool.allocateRange();
+    EXPECT_THROW(pool.allocateRange(), std::runtime_error);
+
+    a = DescriptorBlock();
+    auto c = pool.allocateRange();
+    EXPECT_EQ(c.begin(), 0u);
+    EXPECT_THROW(pool.allocateRange(), std::runtime_error);
+}
+
+TEST(DescriptorPool, Torture) {
+    constexpr uint32_t blockCount = 1000;
+    constexpr int iterations = 20000;
+    DescriptorPool pool(1, blockCount, std::pmr::get_default_resource());
+    std::vector<std::atomic_int> owners(blockCount);
+    std::atomic_int doubleOwned = 0;
+    std::atomic_int exhausted = 0;
+
+    for (int threadCount : { 1, 2, 4, 8, 16, 32 }) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t != threadCount; ++t) {
+            threads.emplace_back([&, t]() {
+                std::vector<DescriptorBlock> held;
+                for (int i = 0; i != iterations; ++i) {
+                    // vary the batch so threads interleave pushes and pops
+                    const int batch = 1 + (i + t) % 8;
+                    for (int k = 0; k != batch; ++k) {
+                        try {
+                            auto block = pool.allocateRange();
+                            if (owners[block.begin()].fetch_add(1) != 0) {
+                                ++doubleOwned;
+                            }
+                            held.emplace_back(std::move(block));
+                        } catch (const std::runtime_error&) {
+                            ++exhausted;
+                        }
+                    }
+                    for (auto& block : held) {
+                        owners[block.begin()].fetch_sub(1);
+                    }
+                    held.clear();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        EXPECT_EQ(doubleOwned.load(), 0) << threadCount << " threads";
+    }
+    // 32 threads * 8 blocks never exceed the pool
+    EXPECT_EQ(exhausted.load(), 0);
+
+    // every block came back exactly once
+    std::vector<DescriptorBlock> all;
+    for (uint32_t i = 0; i != blockCount; ++i) {
+        all.emplace_back(pool.allocateRange());
+    }
+    EXPECT_THROW(pool.allocateRange(), std::runtime_error);
+    auto begins = beginsOf(all);
+    std::sort(begins.begin(), begins.end());
+    for (uint32_t i = 0; i != blockCount; ++i) {
+        EXPECT_EQ(begins[i], i);
+    }
+}
@@ -0,0 +1,246 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SDrawPacket.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+using namespace Star::Graphics::Render;
+
+namespace {
+
+// a draw as the frame queue sees it, states are addresses of pso, material and mesh
+struct Draw {
+    uint32_t mPass = 0;
+    uint64_t mPSO = 0;
+    uint64_t mMaterial = 0;
+    uint64_t mMesh = 0;
+    uint32_t mDepthBucket = 0;
+};
+
+struct StateChanges {
+    uint32_t mPSO = 0;
+    uint32_t mMaterial = 0;
+    uint32_t mMesh = 0;
+};
+
+// draws from small pools of aligned addresses, as a scene with shared assets
+std::vector<Draw> makeScene(size_t count, uint32_t psoCount, uint32_t materialCount,
+    uint32_t meshCount, uint32_t seed
+) {
+    std::mt19937 rng(seed);
+    auto address = [&](uint32_t pool, uint32_t n) {
+        return 0x10000000ull * (pool + 1) + 0x140ull * (rng() % n);
+    };
+    std::vector<Draw> draws(count);
+    for (auto& draw : draws) {
+        draw.mPSO = address(0, psoCount);
+        draw.mMaterial = address(1, materialCount);
+        draw.mMesh = address(2, meshCount);
+        draw.mDepthBucket = rng() % sDrawDepthBuckets;
+    }
+    return draws;
+}
+
+std::pmr::vector<DrawPacket> makePackets(const std::vector<Draw>& draws) {
+    std::pmr::vector<DrawPacket> packets;
+    packets.reserve(draws.size());
+    for (uint32_t i = 0; i != draws.size(); ++i) {
+        const auto& d = draws[i];
+        packets.emplace_back(DrawPacket{
+            makeDrawSortKey(d.mPass, d.mPSO, d.mMaterial, d.mMesh, d.mDepthBucket), i });
+    }
+    return packets;
+}
+
+// binds skipped when the previous draw already set the same state, as recordJob does
+StateChanges countStateChanges(const std::vector<Draw>& draws,
+    const std::pmr::vector<DrawPacket>& packets
+) {
+    StateChanges changes;
+    const Draw* pPrev = nullptr;
+    for (const auto& packet : packets) {
+        const auto& draw = draws[packet.mIndex];
+        if (!pPrev || pPrev->mPSO != draw.mPSO)
+            ++changes.mPSO;
+        if (!pPrev || pPrev->mMaterial != draw.mMaterial)
+            ++changes.mMaterial;
+        if (!pPrev || pPrev->mMesh != draw.mMesh)
+            ++changes.mMesh;
+        pPrev = &draw;
+    }
+    return changes;
+}
+
+void radixSort(std::pmr::vector<DrawPacket>& packets) {
+    std::pmr::vector<DrawPacket> scratch;
+    radixSortDrawPackets(packets, scratch);
+}
+
+std::pmr::vector<DrawPacket> stableSorted(std::pmr::vector<DrawPacket> packets) {
+    std::stable_sort(packets.begin(), packets.end(), [](const DrawPacket& lhs, const DrawPacket& rhs) {
+        return lhs.mKey < rhs.mKey;
+    });
+    return packets;
+}
+
+void expectSame(const std::pmr::vector<DrawPacket>& lhs, const std::pmr::vector<DrawPacket>& rhs) {
+    ASSERT_EQ(lhs.size(), rhs.size());
+    for (size_t i = 0; i != lhs.size(); ++i) {
+        EXPECT_EQ(lhs[i].mKey, rhs[i].mKey) << i;
+        EXPECT_EQ(lhs[i].mIndex, rhs[i].mIndex) << i;
+    }
+}
+
+}
+
+TEST(DrawPacketTest, KeyFieldsSortMostSignificantFirst) {
+    const uint64_t a = 0x1000, b = 0x2000;
+    auto key = [](uint32_t pass, uint64_t pso, uint64_t material, uint64_t mesh, uint32_t depth) {
+        return makeDrawSortKey(pass, pso, material, mesh, depth);
+    };
+    // pass wins over every other field
+    EXPECT_LT(key(0, b, b, b, 255), key(1, a, a, a, 0));
+    // depth only orders draws sharing every state
+    EXPECT_LT(key(0, a, a, a, 3), key(0, a, a, a, 4));
+    EXPECT_EQ(key(0, a, b, a, 0) >> 40, key(0, a, a, b, 255) >> 40);
+    EXPECT_EQ(key(0, a, a, b, 0) >> 24, key(0, a, a, b, 255) >> 24);
+    EXPECT_EQ(key(2, a, a, a, 7) >> 56, 2u);
+    EXPECT_EQ(key(2, a, a, a, 7) & 0xff, 7u);
+}
+
+TEST(DrawPacketTest, DepthBuckets) {
+    EXPECT_EQ(getDrawDepthBucket(-1.0f, 100.0f), 0u);
+    EXPECT_EQ(getDrawDepthBucket(0.0f, 100.0f), 0u);
+    EXPECT_EQ(getDrawDepthBucket(std::numeric_limits<float>::quiet_NaN(), 100.0f), 0u);
+    EXPECT_EQ(getDrawDepthBucket(100.0f, 100.0f), sDrawDepthBuckets - 1);
+    EXPECT_EQ(getDrawDepthBucket(1e30f, 100.0f), sDrawDepthBuckets - 1);
+    EXPECT_EQ(getDrawDepthBucket(std::numeric_limits<float>::infinity(), 100.0f), sDrawDepthBuckets - 1);
+
+    uint32_t prev = 0;
+    for (float d = 0; d < 120.0f; d += 0.37f) {
+        const auto bucket = getDrawDepthBucket(d, 100.0f);
+        EXPECT_LT(bucket, sDrawDepthBuckets);
+        EXPECT_GE(bucket, prev) << d;
+        prev = bucket;
+    }
+}
+
+TEST(DrawPacketTest, RadixSortSmall) {
+    std::pmr::vector<DrawPacket> packets;
+    radixSort(packets);
+    EXPECT_TRUE(packets.empty());
+
+    packets = { { 5, 0 } };
+    radixSort(packets);
+    EXPECT_EQ(packets[0].mIndex, 0u);
+
+    packets = { { 5, 0 }, { 3, 1 } };
+    radixSort(packets);
+    EXPECT_EQ(packets[0].mIndex, 1u);
+    EXPECT_EQ(packets[1].mIndex, 0u);
+}
+
+// every pass skipped, the order is untouched
+TEST(DrawPacketTest, RadixSortEqualKeys) {
+    std::pmr::vector<DrawPacket> packets;
+    for (uint32_t i = 0; i != 100; ++i) {
+        packets.emplace_back(DrawPacket{ 0x0123456789abcdefull, i });
+    }
+    radixSort(packets);
+    for (uint32_t i = 0; i != 100; ++i) {
+        EXPECT_EQ(packets[i].mIndex, i);
+    }
+}
+
+// odd and even numbers of byte passes end in either buffer
+TEST(DrawPacketTest, RadixSortMatchesStableSort) {
+    std::mt19937_64 rng(7);
+    for (uint64_t mask : { 0xffull, 0xff00ull, 0xffffull, 0xff00ff00ff000000ull, ~0ull }) {
+        for (size_t count : { 3, 64, 1000, 1024, 5000 }) {
+            std::pmr::vector<DrawPacket> packets;
+            for (uint32_t i = 0; i != count; ++i) {
+                // few distinct values so equal keys exercise stability
+                packets.emplace_back(DrawPacket{ (rng() % 37 * 0x0101010101010101ull) & mask, i });
+            }
+            auto expected = stableSorted(packets);
+            radixSort(packets);
+            expectSame(packets, expected);
+        }
+    }
+}
+
+TEST(DrawPacketTest, SortedScene) {
+    const auto draws = makeScene(4096, 6, 24, 40, 1);
+    auto packets = makePackets(draws);
+    radixSort(packets);
+    expectSame(packets, stableSorted(makePackets(draws)));
+
+    // within a state run draws go front to back
+    for (size_t i = 1; i != packets.size(); ++i) {
+        const auto& prev = draws[packets[i - 1].mIndex];
+        const auto& curr = draws[packets[i].mIndex];
+        if (prev.mPSO == curr.mPSO && prev.mMaterial == curr.mMaterial && prev.mMesh == curr.mMesh) {
+            EXPECT_LE(prev.mDepthBucket, curr.mDepthBucket);
+        }
+    }
+}
+
+TEST(DrawPacketTest, SortingReducesStateChanges) {
+    const auto draws = makeScene(4096, 6, 24, 40, 2);
+    std::set<uint64_t> psos;
+    std::set<std::pair<uint64_t, uint64_t>> materials;
+    std::set<std::tuple<uint64_t, uint64_t, uint64_t>> meshes;
+    for (const auto& d : draws) {
+        psos.emplace(d.mPSO);
+        materials.emplace(d.mPSO, d.mMaterial);
+        meshes.emplace(d.mPSO, d.mMaterial, d.mMesh);
+    }
+
+    auto packets = makePackets(draws);
+    const auto before = countStateChanges(draws, packets);
+    radixSort(packets);
+    const auto after = countStateChanges(draws, packets);
+
+    // submission order switches state on nearly every draw
+    EXPECT_GT(before.mPSO, draws.size() / 2);
+    EXPECT_GT(before.mMaterial, draws.size() * 9 / 10);
+    EXPECT_GT(before.mMesh, draws.size() * 9 / 10);
+
+    // sorted, each state is bound once per run of its parent state
+    EXPECT_EQ(after.mPSO, psos.size());
+    EXPECT_EQ(after.mMaterial, materials.size());
+    EXPECT_EQ(after.mMesh, meshes.size());
+}
+
+// the pass field keeps passes apart even if it costs state changes
+TEST(DrawPacketTest, PassesStaySeparate) {
+    auto draws = makeScene(1000, 4, 8, 8, 3);
+    for (uint32_t i = 0; i != draws.size(); ++i) {
+        draws[i].mPass = i % 3;
+    }
+    auto packets = makePackets(draws);
+    radixSort(packets);
+    uint32_t prevPass = 0;
+    for (const auto& packet : packets) {
+        EXPECT_GE(draws[packet.mIndex].mPass, prevPass);
+        prevPass = draws[packet.mIndex].mPass;
+    }
+    EXPECT_LE(countStateChanges(draws, packets).mPSO, 3u * 4u);
+}
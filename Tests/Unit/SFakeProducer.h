@@ -0,0 +1,303 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+#include <Star/Core/SManagerPrivate.h>
+#include <gtest/gtest.h>
+
+namespace Star::Core::Test {
+
+enum class State : int {
+    Unloaded,
+    Queued,
+    Loading,
+    Cancelling,
+    Loaded,
+};
+
+inline State getState(const Resource* pResource) noexcept {
+    return static_cast<State>(pResource->current_state()[0]);
+}
+
+inline MetaID makeMetaID(uint64_t i) noexcept {
+    MetaID id{};
+    for (size_t k = 0; k != sizeof(i); ++k) {
+        id.data[k] = static_cast<uint8_t>(i >> (k * 8));
+    }
+    return id;
+}
+
+inline uint64_t getIndex(const MetaID& id) noexcept {
+    uint64_t i = 0;
+    for (size_t k = 0; k != sizeof(i); ++k) {
+        i |= uint64_t(id.data[k]) << (k * 8);
+    }
+    return i;
+}
+
+// producer with no backing storage, the payload of a resource is a heap allocated MetaID.
+// every callback is checked against the loads actually started, so the manager can't
+// call created or destroy for work the producer never did.
+// a concurrent producer is loaded on the workflow loader pool, its state is locked
+class FakeProducer : public Producer {
+public:
+    using Payload = MetaID;
+
+    FakeProducer(const ResourceType& tag, bool concurrent = false) {
+        registerProducer(tag, concurrent);
+    }
+
+    ~FakeProducer() {
+        for (auto& [id, pPayload] : mPayloads) {
+            delete pPayload;
+        }
+    }
+
+    // settings, fixed once loads start
+    uint64_t mDefaultSize = 0;
+    std::unordered_map<MetaID, uint64_t, boost::hash<MetaID>> mSizes;
+    // frames from load to delivery, delivered by tick
+    uint32_t mLatencyFrames = 0;
+    // delayed loads check their token on every tick
+    bool mAbandonOnCancel = false;
+    // time spent in load
+    std::chrono::microseconds mLoadTime{ 0 };
+    std::unordered_map<MetaID, std::chrono::microseconds, boost::hash<MetaID>> mLoadTimes;
+    // async loads poll their token after the load time until it is cancelled, 10s at most
+    bool mWaitForCancel = false;
+    // loads in flight before load reports busy, 0 is unlimited
+    size_t mMaxInFlight = 0;
+    // async loads finished as failed
+    std::unordered_set<MetaID, boost::hash<MetaID>> mFailures;
+    // dependencies reported once a resource is created
+    std::unordered_map<MetaID, std::vector<std::pair<MetaID, ResourceType>>, boost::hash<MetaID>> mDependencies;
+
+    uint64_t size(const MetaID& id) const {
+        auto iter = mSizes.find(id);
+        return iter != mSizes.end() ? iter->second : mDefaultSize;
+    }
+
+    std::chrono::microseconds loadTime(const MetaID& id) const {
+        auto iter = mLoadTimes.find(id);
+        return iter != mLoadTimes.end() ? iter->second : mLoadTime;
+    }
+
+    // payloads created and not yet destroyed
+    size_t live() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mPayloads.size();
+    }
+
+    // loads started and not yet created
+    size_t inFlight() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mTasks.size();
+    }
+
+    // loads started so far, safe while loads run
+    std::vector<MetaID> started() const {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mLoaded;
+    }
+
+    // most loads running at the same time
+    size_t peakRunning() const noexcept {
+        return mPeakRunning.load();
+    }
+
+    // called once per frame before the manager handles its commands
+    void tick() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto iter = std::remove_if(mPending.begin(), mPending.end(), [this](Pending& p) {
+            // a token seen cancelled abandons the load, even if it is reset later
+            p.mAbandoned |= mAbandonOnCancel && p.mToken.cancelled();
+            if (--p.mFrames != 0)
+                return false;
+            if (p.mAbandoned) {
+                deliverCancelled(*p.mResource, true);
+            } else {
+                finish(*p.mResource);
+            }
+            return true;
+        });
+        mPending.erase(iter, mPending.end());
+    }
+
+    // observed, read them once the loads are done
+    std::vector<MetaID> mLoaded;
+    std::vector<MetaID> mCreated;
+    std::vector<MetaID> mDestroyed;
+private:
+    struct Pending {
+        const Resource* mResource = nullptr;
+        uint32_t mFrames = 0;
+        CancellationToken mToken;
+        bool mAbandoned = false;
+    };
+
+    bool load(const Resource& resource, bool async, CancellationToken token) override {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mMaxInFlight && mTasks.size() >= mMaxInFlight)
+                return false;
+
+            auto res = mTasks.emplace(resource.metaID());
+            EXPECT_TRUE(res.second) << "load started twice";
+            mLoaded.emplace_back(resource.metaID());
+        }
+        const auto running = ++mRunning;
+        auto peak = mPeakRunning.load();
+        while (running > peak && !mPeakRunning.compare_exchange_weak(peak, running)) {}
+
+        const auto loadTime = this->loadTime(resource.metaID());
+        if (loadTime.count()) {
+            std::this_thread::sleep_for(loadTime);
+        }
+        if (async && mWaitForCancel) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (!token.cancelled() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        --mRunning;
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (async && token.cancelled()) { // released while loading, abandoned
+            deliverCancelled(resource, async);
+        } else if (async && mLatencyFrames) {
+            mPending.emplace_back(Pending{ &resource, mLatencyFrames, token });
+        } else {
+            finish(resource, async);
+        }
+        return true;
+    }
+
+    // locked
+    void finish(const Resource& resource, bool async = true) {
+        if (async && mFailures.count(resource.metaID())) {
+            deliverFailed(resource, async);
+            return;
+        }
+        auto pPayload = new Payload(resource.metaID());
+        auto res = mPayloads.emplace(resource.metaID(), pPayload);
+        EXPECT_TRUE(res.second) << "payload not destroyed";
+        deliver(resource, pPayload, async, size(resource.metaID()));
+    }
+
+    void dependencies(const Resource& resource,
+        std::vector<MetaID>& metaIDs, std::vector<ResourceType>& tags) const override {
+        auto iter = mDependencies.find(resource.metaID());
+        if (iter == mDependencies.end())
+            return;
+        for (const auto& [id, tag] : iter->second) {
+            metaIDs.emplace_back(id);
+            tags.emplace_back(tag);
+        }
+    }
+
+    uint64_t estimateSize(const Resource& resource) const override {
+        return size(resource.metaID());
+    }
+
+    void created(const Resource& resource) override {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto count = mTasks.erase(resource.metaID());
+        EXPECT_EQ(count, 1u) << "created without a load";
+        mCreated.emplace_back(resource.metaID());
+    }
+
+    void destroy(const Resource& resource) noexcept override {
+        std::lock_guard<std::mutex> lock(mMutex);
+        EXPECT_EQ(mTasks.count(resource.metaID()), 0u) << "destroyed while loading";
+        auto iter = mPayloads.find(resource.metaID());
+        if (iter != mPayloads.end()) {
+            delete iter->second;
+            mPayloads.erase(iter);
+        }
+        mDestroyed.emplace_back(resource.metaID());
+    }
+
+    mutable std::mutex mMutex;
+    std::atomic<size_t> mRunning{ 0 };
+    std::atomic<size_t> mPeakRunning{ 0 };
+    std::unordered_set<MetaID, boost::hash<MetaID>> mTasks;
+    std::vector<Pending> mPending;
+    std::unordered_map<MetaID, Payload*, boost::hash<MetaID>> mPayloads;
+};
+
+// owns the Workflow singleton for one test
+class ManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Workflow::init(4096, 64, loaderCount());
+    }
+
+    void TearDown() override {
+        Workflow::stop();
+        // producers are used until the manager is gone
+        Workflow::terminate();
+        mProducers.clear();
+    }
+
+    // worker threads for concurrent producers
+    virtual size_t loaderCount() const noexcept {
+        return 0;
+    }
+
+    // runs frames until pred holds, loads of concurrent producers complete in the background
+    template<class Pred>
+    bool frameUntil(Pred pred, std::chrono::milliseconds timeout = std::chrono::seconds(10)) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!pred()) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            frame();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    template<class... Args>
+    FakeProducer& addProducer(Args&&... args) {
+        return *mProducers.emplace_back(std::make_unique<FakeProducer>(std::forward<Args>(args)...));
+    }
+
+    static const Resource* get(uint64_t i, const ResourceType& tag) {
+        return Manager::instance().get(makeMetaID(i), tag);
+    }
+
+    // one frame of the async workflow, as the render loop runs it
+    void frame() {
+        for (auto& pProducer : mProducers) {
+            pProducer->tick();
+        }
+        Workflow::processEvents();
+        Workflow::loadResources();
+        Workflow::processEvents();
+        Workflow::updateResources();
+    }
+
+    static const Resource* acquire(uint64_t i, const ResourceType& tag, int32_t priority = 0) {
+        auto pResource = get(i, tag);
+        pResource->async_acquire(priority);
+        return pResource;
+    }
+
+    std::vector<std::unique_ptr<FakeProducer>> mProducers;
+};
+
+}
@@ -0,0 +1,160 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SFakeProducer.h"
+#include <Star/Core/SFetch.h>
+
+using namespace Star;
+using namespace Star::Core;
+using namespace Star::Core::Test;
+
+namespace {
+
+class FetchGroupTest : public ManagerTest {
+protected:
+    static std::vector<MetaID> metaIDs(uint64_t count) {
+        std::vector<MetaID> ids;
+        for (uint64_t i = 0; i != count; ++i) {
+            ids.emplace_back(makeMetaID(i));
+        }
+        return ids;
+    }
+};
+
+}
+
+TEST_F(FetchGroupTest, ReadyWhenAllLoaded) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 2;
+
+    FetchGroup group(metaIDs(4), Mesh);
+    EXPECT_FALSE(group.ready());
+    EXPECT_FALSE(group.done());
+    frame();
+    frame();
+    EXPECT_FALSE(group.done());
+    frame();
+    EXPECT_TRUE(group.ready());
+    EXPECT_TRUE(group.done());
+    EXPECT_FALSE(group.failed());
+    EXPECT_EQ(group.loadedCount(), 4u);
+    for (size_t i = 0; i != group.size(); ++i) {
+        EXPECT_EQ(group.status(i), FetchStatus::Loaded);
+        EXPECT_EQ(*static_cast<const MetaID*>(group.get(i)), makeMetaID(i));
+    }
+}
+
+// members load at their own pace, each one is settled once
+TEST_F(FetchGroupTest, MembersCompleteOutOfOrder) {
+    auto& meshes = addProducer(Mesh);
+    meshes.mLatencyFrames = 4;
+    auto& textures = addProducer(Texture);
+    textures.mLatencyFrames = 1;
+
+    const auto ids = metaIDs(4);
+    const ResourceType tags[] = { Mesh, Texture, Mesh, Texture };
+    FetchGroup group(ids, tags);
+    frame();
+    frame();
+    EXPECT_FALSE(group.done());
+    EXPECT_EQ(group.loadedCount(), 2u);
+    EXPECT_EQ(group.status(0), FetchStatus::Loading);
+    EXPECT_EQ(group.status(1), FetchStatus::Loaded);
+    EXPECT_EQ(group.status(2), FetchStatus::Loading);
+    EXPECT_EQ(group.status(3), FetchStatus::Loaded);
+    frame();
+    frame();
+    frame();
+    EXPECT_TRUE(group.ready());
+    EXPECT_EQ(group.loadedCount(), 4u);
+}
+
+// a failed member completes the group instead of keeping it loading forever
+TEST_F(FetchGroupTest, FailedMemberCompletesGroup) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 1;
+    producer.mFailures = { makeMetaID(2) };
+
+    FetchGroup group(metaIDs(4), Mesh);
+    for (int f = 0; f != 4 && !group.done(); ++f) {
+        frame();
+    }
+    EXPECT_TRUE(group.done());
+    EXPECT_FALSE(group.ready());
+    EXPECT_TRUE(group.failed());
+    EXPECT_EQ(group.loadedCount(), 3u);
+    EXPECT_EQ(group.failedCount(), 1u);
+    EXPECT_EQ(group.status(2), FetchStatus::Failed);
+    EXPECT_EQ(group.get(2), nullptr);
+    EXPECT_EQ(group.status(3), FetchStatus::Loaded);
+    EXPECT_EQ(producer.inFlight(), 0u);
+    EXPECT_EQ(producer.live(), 3u);
+}
+
+// every member failing still completes the group
+TEST_F(FetchGroupTest, AllMembersFail) {
+    auto& producer = addProducer(Mesh);
+    producer.mFailures = { makeMetaID(0), makeMetaID(1) };
+
+    FetchGroup group(metaIDs(2), Mesh);
+    frame();
+    EXPECT_TRUE(group.done());
+    EXPECT_EQ(group.failedCount(), 2u);
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+// a failure is kept until the resource is released, acquiring it again retries the load
+TEST_F(FetchGroupTest, FailureClearedWhenAcquiredAgain) {
+    auto& producer = addProducer(Mesh);
+    producer.mFailures = { makeMetaID(0) };
+
+    const auto ids = metaIDs(1);
+    FetchGroup group(ids, Mesh);
+    frame();
+    EXPECT_TRUE(group.failed());
+
+    // sharing the failed resource sees the failure
+    FetchGroup shared(ids, Mesh);
+    EXPECT_TRUE(shared.failed());
+    shared = FetchGroup();
+    group = FetchGroup();
+    frame();
+
+    producer.mFailures.clear();
+    FetchGroup retry(ids, Mesh);
+    EXPECT_FALSE(retry.done());
+    frame();
+    EXPECT_TRUE(retry.ready());
+    EXPECT_EQ(producer.mLoaded.size(), 2u);
+}
+
+TEST_F(FetchGroupTest, MoveKeepsStatus) {
+    auto& producer = addProducer(Mesh);
+    producer.mFailures = { makeMetaID(1) };
+
+    FetchGroup group(metaIDs(3), Mesh);
+    frame();
+    EXPECT_TRUE(group.done());
+    FetchGroup moved(std::move(group));
+    EXPECT_EQ(group.size(), 0u);
+    EXPECT_TRUE(group.done());
+    EXPECT_EQ(moved.loadedCount(), 2u);
+    EXPECT_EQ(moved.failedCount(), 1u);
+    EXPECT_EQ(moved.status(1), FetchStatus::Failed);
+    EXPECT_TRUE(moved.done());
+}
@@ -0,0 +1,173 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SFakeProducer.h"
+#include <Star/Core/SHandleTable.h>
+
+using namespace Star;
+using namespace Star::Core;
+using namespace Star::Core::Test;
+
+namespace {
+
+using Table = HandleTable<int>;
+
+Table makeTable() {
+    return Table(std::pmr::get_default_resource());
+}
+
+}
+
+TEST(HandleTableTest, InsertAndFind) {
+    auto table = makeTable();
+    auto [a, insertedA] = table.try_emplace(makeMetaID(1), 10);
+    auto [b, insertedB] = table.try_emplace(makeMetaID(2), 20);
+    EXPECT_TRUE(insertedA);
+    EXPECT_TRUE(insertedB);
+    EXPECT_TRUE(a);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(*table.get(a), 10);
+    EXPECT_EQ(*table.get(b), 20);
+    EXPECT_EQ(table.find(makeMetaID(2)), b);
+    EXPECT_EQ(table.metaID(a), makeMetaID(1));
+    EXPECT_EQ(table.size(), 2u);
+
+    // inserted once, the existing handle is returned
+    auto [again, inserted] = table.try_emplace(makeMetaID(1), 30);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(again, a);
+    EXPECT_EQ(*table.get(a), 10);
+}
+
+TEST(HandleTableTest, NullHandle) {
+    auto table = makeTable();
+    table.try_emplace(makeMetaID(1), 10);
+    EXPECT_FALSE(Handle{});
+    EXPECT_FALSE(table.valid(Handle{}));
+    EXPECT_EQ(table.get(Handle{}), nullptr);
+    EXPECT_FALSE(table.find(makeMetaID(2)));
+    EXPECT_FALSE(table.erase(Handle{}));
+}
+
+TEST(HandleTableTest, EraseMakesHandleStale) {
+    auto table = makeTable();
+    auto a = table.try_emplace(makeMetaID(1), 10).first;
+    EXPECT_TRUE(table.erase(a));
+    EXPECT_FALSE(table.valid(a));
+    EXPECT_EQ(table.get(a), nullptr);
+    EXPECT_FALSE(table.find(makeMetaID(1)));
+    EXPECT_FALSE(table.erase(a));
+    EXPECT_EQ(table.size(), 0u);
+}
+
+// a reused slot gets a new generation, the old handle does not see the new entry
+TEST(HandleTableTest, ReusedSlotRejectsStaleHandle) {
+    auto table = makeTable();
+    auto a = table.try_emplace(makeMetaID(1), 10).first;
+    table.erase(a);
+    auto b = table.try_emplace(makeMetaID(2), 20).first;
+    EXPECT_EQ(b.index(), a.index());
+    EXPECT_NE(b.generation(), a.generation());
+    EXPECT_EQ(table.get(a), nullptr);
+    EXPECT_EQ(*table.get(b), 20);
+}
+
+// generations never wrap, a slot that used all of them is retired
+TEST(HandleTableTest, GenerationDoesNotWrap) {
+    auto table = makeTable();
+    auto first = table.try_emplace(makeMetaID(0), 0).first;
+    EXPECT_EQ(first.generation(), 1u);
+    std::vector<Handle> handles{ first };
+    table.erase(first);
+    for (uint32_t i = 1; i != Handle::sGenerationMask; ++i) {
+        auto h = table.try_emplace(makeMetaID(i), static_cast<int>(i)).first;
+        ASSERT_EQ(h.index(), first.index());
+        handles.emplace_back(h);
+        table.erase(h);
+    }
+    EXPECT_EQ(handles.back().generation(), Handle::sGenerationMask);
+    EXPECT_EQ(table.retiredCount(), 1u);
+
+    // the next entry takes a new slot, none of the old handles resolves
+    auto next = table.try_emplace(makeMetaID(Handle::sGenerationMask), 1).first;
+    EXPECT_NE(next.index(), first.index());
+    for (auto h : handles) {
+        EXPECT_EQ(table.get(h), nullptr);
+    }
+    EXPECT_EQ(*table.get(next), 1);
+}
+
+// the free list hands out erased slots before growing
+TEST(HandleTableTest, SlotsAreDense) {
+    auto table = makeTable();
+    std::vector<Handle> handles;
+    for (uint64_t i = 0; i != 8; ++i) {
+        handles.emplace_back(table.try_emplace(makeMetaID(i), static_cast<int>(i)).first);
+    }
+    for (uint64_t i = 0; i < 8; i += 2) {
+        table.erase(handles[i]);
+    }
+    for (uint64_t i = 8; i != 12; ++i) {
+        auto h = table.try_emplace(makeMetaID(i), static_cast<int>(i)).first;
+        EXPECT_LT(h.index(), 8u);
+    }
+    EXPECT_EQ(table.size(), 8u);
+}
+
+namespace {
+
+class ManagerHandleTest : public ManagerTest {};
+
+}
+
+// a loaded resource has a handle until it is unloaded, reloading gives a new one
+TEST_F(ManagerHandleTest, HandleOfLoadedResource) {
+    addProducer(Mesh);
+
+    auto a = acquire(0, Mesh);
+    EXPECT_FALSE(Workflow::getHandle(makeMetaID(0)));
+    frame();
+    auto handle = Workflow::getHandle(makeMetaID(0));
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(*static_cast<const MetaID*>(Workflow::get(handle)), makeMetaID(0));
+    EXPECT_EQ(Workflow::getMetaID(handle), makeMetaID(0));
+
+    a->release();
+    frame();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_EQ(Workflow::get(handle), nullptr);
+    EXPECT_FALSE(Workflow::getHandle(makeMetaID(0)));
+
+    a->async_acquire();
+    frame();
+    auto reloaded = Workflow::getHandle(makeMetaID(0));
+    ASSERT_TRUE(reloaded);
+    EXPECT_NE(reloaded, handle);
+    EXPECT_EQ(Workflow::get(handle), nullptr);
+    EXPECT_NE(Workflow::get(reloaded), nullptr);
+}
+
+// a failed load gets no handle
+TEST_F(ManagerHandleTest, FailedLoadHasNoHandle) {
+    auto& producer = addProducer(Mesh);
+    producer.mFailures = { makeMetaID(0) };
+
+    acquire(0, Mesh);
+    frame();
+    EXPECT_FALSE(Workflow::getHandle(makeMetaID(0)));
+}
@@ -0,0 +1,120 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/SInstanceBatching.h>
+#include <gtest/gtest.h>
+#include <numeric>
+
+using namespace Star::Graphics::Render;
+
+namespace {
+
+struct Grouping {
+    std::pmr::vector<uint32_t> mObjects;
+    std::pmr::vector<InstanceGroup> mGroups;
+};
+
+Grouping group(const std::vector<uint32_t>& classes, uint32_t maxInstanceCount,
+    std::vector<uint32_t> objects
+) {
+    Grouping result{
+        std::pmr::vector<uint32_t>(objects.begin(), objects.end(), std::pmr::get_default_resource()),
+        std::pmr::vector<InstanceGroup>(std::pmr::get_default_resource()),
+    };
+    buildInstanceGroups(classes, maxInstanceCount, result.mObjects, result.mGroups);
+    return result;
+}
+
+std::vector<uint32_t> iota(uint32_t count) {
+    std::vector<uint32_t> objects(count);
+    std::iota(objects.begin(), objects.end(), 0u);
+    return objects;
+}
+
+// groups are contiguous, cover every object, hold one class and respect the limit
+void expectValid(const Grouping& g, const std::vector<uint32_t>& classes, uint32_t maxInstanceCount) {
+    uint32_t next = 0;
+    for (const auto& group : g.mGroups) {
+        EXPECT_EQ(group.mFirst, next);
+        EXPECT_GE(group.mCount, 1u);
+        EXPECT_LE(group.mCount, maxInstanceCount);
+        for (uint32_t i = group.mFirst; i != group.mFirst + group.mCount; ++i) {
+            EXPECT_EQ(classes[g.mObjects[i]], classes[g.mObjects[group.mFirst]]);
+        }
+        next += group.mCount;
+    }
+    EXPECT_EQ(next, g.mObjects.size());
+}
+
+}
+
+TEST(BuildInstanceGroups, NoObjectsNoGroups) {
+    auto g = group({ 0, 1 }, 8, {});
+    EXPECT_TRUE(g.mObjects.empty());
+    EXPECT_TRUE(g.mGroups.empty());
+}
+
+TEST(BuildInstanceGroups, SingleInstanceKeepsOrder) {
+    std::vector<uint32_t> classes{ 2, 0, 2, 1, 0 };
+    auto g = group(classes, 1, iota(5));
+    expectValid(g, classes, 1);
+    EXPECT_EQ(std::vector<uint32_t>(g.mObjects.begin(), g.mObjects.end()), iota(5));
+    EXPECT_EQ(g.mGroups.size(), 5u);
+}
+
+TEST(BuildInstanceGroups, GroupsByClassStably) {
+    std::vector<uint32_t> classes{ 2, 0, 2, 1, 0, 2 };
+    auto g = group(classes, 8, iota(6));
+    expectValid(g, classes, 8);
+    EXPECT_EQ(std::vector<uint32_t>(g.mObjects.begin(), g.mObjects.end()),
+        (std::vector<uint32_t>{ 1, 4, 3, 0, 2, 5 }));
+    ASSERT_EQ(g.mGroups.size(), 3u);
+    EXPECT_EQ(g.mGroups[0].mCount, 2u);
+    EXPECT_EQ(g.mGroups[1].mCount, 1u);
+    EXPECT_EQ(g.mGroups[2].mCount, 3u);
+}
+
+TEST(BuildInstanceGroups, SplitsAtMaxInstanceCount) {
+    std::vector<uint32_t> classes(10, 7);
+    auto g = group(classes, 4, iota(10));
+    expectValid(g, classes, 4);
+    ASSERT_EQ(g.mGroups.size(), 3u);
+    EXPECT_EQ(g.mGroups[0].mCount, 4u);
+    EXPECT_EQ(g.mGroups[1].mCount, 4u);
+    EXPECT_EQ(g.mGroups[2].mCount, 2u);
+}
+
+TEST(BuildInstanceGroups, GroupsVisibleSubset) {
+    // only visible objects are passed, classes is indexed by object
+    std::vector<uint32_t> classes{ 0, 1, 0, 1, 0, 1, 0, 1 };
+    auto g = group(classes, 16, { 7, 2, 5, 0 });
+    expectValid(g, classes, 16);
+    EXPECT_EQ(std::vector<uint32_t>(g.mObjects.begin(), g.mObjects.end()),
+        (std::vector<uint32_t>{ 2, 0, 7, 5 }));
+    EXPECT_EQ(g.mGroups.size(), 2u);
+}
+
+TEST(BuildInstanceGroups, ManyClasses) {
+    std::vector<uint32_t> classes(4096);
+    for (uint32_t i = 0; i != classes.size(); ++i) {
+        classes[i] = (i * 2654435761u) % 61;
+    }
+    for (uint32_t maxInstanceCount : { 1u, 3u, 64u, 10000u }) {
+        auto g = group(classes, maxInstanceCount, iota(4096));
+        expectValid(g, classes, maxInstanceCount);
+    }
+}
@@ -0,0 +1,135 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Log/SLog.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace Star;
+
+namespace {
+
+class SLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mConsole = std::clog.rdbuf(mConsoleText.rdbuf());
+        // unique per test and process, ctest -j runs tests side by side
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        mFilename = (std::filesystem::temp_directory_path() / ("star_log_test_"
+            + std::string(info->name()) + "_" + std::to_string(getpid()) + ".log")).string();
+    }
+    void TearDown() override {
+        exitLogging();
+        std::clog.rdbuf(mConsole);
+        std::error_code ec;
+        std::filesystem::remove(mFilename, ec);
+    }
+
+    static void logFromThreads(int threadCount, int recordCount) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t != threadCount; ++t) {
+            threads.emplace_back([t, recordCount]() {
+                for (int i = 0; i != recordCount; ++i) {
+                    S_INFO << "thread " << t << " record " << i;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    static size_t countLines(std::istream& is) {
+        size_t count = 0;
+        std::string line;
+        while (std::getline(is, line)) {
+            ++count;
+        }
+        return count;
+    }
+
+    std::ostringstream mConsoleText;
+    std::streambuf* mConsole = nullptr;
+    std::string mFilename;
+};
+
+}
+
+TEST_F(SLogTest, AsyncWritesEveryRecord) {
+    AsyncLogSettings settings;
+    settings.mOverflow = LogOverflowPolicy::Block;
+    initAsyncLogging(boost::log::trivial::info, mFilename.c_str(), settings);
+    logFromThreads(4, 1000);
+    exitLogging();
+
+    std::ifstream file(mFilename);
+    EXPECT_EQ(countLines(file), 4000u);
+    std::istringstream console(mConsoleText.str());
+    EXPECT_EQ(countLines(console), 4000u);
+}
+
+TEST_F(SLogTest, AsyncFiltersBySeverity) {
+    initAsyncLogging(boost::log::trivial::warning, mFilename.c_str());
+    S_INFO << "hidden";
+    S_WARNING << "shown";
+    exitLogging();
+
+    std::ifstream file(mFilename);
+    std::string line;
+    ASSERT_TRUE(std::getline(file, line));
+    EXPECT_NE(line.find("<warning> shown"), std::string::npos);
+    EXPECT_FALSE(std::getline(file, line));
+}
+
+TEST_F(SLogTest, BinaryFileDecodes) {
+    AsyncLogSettings settings;
+    settings.mOverflow = LogOverflowPolicy::Block;
+    settings.mBinary = true;
+    initAsyncLogging(boost::log::trivial::info, mFilename.c_str(), settings);
+    // longer than the inline buffer, stored on the heap
+    const std::string longMessage(500, 'x');
+    S_INFO << "short";
+    S_ERROR << longMessage;
+    logFromThreads(2, 100);
+    exitLogging();
+
+    std::ifstream file(mFilename, std::ios::binary);
+    std::ostringstream decoded;
+    decodeLogFile(file, decoded);
+
+    std::istringstream text(decoded.str());
+    EXPECT_EQ(countLines(text), 202u);
+    EXPECT_EQ(decoded.str(), mConsoleText.str());
+    EXPECT_NE(decoded.str().find("<error> " + longMessage + "\n"), std::string::npos);
+}
+
+TEST_F(SLogTest, DecodeRejectsTextFile) {
+    std::istringstream text("[00:00:00] <info> not binary\n");
+    std::ostringstream decoded;
+    EXPECT_THROW(decodeLogFile(text, decoded), std::runtime_error);
+}
@@ -0,0 +1,733 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SFakeProducer.h"
+#include <random>
+
+using namespace Star;
+using namespace Star::Core;
+using namespace Star::Core::Test;
+
+namespace {
+
+class ManagerBudgetTest : public ManagerTest {};
+
+}
+
+// loaded resources released under memory pressure are evicted least recently released first
+TEST_F(ManagerBudgetTest, EvictsLeastRecentlyReleased) {
+    auto& producer = addProducer(Mesh);
+    producer.mDefaultSize = 100;
+    Workflow::setBudget(Mesh, 250);
+
+    const Resource* resources[4];
+    for (uint64_t i = 0; i != 4; ++i) {
+        resources[i] = acquire(i, Mesh);
+    }
+    frame();
+    for (auto pResource : resources) {
+        EXPECT_EQ(getState(pResource), State::Loaded);
+    }
+    // acquired resources are never evicted, usage may exceed the budget
+    EXPECT_EQ(Workflow::getUsage(Mesh), 400u);
+
+    resources[2]->release();
+    resources[0]->release();
+    resources[3]->release();
+    frame();
+
+    // released in the order 2, 0, 3, two of them must go
+    EXPECT_EQ(getState(resources[2]), State::Unloaded);
+    EXPECT_EQ(getState(resources[0]), State::Unloaded);
+    EXPECT_EQ(getState(resources[3]), State::Loaded);
+    EXPECT_EQ(getState(resources[1]), State::Loaded);
+    EXPECT_EQ(producer.mDestroyed, (std::vector<MetaID>{ makeMetaID(2), makeMetaID(0) }));
+    EXPECT_EQ(Workflow::getUsage(Mesh), 200u);
+    EXPECT_EQ(producer.live(), 2u);
+
+    resources[1]->release();
+    frame();
+    EXPECT_EQ(Workflow::getUsage(Mesh), 200u);
+    EXPECT_EQ(producer.live(), 2u);
+}
+
+// a resident unused resource acquired again leaves the lru and is not loaded twice
+TEST_F(ManagerBudgetTest, ReacquireKeepsResident) {
+    auto& producer = addProducer(Mesh);
+    producer.mDefaultSize = 100;
+    Workflow::setBudget(Mesh, 200);
+
+    auto a = acquire(0, Mesh);
+    auto b = acquire(1, Mesh);
+    frame();
+    a->release();
+    b->release();
+    frame();
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(getState(b), State::Loaded);
+
+    // a was released first, but using it again makes b the eviction candidate
+    a->async_acquire();
+    frame();
+    EXPECT_EQ(producer.mLoaded.size(), 2u);
+
+    auto c = acquire(2, Mesh);
+    frame();
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(getState(b), State::Unloaded);
+    EXPECT_EQ(getState(c), State::Loaded);
+    EXPECT_EQ(producer.mDestroyed, std::vector<MetaID>{ makeMetaID(1) });
+
+    // reloaded after eviction
+    b->async_acquire();
+    frame();
+    EXPECT_EQ(getState(b), State::Loaded);
+    EXPECT_EQ(producer.mLoaded.size(), 4u);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 300u);
+}
+
+// released and acquired again before the manager handled the release
+TEST_F(ManagerBudgetTest, ReleaseRacesReacquire) {
+    auto& producer = addProducer(Mesh);
+    producer.mDefaultSize = 100;
+    Workflow::setBudget(Mesh, 0);
+
+    auto a = acquire(0, Mesh);
+    frame();
+    a->release();
+    a->async_acquire();
+    frame();
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(producer.mLoaded.size(), 1u);
+    EXPECT_TRUE(producer.mDestroyed.empty());
+}
+
+// without a budget nothing unused stays resident
+TEST_F(ManagerBudgetTest, ZeroBudgetUnloadsOnRelease) {
+    auto& producer = addProducer(Mesh);
+    producer.mDefaultSize = 100;
+
+    auto a = acquire(0, Mesh);
+    frame();
+    EXPECT_EQ(Workflow::getUsage(Mesh), 100u);
+    a->release();
+    frame();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 0u);
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+// lowering the budget evicts right away, in lru order
+TEST_F(ManagerBudgetTest, LoweringBudgetEvicts) {
+    auto& producer = addProducer(Mesh);
+    producer.mSizes = {
+        { makeMetaID(0), 300 },
+        { makeMetaID(1), 100 },
+        { makeMetaID(2), 200 },
+    };
+    Workflow::setBudget(Mesh, 1000);
+
+    const Resource* resources[3];
+    for (uint64_t i = 0; i != 3; ++i) {
+        resources[i] = acquire(i, Mesh);
+    }
+    frame();
+    for (auto pResource : resources) {
+        pResource->release();
+    }
+    frame();
+    EXPECT_EQ(Workflow::getUsage(Mesh), 600u);
+    EXPECT_EQ(producer.live(), 3u);
+
+    Workflow::setBudget(Mesh, 250);
+    EXPECT_EQ(producer.mDestroyed, (std::vector<MetaID>{ makeMetaID(0), makeMetaID(1) }));
+    EXPECT_EQ(Workflow::getUsage(Mesh), 200u);
+
+    Workflow::setBudget(Mesh, 0);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 0u);
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+// budgets and usage are kept per resource type
+TEST_F(ManagerBudgetTest, BudgetsArePerType) {
+    auto& meshes = addProducer(Mesh);
+    auto& textures = addProducer(Texture);
+    meshes.mDefaultSize = 100;
+    textures.mDefaultSize = 1000;
+    Workflow::setBudget(Mesh, 1000);
+    Workflow::setBudget(Texture, 1000);
+
+    auto mesh = acquire(0, Mesh);
+    frame();
+    mesh->release();
+    frame();
+
+    // textures over their budget don't touch the meshes, metaIDs are unique across types
+    const Resource* texturesLoaded[3];
+    for (uint64_t i = 0; i != 3; ++i) {
+        texturesLoaded[i] = acquire(100 + i, Texture);
+    }
+    frame();
+    for (auto pResource : texturesLoaded) {
+        pResource->release();
+    }
+    frame();
+
+    EXPECT_EQ(getState(mesh), State::Loaded);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 100u);
+    EXPECT_EQ(Workflow::getUsage(Texture), 1000u);
+    EXPECT_EQ(textures.live(), 1u);
+    EXPECT_EQ(getState(texturesLoaded[2]), State::Loaded);
+}
+
+// many resources cycling through a small budget keep usage and payloads in step
+TEST_F(ManagerBudgetTest, MemoryPressure) {
+    auto& producer = addProducer(Mesh);
+    for (uint64_t i = 0; i != 512; ++i) {
+        producer.mSizes.emplace(makeMetaID(i), 1 + i % 7 * 64);
+    }
+    constexpr uint64_t budget = 4096;
+    Workflow::setBudget(Mesh, budget);
+
+    std::mt19937 rng(3);
+    std::vector<const Resource*> acquired;
+    for (int f = 0; f != 200; ++f) {
+        for (int k = 0; k != 8; ++k) {
+            acquired.emplace_back(acquire(rng() % 512, Mesh));
+        }
+        frame();
+        std::shuffle(acquired.begin(), acquired.end(), rng);
+        while (acquired.size() > 16) {
+            acquired.back()->release();
+            acquired.pop_back();
+        }
+        frame();
+
+        uint64_t resident = 0;
+        uint64_t used = 0;
+        size_t loaded = 0;
+        for (uint64_t i = 0; i != 512; ++i) {
+            auto pResource = get(i, Mesh);
+            if (getState(pResource) == State::Loaded) {
+                ++loaded;
+                resident += producer.size(makeMetaID(i));
+                if (!pResource->unused()) {
+                    used += producer.size(makeMetaID(i));
+                }
+            }
+        }
+        ASSERT_EQ(Workflow::getUsage(Mesh), resident);
+        ASSERT_LE(resident, std::max(budget, used));
+        ASSERT_EQ(producer.live(), loaded);
+    }
+}
+
+namespace {
+
+class ManagerPriorityTest : public ManagerTest {
+protected:
+    static std::vector<MetaID> metaIDs(std::initializer_list<uint64_t> ids) {
+        std::vector<MetaID> result;
+        for (auto i : ids) {
+            result.emplace_back(makeMetaID(i));
+        }
+        return result;
+    }
+};
+
+}
+
+TEST_F(ManagerPriorityTest, HigherPriorityStartsFirst) {
+    auto& producer = addProducer(Mesh);
+    StreamingBudget budget;
+    budget.mLoadCount = 2;
+    Workflow::setStreamingBudget(budget);
+
+    const int32_t priorities[] = { 0, 3, 1, 4, 2 };
+    for (uint64_t i = 0; i != 5; ++i) {
+        acquire(i, Mesh, priorities[i]);
+    }
+    frame();
+    EXPECT_EQ(producer.mLoaded, metaIDs({ 3, 1 }));
+    frame();
+    frame();
+    EXPECT_EQ(producer.mLoaded, metaIDs({ 3, 1, 4, 2, 0 }));
+}
+
+// equal priorities start in the order they were queued
+TEST_F(ManagerPriorityTest, EqualPriorityIsFirstInFirstOut) {
+    auto& producer = addProducer(Mesh);
+    StreamingBudget budget;
+    budget.mLoadCount = 1;
+    Workflow::setStreamingBudget(budget);
+
+    acquire(5, Mesh);
+    frame(); // 5 starts
+    acquire(7, Mesh);
+    frame(); // 7 starts
+    acquire(2, Mesh);
+    acquire(9, Mesh);
+    acquire(1, Mesh);
+    frame();
+    frame();
+    frame();
+    EXPECT_EQ(producer.mLoaded, metaIDs({ 5, 7, 2, 9, 1 }));
+}
+
+TEST_F(ManagerPriorityTest, PriorityUpdatedWhileQueued) {
+    auto& producer = addProducer(Mesh);
+    StreamingBudget budget;
+    budget.mLoadCount = 1;
+    Workflow::setStreamingBudget(budget);
+
+    const Resource* resources[4];
+    for (uint64_t i = 0; i != 4; ++i) {
+        resources[i] = acquire(i, Mesh, 1);
+    }
+    frame();
+    EXPECT_EQ(producer.mLoaded, metaIDs({ 0 }));
+
+    // the camera turned, 3 is in front now and 1 behind
+    resources[3]->setPriority(5);
+    resources[1]->setPriority(-5);
+    frame();
+    frame();
+    frame();
+    EXPECT_EQ(producer.mLoaded, metaIDs({ 0, 3, 2, 1 }));
+}
+
+// a low priority load ages past a steady stream of higher priority ones
+TEST_F(ManagerPriorityTest, AgingAvoidsStarvation) {
+    addProducer(Mesh);
+    StreamingBudget budget;
+    budget.mLoadCount = 1;
+    Workflow::setStreamingBudget(budget);
+
+    auto low = acquire(0, Mesh, 0);
+    int frames = 0;
+    for (uint64_t i = 1; getState(low) != State::Loaded && i != 100; ++i) {
+        acquire(i, Mesh, 2);
+        frame();
+        ++frames;
+    }
+    EXPECT_EQ(getState(low), State::Loaded);
+    // two priority levels gained every 8 frames each
+    EXPECT_LE(frames, 2 * 8 + 2);
+    EXPECT_GT(frames, 8);
+}
+
+TEST_F(ManagerPriorityTest, ByteBudgetLimitsLoadsPerFrame) {
+    auto& producer = addProducer(Mesh);
+    producer.mDefaultSize = 100;
+    StreamingBudget budget;
+    budget.mLoadBytes = 250;
+    Workflow::setStreamingBudget(budget);
+
+    for (uint64_t i = 0; i != 10; ++i) {
+        acquire(i, Mesh);
+    }
+    // the budget is checked before each start, the last one may go over
+    std::vector<size_t> perFrame;
+    while (producer.mLoaded.size() != 10 && perFrame.size() != 10) {
+        auto count = producer.mLoaded.size();
+        frame();
+        perFrame.emplace_back(producer.mLoaded.size() - count);
+    }
+    EXPECT_EQ(perFrame, (std::vector<size_t>{ 3, 3, 3, 1 }));
+}
+
+TEST_F(ManagerPriorityTest, TimeBudgetLimitsLoadsPerFrame) {
+    auto& producer = addProducer(Mesh);
+    producer.mLoadTime = std::chrono::microseconds(200);
+    StreamingBudget budget;
+    budget.mLoadTime = std::chrono::microseconds(1);
+    Workflow::setStreamingBudget(budget);
+
+    for (uint64_t i = 0; i != 4; ++i) {
+        acquire(i, Mesh);
+    }
+    frame();
+    EXPECT_EQ(producer.mLoaded.size(), 1u);
+    frame();
+    frame();
+    frame();
+    EXPECT_EQ(producer.mLoaded.size(), 4u);
+}
+
+// a busy producer keeps loads pending, they start as earlier ones complete
+TEST_F(ManagerPriorityTest, BusyProducerRetries) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 3;
+    producer.mMaxInFlight = 2;
+
+    const Resource* resources[7];
+    for (uint64_t i = 0; i != 7; ++i) {
+        resources[i] = acquire(i, Mesh, static_cast<int32_t>(i));
+    }
+    for (int f = 0; f != 20; ++f) {
+        frame();
+        EXPECT_LE(producer.inFlight(), 2u);
+    }
+    for (auto pResource : resources) {
+        EXPECT_EQ(getState(pResource), State::Loaded);
+    }
+    EXPECT_EQ(producer.mLoaded, metaIDs({ 6, 5, 4, 3, 2, 1, 0 }));
+}
+
+// a load stays in flight until the producer delivers it
+TEST_F(ManagerPriorityTest, SimulatedLatency) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 4;
+
+    auto a = acquire(0, Mesh);
+    frame();
+    EXPECT_EQ(getState(a), State::Loading);
+    auto b = acquire(1, Mesh);
+    frame();
+    frame();
+    frame();
+    EXPECT_EQ(getState(a), State::Loading);
+    frame();
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(getState(b), State::Loading);
+    frame();
+    EXPECT_EQ(getState(b), State::Loaded);
+}
+
+namespace {
+
+class ManagerConcurrentTest : public ManagerTest {
+protected:
+    size_t loaderCount() const noexcept override {
+        return 4;
+    }
+
+    static bool allLoaded(gsl::span<const Resource* const> resources) {
+        return std::all_of(resources.begin(), resources.end(), [](const Resource* pResource) {
+            return getState(pResource) == State::Loaded;
+        });
+    }
+};
+
+}
+
+// loads of a concurrent producer run on the loader pool side by side
+TEST_F(ManagerConcurrentTest, LoadsOverlap) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTime = std::chrono::milliseconds(20);
+
+    const Resource* resources[8];
+    for (uint64_t i = 0; i != 8; ++i) {
+        resources[i] = acquire(i, Mesh);
+    }
+    ASSERT_TRUE(frameUntil([&] { return allLoaded(resources); }));
+    EXPECT_GT(producer.peakRunning(), 1u);
+    EXPECT_LE(producer.peakRunning(), loaderCount());
+    EXPECT_EQ(producer.live(), 8u);
+    EXPECT_EQ(producer.inFlight(), 0u);
+}
+
+// loads complete in the order they finish, not the order they started
+TEST_F(ManagerConcurrentTest, MixedLatencyCompletesOutOfOrder) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTimes = {
+        { makeMetaID(0), std::chrono::milliseconds(200) },
+        { makeMetaID(1), std::chrono::milliseconds(0) },
+        { makeMetaID(2), std::chrono::milliseconds(50) },
+    };
+
+    const Resource* resources[3];
+    for (uint64_t i = 0; i != 3; ++i) {
+        resources[i] = acquire(i, Mesh);
+    }
+    ASSERT_TRUE(frameUntil([&] { return getState(resources[1]) == State::Loaded; }));
+    EXPECT_EQ(getState(resources[0]), State::Loading);
+
+    ASSERT_TRUE(frameUntil([&] { return allLoaded(resources); }));
+    ASSERT_EQ(producer.mCreated.size(), 3u);
+    EXPECT_EQ(producer.mCreated.front(), makeMetaID(1));
+    EXPECT_EQ(producer.mCreated.back(), makeMetaID(0));
+}
+
+// a slow concurrent producer does not hold back the loads of the others
+TEST_F(ManagerConcurrentTest, SlowProducerDoesNotBlock) {
+    auto& slow = addProducer(Mesh, true);
+    slow.mLoadTime = std::chrono::milliseconds(300);
+    auto& fast = addProducer(Texture);
+    fast.mLatencyFrames = 2;
+
+    auto a = acquire(0, Mesh);
+    auto b = acquire(1, Texture);
+    frame(); // both start
+    frame();
+    frame(); // b delivered
+    EXPECT_EQ(getState(b), State::Loaded);
+    EXPECT_EQ(getState(a), State::Loading);
+    ASSERT_TRUE(frameUntil([&] { return getState(a) == State::Loaded; }));
+    EXPECT_EQ(slow.live(), 1u);
+    EXPECT_EQ(fast.live(), 1u);
+}
+
+// released while its load runs, the producer abandons it on the token
+TEST_F(ManagerConcurrentTest, ReleasedWhileLoading) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTime = std::chrono::milliseconds(50);
+
+    auto a = acquire(0, Mesh);
+    ASSERT_TRUE(frameUntil([&] { return producer.started().size() == 1; }));
+    a->release();
+    ASSERT_TRUE(frameUntil([&] {
+        return getState(a) == State::Unloaded && producer.inFlight() == 0;
+    }));
+    EXPECT_EQ(producer.live(), 0u);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 0u);
+}
+
+// the load only ends once the producer sees the token at its cancellation point
+TEST_F(ManagerConcurrentTest, AbandonedAtCancellationPoint) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mWaitForCancel = true;
+
+    auto a = acquire(0, Mesh);
+    ASSERT_TRUE(frameUntil([&] { return producer.started().size() == 1; }));
+    EXPECT_EQ(getState(a), State::Loading);
+    a->release();
+    // well before the producer stops waiting on its own
+    ASSERT_TRUE(frameUntil([&] {
+        return getState(a) == State::Unloaded && producer.inFlight() == 0;
+    }, std::chrono::seconds(5)));
+    ASSERT_EQ(producer.mDestroyed.size(), 1u);
+    EXPECT_EQ(producer.live(), 0u);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 0u);
+}
+
+// many small loads with random latencies, acquired and released while loading
+TEST_F(ManagerConcurrentTest, StressMixedLatency) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mDefaultSize = 10;
+    std::mt19937 rng(7);
+    constexpr uint64_t count = 200;
+    for (uint64_t i = 0; i != count; ++i) {
+        producer.mLoadTimes.emplace(makeMetaID(i), std::chrono::microseconds(rng() % 2000));
+    }
+
+    std::vector<const Resource*> resources;
+    for (uint64_t i = 0; i != count; ++i) {
+        resources.emplace_back(acquire(i, Mesh, static_cast<int32_t>(rng() % 4)));
+    }
+    ASSERT_TRUE(frameUntil([&] { return producer.started().size() >= count / 2; }));
+    // every other one started so far is not needed anymore, running or already loaded
+    std::vector<bool> released(count);
+    size_t releasedCount = 0;
+    const auto started = producer.started();
+    for (size_t k = 0; k < started.size(); k += 2) {
+        const auto i = getIndex(started[k]);
+        resources[i]->release();
+        released[i] = true;
+        ++releasedCount;
+    }
+    ASSERT_TRUE(frameUntil([&] {
+        for (uint64_t i = 0; i != count; ++i) {
+            const auto expected = released[i] ? State::Unloaded : State::Loaded;
+            if (getState(resources[i]) != expected)
+                return false;
+        }
+        return producer.inFlight() == 0;
+    }));
+    EXPECT_EQ(producer.live(), count - releasedCount);
+    EXPECT_EQ(Workflow::getUsage(Mesh), (count - releasedCount) * 10);
+}
+
+namespace {
+
+class ManagerDependencyTest : public ManagerTest {
+protected:
+    static void addEdge(FakeProducer& producer, uint64_t from, uint64_t to,
+        const ResourceType& tag = Mesh) {
+        producer.mDependencies[makeMetaID(from)].emplace_back(makeMetaID(to), tag);
+    }
+
+    static size_t count(const std::vector<MetaID>& ids, uint64_t i) {
+        return std::count(ids.begin(), ids.end(), makeMetaID(i));
+    }
+
+    static ptrdiff_t position(const std::vector<MetaID>& ids, uint64_t i) {
+        return std::find(ids.begin(), ids.end(), makeMetaID(i)) - ids.begin();
+    }
+
+    void frames(int count) {
+        for (int f = 0; f != count; ++f) {
+            frame();
+        }
+    }
+};
+
+}
+
+// the closure of a resource is loaded one level after the other
+TEST_F(ManagerDependencyTest, ClosureLoadsLevelByLevel) {
+    auto& producer = addProducer(Mesh);
+    addEdge(producer, 0, 1);
+    addEdge(producer, 0, 2);
+    addEdge(producer, 1, 3);
+
+    auto a = acquire(0, Mesh);
+    frames(4);
+    EXPECT_EQ(getState(a), State::Loaded);
+    for (uint64_t i = 1; i != 4; ++i) {
+        EXPECT_EQ(getState(get(i, Mesh)), State::Loaded) << i;
+    }
+    const auto& created = producer.mCreated;
+    ASSERT_EQ(created.size(), 4u);
+    EXPECT_LT(position(created, 0), position(created, 1));
+    EXPECT_LT(position(created, 0), position(created, 2));
+    EXPECT_LT(position(created, 1), position(created, 3));
+}
+
+// unloading a resource releases its dependencies, the closure goes with it
+TEST_F(ManagerDependencyTest, ReleaseUnloadsClosure) {
+    auto& producer = addProducer(Mesh);
+    addEdge(producer, 0, 1);
+    addEdge(producer, 1, 2);
+
+    auto a = acquire(0, Mesh);
+    frames(4);
+    EXPECT_EQ(producer.live(), 3u);
+    a->release();
+    frames(4);
+    for (uint64_t i = 0; i != 3; ++i) {
+        EXPECT_EQ(getState(get(i, Mesh)), State::Unloaded) << i;
+    }
+    EXPECT_EQ(producer.live(), 0u);
+    EXPECT_EQ(producer.mDestroyed.size(), 3u);
+}
+
+// a dependency shared by several resources, or listed twice, is loaded once and
+// stays resident until its last dependent is gone
+TEST_F(ManagerDependencyTest, SharedDependencyLoadedOnce) {
+    auto& producer = addProducer(Mesh);
+    addEdge(producer, 0, 2);
+    addEdge(producer, 0, 2);
+    addEdge(producer, 1, 2);
+
+    auto a = acquire(0, Mesh);
+    auto b = acquire(1, Mesh);
+    frames(4);
+    auto shared = get(2, Mesh);
+    EXPECT_EQ(getState(shared), State::Loaded);
+    EXPECT_EQ(count(producer.mLoaded, 2), 1u);
+
+    a->release();
+    frames(4);
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_EQ(getState(shared), State::Loaded);
+
+    b->release();
+    frames(4);
+    EXPECT_EQ(getState(shared), State::Unloaded);
+    EXPECT_EQ(count(producer.mDestroyed, 2), 1u);
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+// diamond, the common dependency is reached on two paths
+TEST_F(ManagerDependencyTest, DiamondLoadsOnce) {
+    auto& producer = addProducer(Mesh);
+    addEdge(producer, 0, 1);
+    addEdge(producer, 0, 2);
+    addEdge(producer, 1, 3);
+    addEdge(producer, 2, 3);
+
+    auto a = acquire(0, Mesh);
+    frames(4);
+    EXPECT_EQ(getState(get(3, Mesh)), State::Loaded);
+    EXPECT_EQ(count(producer.mLoaded, 3), 1u);
+    EXPECT_EQ(producer.live(), 4u);
+
+    a->release();
+    frames(4);
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+// a cycle is loaded once, the closing edge is dropped so nothing keeps itself resident
+TEST_F(ManagerDependencyTest, CycleDoesNotKeepItselfResident) {
+    auto& producer = addProducer(Mesh);
+    addEdge(producer, 0, 1);
+    addEdge(producer, 1, 2);
+    addEdge(producer, 2, 0);
+
+    auto a = acquire(0, Mesh);
+    frames(4);
+    for (uint64_t i = 0; i != 3; ++i) {
+        EXPECT_EQ(getState(get(i, Mesh)), State::Loaded) << i;
+        EXPECT_EQ(count(producer.mLoaded, i), 1u) << i;
+    }
+
+    a->release();
+    frames(4);
+    for (uint64_t i = 0; i != 3; ++i) {
+        EXPECT_EQ(getState(get(i, Mesh)), State::Unloaded) << i;
+    }
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+TEST_F(ManagerDependencyTest, SelfDependencyIgnored) {
+    auto& producer = addProducer(Mesh);
+    addEdge(producer, 0, 0);
+
+    auto a = acquire(0, Mesh);
+    frames(2);
+    EXPECT_EQ(getState(a), State::Loaded);
+    a->release();
+    frames(2);
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_EQ(producer.live(), 0u);
+}
+
+// dependencies of another type are loaded by their own producer
+TEST_F(ManagerDependencyTest, DependenciesAcrossTypes) {
+    auto& meshes = addProducer(Mesh);
+    auto& textures = addProducer(Texture);
+    addEdge(meshes, 0, 10, Texture);
+    addEdge(meshes, 0, 11, Texture);
+
+    auto a = acquire(0, Mesh);
+    frames(4);
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(getState(get(10, Texture)), State::Loaded);
+    EXPECT_EQ(getState(get(11, Texture)), State::Loaded);
+    EXPECT_EQ(textures.live(), 2u);
+
+    a->release();
+    frames(4);
+    EXPECT_EQ(meshes.live(), 0u);
+    EXPECT_EQ(textures.live(), 0u);
+}
+
+// dependencies start with the priority of their dependent
+TEST_F(ManagerDependencyTest, DependenciesInheritPriority) {
+    auto& producer = addProducer(Mesh);
+    StreamingBudget budget;
+    budget.mLoadCount = 1;
+    Workflow::setStreamingBudget(budget);
+    addEdge(producer, 0, 1);
+
+    acquire(0, Mesh, 5);
+    frame(); // 0 starts and is created, 1 is acquired
+    acquire(2, Mesh, 1);
+    frames(3);
+    EXPECT_LT(position(producer.mLoaded, 1), position(producer.mLoaded, 2));
+}
@@ -0,0 +1,155 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SObjectConstants.h>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Star;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+struct Placement {
+    std::pmr::vector<uint32_t> mSlots;
+    ObjectConstantLayout mLayout;
+};
+
+Placement place(const std::vector<uint32_t>& counts) {
+    std::vector<InstanceGroup> groups;
+    uint32_t first = 0;
+    for (auto count : counts) {
+        groups.emplace_back(InstanceGroup{ first, count });
+        first += count;
+    }
+    Placement result;
+    result.mLayout = placeObjectConstants(groups, result.mSlots);
+    return result;
+}
+
+// what the shader sees through the view of a group
+const float* getArray(const std::byte* pView, uint32_t arrayID, uint32_t instanceID) {
+    return reinterpret_cast<const float*>(pView + arrayID * sObjectConstantArraySize
+        + instanceID * sObjectConstantStride);
+}
+
+}
+
+TEST(ObjectConstantsTest, ViewCoversAllArrays) {
+    EXPECT_EQ(sObjectConstantStride, 64u);
+    EXPECT_EQ(sObjectConstantSlotAlignment, 4u);
+    EXPECT_EQ(getObjectConstantOffset(0), 0u);
+    EXPECT_EQ(getObjectConstantOffset(4), 256u);
+    EXPECT_EQ(getObjectConstantOffset(sMaxInstanceCount), sObjectConstantStripeSize);
+    EXPECT_EQ(getObjectConstantOffset(sMaxInstanceCount + 8), sObjectConstantStripeSize + 512);
+
+    EXPECT_EQ(getObjectConstantViewSize(1), sObjectConstantArraySize + 256);
+    EXPECT_EQ(getObjectConstantViewSize(4), sObjectConstantArraySize + 256);
+    EXPECT_EQ(getObjectConstantViewSize(5), sObjectConstantArraySize + 512);
+    EXPECT_EQ(getObjectConstantViewSize(sMaxInstanceCount), sObjectConstantStripeSize);
+    // one view stays inside the 64KB constant buffer limit
+    EXPECT_LE(getObjectConstantViewSize(sMaxInstanceCount), 65536u);
+}
+
+TEST(ObjectConstantsTest, Empty) {
+    auto p = place({});
+    EXPECT_TRUE(p.mSlots.empty());
+    EXPECT_EQ(p.mLayout.mSlotCount, 0u);
+    EXPECT_EQ(p.mLayout.mSize, 0u);
+}
+
+TEST(ObjectConstantsTest, GroupsStartAligned) {
+    auto p = place({ 1, 1, 3, 4, 5, 2 });
+    EXPECT_EQ(p.mSlots, (std::pmr::vector<uint32_t>{ 0, 4, 8, 12, 16, 24 }));
+    EXPECT_EQ(p.mLayout.mSlotCount, 26u);
+    EXPECT_EQ(p.mLayout.mSize, sObjectConstantArraySize + 26 * 64 + 128);
+}
+
+TEST(ObjectConstantsTest, GroupsNeverCrossStripes) {
+    auto p = place({ 60, 8, sMaxInstanceCount, 1 });
+    EXPECT_EQ(p.mSlots, (std::pmr::vector<uint32_t>{ 0, 64, 128, 192 }));
+
+    p = place({ 60, 4, 1 });
+    EXPECT_EQ(p.mSlots, (std::pmr::vector<uint32_t>{ 0, 60, 64 }));
+    EXPECT_EQ(p.mLayout.mSize, sObjectConstantStripeSize + sObjectConstantArraySize + 256);
+}
+
+TEST(ObjectConstantsTest, RandomPlacement) {
+    std::mt19937 rng(3);
+    std::vector<uint32_t> counts(500);
+    for (auto& count : counts) {
+        count = rng() % 3 ? 1 + rng() % 6 : 1 + rng() % sMaxInstanceCount;
+    }
+    auto p = place(counts);
+    ASSERT_EQ(p.mSlots.size(), counts.size());
+    EXPECT_EQ(p.mLayout.mSize % 256, 0u);
+
+    uint32_t end = 0;
+    for (size_t i = 0; i != counts.size(); ++i) {
+        const auto slot = p.mSlots[i];
+        EXPECT_GE(slot, end);
+        EXPECT_EQ(getObjectConstantOffset(slot) % 256, 0u);
+        EXPECT_EQ(slot / sMaxInstanceCount, (slot + counts[i] - 1) / sMaxInstanceCount);
+        EXPECT_LE(getObjectConstantOffset(slot) + getObjectConstantViewSize(counts[i]), p.mLayout.mSize);
+        end = slot + counts[i];
+    }
+    EXPECT_EQ(p.mLayout.mSlotCount, end);
+}
+
+TEST(ObjectConstantsTest, PackMatchesShaderView) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    const uint32_t objectCount = 300;
+    std::vector<WorldTransform> worlds(objectCount);
+    std::vector<WorldTransformInv> worldInvs(objectCount);
+    for (uint32_t i = 0; i != objectCount; ++i) {
+        worlds[i].mTransform = Translation3f(dist(rng), dist(rng), dist(rng))
+            * AngleAxisf(dist(rng), Vector3f::UnitY());
+        worldInvs[i].mTransform = worlds[i].mTransform.inverse().matrix().transpose();
+    }
+    Matrix4f view = (Translation3f(0, 0, -5) * AngleAxisf(0.3f, Vector3f::UnitX())).matrix();
+
+    // every third object is visible, groups of mixed size
+    std::pmr::vector<uint32_t> objects;
+    for (uint32_t i = 0; i < objectCount; i += 3) {
+        objects.emplace_back(i);
+    }
+    std::vector<InstanceGroup> groups;
+    for (uint32_t first = 0; first != objects.size();) {
+        const auto count = std::min<uint32_t>(1 + rng() % 20, gsl::narrow_cast<uint32_t>(objects.size()) - first);
+        groups.emplace_back(InstanceGroup{ first, count });
+        first += count;
+    }
+
+    std::pmr::vector<uint32_t> slots;
+    const auto layout = placeObjectConstants(groups, slots);
+    std::vector<std::byte> block(layout.mSize);
+    packObjectConstants(view, worlds, worldInvs, objects, groups, slots, block);
+
+    for (size_t groupID = 0; groupID != groups.size(); ++groupID) {
+        const auto& group = groups[groupID];
+        const auto* pView = block.data() + getObjectConstantOffset(slots[groupID]);
+        for (uint32_t instanceID = 0; instanceID != group.mCount; ++instanceID) {
+            const auto objectID = objects[group.mFirst + instanceID];
+            const Matrix4f worldView = view * worlds[objectID].mTransform.matrix();
+            EXPECT_EQ(memcmp(getArray(pView, 0, instanceID), worldView.data(), sizeof(Matrix4f)), 0);
+            EXPECT_EQ(memcmp(getArray(pView, 1, instanceID),
+                worldInvs[objectID].mTransform.matrix().data(), sizeof(Matrix4f)), 0);
+        }
+    }
+}
@@ -0,0 +1,187 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SRenderGraphAliasing.h>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Star::Graphics::Render;
+
+namespace {
+
+constexpr uint64_t sPlacementAlignment = 64 << 10;
+constexpr uint64_t sMSAAPlacementAlignment = 4 << 20;
+
+TransientResourceDesc makeDesc(uint32_t begin, uint32_t end, uint64_t size,
+    uint64_t alignment = sPlacementAlignment
+) {
+    return TransientResourceDesc{ begin, end, size, alignment };
+}
+
+std::vector<uint64_t> place(const std::vector<TransientResourceDesc>& resources, uint64_t& heapSize) {
+    std::vector<uint64_t> offsets(resources.size(), ~0ull);
+    heapSize = placeTransientResources(resources, offsets);
+    return offsets;
+}
+
+// every resource in an allocation of its own, sizes round up to the alignment
+uint64_t getDedicatedSize(const std::vector<TransientResourceDesc>& resources) {
+    uint64_t size = 0;
+    for (const auto& r : resources) {
+        size += boost::alignment::align_up(r.mSize, r.mAlignment);
+    }
+    return size;
+}
+
+// no placement can be smaller than the bytes alive in the busiest pass
+uint64_t getPeakLiveSize(const std::vector<TransientResourceDesc>& resources) {
+    uint64_t peak = 0;
+    for (const auto& pass : resources) {
+        uint64_t live = 0;
+        for (const auto& r : resources) {
+            if (r.mLifetimeBegin <= pass.mLifetimeBegin && pass.mLifetimeBegin <= r.mLifetimeEnd) {
+                live += r.mSize;
+            }
+        }
+        peak = std::max(peak, live);
+    }
+    return peak;
+}
+
+void expectValidPlacement(const std::vector<TransientResourceDesc>& resources,
+    const std::vector<uint64_t>& offsets, uint64_t heapSize
+) {
+    for (size_t i = 0; i != resources.size(); ++i) {
+        const auto& r = resources[i];
+        EXPECT_EQ(offsets[i] % r.mAlignment, 0u) << i;
+        EXPECT_LE(offsets[i] + r.mSize, heapSize) << i;
+        for (size_t j = i + 1; j != resources.size(); ++j) {
+            if (!overlaps(r, resources[j]))
+                continue;
+            const bool disjoint = offsets[i] + r.mSize <= offsets[j] ||
+                offsets[j] + resources[j].mSize <= offsets[i];
+            EXPECT_TRUE(disjoint) << "resources " << i << " and " << j << " are alive together";
+        }
+    }
+}
+
+}
+
+TEST(TransientPlacement, PlacesNothing) {
+    uint64_t heapSize = 1;
+    EXPECT_TRUE(place({}, heapSize).empty());
+    EXPECT_EQ(heapSize, 0u);
+}
+
+TEST(TransientPlacement, SharesMemoryBetweenDisjointLifetimes) {
+    const std::vector<TransientResourceDesc> resources = {
+        makeDesc(0, 1, 8 << 20),
+        makeDesc(2, 3, 8 << 20),
+        makeDesc(4, 6, 4 << 20),
+    };
+    uint64_t heapSize = 0;
+    const auto offsets = place(resources, heapSize);
+    EXPECT_EQ(offsets, (std::vector<uint64_t>{ 0, 0, 0 }));
+    EXPECT_EQ(heapSize, 8u << 20);
+}
+
+TEST(TransientPlacement, KeepsOverlappingLifetimesApart) {
+    // lifetimes are inclusive, ending and starting in the same pass overlaps
+    const std::vector<TransientResourceDesc> resources = {
+        makeDesc(0, 2, 8 << 20),
+        makeDesc(2, 3, 8 << 20),
+        makeDesc(1, 1, 1000),
+    };
+    uint64_t heapSize = 0;
+    const auto offsets = place(resources, heapSize);
+    expectValidPlacement(resources, offsets, heapSize);
+    EXPECT_EQ(offsets[0], 0u);
+    EXPECT_EQ(offsets[1], 8u << 20);
+    // the small target only overlaps the first one, it takes the memory of the second
+    EXPECT_EQ(offsets[2], 8u << 20);
+    EXPECT_EQ(heapSize, 16u << 20);
+}
+
+TEST(TransientPlacement, FillsGapsBetweenLiveResources) {
+    // c and b hold both sides of the gap a leaves in pass 1, d fits in between
+    const std::vector<TransientResourceDesc> resources = {
+        makeDesc(0, 0, 4 << 20),
+        makeDesc(0, 3, 3 << 20),
+        makeDesc(1, 3, 2 << 20),
+        makeDesc(1, 1, 2 << 20),
+    };
+    uint64_t heapSize = 0;
+    const auto offsets = place(resources, heapSize);
+    expectValidPlacement(resources, offsets, heapSize);
+    EXPECT_EQ(offsets, (std::vector<uint64_t>{ 0, 4 << 20, 0, 2 << 20 }));
+    EXPECT_EQ(heapSize, 7u << 20);
+}
+
+TEST(TransientPlacement, RespectsAlignment) {
+    // larger alignments are placed first, the msaa target starts the heap
+    const std::vector<TransientResourceDesc> resources = {
+        makeDesc(0, 4, 64 << 10),
+        makeDesc(0, 4, 16 << 20, sMSAAPlacementAlignment),
+        makeDesc(0, 4, 100 << 10),
+    };
+    uint64_t heapSize = 0;
+    const auto offsets = place(resources, heapSize);
+    expectValidPlacement(resources, offsets, heapSize);
+    EXPECT_EQ(offsets[1], 0u);
+    EXPECT_EQ(offsets[2], 16u << 20);
+    // 100 KB take two 64 KB pages
+    EXPECT_EQ(offsets[0], (16u << 20) + (128u << 10));
+    EXPECT_EQ(heapSize, (16u << 20) + (192u << 10));
+}
+
+TEST(TransientPlacement, DoesNotPadForLargerAlignments) {
+    // placed by size alone, the 4 MB aligned target would start at 8 MB
+    const std::vector<TransientResourceDesc> resources = {
+        makeDesc(0, 1, (4 << 20) + (64 << 10)),
+        makeDesc(1, 2, 4 << 20, sMSAAPlacementAlignment),
+    };
+    uint64_t heapSize = 0;
+    const auto offsets = place(resources, heapSize);
+    expectValidPlacement(resources, offsets, heapSize);
+    EXPECT_EQ(offsets, (std::vector<uint64_t>{ 4 << 20, 0 }));
+    EXPECT_EQ(heapSize, getDedicatedSize(resources));
+}
+
+TEST(TransientPlacement, NeverExceedsTheDedicatedSize) {
+    std::mt19937 rng(11);
+    for (int trial = 0; trial != 200; ++trial) {
+        const uint32_t passCount = 1 + rng() % 16;
+        std::vector<TransientResourceDesc> resources(1 + rng() % 24);
+        for (auto& r : resources) {
+            const uint32_t a = rng() % passCount;
+            const uint32_t b = rng() % passCount;
+            r.mLifetimeBegin = std::min(a, b);
+            r.mLifetimeEnd = std::max(a, b);
+            r.mAlignment = rng() % 8 ? sPlacementAlignment : sMSAAPlacementAlignment;
+            r.mSize = (1 + rng() % 256) * (16 << 10);
+        }
+
+        uint64_t heapSize = 0;
+        const auto offsets = place(resources, heapSize);
+        expectValidPlacement(resources, offsets, heapSize);
+        EXPECT_LE(heapSize, getDedicatedSize(resources)) << "trial " << trial;
+        EXPECT_GE(heapSize, getPeakLiveSize(resources)) << "trial " << trial;
+        if (::testing::Test::HasFailure())
+            break;
+    }
+}
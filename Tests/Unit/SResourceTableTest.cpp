@@ -0,0 +1,135 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Core/SResourceTable.h>
+#include <gtest/gtest.h>
+
+using namespace Star;
+using namespace Star::Core;
+
+namespace {
+
+MetaID makeMetaID(uint64_t i) noexcept {
+    MetaID id{};
+    for (size_t k = 0; k != sizeof(i); ++k) {
+        id.data[k] = static_cast<uint8_t>(i >> (k * 8));
+    }
+    return id;
+}
+
+}
+
+TEST(ResourceTable, FindsInsertedResources) {
+    ResourceTable table(64);
+    EXPECT_EQ(table.find(makeMetaID(1)), nullptr);
+
+    auto& a = table.try_emplace(makeMetaID(1), Mesh);
+    auto& b = table.try_emplace(makeMetaID(2), Texture);
+    EXPECT_NE(&a, &b);
+    EXPECT_EQ(&table.try_emplace(makeMetaID(1), Mesh), &a);
+    EXPECT_EQ(table.find(makeMetaID(2)), &b);
+    EXPECT_EQ(b.metaID(), makeMetaID(2));
+    EXPECT_EQ(table.size(), 2u);
+}
+
+TEST(ResourceTable, GrowsPastCapacity) {
+    ResourceTable table(16);
+    std::vector<Resource*> resources;
+    for (uint64_t i = 0; i != 4096; ++i) {
+        resources.emplace_back(&table.try_emplace(makeMetaID(i), Mesh));
+    }
+    EXPECT_EQ(table.size(), 4096u);
+    for (uint64_t i = 0; i != 4096; ++i) {
+        EXPECT_EQ(table.find(makeMetaID(i)), resources[i]);
+    }
+}
+
+TEST(ResourceTable, BatchedEmplaceDeduplicates) {
+    ResourceTable table(64);
+    auto& existing = table.try_emplace(makeMetaID(3), Material);
+
+    std::vector<MetaID> ids{ makeMetaID(1), makeMetaID(3), makeMetaID(1), makeMetaID(2) };
+    std::vector<ResourceType> tags{ Mesh, Material, Mesh, Texture };
+    std::vector<Resource*> resources(ids.size());
+    table.try_emplace(ids, tags, resources);
+
+    EXPECT_EQ(resources[1], &existing);
+    EXPECT_EQ(resources[0], resources[2]);
+    EXPECT_NE(resources[0], resources[3]);
+    EXPECT_EQ(table.size(), 3u);
+    for (size_t i = 0; i != ids.size(); ++i) {
+        EXPECT_EQ(table.find(ids[i]), resources[i]);
+    }
+}
+
+TEST(ResourceTable, ConcurrentInsertAndFind) {
+    // threads race on overlapping ids, every id must resolve to one resource
+    constexpr uint64_t idCount = 20000;
+    constexpr int threadCount = 16;
+    ResourceTable table(1024);
+    std::vector<std::vector<Resource*>> seen(threadCount, std::vector<Resource*>(idCount));
+    std::atomic_int missing = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            std::vector<MetaID> batch;
+            std::vector<ResourceType> tags;
+            std::vector<Resource*> resources;
+            for (uint64_t k = 0; k != idCount; ++k) {
+                // each thread walks the ids in its own order
+                const uint64_t i = (k * 7919 + t * 104729) % idCount;
+                if (t % 2) {
+                    seen[t][i] = &table.try_emplace(makeMetaID(i), Mesh);
+                } else {
+                    batch.emplace_back(makeMetaID(i));
+                    tags.emplace_back(Mesh);
+                    if (batch.size() == 64 || k + 1 == idCount) {
+                        resources.resize(batch.size());
+                        table.try_emplace(batch, tags, resources);
+                        for (size_t j = 0; j != batch.size(); ++j) {
+                            const uint64_t id = ((k + 1 - batch.size() + j) * 7919 + t * 104729) % idCount;
+                            seen[t][id] = resources[j];
+                        }
+                        batch.clear();
+                        tags.clear();
+                    }
+                }
+                // lock-free readers run against concurrent inserts
+                const uint64_t probe = (i * 31) % idCount;
+                auto ptr = table.find(makeMetaID(probe));
+                if (ptr && ptr->metaID() != makeMetaID(probe)) {
+                    ++missing;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(missing.load(), 0);
+    EXPECT_EQ(table.size(), idCount);
+    for (uint64_t i = 0; i != idCount; ++i) {
+        auto ptr = table.find(makeMetaID(i));
+        ASSERT_NE(ptr, nullptr);
+        for (int t = 0; t != threadCount; ++t) {
+            EXPECT_EQ(seen[t][i], ptr) << "id " << i << ", thread " << t;
+        }
+    }
+}
@@ -0,0 +1,361 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "SFakeProducer.h"
+#include <random>
+
+using namespace Star;
+using namespace Star::Core;
+using namespace Star::Core::Test;
+
+namespace {
+
+// drives the workflow one step at a time, every row of the ControlBlock transition table
+// is taken by at least one test
+class ControlBlockTest : public ManagerTest {
+protected:
+    static bool cancelled(const Resource* pResource) {
+        return pResource->mCancelled.load();
+    }
+
+    // until the resource is loading
+    void start() {
+        Workflow::processEvents();
+        Workflow::loadResources();
+    }
+
+    // delivers what the producers finished
+    void deliver() {
+        for (auto& pProducer : mProducers) {
+            pProducer->tick();
+        }
+        Workflow::processEvents();
+        Workflow::updateResources();
+    }
+};
+
+}
+
+// Unloaded -> Queued
+TEST_F(ControlBlockTest, AcquireQueues) {
+    auto& producer = addProducer(Mesh);
+    auto a = acquire(0, Mesh);
+    EXPECT_EQ(getState(a), State::Unloaded);
+    Workflow::processEvents();
+    EXPECT_EQ(getState(a), State::Queued);
+    EXPECT_TRUE(producer.mLoaded.empty());
+}
+
+// Queued -> Unloaded, the load never starts
+TEST_F(ControlBlockTest, ReleaseWhileQueued) {
+    auto& producer = addProducer(Mesh);
+    auto a = acquire(0, Mesh);
+    Workflow::processEvents();
+    a->release();
+    Workflow::processEvents();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    Workflow::loadResources();
+    frame();
+    EXPECT_TRUE(producer.mLoaded.empty());
+    EXPECT_TRUE(producer.mDestroyed.empty());
+}
+
+// Queued -> Loading
+TEST_F(ControlBlockTest, StartLoading) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 2;
+    auto a = acquire(0, Mesh);
+    start();
+    EXPECT_EQ(getState(a), State::Loading);
+    EXPECT_EQ(producer.inFlight(), 1u);
+}
+
+// Queued stays Queued when the producer is busy
+TEST_F(ControlBlockTest, BusyProducerKeepsQueued) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 2;
+    producer.mMaxInFlight = 1;
+    auto a = acquire(0, Mesh, 1);
+    auto b = acquire(1, Mesh, 0);
+    start();
+    EXPECT_EQ(getState(a), State::Loading);
+    EXPECT_EQ(getState(b), State::Queued);
+}
+
+// Loading -> Loaded
+TEST_F(ControlBlockTest, LoadCompletes) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 1;
+    producer.mDefaultSize = 10;
+    auto a = acquire(0, Mesh);
+    start();
+    deliver();
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_NE(a->mPointer.load(), nullptr);
+    EXPECT_EQ(producer.live(), 1u);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 10u);
+}
+
+// Loading -> Cancelling, the token is set for the producer
+TEST_F(ControlBlockTest, ReleaseWhileLoading) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 3;
+    auto a = acquire(0, Mesh);
+    start();
+    a->release();
+    Workflow::processEvents();
+    EXPECT_EQ(getState(a), State::Cancelling);
+    EXPECT_TRUE(cancelled(a));
+}
+
+// Cancelling -> Loading, the token is reset and the load goes on
+TEST_F(ControlBlockTest, ReacquireWhileCancelling) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 3;
+    auto a = acquire(0, Mesh);
+    start();
+    a->release();
+    Workflow::processEvents();
+    a->async_acquire();
+    Workflow::processEvents();
+    EXPECT_EQ(getState(a), State::Loading);
+    EXPECT_FALSE(cancelled(a));
+    frame();
+    frame();
+    frame();
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(producer.mLoaded.size(), 1u);
+    EXPECT_EQ(producer.live(), 1u);
+}
+
+// Cancelling -> Unloaded, the producer finished anyway and its payload is destroyed
+TEST_F(ControlBlockTest, CompletedWhileCancelling) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 1;
+    producer.mDefaultSize = 10;
+    auto a = acquire(0, Mesh);
+    start();
+    a->release();
+    deliver();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_FALSE(cancelled(a));
+    EXPECT_EQ(a->mPointer.load(), nullptr);
+    EXPECT_EQ(producer.mDestroyed, std::vector<MetaID>{ makeMetaID(0) });
+    EXPECT_EQ(producer.live(), 0u);
+    EXPECT_EQ(producer.inFlight(), 0u);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 0u);
+}
+
+// Cancelling -> Unloaded, the producer gave up on the token
+TEST_F(ControlBlockTest, AbandonedWhileCancelling) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 2;
+    producer.mAbandonOnCancel = true;
+    auto a = acquire(0, Mesh);
+    start();
+    a->release();
+    frame();
+    frame();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_FALSE(cancelled(a));
+    EXPECT_EQ(producer.mDestroyed, std::vector<MetaID>{ makeMetaID(0) });
+    EXPECT_EQ(producer.live(), 0u);
+    EXPECT_EQ(producer.inFlight(), 0u);
+}
+
+// Loading -> Queued, the producer gave up on the token but the resource was acquired again
+TEST_F(ControlBlockTest, AbandonedAfterReacquireRestarts) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 3;
+    producer.mAbandonOnCancel = true;
+    auto a = acquire(0, Mesh);
+    start();
+    a->release();
+    Workflow::processEvents();
+    producer.tick(); // sees the token
+    a->async_acquire();
+    Workflow::processEvents();
+    EXPECT_EQ(getState(a), State::Loading);
+    producer.tick();
+    deliver(); // abandoned
+    EXPECT_EQ(getState(a), State::Queued);
+    EXPECT_EQ(producer.inFlight(), 0u);
+    EXPECT_EQ(producer.live(), 0u);
+
+    for (int f = 0; f != 4; ++f) {
+        frame();
+    }
+    EXPECT_EQ(getState(a), State::Loaded);
+    EXPECT_EQ(producer.mLoaded.size(), 2u);
+    EXPECT_EQ(producer.live(), 1u);
+}
+
+// Loading -> Unloaded, failed
+TEST_F(ControlBlockTest, LoadFails) {
+    auto& producer = addProducer(Mesh);
+    producer.mLatencyFrames = 1;
+    producer.mFailures = { makeMetaID(0) };
+    auto a = acquire(0, Mesh);
+    start();
+    deliver();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_TRUE(a->mFailed.load());
+    EXPECT_EQ(producer.inFlight(), 0u);
+    EXPECT_EQ(producer.live(), 0u);
+
+    // stays unloaded while it is used
+    frame();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_EQ(producer.mLoaded.size(), 1u);
+}
+
+// Loaded -> Unloaded
+TEST_F(ControlBlockTest, ReleaseLoaded) {
+    auto& producer = addProducer(Mesh);
+    producer.mDefaultSize = 10;
+    auto a = acquire(0, Mesh);
+    frame();
+    EXPECT_EQ(getState(a), State::Loaded);
+    a->release();
+    Workflow::processEvents();
+    EXPECT_EQ(getState(a), State::Unloaded);
+    EXPECT_EQ(a->mPointer.load(), nullptr);
+    EXPECT_EQ(producer.live(), 0u);
+    EXPECT_EQ(Workflow::getUsage(Mesh), 0u);
+}
+
+namespace {
+
+// one loader, a long load keeps the next ones waiting in the pool
+class ControlBlockLoaderTest : public ControlBlockTest {
+protected:
+    size_t loaderCount() const noexcept override {
+        return 1;
+    }
+
+    static bool contains(const std::vector<MetaID>& ids, uint64_t i) {
+        return std::find(ids.begin(), ids.end(), makeMetaID(i)) != ids.end();
+    }
+};
+
+}
+
+// released while waiting for a loader, the producer never sees it
+TEST_F(ControlBlockLoaderTest, CancelledBeforeLoadStarts) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTimes = { { makeMetaID(0), std::chrono::milliseconds(100) } };
+
+    auto a = acquire(0, Mesh);
+    ASSERT_TRUE(frameUntil([&] { return producer.started().size() == 1; }));
+    auto b = acquire(1, Mesh);
+    frame(); // posted behind a
+    b->release();
+    frame();
+    EXPECT_EQ(getState(b), State::Cancelling);
+
+    ASSERT_TRUE(frameUntil([&] {
+        return getState(a) == State::Loaded && getState(b) == State::Unloaded;
+    }));
+    EXPECT_FALSE(contains(producer.started(), 1));
+    EXPECT_FALSE(contains(producer.mDestroyed, 1));
+    EXPECT_EQ(producer.inFlight(), 0u);
+    EXPECT_EQ(producer.live(), 1u);
+}
+
+// acquired again before the loader got to it, the load runs normally
+TEST_F(ControlBlockLoaderTest, ReacquiredBeforeLoadStarts) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTimes = { { makeMetaID(0), std::chrono::milliseconds(100) } };
+
+    auto a = acquire(0, Mesh);
+    ASSERT_TRUE(frameUntil([&] { return producer.started().size() == 1; }));
+    auto b = acquire(1, Mesh);
+    frame();
+    b->release();
+    frame();
+    b->async_acquire();
+    frame();
+    EXPECT_EQ(getState(b), State::Loading);
+
+    ASSERT_TRUE(frameUntil([&] {
+        return getState(a) == State::Loaded && getState(b) == State::Loaded;
+    }));
+    EXPECT_TRUE(contains(producer.started(), 1));
+    EXPECT_EQ(producer.live(), 2u);
+}
+
+// dropped by the loader, then acquired again before the drop was handled, the load restarts
+// without the producer being told about the dropped one
+TEST_F(ControlBlockLoaderTest, DroppedThenReacquiredRestarts) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTimes = { { makeMetaID(0), std::chrono::milliseconds(50) } };
+
+    auto a = acquire(0, Mesh);
+    ASSERT_TRUE(frameUntil([&] { return producer.started().size() == 1; }));
+    auto b = acquire(1, Mesh);
+    frame();
+    b->release();
+    frame();
+    // no frames, a finishes and the loader drops b
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    b->async_acquire();
+    Workflow::processEvents();
+    EXPECT_EQ(getState(b), State::Loading);
+    Workflow::updateResources();
+    EXPECT_EQ(getState(b), State::Queued);
+    EXPECT_FALSE(contains(producer.started(), 1));
+
+    ASSERT_TRUE(frameUntil([&] {
+        return getState(a) == State::Loaded && getState(b) == State::Loaded;
+    }));
+    EXPECT_EQ(producer.started().size(), 2u);
+    EXPECT_EQ(producer.live(), 2u);
+}
+
+// released and acquired at random while loads run on the pool
+TEST_F(ControlBlockLoaderTest, Thrash) {
+    auto& producer = addProducer(Mesh, true);
+    producer.mLoadTime = std::chrono::microseconds(200);
+    std::mt19937 rng(3);
+
+    constexpr uint64_t count = 16;
+    std::vector<const Resource*> resources;
+    std::vector<bool> held(count, true);
+    for (uint64_t i = 0; i != count; ++i) {
+        resources.emplace_back(acquire(i, Mesh));
+    }
+    for (int f = 0; f != 200; ++f) {
+        const auto i = rng() % count;
+        if (held[i]) {
+            resources[i]->release();
+        } else {
+            resources[i]->async_acquire();
+        }
+        held[i] = !held[i];
+        frame();
+    }
+    ASSERT_TRUE(frameUntil([&] {
+        for (uint64_t i = 0; i != count; ++i) {
+            if (getState(resources[i]) != (held[i] ? State::Loaded : State::Unloaded))
+                return false;
+        }
+        return producer.inFlight() == 0;
+    }));
+    const auto heldCount = static_cast<size_t>(std::count(held.begin(), held.end(), true));
+    EXPECT_EQ(producer.live(), heldCount);
+}
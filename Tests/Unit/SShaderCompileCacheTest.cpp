@@ -0,0 +1,224 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <StarCompiler/ShaderWorks/SShaderCompileCache.h>
+#include <gtest/gtest.h>
+
+using namespace Star::Graphics::Render::Shader;
+
+namespace {
+
+ShaderCompileRequest makeRequest(std::string source, std::vector<std::string> keywords = {}) {
+    ShaderCompileRequest request;
+    request.mName = "test.hlsl";
+    request.mSource = std::move(source);
+    request.mTarget = "ps_5_0";
+    request.mKeywords = std::move(keywords);
+    return request;
+}
+
+class ShaderCompileCacheDisk : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        mFolder = std::filesystem::temp_directory_path() /
+            (std::string("star_shader_cache_") + info->name());
+        std::filesystem::remove_all(mFolder);
+    }
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(mFolder, ec);
+    }
+
+    std::vector<std::string> files(std::string_view extension) const {
+        std::vector<std::string> names;
+        for (const auto& file : std::filesystem::directory_iterator(mFolder)) {
+            if (file.path().extension() == extension) {
+                names.emplace_back(file.path().filename().string());
+            }
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    void setAge(std::string_view pattern, std::chrono::minutes age) const {
+        const auto time = std::filesystem::file_time_type::clock::now() - age;
+        for (const auto& file : std::filesystem::directory_iterator(mFolder)) {
+            if (file.path().filename().string().find(pattern) != std::string::npos) {
+                std::filesystem::last_write_time(file.path(), time);
+            }
+        }
+    }
+
+    std::filesystem::path mFolder;
+};
+
+}
+
+TEST(ShaderCompileCache, CountsHitsAndMisses) {
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, {}, 1);
+
+    auto first = cache.compile(makeRequest("float4 main() : SV_Target { return 0; }"));
+    EXPECT_TRUE(first.mSucceeded);
+    EXPECT_FALSE(first.mCacheHit);
+    EXPECT_FALSE(first.mBinary.empty());
+
+    auto second = cache.compile(makeRequest("float4 main() : SV_Target { return 0; }"));
+    EXPECT_TRUE(second.mSucceeded);
+    EXPECT_TRUE(second.mCacheHit);
+    EXPECT_EQ(second.mBinary, first.mBinary);
+
+    EXPECT_EQ(cache.missCount(), 1u);
+    EXPECT_EQ(cache.hitCount(), 1u);
+    EXPECT_EQ(compiler.compileCount(), 1u);
+
+    cache.clear();
+    EXPECT_FALSE(cache.compile(makeRequest("float4 main() : SV_Target { return 0; }")).mCacheHit);
+    EXPECT_EQ(compiler.compileCount(), 2u);
+}
+
+TEST(ShaderCompileCache, KeyIgnoresKeywordOrder) {
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, {}, 1);
+
+    cache.compile(makeRequest("source", { "FOG", "SHADOW" }));
+    EXPECT_TRUE(cache.compile(makeRequest("source", { "SHADOW", "FOG" })).mCacheHit);
+    EXPECT_EQ(compiler.compileCount(), 1u);
+
+    // a different keyword set is another variant
+    EXPECT_FALSE(cache.compile(makeRequest("source", { "FOG" })).mCacheHit);
+    EXPECT_EQ(compiler.compileCount(), 2u);
+}
+
+TEST(ShaderCompileCache, KeyIncludesFlagsTargetAndEntryPoint) {
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, {}, 1);
+    const auto base = makeRequest("source");
+    cache.compile(base);
+
+    auto flags = base;
+    flags.mFlags = 1;
+    EXPECT_FALSE(cache.compile(flags).mCacheHit);
+
+    auto target = base;
+    target.mTarget = "vs_5_0";
+    EXPECT_FALSE(cache.compile(target).mCacheHit);
+
+    auto entryPoint = base;
+    entryPoint.mEntryPoint = "vert";
+    EXPECT_FALSE(cache.compile(entryPoint).mCacheHit);
+
+    // the file name is not part of the output
+    auto name = base;
+    name.mName = "other.hlsl";
+    EXPECT_TRUE(cache.compile(name).mCacheHit);
+
+    EXPECT_EQ(compiler.compileCount(), 4u);
+    EXPECT_EQ(cache.missCount(), 4u);
+    EXPECT_EQ(cache.hitCount(), 1u);
+}
+
+TEST(ShaderCompileCache, CompilesDuplicatesInBatchOnce) {
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, {}, 4);
+
+    std::vector<ShaderCompileRequest> requests;
+    for (int i = 0; i != 64; ++i) {
+        requests.emplace_back(makeRequest("source " + std::to_string(i % 3)));
+    }
+    requests.emplace_back(makeRequest("")); // fails to preprocess
+    std::vector<ShaderCompileResult> results(requests.size());
+    cache.compile(requests, results);
+
+    EXPECT_EQ(compiler.compileCount(), 3u);
+    EXPECT_EQ(cache.missCount(), 3u);
+    EXPECT_EQ(cache.hitCount(), 61u);
+    for (int i = 0; i != 64; ++i) {
+        EXPECT_TRUE(results[i].mSucceeded);
+        EXPECT_EQ(results[i].mCacheHit, i >= 3);
+        EXPECT_EQ(results[i].mBinary, results[i % 3].mBinary);
+    }
+    EXPECT_NE(results[0].mBinary, results[1].mBinary);
+    EXPECT_FALSE(results.back().mSucceeded);
+    EXPECT_FALSE(results.back().mError.empty());
+}
+
+TEST_F(ShaderCompileCacheDisk, ReusesBinariesAcrossInstances) {
+    const auto request = makeRequest("source", { "FOG" });
+    std::pmr::string binary;
+    {
+        FakeShaderCompiler compiler;
+        ShaderCompileCache cache(compiler, mFolder, 1);
+        binary = cache.compile(request).mBinary;
+        EXPECT_EQ(compiler.compileCount(), 1u);
+    }
+    EXPECT_EQ(files(".cso").size(), 1u);
+    EXPECT_TRUE(files(".tmp").empty());
+
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, mFolder, 1);
+    auto result = cache.compile(request);
+    EXPECT_TRUE(result.mSucceeded);
+    EXPECT_TRUE(result.mCacheHit);
+    EXPECT_EQ(result.mBinary, binary);
+    EXPECT_EQ(compiler.compileCount(), 0u);
+    EXPECT_EQ(cache.hitCount(), 1u);
+}
+
+TEST_F(ShaderCompileCacheDisk, TrimsLeastRecentlyUsedBinaries) {
+    // sources of equal length, so every binary has the same size
+    const auto a = makeRequest("source a");
+    const auto b = makeRequest("source b");
+    const auto c = makeRequest("source c");
+    uint64_t binarySize = 0;
+    {
+        FakeShaderCompiler compiler;
+        ShaderCompileCache cache(compiler, mFolder, 1);
+        binarySize = cache.compile(a).mBinary.size();
+        cache.compile(b);
+    }
+    const auto initial = files(".cso");
+    ASSERT_EQ(initial.size(), 2u);
+    setAge("", std::chrono::minutes(30));
+
+    // a is read from disk, which makes it the most recently used
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, mFolder, 1, binarySize * 2);
+    EXPECT_TRUE(cache.compile(a).mCacheHit);
+    EXPECT_FALSE(cache.compile(c).mCacheHit);
+
+    const auto remaining = files(".cso");
+    ASSERT_EQ(remaining.size(), 2u);
+    cache.clear();
+    EXPECT_TRUE(cache.compile(a).mCacheHit);
+    EXPECT_TRUE(cache.compile(c).mCacheHit);
+    EXPECT_FALSE(cache.compile(b).mCacheHit);
+    EXPECT_EQ(compiler.compileCount(), 2u);
+}
+
+TEST_F(ShaderCompileCacheDisk, RemovesAbandonedTemporaryFiles) {
+    std::filesystem::create_directories(mFolder);
+    std::ofstream(mFolder / "old.cso.tmp") << "partial";
+    std::ofstream(mFolder / "new.cso.tmp") << "partial";
+    setAge("old", std::chrono::minutes(120));
+
+    FakeShaderCompiler compiler;
+    ShaderCompileCache cache(compiler, mFolder, 1);
+    EXPECT_EQ(files(".tmp"), (std::vector<std::string>{ "new.cso.tmp" }));
+}
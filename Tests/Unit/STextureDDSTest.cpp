@@ -0,0 +1,359 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <Star/Graphics/STextureDDS.h>
+#include <Star/Graphics/SRenderFormatTextureUtils.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace Star;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+constexpr uint32_t makeFourCC(char c0, char c1, char c2, char c3) noexcept {
+    return uint32_t(uint8_t(c0)) | (uint32_t(uint8_t(c1)) << 8) |
+        (uint32_t(uint8_t(c2)) << 16) | (uint32_t(uint8_t(c3)) << 24);
+}
+
+constexpr uint32_t sFourCCFlag = 0x4;
+constexpr uint32_t sVolumeFlag = 0x00800000;
+constexpr uint32_t sCubemapCaps = 0x200;
+
+// writes a dds file field by field, the way the specification lays it out,
+// so the test does not share the parser structs
+struct DDSFile {
+    uint32_t mMagic = makeFourCC('D', 'D', 'S', ' ');
+    uint32_t mHeaderSize = 124;
+    uint32_t mFlags = 0x1007; // caps, height, width, pixel format
+    uint32_t mHeight = 8;
+    uint32_t mWidth = 8;
+    uint32_t mMipMapCount = 1;
+    uint32_t mPixelFormatSize = 32;
+    uint32_t mPixelFormatFlags = sFourCCFlag;
+    uint32_t mFourCC = makeFourCC('D', 'X', 'T', '1');
+    uint32_t mCaps2 = 0;
+
+    // written when mFourCC is DX10
+    uint32_t mDXGIFormat = 0;
+    uint32_t mResourceDimension = 3;
+    uint32_t mMiscFlag = 0;
+    uint32_t mArraySize = 1;
+
+    std::string mData;
+
+    std::string str() const {
+        std::string s;
+        auto put = [&s](uint32_t value) {
+            s.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        put(mMagic);
+        put(mHeaderSize);
+        put(mFlags);
+        put(mHeight);
+        put(mWidth);
+        put(0); // pitch or linear size
+        put(0); // depth
+        put(mMipMapCount);
+        for (int i = 0; i != 11; ++i) {
+            put(0);
+        }
+        put(mPixelFormatSize);
+        put(mPixelFormatFlags);
+        put(mFourCC);
+        for (int i = 0; i != 5; ++i) {
+            put(0); // bit count and masks
+        }
+        put(0x1000); // caps texture
+        put(mCaps2);
+        put(0);
+        put(0);
+        put(0);
+        if (mFourCC == makeFourCC('D', 'X', '1', '0')) {
+            put(mDXGIFormat);
+            put(mResourceDimension);
+            put(mMiscFlag);
+            put(mArraySize);
+            put(0);
+        }
+        return s + mData;
+    }
+
+    void setDX10(uint32_t dxgiFormat) {
+        mFourCC = makeFourCC('D', 'X', '1', '0');
+        mDXGIFormat = dxgiFormat;
+    }
+
+    // mip k is filled with byte k + 1, sizes follow the file layout without upload padding
+    void fillMips(Format format) {
+        auto width = mWidth;
+        auto height = mHeight;
+        mData.clear();
+        for (uint32_t k = 0; k != mMipMapCount; ++k) {
+            auto info = getMipInfo(format, width, height);
+            mData.append(static_cast<size_t>(info.mSliceSize), static_cast<char>(k + 1));
+            width = half_size(width);
+            height = half_size(height);
+        }
+    }
+};
+
+struct DDSHeader {
+    RESOURCE_DESC mDesc;
+    Format mFormat;
+};
+
+DDSHeader readHeader(const DDSFile& file, bool bSrgb = false) {
+    TextureData tex(std::pmr::get_default_resource());
+    std::istringstream is(file.str());
+    readDDSHeader(is, tex, bSrgb);
+    return { tex.mDesc, tex.mFormat };
+}
+
+void expectHeaderThrows(const DDSFile& file, const char* message) {
+    TextureData tex(std::pmr::get_default_resource());
+    std::istringstream is(file.str());
+    try {
+        readDDSHeader(is, tex, false);
+        ADD_FAILURE() << "expected: " << message;
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), message);
+    }
+}
+
+}
+
+TEST(STextureDDSTest, LegacyFourCC) {
+    struct Case {
+        uint32_t mFourCC;
+        Format mTypeless;
+        Format mView;
+        Format mSrgbView;
+    };
+    const Case cases[] = {
+        { makeFourCC('D', 'X', 'T', '1'), Format::BC1_TYPELESS_BLOCK, Format::BC1_UNORM_BLOCK, Format::BC1_SRGB_BLOCK },
+        { makeFourCC('D', 'X', 'T', '3'), Format::BC2_TYPELESS_BLOCK, Format::BC2_UNORM_BLOCK, Format::BC2_SRGB_BLOCK },
+        { makeFourCC('D', 'X', 'T', '5'), Format::BC3_TYPELESS_BLOCK, Format::BC3_UNORM_BLOCK, Format::BC3_SRGB_BLOCK },
+        // bc4 and bc5 have no srgb view
+        { makeFourCC('A', 'T', 'I', '1'), Format::BC4_TYPELESS_BLOCK, Format::BC4_UNORM_BLOCK, Format::BC4_UNORM_BLOCK },
+        { makeFourCC('B', 'C', '4', 'U'), Format::BC4_TYPELESS_BLOCK, Format::BC4_UNORM_BLOCK, Format::BC4_UNORM_BLOCK },
+        { makeFourCC('A', 'T', 'I', '2'), Format::BC5_TYPELESS_BLOCK, Format::BC5_UNORM_BLOCK, Format::BC5_UNORM_BLOCK },
+        { makeFourCC('B', 'C', '5', 'U'), Format::BC5_TYPELESS_BLOCK, Format::BC5_UNORM_BLOCK, Format::BC5_UNORM_BLOCK },
+    };
+    for (const auto& c : cases) {
+        DDSFile file;
+        file.mFourCC = c.mFourCC;
+        file.mWidth = 64;
+        file.mHeight = 32;
+        file.mMipMapCount = 7;
+
+        auto tex = readHeader(file);
+        EXPECT_EQ(tex.mDesc.mFormat, c.mTypeless);
+        EXPECT_EQ(tex.mFormat, c.mView);
+        EXPECT_EQ(tex.mDesc.mDimension, RESOURCE_DIMENSION_TEXTURE2D);
+        EXPECT_EQ(tex.mDesc.mWidth, 64u);
+        EXPECT_EQ(tex.mDesc.mHeight, 32u);
+        EXPECT_EQ(tex.mDesc.mDepthOrArraySize, 1u);
+        EXPECT_EQ(tex.mDesc.mMipLevels, 7u);
+
+        EXPECT_EQ(readHeader(file, true).mFormat, c.mSrgbView);
+    }
+}
+
+TEST(STextureDDSTest, DX10Header) {
+    DDSFile file;
+
+    // the importer writes unorm, the colorspace comes from the asset
+    file.setDX10(98); // BC7_UNORM
+    EXPECT_EQ(readHeader(file).mDesc.mFormat, Format::BC7_TYPELESS_BLOCK);
+    EXPECT_EQ(readHeader(file).mFormat, Format::BC7_UNORM_BLOCK);
+    EXPECT_EQ(readHeader(file, true).mFormat, Format::BC7_SRGB_BLOCK);
+
+    file.setDX10(97); // BC7_TYPELESS
+    EXPECT_EQ(readHeader(file, true).mFormat, Format::BC7_SRGB_BLOCK);
+
+    // explicit srgb and snorm formats are kept
+    file.setDX10(72); // BC1_SRGB
+    EXPECT_EQ(readHeader(file).mFormat, Format::BC1_SRGB_BLOCK);
+    file.setDX10(81); // BC4_SNORM
+    EXPECT_EQ(readHeader(file).mDesc.mFormat, Format::BC4_TYPELESS_BLOCK);
+    EXPECT_EQ(readHeader(file, true).mFormat, Format::BC4_SNORM_BLOCK);
+    file.setDX10(84); // BC5_SNORM
+    EXPECT_EQ(readHeader(file).mFormat, Format::BC5_SNORM_BLOCK);
+
+    // no unorm view, falls back to ufloat
+    file.setDX10(94); // BC6H_TYPELESS
+    EXPECT_EQ(readHeader(file).mFormat, Format::BC6H_UFLOAT_BLOCK);
+    file.setDX10(96); // BC6H_SFLOAT
+    EXPECT_EQ(readHeader(file).mFormat, Format::BC6H_SFLOAT_BLOCK);
+}
+
+TEST(STextureDDSTest, MissingMipCountIsOneLevel) {
+    DDSFile file;
+    file.mMipMapCount = 0;
+    EXPECT_EQ(readHeader(file).mDesc.mMipLevels, 1u);
+}
+
+TEST(STextureDDSTest, InvalidHeaders) {
+    {
+        DDSFile file;
+        file.mMagic = makeFourCC('D', 'D', 'S', 'X');
+        expectHeaderThrows(file, "dds magic not found");
+    }
+    {
+        DDSFile file;
+        file.mHeaderSize = 120;
+        expectHeaderThrows(file, "dds header size invalid");
+    }
+    {
+        DDSFile file;
+        file.mPixelFormatSize = 24;
+        expectHeaderThrows(file, "dds header size invalid");
+    }
+    {
+        DDSFile file;
+        file.mPixelFormatFlags = 0x41; // rgb, alpha pixels
+        expectHeaderThrows(file, "dds uncompressed format not supported");
+    }
+    {
+        DDSFile file;
+        file.mFlags |= sVolumeFlag;
+        expectHeaderThrows(file, "dds volume and cubemap not supported");
+    }
+    {
+        DDSFile file;
+        file.mCaps2 = sCubemapCaps | 0xfc00;
+        expectHeaderThrows(file, "dds volume and cubemap not supported");
+    }
+    {
+        DDSFile file;
+        file.mFourCC = makeFourCC('R', 'X', 'G', 'B');
+        expectHeaderThrows(file, "dds format not supported");
+    }
+    {
+        DDSFile file;
+        file.setDX10(28); // R8G8B8A8_UNORM
+        expectHeaderThrows(file, "dds format not supported");
+    }
+    {
+        DDSFile file;
+        file.setDX10(71);
+        file.mArraySize = 6;
+        expectHeaderThrows(file, "dds texture array not supported");
+    }
+    {
+        DDSFile file;
+        file.setDX10(71);
+        file.mMiscFlag = 0x4; // texture cube
+        expectHeaderThrows(file, "dds texture array not supported");
+    }
+    {
+        DDSFile file;
+        file.setDX10(71);
+        file.mResourceDimension = 4; // texture 3d
+        expectHeaderThrows(file, "dds texture array not supported");
+    }
+    {
+        DDSFile file;
+        file.mWidth = 0;
+        expectHeaderThrows(file, "dds texture size invalid");
+    }
+}
+
+TEST(STextureDDSTest, TruncatedHeader) {
+    DDSFile file;
+    auto bytes = file.str();
+    for (size_t size : { size_t(2), size_t(4), size_t(64), bytes.size() - 1 }) {
+        SCOPED_TRACE(size);
+        TextureData tex(std::pmr::get_default_resource());
+        std::istringstream is(bytes.substr(0, size));
+        EXPECT_THROW(readDDSHeader(is, tex, false), std::runtime_error);
+    }
+
+    file.setDX10(71);
+    bytes = file.str();
+    TextureData tex(std::pmr::get_default_resource());
+    std::istringstream is(bytes.substr(0, bytes.size() - 1));
+    EXPECT_THROW(readDDSHeader(is, tex, false), std::runtime_error);
+}
+
+// each mip lands at its upload slice offset, rows at the upload row pitch
+TEST(STextureDDSTest, MipsUseUploadLayout) {
+    for (auto [width, height] : { std::pair{ 64u, 64u }, std::pair{ 256u, 8u }, std::pair{ 12u, 40u } }) {
+        SCOPED_TRACE(testing::Message() << width << "x" << height);
+        DDSFile file;
+        file.mWidth = width;
+        file.mHeight = height;
+        file.mMipMapCount = mip_count(width, height);
+        file.setDX10(71);
+        file.fillMips(Format::BC1_TYPELESS_BLOCK);
+
+        TextureData tex(std::pmr::get_default_resource());
+        std::istringstream is(file.str());
+        readDDS(is, tex, false);
+        ASSERT_EQ(tex.mDesc.mMipLevels, file.mMipMapCount);
+        EXPECT_EQ(tex.mBuffer.size(),
+            boost::alignment::align_up(getTextureUploadSize(tex.mDesc.mFormat, width, height), 16));
+
+        size_t sliceOffset = 0;
+        uint32_t w = width;
+        uint32_t h = height;
+        for (uint32_t k = 0; k != tex.mDesc.mMipLevels; ++k) {
+            auto info = getMipInfo(tex.mDesc.mFormat, w, h);
+            for (uint32_t row = 0; row != info.mRowCount; ++row) {
+                const auto* p = tex.mBuffer.data() + sliceOffset + size_t(row) * info.mUploadRowPitchSize;
+                for (uint32_t i = 0; i != info.mRowPitchSize; ++i) {
+                    ASSERT_EQ(static_cast<int>(p[i]), static_cast<int>(k + 1)) << "mip " << k << " row " << row;
+                }
+            }
+            sliceOffset += info.mUploadSliceSize;
+            w = half_size(w);
+            h = half_size(h);
+        }
+    }
+}
+
+TEST(STextureDDSTest, TruncatedMips) {
+    DDSFile file;
+    file.mWidth = 32;
+    file.mHeight = 32;
+    file.mMipMapCount = 6;
+    file.fillMips(Format::BC1_TYPELESS_BLOCK);
+    file.mData.pop_back();
+
+    TextureData tex(std::pmr::get_default_resource());
+    std::istringstream is(file.str());
+    EXPECT_THROW(readDDS(is, tex, false), std::runtime_error);
+}
+
+// mipMapCount comes from the file and must not write past the upload buffer
+TEST(STextureDDSTest, MipCountBeyondChain) {
+    DDSFile file;
+    file.mWidth = 16;
+    file.mHeight = 16;
+    file.mMipMapCount = 12;
+    file.fillMips(Format::BC1_TYPELESS_BLOCK);
+
+    TextureData tex(std::pmr::get_default_resource());
+    std::istringstream is(file.str());
+    try {
+        readDDS(is, tex, false);
+        ADD_FAILURE() << "expected a throw";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "dds mip chain exceeds texture size");
+    }
+}
@@ -0,0 +1,216 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <Star/Graphics/SVisibility.h>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Star;
+using namespace Star::Graphics::Render;
+
+namespace {
+
+BoundingBox makeBox(const Vector3f& min, const Vector3f& max) {
+    BoundingBox box;
+    box.mLocalBounds = Box3f(min, max);
+    box.mWorldBounds = Box3f(min, max);
+    return box;
+}
+
+// random boxes around the unit cube, about half of them visible
+std::vector<BoundingBox> makeBoxes(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> ext(0.0f, 0.5f);
+    std::vector<BoundingBox> boxes(count);
+    for (auto& box : boxes) {
+        Vector3f c(pos(rng), pos(rng), pos(rng));
+        Vector3f e(ext(rng), ext(rng), ext(rng));
+        box = makeBox(c - e, c + e);
+    }
+    return boxes;
+}
+
+// right handed view space, looking down -z, z in [0, w]
+Matrix4f makePerspective(float fovY, float aspect, float zNear, float zFar) {
+    const float f = 1.0f / std::tan(fovY * 0.5f);
+    Matrix4f proj = Matrix4f::Zero();
+    proj(0, 0) = f / aspect;
+    proj(1, 1) = f;
+    proj(2, 2) = zFar / (zNear - zFar);
+    proj(2, 3) = zNear * zFar / (zNear - zFar);
+    proj(3, 2) = -1.0f;
+    return proj;
+}
+
+// double precision, boxes closer to a plane than the tolerance are ambiguous
+enum class Reference {
+    Visible,
+    Culled,
+    Ambiguous,
+};
+
+Reference cullReference(const Frustum& frustum, const BoundingBox& box) {
+    const auto& b = box.mWorldBounds;
+    const Vector3d min = b.min_corner().cast<double>();
+    const Vector3d max = b.max_corner().cast<double>();
+    if (!(min.array() <= max.array()).all())
+        return Reference::Visible;
+
+    const Vector3d c = (min + max) * 0.5;
+    const Vector3d e = (max - min) * 0.5;
+    bool ambiguous = false;
+    for (const auto& plane : frustum.mPlanes) {
+        const Vector4d p = plane.cast<double>();
+        double margin = p.head<3>().dot(c) + p[3] + p.head<3>().cwiseAbs().dot(e);
+        if (std::abs(margin) < 1e-4) {
+            ambiguous = true;
+        } else if (margin < 0.0) {
+            return Reference::Culled;
+        }
+    }
+    return ambiguous ? Reference::Ambiguous : Reference::Visible;
+}
+
+void expectMatchesReference(const Frustum& frustum, gsl::span<const BoundingBox> boxes,
+    uint32_t begin, uint32_t end, const std::pmr::vector<uint32_t>& visible
+) {
+    ASSERT_TRUE(std::is_sorted(visible.begin(), visible.end()));
+    ASSERT_EQ(std::adjacent_find(visible.begin(), visible.end()), visible.end());
+    auto iter = visible.begin();
+    for (uint32_t i = begin; i != end; ++i) {
+        const bool culled = iter == visible.end() || *iter != i;
+        if (!culled) {
+            ++iter;
+        }
+        const auto expected = cullReference(frustum, boxes[i]);
+        if (expected == Reference::Ambiguous)
+            continue;
+        EXPECT_EQ(culled, expected == Reference::Culled) << "box " << i;
+    }
+    EXPECT_EQ(iter, visible.end());
+}
+
+}
+
+TEST(Frustum, ExtractsNormalizedPlanes) {
+    // identity clip space, x and y in [-1, 1], z in [0, 1]
+    auto frustum = makeFrustum(Matrix4f::Identity());
+    const std::array<Vector4f, 6> expected = { {
+        { 1, 0, 0, 1 }, { -1, 0, 0, 1 },
+        { 0, 1, 0, 1 }, { 0, -1, 0, 1 },
+        { 0, 0, 1, 0 }, { 0, 0, -1, 1 },
+    } };
+    for (size_t i = 0; i != 6; ++i) {
+        EXPECT_TRUE(frustum.mPlanes[i].isApprox(expected[i])) << i;
+    }
+
+    frustum = makeFrustum(makePerspective(1.0f, 1.5f, 0.1f, 100.0f));
+    for (const auto& plane : frustum.mPlanes) {
+        EXPECT_NEAR(plane.head<3>().norm(), 1.0f, 1e-5f);
+    }
+    // the near plane faces -z at distance 0.1
+    EXPECT_NEAR(frustum.mPlanes[4][2], -1.0f, 1e-5f);
+    EXPECT_NEAR(frustum.mPlanes[4][3], -0.1f, 1e-5f);
+}
+
+TEST(Frustum, TransformsBounds) {
+    Affine3f transform = Affine3f::Identity();
+    transform.translate(Vector3f(10, 0, 0));
+    transform.rotate(Eigen::AngleAxisf(0.5f * 3.14159265f, Vector3f::UnitZ()));
+    auto bounds = transformBounds(Box3f(Vector3f(0, 0, 0), Vector3f(2, 1, 1)), transform);
+    EXPECT_TRUE(bounds.min_corner().isApprox(Vector3f(9, 0, 0), 1e-5f));
+    EXPECT_TRUE(bounds.max_corner().isApprox(Vector3f(10, 2, 1), 1e-5f));
+
+    // rotating by 45 degrees grows the box to hold the rotated corners
+    transform = Eigen::AngleAxisf(0.25f * 3.14159265f, Vector3f::UnitZ());
+    bounds = transformBounds(Box3f(Vector3f(-1, -1, -1), Vector3f(1, 1, 1)), transform);
+    EXPECT_NEAR(bounds.max_corner().x(), std::sqrt(2.0f), 1e-5f);
+    EXPECT_NEAR(bounds.min_corner().y(), -std::sqrt(2.0f), 1e-5f);
+    EXPECT_NEAR(bounds.max_corner().z(), 1.0f, 1e-5f);
+}
+
+TEST(Visibility, MatchesScalarReference) {
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    // simd widths of 4 and 8, their tails and the 4096 grain of the parallel split
+    for (uint32_t count : { 0u, 1u, 3u, 4u, 5u, 7u, 8u, 9u, 15u, 17u,
+        4095u, 4096u, 4097u, 4103u, 8191u, 8192u, 8193u, 3 * 4096u + 5u })
+    {
+        auto boxes = makeBoxes(count, count);
+        std::pmr::vector<uint32_t> visible;
+        cullBoundingBoxes(frustum, boxes, visible);
+        expectMatchesReference(frustum, boxes, 0, count, visible);
+    }
+}
+
+TEST(Visibility, MatchesScalarReferenceInPerspective) {
+    Matrix4f view = Matrix4f::Identity();
+    view(2, 3) = -2.0f; // camera at z = 2
+    const auto frustum = makeFrustum(Matrix4f(makePerspective(1.2f, 1.0f, 0.5f, 4.0f) * view));
+    auto boxes = makeBoxes(20000, 1);
+    std::pmr::vector<uint32_t> visible;
+    cullBoundingBoxes(frustum, boxes, visible);
+    expectMatchesReference(frustum, boxes, 0, gsl::narrow<uint32_t>(boxes.size()), visible);
+    EXPECT_GT(visible.size(), 0u);
+    EXPECT_LT(visible.size(), boxes.size());
+}
+
+TEST(Visibility, CullsRangesAtAnyOffset) {
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    auto boxes = makeBoxes(64, 2);
+    for (uint32_t begin : { 0u, 1u, 3u, 5u, 9u }) {
+        for (uint32_t end : { begin, begin + 1, begin + 7, begin + 8, begin + 13, 64u }) {
+            // visible indices are appended after the existing ones
+            std::pmr::vector<uint32_t> visible{ 1000 };
+            cullBoundingBoxes(frustum, boxes, begin, end, visible);
+            ASSERT_FALSE(visible.empty());
+            EXPECT_EQ(visible.front(), 1000u);
+            visible.erase(visible.begin());
+            expectMatchesReference(frustum, boxes, begin, end, visible);
+        }
+    }
+}
+
+TEST(Visibility, KeepsInvalidBoxes) {
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<BoundingBox> boxes(19, makeBox(Vector3f(5, 5, 5), Vector3f(6, 6, 6)));
+    // in the 8 wide, 4 wide and tail iterations
+    for (uint32_t i : { 2u, 11u, 17u }) {
+        boxes[i] = makeBox(Vector3f(6, 6, 6), Vector3f(5, 5, 5));
+    }
+    boxes[6] = makeBox(Vector3f(5, nan, 5), Vector3f(6, 6, 6));
+    boxes[18] = makeBox(Vector3f(5, 5, 5), Vector3f(6, 6, nan));
+
+    std::pmr::vector<uint32_t> visible;
+    cullBoundingBoxes(frustum, boxes, visible);
+    EXPECT_EQ(visible, (std::pmr::vector<uint32_t>{ 2, 6, 11, 17, 18 }));
+}
+
+TEST(Visibility, KeepsBoxesTouchingThePlanes) {
+    const auto frustum = makeFrustum(Matrix4f::Identity());
+    std::vector<BoundingBox> boxes = {
+        makeBox(Vector3f(1, 0, 0.5f), Vector3f(2, 0.5f, 0.5f)),
+        makeBox(Vector3f(-3, -3, 0), Vector3f(-1, -1, 0)),
+        makeBox(Vector3f(1.001f, 0, 0.5f), Vector3f(2, 0.5f, 0.5f)),
+        makeBox(Vector3f(0, 0, -1), Vector3f(0, 0, -0.001f)),
+    };
+    std::pmr::vector<uint32_t> visible;
+    cullBoundingBoxes(frustum, boxes, visible);
+    EXPECT_EQ(visible, (std::pmr::vector<uint32_t>{ 0, 1 }));
+}
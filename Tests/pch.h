@@ -0,0 +1,72 @@
+// Copyright (C) 2019-2020 star.engine at outlook dot com
+//
+// This file is part of StarEngine
+//
+// StarEngine is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published
+// by the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// StarEngine is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with StarEngine.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+// Portable subset of the Star precompiled headers, shared by tests and benchmarks.
+// SCoreRuntime.h is not included, it pulls in the D3D render types.
+// MSVC pulls these standard headers in transitively, other toolchains do not
+
+#include <memory_resource>
+#include <atomic>
+#include <stdexcept>
+#include <string_view>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <execution>
+
+#ifndef _WIN32
+// SRenderTypes.h mirrors the DRED structs, which name the Windows HRESULT
+using HRESULT = long;
+#endif
+
+#include <Star/PrecompiledHeaders/SCore.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <boost/container/static_vector.hpp>
+#include <boost/container/small_vector.hpp>
+#include <boost/container/flat_set.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/lockfree/queue.hpp>
+#include <boost/msm/front/state_machine_def.hpp>
+#include <boost/msm/back/state_machine.hpp>
+#include <boost/asio.hpp>
+#include <boost/format.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+// unordered_map.hpp of older boost misses this include
+#include <boost/serialization/library_version_type.hpp>
+#include <boost/serialization/array_wrapper.hpp>
+#include <boost/serialization/binary_object.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/unordered_map.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include <Star/SBitwise.h>
+#include <Star/SMemory.h>
+#include <Star/SSmallVector.h>
+#include <Star/SAtomic.h>
+#include <Star/SHash.h>
+#include <Star/SGeometry.h>
+#include <Star/SSerializationUtils.h>
+#include <Star/SFileUtils.h>